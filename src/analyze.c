@@ -20,6 +20,7 @@
 **    CREATE TABLE sqlite_stat1(tbl, idx, stat);
 **    CREATE TABLE sqlite_stat2(tbl, idx, sampleno, sample);
 **    CREATE TABLE sqlite_stat3(tbl, idx, nEq, nLt, nDLt, sample);
+**    CREATE TABLE sqlite_stat4(tbl, idx, nEq, nLt, nDLt, sample);
 **
 ** Additional tables might be added in future releases of SQLite.
 ** The sqlite_stat2 table is not created or used unless the SQLite version
@@ -112,15 +113,36 @@
 ** that contain between 10 and 40 samples which are distributed across
 ** the key space, though not uniformly, and which include samples with
 ** largest possible nEq values.
+**
+** Format for sqlite_stat4:
+**
+** The sqlite_stat4 table is only created and used if SQLite is compiled
+** with SQLITE_ENABLE_STAT4, which implies SQLITE_ENABLE_STAT3.  It holds
+** samples of the multi-column prefixes of each index, collected in the
+** same way as the sqlite_stat3 samples of the left-most column.  For an
+** index on (a,b,c) there are samples of (a,b) and samples of (a,b,c).
+** The sample column is a record, in the format used by OP_MakeRecord,
+** holding the values of the first N columns of the index.  The nEq, nLt
+** and nDLt columns have the same meaning as in sqlite_stat3, except that
+** they compare the whole N-column prefix rather than the left-most
+** column only.  The samples of each prefix are stored in index order,
+** shortest prefix first.
+**
+** sqlite_stat1 gives the average number of rows that match an N-column
+** prefix.  The sqlite_stat4 samples let the query planner see that a
+** particular combination of values, such as (a=? AND b=?) on correlated
+** columns a and b, matches many more or many fewer rows than average.
 */
 #ifndef SQLITE_OMIT_ANALYZE
 #include "sqliteInt.h"
+#include "vdbeInt.h"
 
 /*
 ** This routine generates code that opens the sqlite_stat1 table for
 ** writing with cursor iStatCur. If the library was built with the
 ** SQLITE_ENABLE_STAT3 macro defined, then the sqlite_stat3 table is
-** opened for writing using cursor (iStatCur+1)
+** opened for writing using cursor (iStatCur+1).  Likewise sqlite_stat4
+** is opened using cursor (iStatCur+2) if SQLITE_ENABLE_STAT4 is defined.
 **
 ** If the sqlite_stat1 tables does not previously exist, it is created.
 ** Similarly, if the sqlite_stat3 table does not exist and the library
@@ -156,11 +178,14 @@ static void openStatTable(
     { "sqlite_stat1", "tbl,idx,stat" },
 #ifdef SQLITE_ENABLE_STAT3
     { "sqlite_stat3", "tbl,idx,neq,nlt,ndlt,sample" },
+#endif
+#ifdef SQLITE_ENABLE_STAT4
+    { "sqlite_stat4", "tbl,idx,neq,nlt,ndlt,sample" },
 #endif
   };
 
-  int aRoot[] = {0, 0};
-  u8 aCreateTbl[] = {0, 0};
+  int aRoot[] = {0, 0, 0};
+  u8 aCreateTbl[] = {0, 0, 0};
 
   int i;
   sqlite3 *db = pParse->db;  /*定义数据库句柄*/
@@ -516,7 +541,17 @@ static void analyzeOneTable(
   int once = 1;                /* One-time initialization */ /*一次性初始化*/
   int shortJump = 0;           /* Instruction address */ /*指令地址*/
   int iTabCur = pParse->nTab++; /* Table cursor */ /*表的游标*/
+  int bStat3 = db->nAnalysisSample==0; /* False to skip the stat3/4 samples */
+#endif
+#ifdef SQLITE_ENABLE_STAT4
+  int regPrefix;               /* Six registers for each prefix of 2+ columns */
+  int regPrefixCol;            /* Column values of a prefix sample */
 #endif
+  int nSample = db->nAnalysisSample; /* Leaf pages to sample, or 0 for all */
+  int regLeafLeft = iMem++;    /* Leaf pages still to be sampled */
+  int regRowEst = iMem++;      /* Sum of the row estimates of sampled leaves */
+  int addrLeaf = 0;            /* Address of OP_SampleLeaf */
+  int endOfScan = 0;           /* Jump here once the sampled scan is over */
   int regCol = iMem++;         /* Content of a column in analyzed table *//* 被分析的表中一列的内容 */
   int regRec = iMem++;         /* Register holding completed record */ /* 持有完整记录的记录器 */
   int regTemp = iMem++;        /* Temporary use register *//* 临时用到的记录器*/
@@ -569,6 +604,17 @@ static void analyzeOneTable(
     if( iMem+1+(nCol*2)>pParse->nMem ){  /*nMem表示到目前为止使用的内存单元的数量*/
       pParse->nMem = iMem+1+(nCol*2);
     }
+#ifdef SQLITE_ENABLE_STAT4
+    /* Prefix N+1, for N between 1 and nCol-1, uses registers regPrefix+6*(N-1)
+    ** through regPrefix+6*(N-1)+5 in the same way as the left-most column
+    ** uses regNumEq, regNumLt, regNumDLt, regRowid, regAccum and regLoop.
+    ** stat3_get() may read up to three registers past the last of them. */
+    regPrefix = iMem+1+(nCol*2);
+    regPrefixCol = regPrefix+6*(nCol-1);
+    if( regPrefixCol+nCol+3>pParse->nMem ){
+      pParse->nMem = regPrefixCol+nCol+3;
+    }
+#endif
 
     /* Open a cursor to the index to be analyzed. */
     /*打开将被分析的索引的游标*/
@@ -581,20 +627,36 @@ static void analyzeOneTable(
     sqlite3VdbeAddOp4(v, OP_String8, 0, regIdxname, 0, pIdx->zName, 0);
 
 #ifdef SQLITE_ENABLE_STAT3  /*定义宏*/
-    if( once ){
-      once = 0;
-      sqlite3OpenTable(pParse, iTabCur, iDb, pTab, OP_OpenRead);  /*根据游标iTabCur、数据库索引iDb、表定义pTab，打开表*/
+    /* A sampled analysis does not see the position of each key within
+    ** the index, so it does not collect sqlite_stat3 samples. */
+    if( bStat3 ){
+      if( once ){
+        once = 0;
+        sqlite3OpenTable(pParse, iTabCur, iDb, pTab, OP_OpenRead);  /*根据游标iTabCur、数据库索引iDb、表定义pTab，打开表*/
+      }
+      sqlite3VdbeAddOp2(v, OP_Count, iIdxCur, regCount);  
+      sqlite3VdbeAddOp2(v, OP_Integer, SQLITE_STAT3_SAMPLES, regTemp1);  /*SQLITE_STAT3_SAMPLES表示sqlite_stat3的采样数*/
+      sqlite3VdbeAddOp2(v, OP_Integer, 0, regNumEq);
+      sqlite3VdbeAddOp2(v, OP_Integer, 0, regNumLt);
+      sqlite3VdbeAddOp2(v, OP_Integer, -1, regNumDLt);
+      sqlite3VdbeAddOp3(v, OP_Null, 0, regSample, regAccum);  /*在VDBE中添加一个新的指令到当前列表中，返回新的指令的地址。出自vdbeaux.c*/
+      sqlite3VdbeAddOp4(v, OP_Function, 1, regCount, regAccum,
+                        (char*)&stat3InitFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 2);  /*为最近添加的操作更改操作数 P5 的值*/
     }
-    sqlite3VdbeAddOp2(v, OP_Count, iIdxCur, regCount);  
-    sqlite3VdbeAddOp2(v, OP_Integer, SQLITE_STAT3_SAMPLES, regTemp1);  /*SQLITE_STAT3_SAMPLES表示sqlite_stat3的采样数*/
-    sqlite3VdbeAddOp2(v, OP_Integer, 0, regNumEq);
-    sqlite3VdbeAddOp2(v, OP_Integer, 0, regNumLt);
-    sqlite3VdbeAddOp2(v, OP_Integer, -1, regNumDLt);
-    sqlite3VdbeAddOp3(v, OP_Null, 0, regSample, regAccum);  /*在VDBE中添加一个新的指令到当前列表中，返回新的指令的地址。出自vdbeaux.c*/
-    sqlite3VdbeAddOp4(v, OP_Function, 1, regCount, regAccum,
-                      (char*)&stat3InitFuncdef, P4_FUNCDEF);
-    sqlite3VdbeChangeP5(v, 2);  /*为最近添加的操作更改操作数 P5 的值*/
 #endif /* SQLITE_ENABLE_STAT3 */
+#ifdef SQLITE_ENABLE_STAT4
+    for(i=1; bStat3 && i<nCol; i++){
+      int r = regPrefix+6*(i-1);
+      sqlite3VdbeAddOp2(v, OP_Integer, 0, r);
+      sqlite3VdbeAddOp2(v, OP_Integer, 0, r+1);
+      sqlite3VdbeAddOp2(v, OP_Integer, -1, r+2);
+      sqlite3VdbeAddOp3(v, OP_Null, 0, r+3, r+4);
+      sqlite3VdbeAddOp4(v, OP_Function, 1, regCount, r+4,
+                        (char*)&stat3InitFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 2);
+    }
+#endif /* SQLITE_ENABLE_STAT4 */
 
     /* The block of memory cells initialized here is used as follows.
     **
@@ -634,11 +696,20 @@ static void analyzeOneTable(
     }
 
     /* Start the analysis loop. This loop runs through all the entries in
-    ** the index b-tree.  */
+    ** the index b-tree.  Or, if PRAGMA analysis_sample is set, through
+    ** all entries on nSample leaf pages picked at random.  */
 
     /* 开始循环分析. 这个循环运行了在索引 b-树中的所有条目*/
     endOfLoop = sqlite3VdbeMakeLabel(v);  /*创建一个还没有被编码的指令的新符号标签，这个符号标签仅表示一个负数。出自vdbeaux.c*/
-    sqlite3VdbeAddOp2(v, OP_Rewind, iIdxCur, endOfLoop);
+    if( nSample>0 ){
+      endOfScan = sqlite3VdbeMakeLabel(v);
+      sqlite3VdbeAddOp2(v, OP_Integer, nSample, regLeafLeft);
+      sqlite3VdbeAddOp2(v, OP_Integer, 0, regRowEst);
+      addrLeaf = sqlite3VdbeAddOp3(v, OP_SampleLeaf, iIdxCur, endOfScan,
+                                   regRowEst);
+    }else{
+      sqlite3VdbeAddOp2(v, OP_Rewind, iIdxCur, endOfLoop);
+    }
     topOfLoop = sqlite3VdbeCurrentAddr(v);  /*返回插入下一条指令的地址。*/
     sqlite3VdbeAddOp2(v, OP_AddImm, iMem, 1);  /* 行递增计数器 */
 
@@ -658,10 +729,16 @@ static void analyzeOneTable(
       sqlite3VdbeChangeP5(v, SQLITE_NULLEQ);  /*定义SQLITE_NULLEQ，NULL=NULL*/
       VdbeComment((v, "jump if column %d changed", i));  /*提示*/
 #ifdef SQLITE_ENABLE_STAT3
-      if( i==0 ){
+      if( i==0 && bStat3 ){
         sqlite3VdbeAddOp2(v, OP_AddImm, regNumEq, 1);
         VdbeComment((v, "incr repeat count"));
       }
+#endif
+#ifdef SQLITE_ENABLE_STAT4
+      if( i>0 && bStat3 ){
+        sqlite3VdbeAddOp2(v, OP_AddImm, regPrefix+6*(i-1), 1);
+        VdbeComment((v, "incr repeat count of %d-column prefix", i+1));
+      }
 #endif
     }
     sqlite3VdbeAddOp2(v, OP_Goto, 0, endOfLoop);
@@ -670,15 +747,30 @@ static void analyzeOneTable(
       if( i==0 ){
         sqlite3VdbeJumpHere(v, addrIfNot);   /* Jump dest for OP_IfNot */ /*为OP_IfNot跳转目的地*/
 #ifdef SQLITE_ENABLE_STAT3
-        sqlite3VdbeAddOp4(v, OP_Function, 1, regNumEq, regTemp2,
+        if( bStat3 ){
+          sqlite3VdbeAddOp4(v, OP_Function, 1, regNumEq, regTemp2,
+                            (char*)&stat3PushFuncdef, P4_FUNCDEF);
+          sqlite3VdbeChangeP5(v, 5);
+          sqlite3VdbeAddOp3(v, OP_Column, iIdxCur, pIdx->nColumn, regRowid);
+          sqlite3VdbeAddOp3(v, OP_Add, regNumEq, regNumLt, regNumLt);
+          sqlite3VdbeAddOp2(v, OP_AddImm, regNumDLt, 1);
+          sqlite3VdbeAddOp2(v, OP_Integer, 1, regNumEq);
+        }
+#endif        
+      }
+#ifdef SQLITE_ENABLE_STAT4
+      if( i>0 && bStat3 ){
+        /* Column i changed, so the (i+1)-column prefix changed too */
+        int r = regPrefix+6*(i-1);
+        sqlite3VdbeAddOp4(v, OP_Function, 1, r, regTemp2,
                           (char*)&stat3PushFuncdef, P4_FUNCDEF);
         sqlite3VdbeChangeP5(v, 5);
-        sqlite3VdbeAddOp3(v, OP_Column, iIdxCur, pIdx->nColumn, regRowid);
-        sqlite3VdbeAddOp3(v, OP_Add, regNumEq, regNumLt, regNumLt);
-        sqlite3VdbeAddOp2(v, OP_AddImm, regNumDLt, 1);
-        sqlite3VdbeAddOp2(v, OP_Integer, 1, regNumEq);
-#endif        
+        sqlite3VdbeAddOp3(v, OP_Column, iIdxCur, pIdx->nColumn, r+3);
+        sqlite3VdbeAddOp3(v, OP_Add, r, r+1, r+1);
+        sqlite3VdbeAddOp2(v, OP_AddImm, r+2, 1);
+        sqlite3VdbeAddOp2(v, OP_Integer, 1, r);
       }
+#endif
       sqlite3VdbeAddOp2(v, OP_AddImm, iMem+i+1, 1);
       sqlite3VdbeAddOp3(v, OP_Column, iIdxCur, i, iMem+nCol+i+1);
     }
@@ -689,37 +781,95 @@ static void analyzeOneTable(
     /* 当更新完iMem+1...iMem+1+nCol记录之后总是跳转到此*/
     sqlite3VdbeResolveLabel(v, endOfLoop);  /*释放标签“endOfLoop”的地址给将要插入的下一条指令，endOfLoop必须从之前调用的函数sqlite3VdbeMakeLabel()中获得。*/
 
-    sqlite3VdbeAddOp2(v, OP_Next, iIdxCur, topOfLoop);
+    if( nSample>0 ){
+      /* Move on to the next leaf page, then estimate the size of the
+      ** index as the average of the estimates made at each leaf. */
+      sqlite3VdbeAddOp2(v, OP_SampleNext, iIdxCur, topOfLoop);
+      sqlite3VdbeAddOp2(v, OP_AddImm, regLeafLeft, -1);
+      sqlite3VdbeAddOp2(v, OP_IfPos, regLeafLeft, addrLeaf);
+      sqlite3VdbeResolveLabel(v, endOfScan);
+      sqlite3VdbeAddOp2(v, OP_Integer, nSample, regTemp);
+      sqlite3VdbeAddOp3(v, OP_Divide, regTemp, regRowEst, regRowEst);
+    }else{
+      sqlite3VdbeAddOp2(v, OP_Next, iIdxCur, topOfLoop);
+    }
     sqlite3VdbeAddOp1(v, OP_Close, iIdxCur);
 #ifdef SQLITE_ENABLE_STAT3
-    sqlite3VdbeAddOp4(v, OP_Function, 1, regNumEq, regTemp2,
-                      (char*)&stat3PushFuncdef, P4_FUNCDEF);
-    sqlite3VdbeChangeP5(v, 5);
-    sqlite3VdbeAddOp2(v, OP_Integer, -1, regLoop);
-    shortJump = 
-    sqlite3VdbeAddOp2(v, OP_AddImm, regLoop, 1);
-    sqlite3VdbeAddOp4(v, OP_Function, 1, regAccum, regTemp1,
-                      (char*)&stat3GetFuncdef, P4_FUNCDEF);
-    sqlite3VdbeChangeP5(v, 2);
-    sqlite3VdbeAddOp1(v, OP_IsNull, regTemp1);
-    sqlite3VdbeAddOp3(v, OP_NotExists, iTabCur, shortJump, regTemp1);
-    sqlite3VdbeAddOp3(v, OP_Column, iTabCur, pIdx->aiColumn[0], regSample);
-    sqlite3ColumnDefault(v, pTab, pIdx->aiColumn[0], regSample);
-    sqlite3VdbeAddOp4(v, OP_Function, 1, regAccum, regNumEq,
-                      (char*)&stat3GetFuncdef, P4_FUNCDEF);
-    sqlite3VdbeChangeP5(v, 3);
-    sqlite3VdbeAddOp4(v, OP_Function, 1, regAccum, regNumLt,
-                      (char*)&stat3GetFuncdef, P4_FUNCDEF);
-    sqlite3VdbeChangeP5(v, 4);
-    sqlite3VdbeAddOp4(v, OP_Function, 1, regAccum, regNumDLt,
-                      (char*)&stat3GetFuncdef, P4_FUNCDEF);
-    sqlite3VdbeChangeP5(v, 5);
-    sqlite3VdbeAddOp4(v, OP_MakeRecord, regTabname, 6, regRec, "bbbbbb", 0);
-    sqlite3VdbeAddOp2(v, OP_NewRowid, iStatCur+1, regNewRowid);
-    sqlite3VdbeAddOp3(v, OP_Insert, iStatCur+1, regRec, regNewRowid);
-    sqlite3VdbeAddOp2(v, OP_Goto, 0, shortJump);
-    sqlite3VdbeJumpHere(v, shortJump+2);
+    if( bStat3 ){
+      sqlite3VdbeAddOp4(v, OP_Function, 1, regNumEq, regTemp2,
+                        (char*)&stat3PushFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 5);
+      sqlite3VdbeAddOp2(v, OP_Integer, -1, regLoop);
+      shortJump = 
+      sqlite3VdbeAddOp2(v, OP_AddImm, regLoop, 1);
+      sqlite3VdbeAddOp4(v, OP_Function, 1, regAccum, regTemp1,
+                        (char*)&stat3GetFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 2);
+      sqlite3VdbeAddOp1(v, OP_IsNull, regTemp1);
+      sqlite3VdbeAddOp3(v, OP_NotExists, iTabCur, shortJump, regTemp1);
+      sqlite3VdbeAddOp3(v, OP_Column, iTabCur, pIdx->aiColumn[0], regSample);
+      sqlite3ColumnDefault(v, pTab, pIdx->aiColumn[0], regSample);
+      sqlite3VdbeAddOp4(v, OP_Function, 1, regAccum, regNumEq,
+                        (char*)&stat3GetFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 3);
+      sqlite3VdbeAddOp4(v, OP_Function, 1, regAccum, regNumLt,
+                        (char*)&stat3GetFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 4);
+      sqlite3VdbeAddOp4(v, OP_Function, 1, regAccum, regNumDLt,
+                        (char*)&stat3GetFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 5);
+      sqlite3VdbeAddOp4(v, OP_MakeRecord, regTabname, 6, regRec, "bbbbbb", 0);
+      sqlite3VdbeAddOp2(v, OP_NewRowid, iStatCur+1, regNewRowid);
+      sqlite3VdbeAddOp3(v, OP_Insert, iStatCur+1, regRec, regNewRowid);
+      sqlite3VdbeAddOp2(v, OP_Goto, 0, shortJump);
+      sqlite3VdbeJumpHere(v, shortJump+2);
+    }
 #endif        
+#ifdef SQLITE_ENABLE_STAT4
+    /* Write the samples of each multi-column prefix to sqlite_stat4.  The
+    ** sample is a record built from the prefix columns of the sampled row.
+    */
+    for(i=1; bStat3 && i<nCol; i++){
+      int r = regPrefix+6*(i-1);
+      int addrNext;                /* Top of the loop over samples */
+      int addrIsNull;              /* Exit from the loop over samples */
+      int j;
+      sqlite3VdbeAddOp4(v, OP_Function, 1, r, regTemp2,
+                        (char*)&stat3PushFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 5);
+      sqlite3VdbeAddOp2(v, OP_Integer, -1, r+5);
+      addrNext = sqlite3VdbeAddOp2(v, OP_AddImm, r+5, 1);
+      sqlite3VdbeAddOp4(v, OP_Function, 1, r+4, regTemp1,
+                        (char*)&stat3GetFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 2);
+      addrIsNull = sqlite3VdbeAddOp1(v, OP_IsNull, regTemp1);
+      sqlite3VdbeAddOp3(v, OP_NotExists, iTabCur, addrNext, regTemp1);
+      for(j=0; j<=i; j++){
+        int iCol = pIdx->aiColumn[j];
+        if( iCol==pTab->iPKey ){
+          sqlite3VdbeAddOp2(v, OP_Rowid, iTabCur, regPrefixCol+j);
+        }else{
+          sqlite3VdbeAddOp3(v, OP_Column, iTabCur, iCol, regPrefixCol+j);
+          sqlite3ColumnDefault(v, pTab, iCol, regPrefixCol+j);
+        }
+      }
+      sqlite3VdbeAddOp3(v, OP_MakeRecord, regPrefixCol, i+1, regSample);
+      sqlite3VdbeAddOp4(v, OP_Function, 1, r+4, regNumEq,
+                        (char*)&stat3GetFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 3);
+      sqlite3VdbeAddOp4(v, OP_Function, 1, r+4, regNumLt,
+                        (char*)&stat3GetFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 4);
+      sqlite3VdbeAddOp4(v, OP_Function, 1, r+4, regNumDLt,
+                        (char*)&stat3GetFuncdef, P4_FUNCDEF);
+      sqlite3VdbeChangeP5(v, 5);
+      sqlite3VdbeAddOp4(v, OP_MakeRecord, regTabname, 6, regRec, "bbbbbb", 0);
+      sqlite3VdbeAddOp2(v, OP_NewRowid, iStatCur+2, regNewRowid);
+      sqlite3VdbeAddOp3(v, OP_Insert, iStatCur+2, regRec, regNewRowid);
+      sqlite3VdbeAddOp2(v, OP_Goto, 0, addrNext);
+      sqlite3VdbeJumpHere(v, addrIsNull);
+    }
+#endif /* SQLITE_ENABLE_STAT4 */
 
     /* Store the results in sqlite_stat1.
     **
@@ -752,7 +902,9 @@ static void analyzeOneTable(
     ** 如果k == 0 那么在 sqlite_stat1 表中没有条目.  
     ** 如果k > 0 将总是有这种情况  D>0 因此被0除就不能。
     */
-    sqlite3VdbeAddOp2(v, OP_SCopy, iMem, regStat1);
+    /* A sampled analysis reports the estimated size of the index, and the
+    ** averages found on the sampled pages. */
+    sqlite3VdbeAddOp2(v, OP_SCopy, nSample>0 ? regRowEst : iMem, regStat1);
     if( jZeroRows<0 ){
       jZeroRows = sqlite3VdbeAddOp1(v, OP_IfNot, iMem);
     }
@@ -781,7 +933,18 @@ static void analyzeOneTable(
   if( pTab->pIndex==0 ){
     sqlite3VdbeAddOp3(v, OP_OpenRead, iIdxCur, pTab->tnum, iDb);
     VdbeComment((v, "%s", pTab->zName));
-    sqlite3VdbeAddOp2(v, OP_Count, iIdxCur, regStat1);
+    if( nSample>0 ){
+      sqlite3VdbeAddOp2(v, OP_Integer, nSample, regLeafLeft);
+      sqlite3VdbeAddOp2(v, OP_Integer, 0, regStat1);
+      addrLeaf = sqlite3VdbeAddOp3(v, OP_SampleLeaf, iIdxCur, 0, regStat1);
+      sqlite3VdbeAddOp2(v, OP_AddImm, regLeafLeft, -1);
+      sqlite3VdbeAddOp2(v, OP_IfPos, regLeafLeft, addrLeaf);
+      sqlite3VdbeJumpHere(v, addrLeaf);
+      sqlite3VdbeAddOp2(v, OP_Integer, nSample, regTemp);
+      sqlite3VdbeAddOp3(v, OP_Divide, regTemp, regStat1, regStat1);
+    }else{
+      sqlite3VdbeAddOp2(v, OP_Count, iIdxCur, regStat1);
+    }
     sqlite3VdbeAddOp1(v, OP_Close, iIdxCur);
     jZeroRows = sqlite3VdbeAddOp1(v, OP_IfNot, regStat1);
   }else{
@@ -811,8 +974,59 @@ static void loadAnalysis(Parse *pParse, int iDb){
   }
 }
 
+/*
+** Return true if all the statistics tables used by this build already
+** exist in database iDb.
+*/
+static int analysisTablesExist(sqlite3 *db, int iDb){
+  const char *zDb = db->aDb[iDb].zName;
+  return sqlite3FindTable(db, "sqlite_stat1", zDb)!=0
+#ifdef SQLITE_ENABLE_STAT3
+      && sqlite3FindTable(db, "sqlite_stat3", zDb)!=0
+#endif
+#ifdef SQLITE_ENABLE_STAT4
+      && sqlite3FindTable(db, "sqlite_stat4", zDb)!=0
+#endif
+  ;
+}
+
+/*
+** The number of random paths through a table b-tree that incremental
+** ANALYZE follows to estimate the number of rows in the table.
+*/
+#ifndef SQLITE_ANALYSIS_STALE_SAMPLES
+# define SQLITE_ANALYSIS_STALE_SAMPLES 16
+#endif
+
+/*
+** Return true if an incremental ANALYZE should refresh the statistics of
+** table pTab, which is now estimated to hold nRow rows.  That is the case
+** if the table has no sqlite_stat1 entry, or if nRow differs from the
+** row count recorded in sqlite_stat1 by at least nThreshold percent.
+*/
+static int analysisIsStale(Table *pTab, i64 nRow, int nThreshold){
+  i64 nDiff;
+  if( (pTab->tabFlags & TF_HasStat1)==0 ){
+    return 1;
+  }
+  nDiff = nRow - (i64)pTab->nRowEst;
+  if( nDiff<0 ) nDiff = -nDiff;
+  return nDiff>0 && nDiff*100 >= (i64)pTab->nRowEst*nThreshold;
+}
+
 /*
 ** Generate code that will do an analysis of an entire database
+**
+** If PRAGMA analysis_threshold is set, and the statistics tables already
+** exist, only the tables whose statistics are stale are analyzed.  The
+** statistics of the other tables are left as they are.  A table is stale
+** if its number of rows has drifted from the count in sqlite_stat1.  The
+** number of rows is estimated, and staleness tested by OP_AnalysisFresh,
+** when the statement runs, so the test sees the changes made by every
+** connection since the table was last analyzed, and a prepared ANALYZE
+** sees the changes made since it was prepared.  Changes that leave the
+** number of rows as it was, such as most UPDATE statements, are not
+** detected.
 */
 
 /*该函数用于分析一个完整数据库*/
@@ -822,19 +1036,52 @@ static void analyzeDatabase(Parse *pParse, int iDb){
   HashElem *k;  /*定义一个哈希结构体*/
   int iStatCur;  /* VdbeCursor的索引，用于写sqlite_stat1 表 */
   int iMem;  /*定义可用内存的起始位置*/
+  int nThreshold = db->nAnalysisThreshold;  /* Incremental if non-zero */
 
   sqlite3BeginWriteOperation(pParse, 0, iDb);  /*开始写操作，指定数据库索引。该方法出自 build.c*/
+  sqlite3SchemaLazyLoadAll(db, iDb);
   iStatCur = pParse->nTab;  /*nTab表示事先分配的VDBE光标的数量*/
   pParse->nTab += 3;  /* ？+3？ */
-  openStatTable(pParse, iDb, iStatCur, 0, 0);  /*调用openStatTable方法，打开存储索引的表sqlite_stat1*/
-  iMem = pParse->nMem+1;  /*nMem表示到目前为止使用的内存数量*/
   assert( sqlite3SchemaMutexHeld(db, iDb, 0) );  /*判定模式存在互斥*/
-
-  /*for循环，对数据库中的每一个表进行分析*/
-  /*哈希表宏定义：sqliteHashFirst、sqliteHashNext、sqliteHashData，用于遍历哈希表中的所有元素。*/
-  for(k=sqliteHashFirst(&pSchema->tblHash); k; k=sqliteHashNext(k)){ 
-    Table *pTab = (Table*)sqliteHashData(k);  /*得到要分析的表*/
-    analyzeOneTable(pParse, pTab, 0, iStatCur, iMem);  /*调用analyzeOneTable方法，完成分析单一表的具体过程*/
+  if( nThreshold>0 && analysisTablesExist(db, iDb) ){
+    Vdbe *v = sqlite3GetVdbe(pParse);
+    int iTabCur = pParse->nTab++;       /* Cursor used to sample each table */
+    int regRow = ++pParse->nMem;        /* Estimated rows in the table */
+    int regThreshold = ++pParse->nMem;  /* Must follow regRow */
+    int regLeft = ++pParse->nMem;       /* Paths still to follow */
+    for(k=sqliteHashFirst(&pSchema->tblHash); k; k=sqliteHashNext(k)){
+      Table *pTab = (Table*)sqliteHashData(k);
+      int addrFresh, addrLeaf;
+      if( v==0 ) break;
+      if( pTab->tnum==0 || memcmp(pTab->zName, "sqlite_", 7)==0 ) continue;
+      sqlite3VdbeAddOp3(v, OP_OpenRead, iTabCur, pTab->tnum, iDb);
+      VdbeComment((v, "%s", pTab->zName));
+      sqlite3VdbeAddOp2(v, OP_Integer, SQLITE_ANALYSIS_STALE_SAMPLES, regLeft);
+      sqlite3VdbeAddOp2(v, OP_Integer, 0, regRow);
+      addrLeaf = sqlite3VdbeAddOp3(v, OP_SampleLeaf, iTabCur, 0, regRow);
+      sqlite3VdbeAddOp2(v, OP_AddImm, regLeft, -1);
+      sqlite3VdbeAddOp2(v, OP_IfPos, regLeft, addrLeaf);
+      sqlite3VdbeJumpHere(v, addrLeaf);
+      sqlite3VdbeAddOp1(v, OP_Close, iTabCur);
+      sqlite3VdbeAddOp2(v, OP_Integer, SQLITE_ANALYSIS_STALE_SAMPLES, regLeft);
+      sqlite3VdbeAddOp3(v, OP_Divide, regLeft, regRow, regRow);
+      sqlite3VdbeAddOp2(v, OP_Integer, nThreshold, regThreshold);
+      addrFresh = sqlite3VdbeAddOp4(v, OP_AnalysisFresh, iDb, 0, regRow,
+                                    pTab->zName, 0);
+      openStatTable(pParse, iDb, iStatCur, pTab->zName, "tbl");
+      analyzeOneTable(pParse, pTab, 0, iStatCur, pParse->nMem+1);
+      sqlite3VdbeJumpHere(v, addrFresh);
+    }
+  }else{
+    openStatTable(pParse, iDb, iStatCur, 0, 0);  /*调用openStatTable方法，打开存储索引的表sqlite_stat1*/
+    iMem = pParse->nMem+1;  /*nMem表示到目前为止使用的内存数量*/
+
+    /*for循环，对数据库中的每一个表进行分析*/
+    /*哈希表宏定义：sqliteHashFirst、sqliteHashNext、sqliteHashData，用于遍历哈希表中的所有元素。*/
+    for(k=sqliteHashFirst(&pSchema->tblHash); k; k=sqliteHashNext(k)){ 
+      Table *pTab = (Table*)sqliteHashData(k);  /*得到要分析的表*/
+      analyzeOneTable(pParse, pTab, 0, iStatCur, iMem);  /*调用analyzeOneTable方法，完成分析单一表的具体过程*/
+    }
   }
   loadAnalysis(pParse, iDb);  /*将最近分析的数据库的索引载入内部哈希表*/
 }
@@ -971,8 +1218,124 @@ typedef struct analysisInfo analysisInfo;
 struct analysisInfo {
   sqlite3 *db;
   const char *zDatabase;
+  Schema *pSchema;
 };
 
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+/*
+** The sqlite_stat1 entry argv[] is for a table that has not been parsed
+** yet.  Return the table's SchemaLazy entry, or NULL if it has none.
+**
+** If argv[1] names an index of the table, set *ppIndex to a new Index
+** object, attached to the index's SchemaLazy entry, that has room for
+** the figures in argv[2] and nothing else.  The statistics of the index
+** are loaded into it, and moved to the real index when the table is
+** parsed.  See sqlite3AnalysisLazyApply().  Otherwise set *ppIndex to
+** NULL.
+*/
+static SchemaLazy *analysisLazyTable(
+  analysisInfo *pInfo,    /* Schema being loaded */
+  char **argv,            /* The sqlite_stat1 entry */
+  Index **ppIndex         /* OUT: Object to load index statistics into */
+){
+  Schema *pSchema = pInfo->pSchema;
+  SchemaLazy *pTab;
+  SchemaLazy *pIdx;
+  Index *pStat;
+  const char *z;
+  int nCol = -1;
+
+  *ppIndex = 0;
+  pTab = sqlite3HashFind(&pSchema->lazyHash, argv[0],
+                         sqlite3Strlen30(argv[0]));
+  if( pTab==0 || pTab->pTab!=pTab || pTab->zErr ) return 0;
+  if( argv[1]==0 ) return pTab;
+  pIdx = sqlite3HashFind(&pSchema->lazyHash, argv[1],
+                         sqlite3Strlen30(argv[1]));
+  if( pIdx==0 || pIdx->pTab!=pTab || pIdx->pStat ) return pTab;
+  for(z=argv[2]; *z; z++){
+    if( sqlite3Isdigit(z[0]) && (z==argv[2] || !sqlite3Isdigit(z[-1])) ){
+      nCol++;
+    }
+  }
+  if( nCol<1 ) return pTab;
+  pStat = (Index*)sqlite3MallocZero(ROUND8(sizeof(Index))
+                                    + sizeof(tRowcnt)*(nCol+1));
+  if( pStat==0 ){
+    pInfo->db->mallocFailed = 1;
+    return pTab;
+  }
+  pStat->aiRowEst = (tRowcnt*)&((char*)pStat)[ROUND8(sizeof(Index))];
+  pStat->nColumn = nCol;
+  pIdx->pStat = pStat;
+  *ppIndex = pStat;
+  return pTab;
+}
+
+/*
+** The objects in the list headed by table entry pTab of database iDb
+** have just been parsed.  Move the statistics that were loaded for them
+** while they were not (see analysisLazyTable()) to the new Table and
+** Index objects.
+*/
+void sqlite3AnalysisLazyApply(sqlite3 *db, int iDb, SchemaLazy *pTab){
+  Schema *pSchema = db->aDb[iDb].pSchema;
+  SchemaLazy *p;
+
+  assert( pTab->pTab==pTab );
+  if( pTab->hasStat1 ){
+    Table *pTable = sqlite3HashFind(&pSchema->tblHash, pTab->zName,
+                                    sqlite3Strlen30(pTab->zName));
+    if( pTable ){
+      pTable->nRowEst = pTab->nRowEst;
+      pTable->tabFlags |= TF_HasStat1;
+    }
+  }
+  for(p=pTab; p; p=p->pNext){
+    Index *pStat = p->pStat;
+    Index *pIdx;
+    int i;
+    if( pStat==0 ) continue;
+    pIdx = sqlite3HashFind(&pSchema->idxHash, p->zName,
+                           sqlite3Strlen30(p->zName));
+    if( pIdx==0 ) continue;
+    for(i=0; i<=pIdx->nColumn && i<=pStat->nColumn; i++){
+      pIdx->aiRowEst[i] = pStat->aiRowEst[i];
+    }
+    pIdx->hasStat1 = 1;
+    pIdx->bUnordered = pStat->bUnordered;
+#ifdef SQLITE_ENABLE_STAT3
+    assert( pIdx->aSample==0 );
+    pIdx->nSample = pStat->nSample;
+    pIdx->aSample = pStat->aSample;
+    pIdx->avgEq = pStat->avgEq;
+    pStat->nSample = 0;
+    pStat->aSample = 0;
+#endif
+#ifdef SQLITE_ENABLE_STAT4
+    assert( pIdx->aPrefixSample==0 );
+    pIdx->nPrefixSample = pStat->nPrefixSample;
+    pIdx->aPrefixSample = pStat->aPrefixSample;
+    pStat->nPrefixSample = 0;
+    pStat->aPrefixSample = 0;
+#endif
+  }
+}
+
+/*
+** Discard the statistics held by the SchemaLazy entry p.
+*/
+void sqlite3AnalysisLazyClear(SchemaLazy *p){
+  if( p->pStat ){
+    sqlite3DeleteIndexSamples(0, p->pStat);
+    sqlite3_free(p->pStat);
+    p->pStat = 0;
+  }
+  p->hasStat1 = 0;
+  p->nRowEst = 0;
+}
+#endif /* SQLITE_OMIT_LAZY_SCHEMA */
+
 /*
 ** This callback is invoked once for each index when reading the
 ** sqlite_stat1 table.  
@@ -1000,6 +1363,9 @@ static int analysisLoader(void *pData, int argc, char **argv, char **NotUsed){
   int i, c, n;
   tRowcnt v;  /*宏定义：typedef u32 tRowcnt， 32-bit is the default 32位是默认的  */
   const char *z;
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+  SchemaLazy *pLazy = 0;       /* Entry for a table not yet parsed */
+#endif
 
   assert( argc==3 );
   UNUSED_PARAMETER2(NotUsed, argc);  /* UNUSED_PARAMETER2宏被用来抑制编译器警告，*出自sqliteInt.h 632行 */
@@ -1007,16 +1373,24 @@ static int analysisLoader(void *pData, int argc, char **argv, char **NotUsed){
   if( argv==0 || argv[0]==0 || argv[2]==0 ){
     return 0;
   }
-  pTable = sqlite3FindTable(pInfo->db, argv[0], pInfo->zDatabase);
+  pTable = sqlite3HashFind(&pInfo->pSchema->tblHash, argv[0],
+                           sqlite3Strlen30(argv[0]));
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+  if( pTable==0 ){
+    pLazy = analysisLazyTable(pInfo, argv, &pIndex);
+    if( pLazy==0 ) return 0;
+  }else
+#endif
   if( pTable==0 ){
     return 0;
-  }
-  if( argv[1] ){
-    pIndex = sqlite3FindIndex(pInfo->db, argv[1], pInfo->zDatabase);
+  }else if( argv[1] ){
+    pIndex = sqlite3HashFind(&pInfo->pSchema->idxHash, argv[1],
+                             sqlite3Strlen30(argv[1]));
   }else{
     pIndex = 0;
   }
   n = pIndex ? pIndex->nColumn : 0;
+  if( pIndex ) pIndex->hasStat1 = 1;
   z = argv[2];
   for(i=0; *z && i<=n; i++){
     v = 0;
@@ -1024,7 +1398,16 @@ static int analysisLoader(void *pData, int argc, char **argv, char **NotUsed){
       v = v*10 + c - '0';
       z++;
     }
-    if( i==0 ) pTable->nRowEst = v;
+    if( i==0 && pTable ){
+      pTable->nRowEst = v;
+      pTable->tabFlags |= TF_HasStat1;
+    }
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+    if( i==0 && pLazy ){
+      pLazy->nRowEst = v;
+      pLazy->hasStat1 = 1;
+    }
+#endif
     if( pIndex==0 ) break;
     pIndex->aiRowEst[i] = v;
     if( *z==' ' ) z++;
@@ -1036,6 +1419,28 @@ static int analysisLoader(void *pData, int argc, char **argv, char **NotUsed){
   return 0;
 }
 
+/*
+** Return true if an incremental ANALYZE with a threshold of nThreshold
+** percent should refresh the statistics of table zTab in database iDb,
+** which is estimated to hold nRow rows.  This is called by
+** OP_AnalysisFresh.
+*/
+int sqlite3AnalysisIsStale(
+  sqlite3 *db,            /* Database connection */
+  int iDb,                /* Database holding the table */
+  const char *zTab,       /* Name of the table */
+  i64 nRow,               /* Estimated number of rows in the table */
+  int nThreshold          /* Percentage the row count must have changed */
+){
+  Schema *pSchema;
+  Table *pTab;
+  if( iDb<0 || iDb>=db->nDb || (pSchema = db->aDb[iDb].pSchema)==0 ){
+    return 1;
+  }
+  pTab = sqlite3HashFind(&pSchema->tblHash, zTab, sqlite3Strlen30(zTab));
+  return pTab==0 || analysisIsStale(pTab, nRow, nThreshold);
+}
+
 /*
 ** If the Index.aSample variable is not NULL, delete the aSample[] array
 ** and its contents.
@@ -1054,9 +1459,22 @@ void sqlite3DeleteIndexSamples(sqlite3 *db, Index *pIdx){
     }
     sqlite3DbFree(db, pIdx->aSample);
   }
+#ifdef SQLITE_ENABLE_STAT4
+  if( pIdx->aPrefixSample ){
+    int j;
+    for(j=0; j<pIdx->nPrefixSample; j++){
+      sqlite3DbFree(db, pIdx->aPrefixSample[j].u.z);
+    }
+    sqlite3DbFree(db, pIdx->aPrefixSample);
+  }
+#endif
   if( db && db->pnBytesFreed==0 ){  /*整数型指针pnBytesFreed，若不为空，将其加入函数DbFree()中*/
     pIdx->nSample = 0;  /*nSample当前的样本数目*/
     pIdx->aSample = 0;
+#ifdef SQLITE_ENABLE_STAT4
+    pIdx->nPrefixSample = 0;
+    pIdx->aPrefixSample = 0;
+#endif
   }
 #else
   UNUSED_PARAMETER(db);
@@ -1065,13 +1483,32 @@ void sqlite3DeleteIndexSamples(sqlite3 *db, Index *pIdx){
 }
 
 #ifdef SQLITE_ENABLE_STAT3
+/*
+** Return the Index object that the statistics of index zIndex of pSchema
+** are loaded into, or NULL if there is none.  For an index that has not
+** been parsed yet, this is the object made by analysisLazyTable().
+*/
+static Index *analysisFindIndex(Schema *pSchema, const char *zIndex){
+  int nName = sqlite3Strlen30(zIndex);
+  Index *pIdx = sqlite3HashFind(&pSchema->idxHash, zIndex, nName);
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+  if( pIdx==0 ){
+    SchemaLazy *p = sqlite3HashFind(&pSchema->lazyHash, zIndex, nName);
+    if( p ) pIdx = p->pStat;
+  }
+#endif
+  return pIdx;
+}
+
 /*
 ** Load content from the sqlite_stat3 table into the Index.aSample[]
 ** arrays of all indices.
 */
 
 /*将sqlite_stat3表的内容加载到所有索引的 aSample 数组中*/
-static int loadStat3(sqlite3 *db, const char *zDb){
+static int loadStat3(sqlite3 *db, int iDb){
+  const char *zDb = db->aDb[iDb].zName;
+  Schema *pSchema = db->aDb[iDb].pSchema;
   int rc;                       /* Result codes from subroutines */ /*子过程返回值*/
   sqlite3_stmt *pStmt = 0;      /* An SQL statement being run */ /*正在运行的一个SQl语句*/
   char *zSql;                   /* Text of the SQL statement */ /*SQL语句的内容*/
@@ -1103,7 +1540,7 @@ static int loadStat3(sqlite3 *db, const char *zDb){
     zIndex = (char *)sqlite3_column_text(pStmt, 0);
     if( zIndex==0 ) continue;
     nSample = sqlite3_column_int(pStmt, 1);
-    pIdx = sqlite3FindIndex(db, zIndex, zDb);  /*sqlite3FindIndex方法定位描述一个特定的索引的内存结构*/
+    pIdx = analysisFindIndex(pSchema, zIndex);
     if( pIdx==0 ) continue;
     assert( pIdx->nSample==0 );
     pIdx->nSample = nSample;
@@ -1135,7 +1572,7 @@ static int loadStat3(sqlite3 *db, const char *zDb){
 
     zIndex = (char *)sqlite3_column_text(pStmt, 0);
     if( zIndex==0 ) continue;
-    pIdx = sqlite3FindIndex(db, zIndex, zDb);  /*定位描述一个特定的索引的内存结构*/
+    pIdx = analysisFindIndex(pSchema, zIndex);
     if( pIdx==0 ) continue;
     if( pIdx==pPrevIdx ){
       idx++;
@@ -1195,6 +1632,123 @@ static int loadStat3(sqlite3 *db, const char *zDb){
 }
 #endif /* SQLITE_ENABLE_STAT3 */
 
+#ifdef SQLITE_ENABLE_STAT4
+/*
+** Load content from the sqlite_stat4 table into the Index.aPrefixSample[]
+** arrays of all indices.  Samples that are not well-formed records of
+** between 2 and Index.nColumn fields are ignored.
+*/
+static int loadStat4(sqlite3 *db, int iDb){
+  const char *zDb = db->aDb[iDb].zName;
+  Schema *pSchema = db->aDb[iDb].pSchema;
+  int rc;                       /* Result codes from subroutines */
+  sqlite3_stmt *pStmt = 0;      /* An SQL statement being run */
+  char *zSql;                   /* Text of the SQL statement */
+
+  assert( db->lookaside.bEnabled==0 );
+  if( !sqlite3FindTable(db, "sqlite_stat4", zDb) ){
+    return SQLITE_OK;
+  }
+
+  zSql = sqlite3MPrintf(db, 
+      "SELECT idx,count(*) FROM %Q.sqlite_stat4"
+      " GROUP BY idx", zDb);
+  if( !zSql ){
+    return SQLITE_NOMEM;
+  }
+  rc = sqlite3_prepare(db, zSql, -1, &pStmt, 0);
+  sqlite3DbFree(db, zSql);
+  if( rc ) return rc;
+
+  while( sqlite3_step(pStmt)==SQLITE_ROW ){
+    char *zIndex;   /* Index name */
+    Index *pIdx;    /* Pointer to the index object */
+    int nSample;    /* Number of samples */
+
+    zIndex = (char *)sqlite3_column_text(pStmt, 0);
+    if( zIndex==0 ) continue;
+    nSample = sqlite3_column_int(pStmt, 1);
+    pIdx = analysisFindIndex(pSchema, zIndex);
+    if( pIdx==0 ) continue;
+    assert( pIdx->nPrefixSample==0 );
+    pIdx->aPrefixSample = sqlite3DbMallocZero(db, nSample*sizeof(IndexSample));
+    if( pIdx->aPrefixSample==0 ){
+      db->mallocFailed = 1;
+      sqlite3_finalize(pStmt);
+      return SQLITE_NOMEM;
+    }
+  }
+  rc = sqlite3_finalize(pStmt);
+  if( rc ) return rc;
+
+  zSql = sqlite3MPrintf(db, 
+      "SELECT idx,neq,nlt,ndlt,sample FROM %Q.sqlite_stat4", zDb);
+  if( !zSql ){
+    return SQLITE_NOMEM;
+  }
+  rc = sqlite3_prepare(db, zSql, -1, &pStmt, 0);
+  sqlite3DbFree(db, zSql);
+  if( rc ) return rc;
+
+  while( sqlite3_step(pStmt)==SQLITE_ROW ){
+    char *zIndex;   /* Index name */
+    Index *pIdx;    /* Pointer to the index object */
+    IndexSample *pSample;         /* A slot in pIdx->aPrefixSample[] */
+    const u8 *aRec;               /* The sample record */
+    int nRec;                     /* Size of aRec[] in bytes */
+    u32 szHdr;                    /* Size of the record header */
+    u32 iHdr;                     /* Offset into the record header */
+    u32 serial_type;              /* Serial type of a field */
+    i64 nBody = 0;                /* Body size implied by the header */
+    int nField = 0;               /* Number of fields in the record */
+    int i;
+
+    zIndex = (char *)sqlite3_column_text(pStmt, 0);
+    if( zIndex==0 ) continue;
+    pIdx = analysisFindIndex(pSchema, zIndex);
+    if( pIdx==0 || pIdx->aPrefixSample==0 ) continue;
+    if( sqlite3_column_type(pStmt, 4)!=SQLITE_BLOB ) continue;
+    aRec = (const u8*)sqlite3_column_blob(pStmt, 4);
+    nRec = sqlite3_column_bytes(pStmt, 4);
+    if( aRec==0 || nRec<1 ) continue;
+
+    /* The sample is read by the planner without further checks, so
+    ** ignore any that is not a well-formed record.  Make sure that no
+    ** varint can run past the end of the blob or of the header, that
+    ** the header ends exactly where its size says and that the body is
+    ** exactly as long as the serial types require. */
+    for(i=0; i<nRec && i<9 && (aRec[i]&0x80); i++){}
+    if( i>=nRec ) continue;
+    iHdr = getVarint32(aRec, szHdr);
+    if( szHdr>(u32)nRec || szHdr<=iHdr || (aRec[szHdr-1]&0x80) ) continue;
+    while( iHdr<szHdr && iHdr<(u32)nRec ){
+      iHdr += getVarint32(&aRec[iHdr], serial_type);
+      nBody += sqlite3VdbeSerialTypeLen(serial_type);
+      nField++;
+    }
+    if( iHdr!=szHdr || nBody!=(i64)nRec-szHdr ) continue;
+    if( nField<2 || nField>pIdx->nColumn ) continue;
+
+    pSample = &pIdx->aPrefixSample[pIdx->nPrefixSample];
+    pSample->nEq = (tRowcnt)sqlite3_column_int64(pStmt, 1);
+    pSample->nLt = (tRowcnt)sqlite3_column_int64(pStmt, 2);
+    pSample->nDLt = (tRowcnt)sqlite3_column_int64(pStmt, 3);
+    pSample->eType = SQLITE_BLOB;
+    pSample->nField = (u8)nField;
+    pSample->nByte = nRec;
+    pSample->u.z = sqlite3DbMallocRaw(db, nRec);
+    if( pSample->u.z==0 ){
+      db->mallocFailed = 1;
+      sqlite3_finalize(pStmt);
+      return SQLITE_NOMEM;
+    }
+    memcpy(pSample->u.z, aRec, nRec);
+    pIdx->nPrefixSample++;
+  }
+  return sqlite3_finalize(pStmt);
+}
+#endif /* SQLITE_ENABLE_STAT4 */
+
 /*
 ** Load the content of the sqlite_stat1 and sqlite_stat3 tables. The
 ** contents of sqlite_stat1 are used to populate the Index.aiRowEst[]
@@ -1243,6 +1797,11 @@ int sqlite3AnalysisLoad(sqlite3 *db, int iDb){
 
   /*清空之前的所有数据*/
   assert( sqlite3SchemaMutexHeld(db, iDb, 0) );
+  sqlite3WhereFeedbackClear(db);
+  for(i=sqliteHashFirst(&db->aDb[iDb].pSchema->tblHash);i;i=sqliteHashNext(i)){
+    Table *pTab = sqliteHashData(i);
+    pTab->tabFlags &= ~TF_HasStat1;
+  }
   for(i=sqliteHashFirst(&db->aDb[iDb].pSchema->idxHash);i;i=sqliteHashNext(i)){  
 	/*sqliteHashFirst、sqliteHashNext为哈希表的宏定义，pSchema表示指向数据库模式的指针(可能是共享的)*/
     Index *pIdx = sqliteHashData(i);  /*sqliteHashData为哈希表的宏定义*/
@@ -1250,14 +1809,24 @@ int sqlite3AnalysisLoad(sqlite3 *db, int iDb){
 #ifdef SQLITE_ENABLE_STAT3
     sqlite3DeleteIndexSamples(db, pIdx);
     pIdx->aSample = 0;
+#endif
+#ifdef SQLITE_ENABLE_STAT4
+    pIdx->aPrefixSample = 0;
 #endif
   }
 
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+  for(i=sqliteHashFirst(&db->aDb[iDb].pSchema->lazyHash);i;i=sqliteHashNext(i)){
+    sqlite3AnalysisLazyClear((SchemaLazy*)sqliteHashData(i));
+  }
+#endif
+
   /* Check to make sure the sqlite_stat1 table exists */
 
   /*检查确定sqlite_stat1表存在*/
   sInfo.db = db;
   sInfo.zDatabase = db->aDb[iDb].zName;
+  sInfo.pSchema = db->aDb[iDb].pSchema;
   if( sqlite3FindTable(db, "sqlite_stat1", sInfo.zDatabase)==0 ){  /*定位描述一个特定的数据库表的内存结构*/
     return SQLITE_ERROR;
   }
@@ -1282,7 +1851,12 @@ int sqlite3AnalysisLoad(sqlite3 *db, int iDb){
   if( rc==SQLITE_OK ){
     int lookasideEnabled = db->lookaside.bEnabled;  /*lookaside表示后备动态内存分配配置。bEnabled是一个标志位，占用两个字节的无符号整数，表示可以进行新的后备内存区的分配。*/
     db->lookaside.bEnabled = 0;
-    rc = loadStat3(db, sInfo.zDatabase);
+    rc = loadStat3(db, iDb);
+#ifdef SQLITE_ENABLE_STAT4
+    if( rc==SQLITE_OK ){
+      rc = loadStat4(db, iDb);
+    }
+#endif
     db->lookaside.bEnabled = lookasideEnabled;
   }
 #endif
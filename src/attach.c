@@ -212,6 +212,7 @@ static void attachFunc(
     int iDb = db->nDb - 1;
     assert( iDb>=2 );
     if( db->aDb[iDb].pBt ){
+      sqlite3SchemaShareDetach(db, iDb);
       sqlite3BtreeClose(db->aDb[iDb].pBt);
       db->aDb[iDb].pBt = 0;
       db->aDb[iDb].pSchema = 0;
@@ -285,6 +286,7 @@ static void detachFunc(
     goto detach_error;
   }
 
+  sqlite3SchemaShareDetach(db, i);
   sqlite3BtreeClose(pDb->pBt);
   pDb->pBt = 0;
   pDb->pSchema = 0;
@@ -553,8 +553,9 @@ static int cursorHoldsMutex(BtCursor *p){
 */
 static void invalidateOverflowCache(BtCursor *pCur){
   assert( cursorHoldsMutex(pCur) );
-  sqlite3_free(pCur->aOverflow);
-  pCur->aOverflow = 0;
+  /* The array is kept for the next entry.  accessPayload() clears it
+  ** whenever aOverflow[0] is not the first overflow page of the entry. */
+  if( pCur->aOverflow ) pCur->aOverflow[0] = 0;
 }
 
 /*
@@ -4028,7 +4029,9 @@ int sqlite3BtreeCloseCursor(BtCursor *pCur){  // 
       releasePage(pCur->apPage[i]);
     }
     unlockBtreeIfUnused(pBt);
-    invalidateOverflowCache(pCur);
+#ifndef SQLITE_OMIT_INCRBLOB
+    sqlite3_free(pCur->aOverflow);
+#endif
     /* sqlite3_free(pCur); */
     sqlite3BtreeLeave(pBtree);
   }
@@ -4378,13 +4381,36 @@ static int accessPayload(          //
     /*isIncrblobHandle־úBtCursor.aOverflow[]δ䣬ڷ   
 	aOverflow[]е0ʾ֡
 	*/
-    if( pCur->isIncrblobHandle && !pCur->aOverflow ){
+    /* Ordinary read cursors keep the same cache so that the several
+    ** sqlite3BtreeData() calls OP_Column makes against one large row
+    ** fetch only the overflow pages they need instead of walking the
+    ** chain from its head each time.  The cache is keyed by the first
+    ** overflow page of the entry.  The array only ever grows, and a
+    ** cache left behind by a previous entry is cleared, not freed, so a
+    ** scan of many large rows does not allocate once per row.  For those
+    ** cursors the cache is only an optimization and a failed allocation
+    ** is not an error.
+    */
+    if( pCur->isIncrblobHandle || eOp==0 ){
       int nOvfl = (pCur->info.nPayload-pCur->info.nLocal+ovflSize-1)/ovflSize;
-      pCur->aOverflow = (Pgno *)sqlite3MallocZero(sizeof(Pgno)*nOvfl);
       /* nOvfl is always positive.  If it were zero, fetchPayload would have
       ** been used instead of this routine. */
-      if( ALWAYS(nOvfl) && !pCur->aOverflow ){
-        rc = SQLITE_NOMEM;
+      assert( nOvfl>0 );
+      if( nOvfl>pCur->nOvflAlloc ){
+        Pgno *aNew = (Pgno*)sqlite3Realloc(pCur->aOverflow, nOvfl*2*sizeof(Pgno));
+        if( aNew==0 ){
+          sqlite3_free(pCur->aOverflow);
+          pCur->aOverflow = 0;
+          pCur->nOvflAlloc = 0;
+          if( pCur->isIncrblobHandle ) rc = SQLITE_NOMEM;
+        }else{
+          pCur->aOverflow = aNew;
+          pCur->nOvflAlloc = nOvfl*2;
+          aNew[0] = 0;
+        }
+      }
+      if( pCur->aOverflow && pCur->aOverflow[0]!=nextPage ){
+        memset(pCur->aOverflow, 0, nOvfl*sizeof(Pgno));
       }
     }
 
@@ -5843,6 +5869,11 @@ static int clearCell(MemPage *pPage, unsigned char *pCell){     //
   ovflPgno = get4byte(&pCell[info.iOverflow]);
   assert( pBt->usableSize > 4 );
   ovflPageSize = pBt->usableSize - 4;
+
+  /* The pages of this chain are about to be freed and may be reused by
+  ** another entry.  Discard any cursor overflow cache that might still
+  ** refer to them. */
+  invalidateAllOverflowCache(pBt);
   nOvfl = (info.nPayload - info.nLocal + ovflPageSize - 1)/ovflPageSize;
   assert( ovflPgno==0 || nOvfl>0 );
   while( nOvfl-- ){
@@ -8357,6 +8388,99 @@ int sqlite3BtreeCount(BtCursor *pCur, i64 *pnEntry){    //
 }
 #endif
 
+#ifndef SQLITE_OMIT_ANALYZE
+/*
+** Move cursor pCur to the first entry of a leaf page chosen by descending
+** from the root of the b-tree and picking a child at random on each
+** interior page on the way down.  Only the pages on that path are read.
+**
+** *pnEst is set to the product of the number of children of each interior
+** page on the path and the number of cells on the leaf.  This is the
+** number of leaf entries the b-tree would hold if every page on each level
+** looked like the one visited.  Averaged over many calls it is an unbiased
+** estimate of the number of leaf entries in the b-tree.
+**
+** Set *pRes to 1 if the b-tree is empty, or to 0 otherwise.
+*/
+int sqlite3BtreeSampleLeaf(BtCursor *pCur, i64 *pnEst, int *pRes){
+  MemPage *pPage;
+  i64 nEst = 1;
+  int rc;
+
+  assert( cursorHoldsMutex(pCur) );
+  assert( sqlite3_mutex_held(pCur->pBtree->db->mutex) );
+  *pnEst = 0;
+  rc = moveToRoot(pCur);
+  if( rc!=SQLITE_OK ){
+    return rc;
+  }
+  if( pCur->eState==CURSOR_INVALID ){
+    assert( pCur->pgnoRoot==0 || pCur->apPage[pCur->iPage]->nCell==0 );
+    *pRes = 1;
+    return SQLITE_OK;
+  }
+  while( !(pPage = pCur->apPage[pCur->iPage])->leaf ){
+    u32 iRand;
+    int iChild;
+    sqlite3_randomness(sizeof(iRand), &iRand);
+    iChild = iRand % (pPage->nCell+1);
+    nEst *= pPage->nCell+1;
+    pCur->aiIdx[pCur->iPage] = (u16)iChild;
+    if( iChild==pPage->nCell ){
+      rc = moveToChild(pCur, get4byte(&pPage->aData[pPage->hdrOffset+8]));
+    }else{
+      rc = moveToChild(pCur, get4byte(findCell(pPage, iChild)));
+    }
+    if( rc!=SQLITE_OK ){
+      return rc;
+    }
+  }
+  if( pPage->nCell==0 ){
+    return SQLITE_CORRUPT_BKPT;
+  }
+  *pnEst = nEst*pPage->nCell;
+  *pRes = 0;
+  return SQLITE_OK;
+}
+
+/*
+** Advance cursor pCur to the next entry on the leaf page that it points
+** to.  Set *pRes to 0 if successful.  If the cursor already points to the
+** last entry of the page, leave it where it is and set *pRes to 1.
+** Together with sqlite3BtreeSampleLeaf() this scans a random sample of
+** the leaf pages of a b-tree.
+*/
+int sqlite3BtreeNextInLeaf(BtCursor *pCur, int *pRes){
+  MemPage *pPage;
+  int rc;
+
+  assert( cursorHoldsMutex(pCur) );
+  rc = restoreCursorPosition(pCur);
+  if( rc!=SQLITE_OK ){
+    return rc;
+  }
+  *pRes = 1;
+  if( CURSOR_INVALID==pCur->eState ){
+    return SQLITE_OK;
+  }
+  if( pCur->skipNext>0 ){
+    pCur->skipNext = 0;
+    *pRes = 0;
+    return SQLITE_OK;
+  }
+  pCur->skipNext = 0;
+  pPage = pCur->apPage[pCur->iPage];
+  if( !pPage->leaf || pCur->aiIdx[pCur->iPage]+1>=pPage->nCell ){
+    return SQLITE_OK;
+  }
+  pCur->aiIdx[pCur->iPage]++;
+  pCur->info.nSize = 0;
+  pCur->validNKey = 0;
+  *pRes = 0;
+  return SQLITE_OK;
+}
+#endif /* SQLITE_OMIT_ANALYZE */
+
 /*
 ** Return the pager associated with a BTree.  This routine is used for
 ** testing and debugging only.
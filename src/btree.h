@@ -195,6 +195,10 @@ int sqlite3BtreeCursorIsValid(BtCursor*);
 #ifndef SQLITE_OMIT_BTREECOUNT
 int sqlite3BtreeCount(BtCursor *, i64 *);
 #endif
+#ifndef SQLITE_OMIT_ANALYZE
+int sqlite3BtreeSampleLeaf(BtCursor *, i64 *, int *);
+int sqlite3BtreeNextInLeaf(BtCursor *, int *);
+#endif
 
 #ifdef SQLITE_TEST
 int sqlite3BtreeCursorInfo(BtCursor*, int*, int);
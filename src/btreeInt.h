@@ -535,6 +535,7 @@ struct BtCursor {
   struct KeyInfo *pKeyInfo; /* Argument passed to comparison function */          //参数传递给比较函数
 #ifndef SQLITE_OMIT_INCRBLOB
   Pgno *aOverflow;          /* Cache of overflow page locations */                //缓存溢出的页面位置
+  int nOvflAlloc;           /* Allocated size of aOverflow[] */
 #endif
   Pgno pgnoRoot;            /* The root page of this tree */                      //此Btree的根页页号
   sqlite3_int64 cachedRowid; /* Next rowid cache.  0 means not valid */           //下一个rowid的缓存，0表示无效
@@ -420,6 +420,9 @@ Table *sqlite3FindTable(sqlite3 *db, const char *zName, const char *zDatabase){
 		if (zDatabase != 0 && sqlite3StrICmp(zDatabase, db->aDb[j].zName)) continue;
 		assert(sqlite3SchemaMutexHeld(db, j, 0));   //断言这个表模式已经完全获得了临界区 ，临界区是互斥访问的      
 		p = sqlite3HashFind(&db->aDb[j].pSchema->tblHash, zName, nName);    //进行的是hash查找算法
+		if (p == 0 && sqlite3SchemaLazyLoad(db, j, zName)){
+			p = sqlite3HashFind(&db->aDb[j].pSchema->tblHash, zName, nName);
+		}
 		if (p) break;   //如果找到了，则结束查找工作
 	}
 	return p;   //如果找到的话，返回这个表的地址
@@ -453,6 +456,12 @@ Table *sqlite3LocateTable(
 	p = sqlite3FindTable(pParse->db, zName, zDbase);    //调用寻找表的函数
 	if (p == 0){
 		const char *zMsg = isView ? "no such view" : "no such table";   //判断得到的视图还是表
+		const char *zErr = sqlite3SchemaLazyError(pParse->db, zName, zDbase);
+		if (zErr){   /* The table exists but its CREATE statement could not be parsed */
+			sqlite3ErrorMsg(pParse, "%s", zErr);
+			pParse->rc = SQLITE_CORRUPT;
+			return 0;
+		}
 		if (zDbase){   //如果数据库不为空
 			sqlite3ErrorMsg(pParse, "%s: %s.%s", zMsg, zDbase, zName);    //输出相应的信息
 		}
@@ -498,6 +507,9 @@ Index *sqlite3FindIndex(sqlite3 *db, const char *zName, const char *zDb){
 		if (zDb && sqlite3StrICmp(zDb, db->aDb[j].zName)) continue;
 		assert(sqlite3SchemaMutexHeld(db, j, 0));   //断言该模式已经完全的拥有了临界区
 		p = sqlite3HashFind(&pSchema->idxHash, zName, nName);   //采用的是hash查找
+		if (p == 0 && sqlite3SchemaLazyLoad(db, j, zName)){
+			p = sqlite3HashFind(&pSchema->idxHash, zName, nName);
+		}
 		if (p) break;   //如果查找到了相应的索引，则终止这个循环的查找
 	}
 	return p;
@@ -600,6 +612,7 @@ void sqlite3ResetOneSchema(sqlite3 *db, int iDb){
 	pDb = &db->aDb[iDb];
 	assert(sqlite3SchemaMutexHeld(db, iDb, 0));
 	assert(pDb->pSchema != 0);//0为main，1为临时
+	sqlite3SchemaShareDetach(db, iDb);
 	sqlite3SchemaClear(pDb->pSchema);
 
 	/* If any database other than TEMP is reset, then also reset TEMP
@@ -626,6 +639,7 @@ void sqlite3ResetAllSchemasOfConnection(sqlite3 *db){
 	for (i = 0; i<db->nDb; i++){//循环查找出所有的数据库并对数据库模式进行操作
 		Db *pDb = &db->aDb[i];
 		if (pDb->pSchema){
+			sqlite3SchemaShareDetach(db, i);
 			sqlite3SchemaClear(pDb->pSchema);
 		}
 	}
@@ -688,6 +702,10 @@ void sqlite3DeleteTable(sqlite3 *db, Table *pTable){//不拆开给定的哈希
 
 	/* Do not delete the table until the reference count reaches zero. 如果正在使用这个表则不会删除，如果没有引用那么就删除这个表，是否引用这个表用count参数指定 */
 	if (!pTable) return;
+	/* A statement's reference to a table of a published schema was not
+	** counted by sqlite3TableRef().  The schema frees its tables itself,
+	** passing db==0. */
+	if (db && (pTable->tabFlags & TF_Shared) && db->pnBytesFreed == 0) return;
 	if (((!db || db->pnBytesFreed == 0) && (--pTable->nRef)>0)) return;
 
 	/* Record the number of outstanding lookaside allocations in schema Tables
@@ -2213,6 +2231,7 @@ void sqlite3RootPageMoved(sqlite3 *db, int iDb, int iFrom, int iTo){
 			pIdx->tnum = iTo;
 		}
 	}
+	sqlite3SchemaLazyMoved(pDb->pSchema, iFrom, iTo);
 }
 #endif
 
@@ -2268,7 +2287,7 @@ static void destroyRootPage(Parse *pParse, int iTable, int iDb){
 }
 
 /*
-** Remove entries from the sqlite_statN tables (for N in (1,2,3))//运行删除索引或删除表的指令后从sqlite_statN表删除条目(N(1、2、3))
+** Remove entries from the sqlite_statN tables (for N in (1,2,3,4))//运行删除索引或删除表的指令后从sqlite_statN表删除条目(N(1、2、3))
 ** after a DROP INDEX or DROP TABLE command.
 */
 static void sqlite3ClearStatTables(
@@ -2279,7 +2298,7 @@ static void sqlite3ClearStatTables(
 ){
   int i;
   const char *zDbName = pParse->db->aDb[iDb].zName;  //语法解析上下文所指向的表或者索引的名字
-  for(i=1; i<=3; i++){
+  for(i=1; i<=4; i++){
     char zTab[24];
     sqlite3_snprintf(sizeof(zTab),zTab,"sqlite_stat%d",i);     //  打印出现在的表是1或者2或者3
     if( sqlite3FindTable(pParse->db, zTab, zDbName) ){        //寻找相应的表
@@ -3245,6 +3264,7 @@ void sqlite3DefaultRowEst(Index *pIdx){
   int i;
   tRowcnt n;
   assert( a!=0 );
+  pIdx->hasStat1 = 0;
   a[0] = pIdx->pTable->nRowEst;
   if( a[0]<10 ) a[0] = 10;
   n = 10;
@@ -3536,7 +3556,7 @@ SrcList *sqlite3SrcListAppend(
   struct SrcList_item *pItem;
   assert( pDatabase==0 || pTable!=0 );  /* Cannot have C without B *///没有哦B时不能有C
   if( pList==0 ){
-    pList = sqlite3DbMallocZero(db, sizeof(SrcList) );
+    pList = sqlite3ArenaMallocZero(db, sizeof(SrcList) );
     if( pList==0 ) return 0;
     pList->nAlloc = 1;
   }
@@ -3973,6 +3993,7 @@ static void reindexDatabases(Parse *pParse, char const *zColl){
   assert( sqlite3BtreeHoldsAllMutexes(db) );  /* Needed for schema access *///需要接入模式
   for(iDb=0, pDb=db->aDb; iDb<db->nDb; iDb++, pDb++){
     assert( pDb!=0 );
+    sqlite3SchemaLazyLoadAll(db, iDb);
     for(k=sqliteHashFirst(&pDb->pSchema->tblHash);  k; k=sqliteHashNext(k)){
       pTab = (Table*)sqliteHashData(k);
       reindexTable(pParse, pTab, zColl);
@@ -446,6 +446,7 @@ void sqlite3SchemaClear(void *p){
   }
   sqlite3HashClear(&temp1);
   sqlite3HashClear(&pSchema->fkeyHash);
+  sqlite3SchemaLazyClear(pSchema);
   pSchema->pSeqTab = 0;
   if( pSchema->flags & DB_SchemaLoaded ){
     pSchema->iGeneration++;
@@ -471,7 +472,382 @@ Schema *sqlite3SchemaGet(sqlite3 *db, Btree *pBt){
     sqlite3HashInit(&p->idxHash);
     sqlite3HashInit(&p->trigHash);
     sqlite3HashInit(&p->fkeyHash);
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+    sqlite3HashInit(&p->lazyHash);
+#endif
     p->enc = SQLITE_UTF8;
   }
   return p;
 }
+
+#ifndef SQLITE_OMIT_SHARED_SCHEMA
+/*
+** While PRAGMA shared_schema is on, the schema of a database file is
+** parsed into a standalone Schema object instead of the one that belongs
+** to the Btree.  Once it has been parsed without error the object is
+** published in a process wide list, keyed by the name of the database
+** file.  Other connections that enable shared_schema and open the same
+** file with the same schema cookie, file format and text encoding then
+** use the published object instead of parsing sqlite_master again.  A
+** standalone schema is reference counted, with one reference held by
+** each connection that uses it and one by the published list.
+**
+** A published schema is never written to, so connections read it
+** without any lock.  Everything that would otherwise be filled in on
+** first use is built before the schema is published (see
+** schemaShareComplete()): tables loaded lazily are parsed, the columns
+** of views computed, affinity strings and foreign key action triggers
+** built and statistics loaded.  Statements do not count their references
+** to the tables of a published schema in Table.nRef (see TF_Shared and
+** sqlite3TableRef()); instead, each connection holds a reference to every
+** standalone schema it uses for the duration of sqlite3_prepare() and
+** the like (see sqlite3SchemaShareEnter()).  The process wide schema
+** share mutex only guards the list of published schemas and the
+** reference counts.  Anything that would change the schema (DDL,
+** ANALYZE, a moved root page) first calls sqlite3SchemaUnshare() to
+** detach the connection, which then parses and publishes a new schema
+** object the next time it needs one.  Other connections move to the new
+** object when they see the changed schema cookie.
+**
+** A schema is only published, or replaced by a published one, when it
+** is read outside of any write transaction and while the connection is
+** in autocommit mode.  A schema read inside a write transaction might
+** reflect changes that are later rolled back, and so its schema cookie
+** does not identify it.
+**
+** Virtual tables keep per-connection state in their Table objects, so
+** a schema that contains any is never published.
+*/
+static struct {
+  sqlite3_mutex *mutex;      /* Recursive mutex.  Allocated on first use */
+  Schema *pList;             /* Published schemas */
+} schemaShare = { 0, 0 };
+
+/*
+** Return the schema share mutex, allocating it if necessary.  Return
+** NULL if it cannot be allocated.
+*/
+static sqlite3_mutex *schemaShareMutex(void){
+  if( schemaShare.mutex==0 ){
+    sqlite3_mutex *pMaster = sqlite3MutexAlloc(SQLITE_MUTEX_STATIC_MASTER);
+    sqlite3_mutex_enter(pMaster);
+    if( schemaShare.mutex==0 ){
+      schemaShare.mutex = sqlite3MutexAlloc(SQLITE_MUTEX_RECURSIVE);
+    }
+    sqlite3_mutex_leave(pMaster);
+  }
+  return schemaShare.mutex;
+}
+
+/*
+** Drop a reference to standalone schema p.  Free it when the last
+** reference goes away.  The caller must hold the schema share mutex.
+*/
+static void schemaShareUnref(Schema *p){
+  assert( p->nShareRef>0 );
+  assert( sqlite3_mutex_held(schemaShare.mutex) );
+  if( --p->nShareRef==0 ){
+    assert( p->zShareFile==0 );
+    sqlite3SchemaClear(p);
+    sqlite3DbFree(0, p);
+  }
+}
+
+/*
+** Remove schema p from the published list and drop the reference
+** held by the list.  The caller must hold the schema share mutex.
+*/
+static void schemaShareUnpublish(Schema *p){
+  Schema **pp;
+  assert( p->zShareFile!=0 );
+  for(pp=&schemaShare.pList; *pp!=p; pp=&(*pp)->pShareNext){
+    assert( *pp!=0 );
+  }
+  *pp = p->pShareNext;
+  p->pShareNext = 0;
+  sqlite3DbFree(0, p->zShareFile);
+  p->zShareFile = 0;
+  schemaShareUnref(p);
+}
+
+/*
+** Return true if the schema of database iDb may be shared with other
+** connections.  The TEMP database, in-memory and temporary databases
+** and databases opened in shared-cache mode (where the schema is already
+** shared through the BtShared object) are never shared.  Neither is a
+** schema read while PRAGMA writable_schema is on, since it may be
+** incomplete.
+*/
+static int schemaShareable(sqlite3 *db, int iDb){
+  Btree *pBt = db->aDb[iDb].pBt;
+  const char *zFile;
+  if( !db->bSharedSchema || iDb==1 || pBt==0 ) return 0;
+  if( db->flags & (SQLITE_WriteSchema|SQLITE_RecoveryMode) ) return 0;
+  if( sqlite3BtreeSharable(pBt) ) return 0;
+  zFile = sqlite3BtreeGetFilename(pBt);
+  if( zFile==0 || zFile[0]==0 ) return 0;
+  return schemaShareMutex()!=0;
+}
+
+/*
+** Return true if the schema of database iDb, as just read, is known to
+** be committed: the connection is in autocommit mode and has no write
+** transaction open on the database.
+*/
+static int schemaShareCommitted(sqlite3 *db, int iDb){
+  return db->autoCommit && !sqlite3BtreeIsInTrans(db->aDb[iDb].pBt);
+}
+
+/*
+** Called by sqlite3InitOne() before the schema of database iDb is read.
+** If that schema may be shared, replace the (empty) schema of the Btree
+** with a new standalone schema for sqlite3InitOne() to read into.
+*/
+int sqlite3SchemaShareBegin(sqlite3 *db, int iDb){
+  Db *pDb = &db->aDb[iDb];
+  Schema *p;
+  if( !schemaShareable(db, iDb) ) return SQLITE_OK;
+  sqlite3SchemaShareDetach(db, iDb);
+  p = (Schema *)sqlite3DbMallocZero(0, sizeof(Schema));
+  if( p==0 ){
+    db->mallocFailed = 1;
+    return SQLITE_NOMEM;
+  }
+  sqlite3HashInit(&p->tblHash);
+  sqlite3HashInit(&p->idxHash);
+  sqlite3HashInit(&p->trigHash);
+  sqlite3HashInit(&p->fkeyHash);
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+  sqlite3HashInit(&p->lazyHash);
+#endif
+  p->enc = pDb->pSchema->enc;
+  p->cache_size = pDb->pSchema->cache_size;
+  p->nShareRef = 1;
+  pDb->pSchema = p;
+  return SQLITE_OK;
+}
+
+/*
+** Called by sqlite3InitOne() once the schema cookie, file format and
+** text encoding of database iDb have been read into the standalone
+** schema created by sqlite3SchemaShareBegin().  If a matching schema
+** has been published, use it in place of the new one and return true.
+** The caller then skips reading sqlite_master.
+*/
+int sqlite3SchemaShareAttach(sqlite3 *db, int iDb){
+  Db *pDb = &db->aDb[iDb];
+  Schema *pNew = pDb->pSchema;
+  Schema *p;
+  const char *zFile;
+  if( pNew->nShareRef==0 || !schemaShareCommitted(db, iDb) ) return 0;
+  assert( pNew->nShareRef==1 && pNew->zShareFile==0 );
+  zFile = sqlite3BtreeGetFilename(pDb->pBt);
+  sqlite3_mutex_enter(schemaShare.mutex);
+  for(p=schemaShare.pList; p; p=p->pShareNext){
+    if( p->schema_cookie==pNew->schema_cookie
+     && p->file_format==pNew->file_format
+     && p->enc==pNew->enc
+     && strcmp(p->zShareFile, zFile)==0
+    ){
+      p->nShareRef++;
+      pDb->pSchema = p;
+      schemaShareUnref(pNew);
+      break;
+    }
+  }
+  sqlite3_mutex_leave(schemaShare.mutex);
+  return p!=0;
+}
+
+/*
+** Build everything in standalone schema iDb that would otherwise be
+** built the first time a statement uses it, so that the schema is not
+** written to once it is published.  Return true on success, or false
+** if something could not be built, in which case the schema is kept
+** by this connection and the error is reported by the statement that
+** next needs the object.
+*/
+static int schemaShareComplete(sqlite3 *db, int iDb){
+  Schema *p = db->aDb[iDb].pSchema;
+  ParseArena *pSavedArena = db->pArena;
+  Parse *pParse;
+  HashElem *pElem;
+  int bOk = 1;
+
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+  if( p->lazyHash.count>0 ){
+    u8 busy = db->init.busy;
+    db->init.busy = 0;
+    sqlite3SchemaLazyLoadAll(db, iDb);
+    db->init.busy = busy;
+    if( p->lazyHash.count>0 || db->mallocFailed ) return 0;
+  }
+#endif
+
+  pParse = sqlite3StackAllocZero(db, sizeof(*pParse));
+  if( pParse==0 ) return 0;
+  pParse->db = db;
+  pParse->nQueryLoop = 1;
+
+  /* The objects built here become part of the schema, so they must not
+  ** be built in the arena of a statement that is being prepared. */
+  db->pArena = 0;
+  for(pElem=sqliteHashFirst(&p->tblHash); bOk && pElem;
+      pElem=sqliteHashNext(pElem)){
+    Table *pTab = (Table*)sqliteHashData(pElem);
+    if( (pTab->pSelect && sqlite3ViewGetColumnNames(pParse, pTab))
+     || sqlite3FkBuildActions(pParse, pTab)
+     || sqlite3TableAffinityInit(db, pTab)
+     || pParse->nErr || db->mallocFailed
+    ){
+      bOk = 0;
+    }
+  }
+  db->pArena = pSavedArena;
+  sqlite3DbFree(db, pParse->zErrMsg);
+  sqlite3StackFree(db, pParse);
+  return bOk;
+}
+
+/*
+** Called by sqlite3InitOne() after the schema of database iDb has been
+** read without error.  If it was read into a standalone schema, complete
+** it and publish it for use by other connections, replacing any schema
+** published earlier for the same file.
+*/
+void sqlite3SchemaSharePublish(sqlite3 *db, int iDb){
+  Db *pDb = &db->aDb[iDb];
+  Schema *p = pDb->pSchema;
+  Schema *pOld;
+  HashElem *pElem;
+  char *zFile;
+  if( p->nShareRef==0 || p->zShareFile ) return;
+  if( !schemaShareCommitted(db, iDb) ) return;
+  for(pElem=sqliteHashFirst(&p->tblHash); pElem; pElem=sqliteHashNext(pElem)){
+    if( IsVirtual((Table*)sqliteHashData(pElem)) ) return;
+  }
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+  for(pElem=sqliteHashFirst(&p->lazyHash); pElem; pElem=sqliteHashNext(pElem)){
+    const char *zSql = ((SchemaLazy*)sqliteHashData(pElem))->zSql;
+    if( zSql && sqlite3_strnicmp(zSql, "CREATE VIRTUAL", 14)==0 ) return;
+  }
+#endif
+  if( !schemaShareComplete(db, iDb) ) return;
+  zFile = sqlite3DbStrDup(0, sqlite3BtreeGetFilename(pDb->pBt));
+  if( zFile==0 ) return;
+  for(pElem=sqliteHashFirst(&p->tblHash); pElem; pElem=sqliteHashNext(pElem)){
+    ((Table*)sqliteHashData(pElem))->tabFlags |= TF_Shared;
+  }
+  p->flags &= ~DB_UnresetViews;
+  sqlite3_mutex_enter(schemaShare.mutex);
+  for(pOld=schemaShare.pList; pOld; pOld=pOld->pShareNext){
+    if( strcmp(pOld->zShareFile, zFile)==0 ){
+      schemaShareUnpublish(pOld);
+      break;
+    }
+  }
+  p->zShareFile = zFile;
+  p->pShareNext = schemaShare.pList;
+  p->nShareRef++;
+  schemaShare.pList = p;
+  sqlite3_mutex_leave(schemaShare.mutex);
+}
+
+/*
+** If database iDb is using a standalone schema, stop using it and go
+** back to the (empty) schema that belongs to the Btree.
+*/
+void sqlite3SchemaShareDetach(sqlite3 *db, int iDb){
+  Db *pDb = &db->aDb[iDb];
+  Schema *p = pDb->pSchema;
+  if( p==0 || p->nShareRef==0 ) return;
+  assert( pDb->pBt!=0 );
+  pDb->pSchema = sqlite3SchemaGet(db, pDb->pBt);
+  assert( pDb->pSchema!=0 );
+  sqlite3_mutex_enter(schemaShare.mutex);
+  schemaShareUnref(p);
+  sqlite3_mutex_leave(schemaShare.mutex);
+}
+
+/*
+** Called before the in-memory schema of database iDb is modified while
+** a statement is running.  If the schema is a standalone schema, reset
+** it, so that a private copy is read the next time it is needed.  A
+** published schema is also unpublished, since the file is about to
+** change.  Return true if the schema is no longer loaded, in which case
+** the caller skips the modification.
+*/
+int sqlite3SchemaUnshare(sqlite3 *db, int iDb){
+  Schema *p = db->aDb[iDb].pSchema;
+  if( p->nShareRef>0 ){
+    if( p->zShareFile ){
+      sqlite3_mutex_enter(schemaShare.mutex);
+      if( p->zShareFile ) schemaShareUnpublish(p);
+      sqlite3_mutex_leave(schemaShare.mutex);
+    }
+    sqlite3ResetOneSchema(db, iDb);
+  }
+  return !DbHasProperty(db, iDb, DB_SchemaLoaded);
+}
+
+/*
+** sqlite3SchemaShareEnter() and sqlite3SchemaShareLeave() bracket code,
+** such as sqlite3_prepare(), that reads the schema.  Once sqlite3Init()
+** has loaded the schemas, sqlite3SchemaSharePin() takes a reference to
+** each standalone schema the connection uses, and the outermost
+** sqlite3SchemaShareLeave() drops them.  This keeps a schema alive while
+** the statement being prepared points into it, even if the connection
+** detaches from it in the meantime.  No lock is held: a published
+** schema is never written to, and other connections cannot see a schema
+** that has not been published.
+*/
+u8 sqlite3SchemaShareEnter(sqlite3 *db){
+  assert( sqlite3_mutex_held(db->mutex) );
+  return db->nSchemaShareUse++>0;
+}
+void sqlite3SchemaSharePin(sqlite3 *db){
+  Schema **aHeld = db->aSchemaShareHeld;
+  int nOld = db->nSchemaShareHeld;
+  int n = nOld;
+  int i, j;
+  if( db->nSchemaShareUse==0 ) return;
+  for(i=0; i<db->nDb && n<ArraySize(db->aSchemaShareHeld); i++){
+    Schema *p = db->aDb[i].pSchema;
+    if( p==0 || p->nShareRef==0 ) continue;
+    for(j=0; j<n && aHeld[j]!=p; j++){}
+    if( j==n ) aHeld[n++] = p;
+  }
+  if( n==nOld ) return;
+  sqlite3_mutex_enter(schemaShare.mutex);
+  for(i=nOld; i<n; i++) aHeld[i]->nShareRef++;
+  sqlite3_mutex_leave(schemaShare.mutex);
+  db->nSchemaShareHeld = (u8)n;
+}
+void sqlite3SchemaShareLeave(sqlite3 *db, u8 bNested){
+  int i;
+  int n = db->nSchemaShareHeld;
+  assert( db->nSchemaShareUse>0 );
+  db->nSchemaShareUse--;
+  if( bNested || n==0 ) return;
+  db->nSchemaShareHeld = 0;
+  sqlite3_mutex_enter(schemaShare.mutex);
+  for(i=0; i<n; i++) schemaShareUnref(db->aSchemaShareHeld[i]);
+  sqlite3_mutex_leave(schemaShare.mutex);
+}
+
+/*
+** Release all published schemas and the schema share mutex.  Called
+** by sqlite3_shutdown().
+*/
+void sqlite3SchemaShareShutdown(void){
+  if( schemaShare.mutex ){
+    sqlite3_mutex_enter(schemaShare.mutex);
+    while( schemaShare.pList ){
+      schemaShareUnpublish(schemaShare.pList);
+    }
+    sqlite3_mutex_leave(schemaShare.mutex);
+    sqlite3_mutex_free(schemaShare.mutex);
+    schemaShare.mutex = 0;
+  }
+}
+#endif /* SQLITE_OMIT_SHARED_SCHEMA */
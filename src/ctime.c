@@ -54,15 +54,24 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_DEBUG
   "DEBUG",
 #endif
+#ifdef SQLITE_DEFAULT_LAZY_SCHEMA
+  "DEFAULT_LAZY_SCHEMA=" CTIMEOPT_VAL(SQLITE_DEFAULT_LAZY_SCHEMA),
+#endif
 #ifdef SQLITE_DEFAULT_LOCKING_MODE
   "DEFAULT_LOCKING_MODE=" CTIMEOPT_VAL(SQLITE_DEFAULT_LOCKING_MODE),
 #endif
+#ifdef SQLITE_DEFAULT_SHARED_SCHEMA
+  "DEFAULT_SHARED_SCHEMA=" CTIMEOPT_VAL(SQLITE_DEFAULT_SHARED_SCHEMA),
+#endif
 #ifdef SQLITE_DISABLE_DIRSYNC
   "DISABLE_DIRSYNC",
 #endif
 #ifdef SQLITE_DISABLE_LFS
   "DISABLE_LFS",
 #endif
+#ifdef SQLITE_DISABLE_SIMD
+  "DISABLE_SIMD",
+#endif
 #ifdef SQLITE_ENABLE_ATOMIC_WRITE
   "ENABLE_ATOMIC_WRITE",
 #endif
@@ -111,6 +120,9 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_ENABLE_MEMSYS5
   "ENABLE_MEMSYS5",
 #endif
+#ifdef SQLITE_ENABLE_MEMSYS6
+  "ENABLE_MEMSYS6",
+#endif
 #ifdef SQLITE_ENABLE_OVERSIZE_CELL_CHECK
   "ENABLE_OVERSIZE_CELL_CHECK",
 #endif
@@ -120,6 +132,9 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_ENABLE_STAT3
   "ENABLE_STAT3",
 #endif
+#ifdef SQLITE_ENABLE_STAT4
+  "ENABLE_STAT4",
+#endif
 #ifdef SQLITE_ENABLE_UNLOCK_NOTIFY
   "ENABLE_UNLOCK_NOTIFY",
 #endif
@@ -129,6 +144,9 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_HAS_CODEC
   "HAS_CODEC",
 #endif
+#ifdef SQLITE_HASH_AGGREGATE_MAX_GROUPS
+  "HASH_AGGREGATE_MAX_GROUPS=" CTIMEOPT_VAL(SQLITE_HASH_AGGREGATE_MAX_GROUPS),
+#endif
 #ifdef SQLITE_HAVE_ISNAN
   "HAVE_ISNAN",
 #endif
@@ -189,6 +207,9 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_OMIT_BETWEEN_OPTIMIZATION
   "OMIT_BETWEEN_OPTIMIZATION",
 #endif
+#ifdef SQLITE_OMIT_BIND_ARRAY
+  "OMIT_BIND_ARRAY",
+#endif
 #ifdef SQLITE_OMIT_BLOB_LITERAL
   "OMIT_BLOB_LITERAL",
 #endif
@@ -198,6 +219,9 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_OMIT_BUILTIN_TEST
   "OMIT_BUILTIN_TEST",
 #endif
+#ifdef SQLITE_OMIT_CARD_FEEDBACK
+  "OMIT_CARD_FEEDBACK",
+#endif
 #ifdef SQLITE_OMIT_CAST
   "OMIT_CAST",
 #endif
@@ -239,15 +263,24 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_OMIT_FOREIGN_KEY
   "OMIT_FOREIGN_KEY",
 #endif
+#ifdef SQLITE_OMIT_FUNC_MEMO
+  "OMIT_FUNC_MEMO",
+#endif
 #ifdef SQLITE_OMIT_GET_TABLE
   "OMIT_GET_TABLE",
 #endif
 #ifdef SQLITE_OMIT_INCRBLOB
   "OMIT_INCRBLOB",
 #endif
+#ifdef SQLITE_OMIT_INDEX_ADVISOR
+  "OMIT_INDEX_ADVISOR",
+#endif
 #ifdef SQLITE_OMIT_INTEGRITY_CHECK
   "OMIT_INTEGRITY_CHECK",
 #endif
+#ifdef SQLITE_OMIT_LAZY_SCHEMA
+  "OMIT_LAZY_SCHEMA",
+#endif
 #ifdef SQLITE_OMIT_LIKE_OPTIMIZATION
   "OMIT_LIKE_OPTIMIZATION",
 #endif
@@ -272,6 +305,9 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_OMIT_PAGER_PRAGMAS
   "OMIT_PAGER_PRAGMAS",
 #endif
+#ifdef SQLITE_OMIT_PARSE_ARENA
+  "OMIT_PARSE_ARENA",
+#endif
 #ifdef SQLITE_OMIT_PRAGMA
   "OMIT_PRAGMA",
 #endif
@@ -281,6 +317,9 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_OMIT_QUICKBALANCE
   "OMIT_QUICKBALANCE",
 #endif
+#ifdef SQLITE_OMIT_REGEXP
+  "OMIT_REGEXP",
+#endif
 #ifdef SQLITE_OMIT_REINDEX
   "OMIT_REINDEX",
 #endif
@@ -293,6 +332,18 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_OMIT_SHARED_CACHE
   "OMIT_SHARED_CACHE",
 #endif
+#ifdef SQLITE_OMIT_SHARED_SCHEMA
+  "OMIT_SHARED_SCHEMA",
+#endif
+#ifdef SQLITE_OMIT_STEP_COLUMNS
+  "OMIT_STEP_COLUMNS",
+#endif
+#ifdef SQLITE_OMIT_STMT_SCANSTATUS
+  "OMIT_STMT_SCANSTATUS",
+#endif
+#ifdef SQLITE_OMIT_STMT_SERIALIZE
+  "OMIT_STMT_SERIALIZE",
+#endif
 #ifdef SQLITE_OMIT_SUBQUERY
   "OMIT_SUBQUERY",
 #endif
@@ -317,6 +368,9 @@ static const char * const azCompileOpt[] = {
 #ifdef SQLITE_OMIT_VACUUM
   "OMIT_VACUUM",
 #endif
+#ifdef SQLITE_OMIT_VDBEHASH
+  "OMIT_VDBEHASH",
+#endif
 #ifdef SQLITE_OMIT_VIEW
   "OMIT_VIEW",
 #endif
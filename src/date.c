@@ -304,6 +304,87 @@ static int setDateTimeToCurrent(sqlite3_context *context, DateTime *p){
   }
 }
 
+/*
+** Parse the fixed-width ISO-8601 forms
+**
+**     YYYY-MM-DD
+**     YYYY-MM-DD HH:MM
+**     YYYY-MM-DD HH:MM:SS
+**     YYYY-MM-DD HH:MM:SS.FFF
+**
+** with exactly one space or 'T' between the date and the time and
+** nothing else before or after.  These are how nearly all stored dates
+** look, and checking the digits at fixed offsets is much cheaper than
+** the general parser with its variable argument getDigits() calls.
+**
+** Return 0 and fill in p exactly as parseYyyyMmDd() would on success.
+** Return 1 if zDate is in any other form, which does not mean that
+** it is not a valid date.
+*/
+static int parseIso8601(const char *zDate, DateTime *p){
+  const char *z = zDate;
+  int Y, M, D, h, m, s;
+  int i;
+
+  for(i=0; i<10; i++){
+    if( i==4 || i==7 ){
+      if( z[i]!='-' ) return 1;
+    }else if( !sqlite3Isdigit(z[i]) ){
+      return 1;
+    }
+  }
+  Y = (z[0]-'0')*1000 + (z[1]-'0')*100 + (z[2]-'0')*10 + (z[3]-'0');
+  M = (z[5]-'0')*10 + (z[6]-'0');
+  D = (z[8]-'0')*10 + (z[9]-'0');
+  if( M<1 || M>12 || D<1 || D>31 ) return 1;
+  z += 10;
+  if( *z==0 ){
+    p->validHMS = 0;
+  }else{
+    double ms = 0.0;
+    if( (z[0]!=' ' && z[0]!='T')
+     || !sqlite3Isdigit(z[1]) || !sqlite3Isdigit(z[2]) || z[3]!=':'
+     || !sqlite3Isdigit(z[4]) || !sqlite3Isdigit(z[5])
+    ){
+      return 1;
+    }
+    h = (z[1]-'0')*10 + (z[2]-'0');
+    m = (z[4]-'0')*10 + (z[5]-'0');
+    if( h>24 || m>59 ) return 1;
+    z += 6;
+    s = 0;
+    if( *z==':' ){
+      if( !sqlite3Isdigit(z[1]) || !sqlite3Isdigit(z[2]) ) return 1;
+      s = (z[1]-'0')*10 + (z[2]-'0');
+      if( s>59 ) return 1;
+      z += 3;
+      if( *z=='.' && sqlite3Isdigit(z[1]) ){
+        double rScale = 1.0;
+        z++;
+        while( sqlite3Isdigit(*z) ){
+          ms = ms*10.0 + *z - '0';
+          rScale *= 10.0;
+          z++;
+        }
+        ms /= rScale;
+      }
+    }
+    if( *z!=0 ) return 1;
+    p->validHMS = 1;
+    p->h = h;
+    p->m = m;
+    p->s = s + ms;
+  }
+  p->tz = 0;
+  p->validTZ = 0;
+  p->validJD = 0;
+  p->validYMD = 1;
+  p->Y = Y;
+  p->M = M;
+  p->D = D;
+  return 0;
+}
+
 /*
 ** Attempt to parse the given string into a Julian Day Number.  Return
 ** the number of errors.  试着把给出的字符串解析为朱利安日数。返回错误次数。
@@ -326,7 +407,9 @@ static int parseDateOrTime(
   DateTime *p
 ){
   double r;
-  if( parseYyyyMmDd(zDate,p)==0 ){
+  if( parseIso8601(zDate,p)==0 ){
+    return 0;
+  }else if( parseYyyyMmDd(zDate,p)==0 ){
     return 0;
   }else if( parseHhMmSs(zDate, p)==0 ){
     return 0;
@@ -859,39 +942,61 @@ static void dateFunc(
 }
 
 /*
-**    strftime( FORMAT, TIMESTRING, MOD, MOD, ...)  格式化时间字符串（格式，时间字符串，模数，模数，...）
-**
-** Return a string described by FORMAT.  Conversions as follows:  返回一个格式描述的字符串。
+** A strftime() format string compiled by strftimeCompile().  Each entry
+** of aOp[] is either a conversion or a run of literal text, so the
+** format is validated and sized only once, and literal text is copied
+** with memcpy() rather than a character at a time.  The compiled format
+** is kept with sqlite3_set_auxdata(), so a constant format is compiled
+** once per statement.
 **
-**   %d  day of month                      月的一天
-**   %f  ** fractional seconds  SS.SSS     小数秒  SS.SSS
-**   %H  hour 00-24                        小时   00-24 
-**   %j  day of year 000-366               年的一天   000-366
-**   %J  ** Julian day number              朱利安日数
-**   %m  month 01-12                       月份   01-12
-**   %M  minute 00-59                      分钟   00-59
-**   %s  seconds since 1970-01-01          自1970-01-01以来的秒
-**   %S  seconds 00-59                     秒   00-59
-**   %w  day of week 0-6  sunday==0        周的一天  0-6  sunday==0
-**   %W  week of year 00-53                年的一周  00-53
-**   %Y  year 0000-9999                    年   0000-9999
-**   %%  %
+** The result of the most recent call whose only other argument was a
+** time string is cached as well.  That result depends on nothing but the
+** two strings, unless the time string is 'now', so consecutive rows with
+** the same timestamp can reuse it without parsing or formatting.
 */
-static void strftimeFunc(
-  sqlite3_context *context,
-  int argc,
-  sqlite3_value **argv
-){
-  DateTime x;
+typedef struct DateFmt DateFmt;
+struct DateFmt {
+  u64 nOut;             /* Max bytes of output incl. nul, or 0 if invalid */
+  int nOp;              /* Number of entries in aOp[] */
+  int nIn;              /* Bytes in zIn[], or -1 if nothing is cached */
+  int nRes;             /* Bytes in zRes[] */
+  char zIn[40];         /* The time string of the cached result */
+  char zRes[100];       /* The cached result */
+  const char *zFmt;     /* Copy of the format string */
+  struct DateFmtOp {
+    char cOp;             /* Conversion character, or 0 for literal text */
+    int iOfst;            /* Offset of literal text in zFmt */
+    int n;                /* Bytes of literal text */
+  } aOp[1];
+};
+
+/*
+** Compile the strftime() format string zFmt.  Return NULL if a memory
+** allocation fails.  An invalid format still compiles, with nOut set
+** to zero.
+*/
+static DateFmt *strftimeCompile(const char *zFmt){
+  DateFmt *p;
+  int nFmt = sqlite3Strlen30(zFmt);
+  i64 nByte;
+  char *zCopy;
   u64 n;
-  size_t i,j;
-  char *z;
-  sqlite3 *db;
-  const char *zFmt = (const char*)sqlite3_value_text(argv[0]);
-  char zBuf[100];
-  if( zFmt==0 || isDate(context, argc-1, argv+1, &x) ) return;
-  db = sqlite3_context_db_handle(context);
-  for(i=0, n=1; zFmt[i]; i++, n++){
+  int i, iLit;
+
+  /* Every entry of aOp[] covers at least one byte of the format, so
+  ** nFmt entries are enough, and aOp[] is declared with one already. */
+  nByte = sizeof(DateFmt) + nFmt*(i64)sizeof(p->aOp[0]) + nFmt + 1;
+  if( nByte>0x7fffffff ) return 0;
+  p = sqlite3_malloc((int)nByte);
+  if( p==0 ) return 0;
+  zCopy = (char*)&p->aOp[nFmt+1];
+  memcpy(zCopy, zFmt, nFmt+1);
+  p->zFmt = zCopy;
+  p->nOp = 0;
+  p->nIn = -1;
+  p->nRes = 0;
+  p->nOut = 0;
+  for(i=iLit=0, n=1; zFmt[i]; i++, n++){
     if( zFmt[i]=='%' ){
       switch( zFmt[i+1] ){
         case 'd':
@@ -919,11 +1024,112 @@ static void strftimeFunc(
           n += 50;
           break;
         default:
-          return;  /* ERROR.  return a NULL */    出现错误。返回一个null
+          return p;  /* ERROR.  strftime() returns a NULL */
+      }
+      if( i>iLit ){
+        p->aOp[p->nOp].cOp = 0;
+        p->aOp[p->nOp].iOfst = iLit;
+        p->aOp[p->nOp].n = i - iLit;
+        p->nOp++;
       }
       i++;
+      p->aOp[p->nOp].cOp = zFmt[i];
+      p->nOp++;
+      iLit = i+1;
+    }
+  }
+  if( i>iLit ){
+    p->aOp[p->nOp].cOp = 0;
+    p->aOp[p->nOp].iOfst = iLit;
+    p->aOp[p->nOp].n = i - iLit;
+    p->nOp++;
+  }
+  assert( p->nOp<=nFmt );
+  p->nOut = n;
+  return p;
+}
+
+/*
+** Write v as two decimal digits into z[0] and z[1], the same as
+** sqlite3_snprintf(3, z, "%02d", v) but without the overhead.
+*/
+static void strftimeTwoDigits(char *z, int v){
+  if( v>=0 && v<100 ){
+    z[0] = (char)('0' + v/10);
+    z[1] = (char)('0' + v%10);
+  }else{
+    sqlite3_snprintf(3, z, "%02d", v);
+  }
+}
+
+/*
+**    strftime( FORMAT, TIMESTRING, MOD, MOD, ...)  格式化时间字符串（格式，时间字符串，模数，模数，...）
+**
+** Return a string described by FORMAT.  Conversions as follows:  返回一个格式描述的字符串。
+**
+**   %d  day of month                      月的一天
+**   %f  ** fractional seconds  SS.SSS     小数秒  SS.SSS
+**   %H  hour 00-24                        小时   00-24 
+**   %j  day of year 000-366               年的一天   000-366
+**   %J  ** Julian day number              朱利安日数
+**   %m  month 01-12                       月份   01-12
+**   %M  minute 00-59                      分钟   00-59
+**   %s  seconds since 1970-01-01          自1970-01-01以来的秒
+**   %S  seconds 00-59                     秒   00-59
+**   %w  day of week 0-6  sunday==0        周的一天  0-6  sunday==0
+**   %W  week of year 00-53                年的一周  00-53
+**   %Y  year 0000-9999                    年   0000-9999
+**   %%  %
+*/
+static void strftimeFunc(
+  sqlite3_context *context,
+  int argc,
+  sqlite3_value **argv
+){
+  DateTime x;
+  DateFmt *pFmt;
+  u64 n;
+  int i;
+  size_t j;
+  char *z;
+  sqlite3 *db;
+  const char *zFmt = (const char*)sqlite3_value_text(argv[0]);
+  const char *zIn = 0;
+  int nIn = 0;
+  char zBuf[100];
+  if( zFmt==0 ) return;
+
+  /* Reuse the compiled format from the previous row if it is constant.
+  ** Auxiliary data survives sqlite3_reset(), so a format bound to a
+  ** parameter may have changed since it was compiled.  A new format is
+  ** compiled afresh, which also discards the cached result. */
+  pFmt = (DateFmt*)sqlite3_get_auxdata(context, 0);
+  if( pFmt==0 || strcmp(pFmt->zFmt, zFmt)!=0 ){
+    pFmt = strftimeCompile(zFmt);
+    if( pFmt ){
+      sqlite3_set_auxdata(context, 0, pFmt, sqlite3_free);
+      pFmt = (DateFmt*)sqlite3_get_auxdata(context, 0);
+    }
+    if( pFmt==0 ){
+      sqlite3_result_error_nomem(context);
+      return;
     }
   }
+
+  /* Check for the same time string as on the previous call */
+  if( argc==2 && pFmt->nOut>0 && sqlite3_value_type(argv[1])==SQLITE_TEXT ){
+    zIn = (const char*)sqlite3_value_text(argv[1]);
+    nIn = sqlite3_value_bytes(argv[1]);
+    if( zIn && nIn==pFmt->nIn && memcmp(zIn, pFmt->zIn, nIn)==0 ){
+      sqlite3_result_text(context, pFmt->zRes, pFmt->nRes, SQLITE_TRANSIENT);
+      return;
+    }
+  }
+
+  if( isDate(context, argc-1, argv+1, &x) ) return;
+  if( pFmt->nOut==0 ) return;  /* Invalid format.  Return a NULL */
+  db = sqlite3_context_db_handle(context);
+  n = pFmt->nOut;
   testcase( n==sizeof(zBuf)-1 );
   testcase( n==sizeof(zBuf) );
   testcase( n==(u64)db->aLimit[SQLITE_LIMIT_LENGTH]+1 );
@@ -942,68 +1148,87 @@ static void strftimeFunc(
   }
   computeJD(&x);
   computeYMD_HMS(&x);
-  for(i=j=0; zFmt[i]; i++){
-    if( zFmt[i]!='%' ){
-      z[j++] = zFmt[i];
-    }else{
-      i++;
-      switch( zFmt[i] ){
-        case 'd':  sqlite3_snprintf(3, &z[j],"%02d",x.D); j+=2; break;
-        case 'f': {
-          double s = x.s;
-          if( s>59.999 ) s = 59.999;
-          sqlite3_snprintf(7, &z[j],"%06.3f", s);
-          j += sqlite3Strlen30(&z[j]);
-          break;
-        }
-        case 'H':  sqlite3_snprintf(3, &z[j],"%02d",x.h); j+=2; break;
-        case 'W': /* Fall thru */
-        case 'j': {
-          int nDay;             /* Number of days since 1st day of year */ 从年的第一天起的天数
-          DateTime y = x;
-          y.validJD = 0;
-          y.M = 1;
-          y.D = 1;
-          computeJD(&y);
-          nDay = (int)((x.iJD-y.iJD+43200000)/86400000);
-          if( zFmt[i]=='W' ){
-            int wd;   /* 0=Monday, 1=Tuesday, ... 6=Sunday */
-            wd = (int)(((x.iJD+43200000)/86400000)%7);
-            sqlite3_snprintf(3, &z[j],"%02d",(nDay+7-wd)/7);
-            j += 2;
-          }else{
-            sqlite3_snprintf(4, &z[j],"%03d",nDay+1);
-            j += 3;
-          }
-          break;
-        }
-        case 'J': {
-          sqlite3_snprintf(20, &z[j],"%.16g",x.iJD/86400000.0);
-          j+=sqlite3Strlen30(&z[j]);
-          break;
-        }
-        case 'm':  sqlite3_snprintf(3, &z[j],"%02d",x.M); j+=2; break;
-        case 'M':  sqlite3_snprintf(3, &z[j],"%02d",x.m); j+=2; break;
-        case 's': {
-          sqlite3_snprintf(30,&z[j],"%lld",
-                           (i64)(x.iJD/1000 - 21086676*(i64)10000));
-          j += sqlite3Strlen30(&z[j]);
-          break;
-        }
-        case 'S':  sqlite3_snprintf(3,&z[j],"%02d",(int)x.s); j+=2; break;
-        case 'w': {
-          z[j++] = (char)(((x.iJD+129600000)/86400000) % 7) + '0';
-          break;
+  for(i=j=0; i<pFmt->nOp; i++){
+    struct DateFmtOp *pOp = &pFmt->aOp[i];
+    switch( pOp->cOp ){
+      case 0: {
+        memcpy(&z[j], &pFmt->zFmt[pOp->iOfst], pOp->n);
+        j += pOp->n;
+        break;
+      }
+      case 'd':  strftimeTwoDigits(&z[j], x.D); j+=2; break;
+      case 'f': {
+        double s = x.s;
+        if( s>59.999 ) s = 59.999;
+        sqlite3_snprintf(7, &z[j],"%06.3f", s);
+        j += sqlite3Strlen30(&z[j]);
+        break;
+      }
+      case 'H':  strftimeTwoDigits(&z[j], x.h); j+=2; break;
+      case 'W': /* Fall thru */
+      case 'j': {
+        int nDay;             /* Number of days since 1st day of year */ 从年的第一天起的天数
+        DateTime y = x;
+        y.validJD = 0;
+        y.M = 1;
+        y.D = 1;
+        computeJD(&y);
+        nDay = (int)((x.iJD-y.iJD+43200000)/86400000);
+        if( pOp->cOp=='W' ){
+          int wd;   /* 0=Monday, 1=Tuesday, ... 6=Sunday */
+          wd = (int)(((x.iJD+43200000)/86400000)%7);
+          strftimeTwoDigits(&z[j], (nDay+7-wd)/7);
+          j += 2;
+        }else{
+          sqlite3_snprintf(4, &z[j],"%03d",nDay+1);
+          j += 3;
         }
-        case 'Y': {
+        break;
+      }
+      case 'J': {
+        sqlite3_snprintf(20, &z[j],"%.16g",x.iJD/86400000.0);
+        j+=sqlite3Strlen30(&z[j]);
+        break;
+      }
+      case 'm':  strftimeTwoDigits(&z[j], x.M); j+=2; break;
+      case 'M':  strftimeTwoDigits(&z[j], x.m); j+=2; break;
+      case 's': {
+        sqlite3_snprintf(30,&z[j],"%lld",
+                         (i64)(x.iJD/1000 - 21086676*(i64)10000));
+        j += sqlite3Strlen30(&z[j]);
+        break;
+      }
+      case 'S':  strftimeTwoDigits(&z[j], (int)x.s); j+=2; break;
+      case 'w': {
+        z[j++] = (char)(((x.iJD+129600000)/86400000) % 7) + '0';
+        break;
+      }
+      case 'Y': {
+        if( x.Y>=0 && x.Y<=9999 ){
+          z[j++] = (char)('0' + x.Y/1000);
+          z[j++] = (char)('0' + (x.Y/100)%10);
+          z[j++] = (char)('0' + (x.Y/10)%10);
+          z[j++] = (char)('0' + x.Y%10);
+        }else{
           sqlite3_snprintf(5,&z[j],"%04d",x.Y); j+=sqlite3Strlen30(&z[j]);
-          break;
         }
-        default:   z[j++] = '%'; break;
+        break;
       }
+      default:   z[j++] = '%'; break;
     }
   }
   z[j] = 0;
+
+  /* Remember the result for the next call if it is cacheable */
+  if( zIn && nIn<(int)sizeof(pFmt->zIn) && z==zBuf
+   && sqlite3StrICmp(zIn, "now")!=0
+  ){
+    assert( j<sizeof(pFmt->zRes) );
+    memcpy(pFmt->zIn, zIn, nIn);
+    pFmt->nIn = nIn;
+    memcpy(pFmt->zRes, z, j+1);
+    pFmt->nRes = (int)j;
+  }
   sqlite3_result_text(context, z, -1,
                       z==zBuf ? SQLITE_TRANSIENT : SQLITE_DYNAMIC);
 }
@@ -39,7 +39,7 @@ Table *sqlite3SrcListLookup(Parse *pParse, SrcList *pSrc){
   //功能：删除该表 ，但是还没有调用该函数 
   pItem->pTab = pTab;
   if( pTab ){//如果这个表存在，则逐一检查这个表中的参数   
-    pTab->nRef++;
+    sqlite3TableRef(pTab);
   }
   if( sqlite3IndexedByLookup(pParse, pItem) ){//如果通过查找索引和该表匹配，则0表示要找的就是这个表 
     pTab = 0;
@@ -325,7 +325,9 @@ void sqlite3DeleteFrom(
   if( v==0 ){
     goto delete_from_cleanup;
   }
-  if( pParse->nested==0 ) sqlite3VdbeCountChanges(v);
+  if( pParse->nested==0 ){
+    sqlite3VdbeCountChanges(v);
+  }
   sqlite3BeginWriteOperation(pParse, 1, iDb);
 
   /* If we are trying to delete from a view, realize that view into
@@ -387,7 +389,7 @@ void sqlite3DeleteFrom(
     */
     sqlite3VdbeAddOp2(v, OP_Null, 0, iRowSet);
     pWInfo = sqlite3WhereBegin(
-        pParse, pTabList, pWhere, 0, 0, WHERE_DUPLICATES_OK, 0
+        pParse, pTabList, pWhere, 0, 0, 0, WHERE_DUPLICATES_OK, 0
     );
     if( pWInfo==0 ) goto delete_from_cleanup;
     regRowid = sqlite3ExprCodeGetColumn(pParse, pTab, -1, iCur, iRowid, 0);
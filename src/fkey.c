@@ -560,7 +560,7 @@ static void fkScanChildren(
   ** clause. If the constraint is not deferred, throw an exception for
   ** each row found. Otherwise, for deferred constraints, increment the
   ** deferred constraint counter by nIncr for each row selected.  */
-  pWInfo = sqlite3WhereBegin(pParse, pSrc, pWhere, 0, 0, 0, 0);
+  pWInfo = sqlite3WhereBegin(pParse, pSrc, pWhere, 0, 0, 0, 0, 0);
   if( nIncr>0 && pFKey->isDeferred==0 ){
     sqlite3ParseToplevel(pParse)->mayAbort = 1;
   }
@@ -827,7 +827,7 @@ void sqlite3FkCheck(
       struct SrcList_item *pItem = pSrc->a;
       pItem->pTab = pFKey->pFrom;
       pItem->zName = pFKey->pFrom->zName;
-      pItem->pTab->nRef++;
+      sqlite3TableRef(pItem->pTab);
       pItem->iCursor = pParse->nTab++;
   
       if( regNew!=0 ){
@@ -1173,6 +1173,24 @@ void sqlite3FkActions(
   }
 }
 
+/*
+** Build the ON DELETE and ON UPDATE action triggers of every foreign key
+** that refers to table pTab now, rather than the first time a statement
+** that deletes from or updates pTab is prepared.  This is done before a
+** schema is shared with other connections, so that fkActionTrigger()
+** does not write to it afterwards.  Return the number of errors.
+*/
+int sqlite3FkBuildActions(Parse *pParse, Table *pTab){
+  ExprList sChanges;              /* Any non-NULL change-list will do */
+  FKey *pFKey;                    /* Iterator variable */
+  memset(&sChanges, 0, sizeof(sChanges));
+  for(pFKey = sqlite3FkReferences(pTab); pFKey; pFKey=pFKey->pNextTo){
+    fkActionTrigger(pParse, pTab, pFKey, 0);
+    fkActionTrigger(pParse, pTab, pFKey, &sChanges);
+  }
+  return pParse->nErr;
+}
+
 #endif /* ifndef SQLITE_OMIT_TRIGGER */
 
 /*
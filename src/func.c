@@ -725,6 +725,143 @@ static int patternCompare(
   return *zString==0;
 }
 
+/*
+** Most LIKE and GLOB patterns seen in practice are a literal string with
+** at most one run of matchAll wildcards at either end: 'abc', 'abc%',
+** '%abc' and '%abc%'.  likeCompile() recognizes these shapes so that
+** likeFunc() can match them with strncmp() or the C library strstr()
+** instead of walking the pattern with patternCompare() for every row.
+** The compiled pattern is kept with sqlite3_set_auxdata(), so a constant
+** pattern is analyzed only once per statement.
+**
+** Only patterns whose literal part is pure ASCII take the fast path.
+** ASCII bytes never appear inside a multi-byte UTF-8 character, and
+** patternCompare() only folds the case of ASCII characters, so a byte
+** comparison gives exactly the answer patternCompare() would, even for
+** strings that are not well-formed UTF-8.  Everything else is
+** LIKEPAT_GENERIC and still goes through patternCompare().
+*/
+#define LIKEPAT_GENERIC  0   /* Use patternCompare() */
+#define LIKEPAT_EXACT    1   /* 'abc' */
+#define LIKEPAT_PREFIX   2   /* 'abc%' */
+#define LIKEPAT_SUFFIX   3   /* '%abc' */
+#define LIKEPAT_SUBSTR   4   /* '%abc%' */
+
+typedef struct LikePattern LikePattern;
+struct LikePattern {
+  u32 esc;           /* Escape character the pattern was compiled with */
+  u8 eKind;          /* One of the LIKEPAT_* values above */
+  int nPat;          /* Number of bytes in zPat[] */
+  const char *zPat;  /* Copy of the pattern that was compiled */
+  int nLit;          /* Number of bytes in zLit[] */
+  char zLit[1];      /* The literal, in lower case if noCase is set */
+};
+
+/*
+** Analyze the pattern zPattern.  Return NULL if a memory allocation
+** fails.
+*/
+static LikePattern *likeCompile(
+  const u8 *zPattern,              /* The LIKE or GLOB pattern */
+  int nPat,                        /* Number of bytes in zPattern */
+  const struct compareInfo *pInfo, /* Which wildcards apply */
+  u32 esc                          /* The escape character, or 0 */
+){
+  const u8 *z = zPattern;
+  int bLead = 0;                   /* Pattern starts with matchAll */
+  int bTrail = 0;                  /* Pattern ends with matchAll */
+  LikePattern *p;
+
+  p = sqlite3_malloc( sizeof(LikePattern) + nPat*2 );
+  if( p==0 ) return 0;
+  p->esc = esc;
+  p->nPat = nPat;
+  p->zPat = &p->zLit[nPat+1];
+  memcpy((char*)p->zPat, zPattern, nPat);
+  p->eKind = LIKEPAT_GENERIC;
+  p->nLit = 0;
+  if( esc==pInfo->matchAll || esc==pInfo->matchOne ) return p;
+
+  while( *z==pInfo->matchAll ){ z++; bLead = 1; }
+  while( *z ){
+    u8 c = *z++;
+    if( c==pInfo->matchAll ){
+      while( *z==pInfo->matchAll ) z++;
+      if( *z ) return p;
+      bTrail = 1;
+      break;
+    }
+    if( c==pInfo->matchOne || (pInfo->matchSet && c==pInfo->matchSet) ){
+      return p;
+    }
+    if( esc && c==esc ){
+      c = *z++;
+      if( c==0 ) return p;
+    }
+    if( c>=0x80 ) return p;
+    p->zLit[p->nLit++] = pInfo->noCase ? sqlite3UpperToLower[c] : (char)c;
+  }
+  p->zLit[p->nLit] = 0;
+  if( bLead ){
+    p->eKind = bTrail ? LIKEPAT_SUBSTR : LIKEPAT_SUFFIX;
+  }else{
+    p->eKind = bTrail ? LIKEPAT_PREFIX : LIKEPAT_EXACT;
+  }
+  return p;
+}
+
+/*
+** Return true if zString contains the lower-case ASCII string zLit
+** of nLit bytes, ignoring the case of ASCII characters.
+*/
+static int likeFindNoCase(const char *zString, const char *zLit, int nLit){
+  char c0 = zLit[0];
+  char c1 = sqlite3Toupper(c0);
+  if( nLit==0 ) return 1;
+  if( c0==c1 ){
+    while( (zString = strchr(zString, c0))!=0 ){
+      zString++;
+      if( sqlite3StrNICmp(zString, &zLit[1], nLit-1)==0 ) return 1;
+    }
+  }else{
+    for(; *zString; zString++){
+      if( (*zString==c0 || *zString==c1)
+       && sqlite3StrNICmp(&zString[1], &zLit[1], nLit-1)==0
+      ){
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/*
+** Match zString against a pattern that likeCompile() reduced to one of
+** the literal shapes.
+*/
+static int likeMatchLiteral(
+  const LikePattern *p,            /* The compiled pattern */
+  int noCase,                      /* True to ignore ASCII case */
+  const char *zString              /* The string to compare */
+){
+  int n;
+  switch( p->eKind ){
+    case LIKEPAT_PREFIX:
+      return noCase ? sqlite3StrNICmp(zString, p->zLit, p->nLit)==0
+                    : strncmp(zString, p->zLit, p->nLit)==0;
+    case LIKEPAT_SUBSTR:
+      return noCase ? likeFindNoCase(zString, p->zLit, p->nLit)
+                    : strstr(zString, p->zLit)!=0;
+    default:
+      assert( p->eKind==LIKEPAT_EXACT || p->eKind==LIKEPAT_SUFFIX );
+      n = sqlite3Strlen30(zString);
+      if( n<p->nLit || (p->eKind==LIKEPAT_EXACT && n!=p->nLit) ) return 0;
+      zString += n - p->nLit;
+      return noCase ? sqlite3StrNICmp(zString, p->zLit, p->nLit)==0
+                    : memcmp(zString, p->zLit, p->nLit)==0;
+  }
+}
+
 /*
 ** Count the number of times that the LIKE operator (or GLOB which is
 ** just a variation of LIKE) gets called.  This is used for testing
@@ -796,11 +933,33 @@ static void likeFunc(//确定给定的字符串是否与指定的模式匹配。
   }
   if( zA && zB ){
     struct compareInfo *pInfo = sqlite3_user_data(context);
+    LikePattern *pPat;
 #ifdef SQLITE_TEST
     sqlite3_like_count++;//LIKE 操作符的次数加1
 #endif
-    
-    sqlite3_result_int(context, patternCompare(zB, zA, pInfo, escape));
+
+    /* Reuse the analysis of the pattern from the previous row if the
+    ** pattern is a constant.  Auxiliary data survives sqlite3_reset(),
+    ** so a pattern bound to a parameter may have changed since it was
+    ** analyzed.  The pattern and the escape character are both checked
+    ** before the analysis is reused. */
+    pPat = (LikePattern*)sqlite3_get_auxdata(context, 0);
+    if( pPat==0 || pPat->esc!=escape || pPat->nPat!=nPat
+     || memcmp(pPat->zPat, zB, nPat)!=0
+    ){
+      pPat = likeCompile(zB, nPat, pInfo, escape);
+      if( pPat ){
+        sqlite3_set_auxdata(context, 0, pPat, sqlite3_free);
+        pPat = (LikePattern*)sqlite3_get_auxdata(context, 0);
+        if( pPat && pPat->esc!=escape ) pPat = 0;
+      }
+    }
+    if( pPat && pPat->eKind!=LIKEPAT_GENERIC ){
+      sqlite3_result_int(context,
+          likeMatchLiteral(pPat, pInfo->noCase, (const char*)zA));
+    }else{
+      sqlite3_result_int(context, patternCompare(zB, zA, pInfo, escape));
+    }
   }
 }
 
@@ -1751,6 +1910,9 @@ void sqlite3RegisterGlobalFunctions(void){
     sqlite3FuncDefInsert(pHash, &aFunc[i]);
   }
   sqlite3RegisterDateTimeFunctions();
+#ifndef SQLITE_OMIT_REGEXP
+  sqlite3RegisterRegexpFunctions();
+#endif
 #ifndef SQLITE_OMIT_ALTERTABLE
   sqlite3AlterFunctions();
 #endif
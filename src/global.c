@@ -277,3 +277,9 @@ int sqlite3PendingByte = 0x40000000;
 在vdbe.c中声明的case OP_xxxx中获得
 */
 const unsigned char sqlite3OpcodeProperty[] = OPFLG_INITIALIZER; /*不可改变的无符号的字符数组*/
+
+/*
+** The number of entries in sqlite3OpcodeProperty[].  This is one more
+** than the largest opcode number.
+*/
+const int sqlite3OpcodeCount = sizeof(sqlite3OpcodeProperty);
@@ -67,7 +67,7 @@
       return retval;
   }
 
-#else
+#elif !defined(SQLITE_HWTIME_OPTIONAL)
 
   #error Need implementation of sqlite3Hwtime() for your platform.
 
@@ -80,6 +80,15 @@
   */
   sqlite_uint64 sqlite3Hwtime(void){ return ((sqlite_uint64)0); }
 
+#else
+
+  /*
+  ** Code that defines SQLITE_HWTIME_OPTIONAL before including this file
+  ** can cope with a timer that always returns zero, so there is no need
+  ** for an error.
+  */
+  sqlite_uint64 sqlite3Hwtime(void){ return ((sqlite_uint64)0); }
+
 #endif
 
 #endif /* !defined(_HWTIME_H_) */
@@ -44,7 +44,7 @@ void sqlite3OpenTable(Parse *p, int iCur, int iDb, Table *pTab, int opcode ）
 
 ////2、返回一个与索引pIdx相关的列相关字符串的指针的值而不用修改它，
 //根据列关联，表中每一个列都有一个字符代表列关联的数据类型。
-const char *sqlite3IndexAffinityStr(Vdbe *v, Index *pIdx)
+static const char *indexAffinityStr(sqlite3 *db, Index *pIdx)
 {
   //对于一个特定的索引来说，一个列关联字符串在第一次才需要分配和赋值的。
   //然后对于后续的使用来说，它将会作为一个索引的成员存储.
@@ -54,7 +54,6 @@ const char *sqlite3IndexAffinityStr(Vdbe *v, Index *pIdx)
 
     int n;
     Table *pTab = pIdx->pTable;//SQL表索引
-    sqlite3 *db = sqlite3VdbeDb(v);//定义一个当前虚拟机运行的数据库数据实例的指针
 
     //对于数据的索引一旦开始分配，失败终止只有当失败分配重置。
     pIdx->zColAff = (char *)sqlite3DbMallocRaw(0, pIdx->nColumn+2);
@@ -73,9 +72,13 @@ const char *sqlite3IndexAffinityStr(Vdbe *v, Index *pIdx)
 
   return pIdx->zColAff;
 }
+const char *sqlite3IndexAffinityStr(Vdbe *v, Index *pIdx)
+{
+  return indexAffinityStr(sqlite3VdbeDb(v), pIdx);
+}
 
 ////3.该函数主要是用于把表和与列相关的字符关联在一起。
-void sqlite3TableAffinityStr(Vdbe *v, Table *pTab)
+static const char *tableAffinityStr(sqlite3 *db, Table *pTab)
 {
     /* 对于一个特定的索引来说，一个列关联字符串在第一次才需要分配和赋值的。
     **然后对于后续的使用，它将会作为一个索引结构成员存储.
@@ -85,12 +88,11 @@ void sqlite3TableAffinityStr(Vdbe *v, Table *pTab)
     {
     char *zColAff;
     int i;
-    sqlite3 *db = sqlite3VdbeDb(v);
 
     zColAff = (char *)sqlite3DbMallocRaw(0, pTab->nCol+1);
     if( !zColAff ){
       db->mallocFailed = 1;
-      return;
+      return 0;
     }
 
     for(i=0; i<pTab->nCol; i++){
@@ -101,7 +103,30 @@ void sqlite3TableAffinityStr(Vdbe *v, Table *pTab)
     pTab->zColAff = zColAff;
   }
 
-  sqlite3VdbeChangeP4(v, -1, pTab->zColAff, P4_TRANSIENT);//同上
+  return pTab->zColAff;
+}
+void sqlite3TableAffinityStr(Vdbe *v, Table *pTab)
+{
+  if( tableAffinityStr(sqlite3VdbeDb(v), pTab) ){
+    sqlite3VdbeChangeP4(v, -1, pTab->zColAff, P4_TRANSIENT);//同上
+  }
+}
+
+/*
+** Compute the affinity strings of table pTab and of all its indices
+** ahead of time, so that sqlite3TableAffinityStr() and
+** sqlite3IndexAffinityStr() do not write to pTab later.  Used before a
+** schema is shared with other connections.  Return non-zero if a malloc
+** fails.
+*/
+int sqlite3TableAffinityInit(sqlite3 *db, Table *pTab)
+{
+  Index *pIdx;
+  if( tableAffinityStr(db, pTab)==0 ) return 1;
+  for(pIdx=pTab->pIndex; pIdx; pIdx=pIdx->pNext){
+    if( indexAffinityStr(db, pIdx)==0 ) return 1;
+  }
+  return 0;
 }
 
 /*
@@ -473,7 +498,9 @@ void sqlite3Insert(Parse *pParse, SrcList *pTabList, ExprList *pList, Select *pS
   //分配一个触发器
   v = sqlite3GetVdbe(pParse);
   if( v==0 ) goto insert_cleanup;
-  if( pParse->nested==0 ) sqlite3VdbeCountChanges(v);
+  if( pParse->nested==0 ){
+    sqlite3VdbeCountChanges(v);
+  }
   sqlite3BeginWriteOperation(pParse, pSelect || pTrigger, iDb);
 
 #ifndef SQLITE_OMIT_XFER_OPT
@@ -87,6 +87,10 @@
 # define sqlite3_declare_vtab 0
 # define sqlite3_vtab_config 0
 # define sqlite3_vtab_on_conflict 0
+# define sqlite3_vtab_distinct 0
+# define sqlite3_vtab_in 0
+# define sqlite3_vtab_in_first 0
+# define sqlite3_vtab_in_next 0
 #endif
 
 #ifdef SQLITE_OMIT_SHARED_CACHE
@@ -113,6 +117,25 @@
 #define sqlite3_blob_reopen    0
 #endif
 
+#ifdef SQLITE_OMIT_STMT_SCANSTATUS
+# define sqlite3_stmt_scanstatus 0
+# define sqlite3_stmt_scanstatus_reset 0
+#endif
+
+#ifdef SQLITE_OMIT_STMT_SERIALIZE
+# define sqlite3_stmt_serialize 0
+# define sqlite3_stmt_deserialize 0
+#endif
+
+#ifdef SQLITE_OMIT_BIND_ARRAY
+# define sqlite3_bind_array 0
+# define sqlite3_step_array 0
+#endif
+
+#ifdef SQLITE_OMIT_STEP_COLUMNS
+# define sqlite3_step_columns 0
+#endif
+
 /*
 ** The following structure contains pointers to all SQLite API routines.
 ** A pointer to this structure is passed into extensions when they are
@@ -384,6 +407,17 @@ static const sqlite3_api_routines sqlite3Apis = {
   sqlite3_blob_reopen,
   sqlite3_vtab_config,
   sqlite3_vtab_on_conflict,
+  sqlite3_stmt_scanstatus,
+  sqlite3_stmt_scanstatus_reset,
+  sqlite3_vtab_distinct,
+  sqlite3_vtab_in,
+  sqlite3_vtab_in_first,
+  sqlite3_vtab_in_next,
+  sqlite3_stmt_serialize,
+  sqlite3_stmt_deserialize,
+  sqlite3_bind_array,
+  sqlite3_step_array,
+  sqlite3_step_columns,
 };
 
 /*
@@ -312,6 +312,7 @@ int sqlite3_shutdown(void){
     void SQLITE_EXTRA_SHUTDOWN(void);
     SQLITE_EXTRA_SHUTDOWN();
 #endif
+    sqlite3SchemaShareShutdown();
     sqlite3_os_end();
     sqlite3_reset_auto_extension();
     sqlite3GlobalConfig.isInit = 0;
@@ -556,6 +557,27 @@ int sqlite3_config(int op, ...){
   return rc;
 }
 
+/*
+** Free the lookaside memory of a database connection: the first chunk,
+** if it was obtained from sqlite3_malloc(), and every chunk added since.
+*/
+static void freeLookaside(sqlite3 *db){
+  Lookaside *pLook = &db->lookaside;
+  int i;
+  assert( pLook->nOut==0 );
+  for(i=0; i<pLook->nChunk; i++){
+    if( i>0 || pLook->bMalloced ){
+      sqlite3_free(pLook->aChunk[i].pStart);
+    }
+  }
+  for(i=0; i<LOOKASIDE_NCLASS; i++){
+    pLook->apFree[i] = 0;
+  }
+  pLook->nChunk = 0;
+  pLook->pStart = 0;
+  pLook->pEnd = 0;
+}
+
 /*
 ** Set up the lookaside buffers for a database connection.
 ** Return SQLITE_OK on success.  
@@ -566,11 +588,18 @@ int sqlite3_config(int op, ...){
 ** space for the lookaside memory is obtained from sqlite3_malloc().
 ** If pStart is not NULL then it is sz*cnt bytes of memory to use for
 ** the lookaside memory.
+**
+** A quarter of the memory is used for slots of half size sz and another
+** quarter for slots of twice size sz.  More chunks of the same size may
+** be added later, up to a total of db->lookaside.szMax bytes.
 */
 //设置一个后贝缓冲区为了数据的连接、成功了返回SQLITE_OK
 static int setupLookaside(sqlite3 *db, void *pBuf, int sz, int cnt){
+  Lookaside *pLook = &db->lookaside;
   void *pStart;
-  if( db->lookaside.nOut ){
+  int nByte;
+  int i;
+  if( pLook->nOut ){
     return SQLITE_BUSY;
   }
   /* Free any existing lookaside buffer for this handle before
@@ -579,15 +608,14 @@ static int setupLookaside(sqlite3 *db, void *pBuf, int sz, int cnt){
   */
   //为了接下来的处理，再分配新的一个要释放所有存在的后备缓存，
   //所以我们不能在同一时刻拥有空间
-  if( db->lookaside.bMalloced ){
-    sqlite3_free(db->lookaside.pStart);
-  }
+  freeLookaside(db);
   /* The size of a lookaside slot after ROUNDDOWN8 needs to be larger
   ** than a pointer to be useful.
   */
   //ROUNDDOWN8 需要比一个指针大的一个后备槽
   sz = ROUNDDOWN8(sz);  /* IMP: R-33038-09382 */
   if( sz<=(int)sizeof(LookasideSlot*) ) sz = 0;
+  if( sz>0x7ff8 ) sz = 0x7ff8;
   if( cnt<0 ) cnt = 0;
   if( sz==0 || cnt==0 ){
     sz = 0;
@@ -600,26 +628,36 @@ static int setupLookaside(sqlite3 *db, void *pBuf, int sz, int cnt){
   }else{
     pStart = pBuf;
   }
-  db->lookaside.pStart = pStart;
-  db->lookaside.pFree = 0;
-  db->lookaside.sz = (u16)sz;
+  pLook->sz = (u16)sz;
   if( pStart ){
-    int i;
-    LookasideSlot *p;
-    assert( sz > (int)sizeof(LookasideSlot*) );
-    p = (LookasideSlot*)pStart;
-    for(i=cnt-1; i>=0; i--){
-      p->pNext = db->lookaside.pFree;
-      db->lookaside.pFree = p;
-      p = (LookasideSlot*)&((u8*)p)[sz];
-    }
-    db->lookaside.pEnd = p;
-    db->lookaside.bEnabled = 1;
-    db->lookaside.bMalloced = pBuf==0 ?1:0;
+    nByte = sz*cnt;
+    pLook->aSz[0] = (u16)ROUNDDOWN8(sz/2);
+    pLook->aSz[1] = (u16)sz;
+    pLook->aSz[2] = (u16)(sz*2);
+    if( pLook->aSz[0]<=(int)sizeof(LookasideSlot*) ) pLook->aSz[0] = 0;
+    pLook->anSlot[0] = pLook->aSz[0] ? (nByte/4)/pLook->aSz[0] : 0;
+    pLook->anSlot[2] = (nByte/4)/pLook->aSz[2];
+    pLook->anSlot[1] = (nByte - pLook->anSlot[0]*pLook->aSz[0]
+                             - pLook->anSlot[2]*pLook->aSz[2])/sz;
+    for(i=0; i<LOOKASIDE_NCLASS; i++){
+      if( pLook->anSlot[i]==0 ) pLook->aSz[i] = 0;
+    }
+    pLook->szChunk = nByte;
+    pLook->nChunkMax = pLook->szMax/nByte;
+    if( pLook->nChunkMax<1 ) pLook->nChunkMax = 1;
+    if( pLook->nChunkMax>LOOKASIDE_NCHUNK ) pLook->nChunkMax = LOOKASIDE_NCHUNK;
+    sqlite3LookasideAddChunk(db, pStart);
+    pLook->bEnabled = 1;
+    pLook->bMalloced = pBuf==0 ?1:0;
   }else{
-    db->lookaside.pEnd = 0;
-    db->lookaside.bEnabled = 0;
-    db->lookaside.bMalloced = 0;
+    for(i=0; i<LOOKASIDE_NCLASS; i++){
+      pLook->aSz[i] = 0;
+      pLook->anSlot[i] = 0;
+    }
+    pLook->szChunk = 0;
+    pLook->nChunkMax = 0;
+    pLook->bEnabled = 0;
+    pLook->bMalloced = 0;
   }
   return SQLITE_OK;
 }
@@ -669,6 +707,24 @@ int sqlite3_db_config(sqlite3 *db, int op, ...){
       rc = setupLookaside(db, pBuf, sz, cnt);
       break;
     }
+    case SQLITE_DBCONFIG_LOOKASIDE_MAX: {
+      Lookaside *pLook = &db->lookaside;
+      int szMax = va_arg(ap, int);
+      int *pRes = va_arg(ap, int*);
+      if( szMax>=0 ){
+        pLook->szMax = szMax;
+        if( pLook->szChunk ){
+          pLook->nChunkMax = szMax/pLook->szChunk;
+          if( pLook->nChunkMax<pLook->nChunk ) pLook->nChunkMax = pLook->nChunk;
+          if( pLook->nChunkMax>LOOKASIDE_NCHUNK ){
+            pLook->nChunkMax = LOOKASIDE_NCHUNK;
+          }
+        }
+      }
+      if( pRes ) *pRes = pLook->szMax;
+      rc = SQLITE_OK;
+      break;
+    }
     default: {
       static const struct {
         int op;      /* The opcode */
@@ -981,6 +1037,7 @@ void sqlite3LeaveMutexAndCloseZombie(sqlite3 *db){
   for(j=0; j<db->nDb; j++){
     struct Db *pDb = &db->aDb[j];
     if( pDb->pBt ){
+      sqlite3SchemaShareDetach(db, j);
       sqlite3BtreeClose(pDb->pBt);
       pDb->pBt = 0;
       if( j!=1 ){
@@ -1031,6 +1088,8 @@ void sqlite3LeaveMutexAndCloseZombie(sqlite3 *db){
     sqlite3DbFree(db, pColl);
   }
   sqlite3HashClear(&db->aCollSeq);
+  sqlite3WhereFeedbackClear(db);
+  sqlite3WhereAdviceClear(db);
 #ifndef SQLITE_OMIT_VIRTUALTABLE
   for(i=sqliteHashFirst(&db->aModule); i; i=sqliteHashNext(i)){
     Module *pMod = (Module *)sqliteHashData(i);
@@ -1063,9 +1122,7 @@ void sqlite3LeaveMutexAndCloseZombie(sqlite3 *db){
   db->magic = SQLITE_MAGIC_CLOSED;
   sqlite3_mutex_free(db->mutex);
   assert( db->lookaside.nOut==0 );  /* Fails on a lookaside memory leak 释放后备内存*/
-  if( db->lookaside.bMalloced ){
-    sqlite3_free(db->lookaside.pStart);
-  }
+  freeLookaside(db);
   sqlite3_free(db);
 }
 
@@ -1313,8 +1370,11 @@ int sqlite3CreateFunc(													  /*一个SQlite内部函数*/
 ){
   FuncDef *p;
   int nName;
+  int extraFlags;
 
   assert( sqlite3_mutex_held(db->mutex) );
+  extraFlags = enc & SQLITE_DETERMINISTIC;
+  enc &= ~SQLITE_DETERMINISTIC;
   if( zFunctionName==0 ||
       (xFunc && (xFinal || xStep)) || 
       (!xFunc && (xFinal && !xStep)) ||
@@ -1336,11 +1396,12 @@ int sqlite3CreateFunc(													  /*一个SQlite内部函数*/
     enc = SQLITE_UTF16NATIVE;
   }else if( enc==SQLITE_ANY ){											  /*如果编码格式为SQLITE_ANY*/
     int rc;
-    rc = sqlite3CreateFunc(db, zFunctionName, nArg, SQLITE_UTF8,
+    rc = sqlite3CreateFunc(db, zFunctionName, nArg, SQLITE_UTF8|extraFlags,
          pUserData, xFunc, xStep, xFinal, pDestructor);
     if( rc==SQLITE_OK ){
-      rc = sqlite3CreateFunc(db, zFunctionName, nArg, SQLITE_UTF16LE,
-          pUserData, xFunc, xStep, xFinal, pDestructor);
+      rc = sqlite3CreateFunc(db, zFunctionName, nArg,
+          SQLITE_UTF16LE|extraFlags, pUserData, xFunc, xStep, xFinal,
+          pDestructor);
     }
     if( rc!=SQLITE_OK ){
       return rc;
@@ -1382,7 +1443,7 @@ int sqlite3CreateFunc(													  /*一个SQlite内部函数*/
     pDestructor->nRef++;
   }
   p->pDestructor = pDestructor;
-  p->flags = 0;
+  p->flags = extraFlags ? SQLITE_FUNC_CONSTANT : 0;
   p->xFunc = xFunc;
   p->xStep = xStep;
   p->xFinalize = xFinal;
@@ -2422,6 +2483,18 @@ static int openDatabase(
 #ifndef SQLITE_OMIT_VIRTUALTABLE
   sqlite3HashInit(&db->aModule);
 #endif
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+  sqlite3HashInit(&db->aCardFeedback);
+#endif
+#ifndef SQLITE_OMIT_INDEX_ADVISOR
+  sqlite3HashInit(&db->aIndexAdvice);
+#endif
+#if !defined(SQLITE_OMIT_LAZY_SCHEMA) && defined(SQLITE_DEFAULT_LAZY_SCHEMA)
+  db->bLazySchema = SQLITE_DEFAULT_LAZY_SCHEMA!=0;
+#endif
+#if !defined(SQLITE_OMIT_SHARED_SCHEMA) && defined(SQLITE_DEFAULT_SHARED_SCHEMA)
+  db->bSharedSchema = SQLITE_DEFAULT_SHARED_SCHEMA!=0;
+#endif
 
   /* Add the default collation sequence BINARY. BINARY works for both UTF-8
   ** and UTF-16, so add a version for each to avoid any unnecessary
@@ -2541,6 +2614,7 @@ static int openDatabase(
 #endif
 
   /* Enable the lookaside-malloc subsystem */
+  db->lookaside.szMax = SQLITE_DEFAULT_LOOKASIDE_MAX;
   setupLookaside(db, 0, sqlite3GlobalConfig.szLookaside,
                         sqlite3GlobalConfig.nLookaside);
 
@@ -2817,10 +2891,12 @@ int sqlite3_table_column_metadata(
   int notnull = 0;
   int primarykey = 0;
   int autoinc = 0;
+  u8 bShareHeld;
 
   /* Ensure the database schema has been loaded */
   sqlite3_mutex_enter(db->mutex);
   sqlite3BtreeEnterAll(db);
+  bShareHeld = sqlite3SchemaShareEnter(db);
   rc = sqlite3Init(db, &zErrMsg);
   if( SQLITE_OK!=rc ){
     goto error_out;
@@ -2877,6 +2953,7 @@ int sqlite3_table_column_metadata(
   }
 
 error_out:
+  sqlite3SchemaShareLeave(db, bShareHeld);
   sqlite3BtreeLeaveAll(db);
 
   /* Whether the function call succeeded or failed, set the output parameters
@@ -372,6 +372,34 @@ static int mallocWithAlarm(int n, void **pp){
   return nFull;
 }
 
+#ifdef SQLITE_ENABLE_MEMSYS6
+/*
+** Add memory statistics accumulated by a thread of the memsys6 allocator
+** to the global status counters.
+*/
+void sqlite3MallocStatAdd(int nByte, int nCount){
+  sqlite3_mutex_enter(mem0.mutex);
+  sqlite3StatusAdd(SQLITE_STATUS_MEMORY_USED, nByte);
+  sqlite3StatusAdd(SQLITE_STATUS_MALLOC_COUNT, nCount);
+  sqlite3_mutex_leave(mem0.mutex);
+}
+#endif
+
+/*
+** Return true if the statistics for an allocation of n bytes may be
+** recorded by the memsys6 allocator in the calling thread instead of
+** under mem0.mutex.  This is not done while an alarm callback is set, as
+** the alarm depends on an accurate SQLITE_STATUS_MEMORY_USED, nor for
+** the largest request seen so far, so that SQLITE_STATUS_MALLOC_SIZE
+** still records it.
+*/
+static int mallocStatDeferrable(int n){
+  int nCur, nMax;
+  if( !sqlite3Memsys6Stat(0, 0) || mem0.alarmCallback!=0 ) return 0;
+  sqlite3_status(SQLITE_STATUS_MALLOC_SIZE, &nCur, &nMax, 0);
+  return n<=nMax;
+}
+
 /*
 ** Allocate memory.  This routine is like sqlite3_malloc() except that it
 ** assumes the memory subsystem has already been initialized.
@@ -391,9 +419,14 @@ void *sqlite3Malloc(int n){
     /*内存分配满了就用sqlite3_malloc*/
     p = 0;
   }else if( sqlite3GlobalConfig.bMemstat ){//允许分配
-    sqlite3_mutex_enter(mem0.mutex);
-    mallocWithAlarm(n, &p);
-    sqlite3_mutex_leave(mem0.mutex);
+    if( mallocStatDeferrable(n) ){
+      p = sqlite3GlobalConfig.m.xMalloc(sqlite3GlobalConfig.m.xRoundup(n));
+      if( p ) (void)sqlite3Memsys6Stat(sqlite3MallocSize(p), 1);
+    }else{
+      sqlite3_mutex_enter(mem0.mutex);
+      mallocWithAlarm(n, &p);
+      sqlite3_mutex_leave(mem0.mutex);
+    }
   }else{
     p = sqlite3GlobalConfig.m.xMalloc(n);//重新分配
   }
@@ -534,8 +567,192 @@ void sqlite3ScratchFree(void *p){/*释放缓冲区*/
 static int isLookaside(sqlite3 *db, void *p){
   return p && p>=db->lookaside.pStart && p<db->lookaside.pEnd;
 }
+
+/*
+** Return the lookaside slot class of p, or -1 if p is not a lookaside
+** memory allocation from db.
+*/
+static int lookasideClass(sqlite3 *db, void *p){
+  Lookaside *pLook = &db->lookaside;
+  int i, j;
+  if( !isLookaside(db, p) ) return -1;
+  for(i=0; i<pLook->nChunk; i++){
+    LookasideChunk *pChunk = &pLook->aChunk[i];
+    if( p>=pChunk->pStart && p<pChunk->aEnd[LOOKASIDE_NCLASS-1] ){
+      for(j=0; p>=pChunk->aEnd[j]; j++){}
+      return j;
+    }
+  }
+  return -1;
+}
 #else
 #define isLookaside(A,B) 0
+#define lookasideClass(A,B) (-1)
+#endif
+
+/*
+** Add a chunk of db->lookaside.szChunk bytes at pStart to the lookaside
+** memory of db, dividing it into slots of each class.
+*/
+void sqlite3LookasideAddChunk(sqlite3 *db, void *pStart){
+  Lookaside *pLook = &db->lookaside;
+  LookasideChunk *pChunk;
+  u8 *z = (u8*)pStart;
+  int i, j;
+
+  assert( pLook->nChunk<LOOKASIDE_NCHUNK );
+  pChunk = &pLook->aChunk[pLook->nChunk++];
+  pChunk->pStart = pStart;
+  for(i=0; i<LOOKASIDE_NCLASS; i++){
+    for(j=0; j<pLook->anSlot[i]; j++){
+      LookasideSlot *p = (LookasideSlot*)z;
+      p->pNext = pLook->apFree[i];
+      pLook->apFree[i] = p;
+      z += pLook->aSz[i];
+    }
+    pChunk->aEnd[i] = (void*)z;
+  }
+  assert( z<=&((u8*)pStart)[pLook->szChunk] );
+  if( pLook->pStart==0 || pStart<pLook->pStart ) pLook->pStart = pStart;
+  if( pLook->pEnd==0 || (void*)z>pLook->pEnd ) pLook->pEnd = (void*)z;
+}
+
+#ifndef SQLITE_OMIT_LOOKASIDE
+/*
+** Take a slot large enough for n bytes from the lookaside memory of db.
+** Use the smallest suitable class that has a free slot, adding a new
+** chunk if there is none and the limit on chunks allows it.  Return
+** NULL if no slot is available.
+*/
+static void *lookasideMalloc(sqlite3 *db, int n){
+  Lookaside *pLook = &db->lookaside;
+  LookasideSlot *pBuf;
+  int iReq, i;
+
+  for(iReq=0; iReq<LOOKASIDE_NCLASS && n>pLook->aSz[iReq]; iReq++){}
+  if( iReq>=LOOKASIDE_NCLASS ){
+    pLook->anStat[1]++;
+    return 0;
+  }
+  for(i=iReq; i<LOOKASIDE_NCLASS && pLook->apFree[i]==0; i++){}
+  if( i>=LOOKASIDE_NCLASS && pLook->nChunk<pLook->nChunkMax ){
+    void *pStart;
+    sqlite3BeginBenignMalloc();
+    pStart = sqlite3Malloc(pLook->szChunk);
+    sqlite3EndBenignMalloc();
+    if( pStart ){
+      sqlite3LookasideAddChunk(db, pStart);
+      for(i=iReq; i<LOOKASIDE_NCLASS && pLook->apFree[i]==0; i++){}
+    }else{
+      pLook->nChunkMax = pLook->nChunk;
+    }
+  }
+  if( i>=LOOKASIDE_NCLASS ){
+    pLook->anStat[2]++;
+    pLook->aClassStat[iReq][2]++;
+    return 0;
+  }
+  pBuf = pLook->apFree[i];
+  pLook->apFree[i] = pBuf->pNext;
+  pLook->anOut[i]++;
+  pLook->nOut++;
+  pLook->anStat[0]++;
+  pLook->aClassStat[iReq][i==iReq ? 0 : 1]++;
+  if( pLook->nOut>pLook->mxOut ){
+    pLook->mxOut = pLook->nOut;
+  }
+  return (void*)pBuf;
+}
+#endif
+
+#ifndef SQLITE_OMIT_PARSE_ARENA
+/*
+** If p was taken from the arena of the statement that db is preparing,
+** return the number of bytes available in the allocation.  Otherwise
+** return -1.
+*/
+static int arenaSize(sqlite3 *db, void *p){
+  ParseArena *pArena = db->pArena;
+  ParseArenaChunk *pChunk;
+  if( pArena==0 || p<pArena->pStart || p>=pArena->pEnd ) return -1;
+  for(pChunk=pArena->pChunk; pChunk; pChunk=pChunk->pNext){
+    if( p>(void*)pChunk && p<(void*)pChunk->pEnd ){
+      return *(int*)&((u8*)p)[-8];
+    }
+  }
+  return -1;
+}
+
+/*
+** Allocate n bytes from the arena of the statement that db is preparing.
+** Use sqlite3DbMallocRaw() instead if there is no such statement, if
+** lookaside is disabled, if the schema is being parsed or if n is too
+** large for the arena.
+*/
+void *sqlite3ArenaMallocRaw(sqlite3 *db, int n){
+  ParseArena *pArena = db ? db->pArena : 0;
+  int nByte;
+  u8 *p;
+
+  if( pArena==0 || db->lookaside.bEnabled==0 || db->init.busy
+   || db->mallocFailed || n>PARSE_ARENA_MAXCHUNK/4 ){
+    return sqlite3DbMallocRaw(db, n);
+  }
+  nByte = ROUND8(n) + 8;
+  if( pArena->pChunk==0 || nByte>pArena->pChunk->pEnd-pArena->pFree ){
+    ParseArenaChunk *pChunk;
+    int nHdr = ROUND8(sizeof(ParseArenaChunk));
+    int szChunk = pArena->szChunk ? pArena->szChunk : PARSE_ARENA_MINCHUNK;
+    if( szChunk<nHdr+nByte ) szChunk = nHdr+nByte;
+    sqlite3BeginBenignMalloc();
+    pChunk = (ParseArenaChunk*)sqlite3Malloc(szChunk);
+    sqlite3EndBenignMalloc();
+    if( pChunk==0 ){
+      return sqlite3DbMallocRaw(db, n);
+    }
+    pChunk->pNext = pArena->pChunk;
+    pChunk->pEnd = &((u8*)pChunk)[szChunk];
+    pArena->pChunk = pChunk;
+    pArena->pFree = &((u8*)pChunk)[nHdr];
+    pArena->szChunk = szChunk<PARSE_ARENA_MAXCHUNK/2 ? szChunk*2 : szChunk;
+    if( pArena->pStart==0 || (void*)pChunk<pArena->pStart ){
+      pArena->pStart = (void*)pChunk;
+    }
+    if( (void*)pChunk->pEnd>pArena->pEnd ){
+      pArena->pEnd = (void*)pChunk->pEnd;
+    }
+  }
+  p = pArena->pFree;
+  pArena->pFree += nByte;
+  *(int*)p = nByte-8;
+  return (void*)&p[8];
+}
+
+/*
+** Allocate and zero n bytes from the arena of the statement that db
+** is preparing.
+*/
+void *sqlite3ArenaMallocZero(sqlite3 *db, int n){
+  void *p = sqlite3ArenaMallocRaw(db, n);
+  if( p ){
+    memset(p, 0, n);
+  }
+  return p;
+}
+
+/*
+** Release all memory held by an arena.
+*/
+void sqlite3ArenaClear(ParseArena *pArena){
+  while( pArena->pChunk ){
+    ParseArenaChunk *pChunk = pArena->pChunk;
+    pArena->pChunk = pChunk->pNext;
+    sqlite3_free(pChunk);
+  }
+  memset(pArena, 0, sizeof(*pArena));
+}
+#else
+#define arenaSize(A,B) (-1)
 #endif
 
 /*
@@ -550,9 +767,12 @@ int sqlite3MallocSize(void *p){
   return sqlite3GlobalConfig.m.xSize(p);
 }
 int sqlite3DbMallocSize(sqlite3 *db, void *p){
+  int iClass, nArena;
   assert( db==0 || sqlite3_mutex_held(db->mutex) );
-  if( db && isLookaside(db, p) ){
-    return db->lookaside.sz;
+  if( db && (nArena = arenaSize(db, p))>=0 ){
+    return nArena;
+  }else if( db && (iClass = lookasideClass(db, p))>=0 ){
+    return db->lookaside.aSz[iClass];
   }else{
     assert( sqlite3MemdebugHasType(p, MEMTYPE_DB) );
     assert( sqlite3MemdebugHasType(p, MEMTYPE_LOOKASIDE|MEMTYPE_HEAP) );
@@ -571,6 +791,11 @@ void sqlite3_free(void *p){
   assert( sqlite3MemdebugNoType(p, MEMTYPE_DB) );
   assert( sqlite3MemdebugHasType(p, MEMTYPE_HEAP) );
   if( sqlite3GlobalConfig.bMemstat ){
+    if( mallocStatDeferrable(0) ){
+      (void)sqlite3Memsys6Stat(-sqlite3MallocSize(p), -1);
+      sqlite3GlobalConfig.m.xFree(p);
+      return;
+    }
     sqlite3_mutex_enter(mem0.mutex);
     sqlite3StatusAdd(SQLITE_STATUS_MEMORY_USED, -sqlite3MallocSize(p));
     sqlite3StatusAdd(SQLITE_STATUS_MALLOC_COUNT, -1);
@@ -590,18 +815,25 @@ void sqlite3_free(void *p){
 void sqlite3DbFree(sqlite3 *db, void *p){
   assert( db==0 || sqlite3_mutex_held(db->mutex) );
   if( db ){
+    int iClass;
     if( db->pnBytesFreed ){
       *db->pnBytesFreed += sqlite3DbMallocSize(db, p);
       return;
     }
-    if( isLookaside(db, p) ){
+    if( arenaSize(db, p)>=0 ){
+      /* Arena memory is released by sqlite3ArenaClear() */
+      return;
+    }
+    iClass = lookasideClass(db, p);
+    if( iClass>=0 ){
       LookasideSlot *pBuf = (LookasideSlot*)p;
 #if SQLITE_DEBUG
       /* Trash all content in the buffer being freed */
-      memset(p, 0xaa, db->lookaside.sz);
+      memset(p, 0xaa, db->lookaside.aSz[iClass]);
 #endif
-      pBuf->pNext = db->lookaside.pFree;
-      db->lookaside.pFree = pBuf;
+      pBuf->pNext = db->lookaside.apFree[iClass];
+      db->lookaside.apFree[iClass] = pBuf;
+      db->lookaside.anOut[iClass]--;
       db->lookaside.nOut--;
       return;
     }
@@ -639,6 +871,9 @@ void *sqlite3Realloc(void *pOld, int nBytes){
   nNew = sqlite3GlobalConfig.m.xRoundup(nBytes);//四舍五入给nNew
   if( nOld==nNew ){//新的等于旧的
     pNew = pOld;//新指针指向pOld
+  }else if( sqlite3GlobalConfig.bMemstat && mallocStatDeferrable(nBytes) ){
+    pNew = sqlite3GlobalConfig.m.xRealloc(pOld, nNew);
+    if( pNew ) (void)sqlite3Memsys6Stat(sqlite3MallocSize(pNew)-nOld, 0);
   }else if( sqlite3GlobalConfig.bMemstat ){
     sqlite3_mutex_enter(mem0.mutex);
     sqlite3StatusSet(SQLITE_STATUS_MALLOC_SIZE, nBytes);
@@ -736,24 +971,12 @@ void *sqlite3DbMallocRaw(sqlite3 *db, int n){
   assert( db==0 || db->pnBytesFreed==0 );
 #ifndef SQLITE_OMIT_LOOKASIDE//定义宏
   if( db ){
-    LookasideSlot *pBuf;//pBuf指向一个大的连续的内存块
     if( db->mallocFailed ){//分配失败 返回0
       return 0;    }
       ///*0：命中。 1：不是完全命中。 2：全部未命中*/
     if( db->lookaside.bEnabled ){//禁用后备内存
-      if( n>db->lookaside.sz ){//如果给的n大于每个缓冲区大小
-        db->lookaside.anStat[1]++;
-      }else if( (pBuf = db->lookaside.pFree)==0 ){
-        db->lookaside.anStat[2]++;
-      }else{
-        db->lookaside.pFree = pBuf->pNext;
-        db->lookaside.nOut++;
-        db->lookaside.anStat[0]++;//命中
-        if( db->lookaside.nOut>db->lookaside.mxOut ){//最大值
-          db->lookaside.mxOut = db->lookaside.nOut;
-        }
-        return (void*)pBuf;
-      }
+      void *pBuf = lookasideMalloc(db, n);
+      if( pBuf ) return pBuf;
     }
   }
 #else
@@ -778,19 +1001,30 @@ void *sqlite3DbMallocRaw(sqlite3 *db, int n){
 */
 void *sqlite3DbRealloc(sqlite3 *db, void *p, int n){
   void *pNew = 0;
+  int iClass, nArena;
   assert( db!=0 );
   assert( sqlite3_mutex_held(db->mutex) );
   if( db->mallocFailed==0 ){
     if( p==0 ){
       return sqlite3DbMallocRaw(db, n);
     }
-    if( isLookaside(db, p) ){//后备内存
-      if( n<=db->lookaside.sz ){//小于每一个块的大小
+    nArena = arenaSize(db, p);
+    iClass = nArena>=0 ? -1 : lookasideClass(db, p);
+    if( nArena>=0 ){
+      if( n<=nArena ){
+        return p;
+      }
+      pNew = sqlite3ArenaMallocRaw(db, n);
+      if( pNew ){
+        memcpy(pNew, p, nArena);
+      }
+    }else if( iClass>=0 ){//后备内存
+      if( n<=db->lookaside.aSz[iClass] ){//小于每一个块的大小
         return p;
       }
       pNew = sqlite3DbMallocRaw(db, n);//pNew指向新的地址空间
       if( pNew ){
-        memcpy(pNew, p, db->lookaside.sz);//拷贝p的内存到pNew中
+        memcpy(pNew, p, db->lookaside.aSz[iClass]);//拷贝p的内存到pNew中
         sqlite3DbFree(db, p);//释放p
       }
     }else{
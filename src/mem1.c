@@ -314,6 +314,8 @@ static void sqlite3MemShutdown(void *NotUsed){
 **
 ** Populate the low-level memory allocation function pointers in
 ** sqlite3GlobalConfig.m with pointers to the routines in this file.
+** If SQLITE_ENABLE_MEMSYS6 is defined, the memsys6 per-thread cache
+** is installed in front of them.
 ** 
 ** 该例程是外部链接这个文件的唯一的例程。
 ** 在sqlite3GlobalConfig.m与这个文件指针的例程中填充底层内存分配函数指针。
@@ -329,7 +331,11 @@ void sqlite3MemSetDefault(void){
      sqlite3MemShutdown,
      0
   };
+#ifdef SQLITE_ENABLE_MEMSYS6
+  sqlite3_config(SQLITE_CONFIG_MALLOC, sqlite3MemGetMemsys6(&defaultMethods));
+#else
   sqlite3_config(SQLITE_CONFIG_MALLOC, &defaultMethods);
+#endif
 }
 
 #endif /* SQLITE_SYSTEM_MALLOC */
@@ -0,0 +1,477 @@
+/*
+** 2012 October 19
+**
+** The author disclaims copyright to this source code.  In place of
+** a legal notice, here is a blessing:
+**
+**    May you do good and not evil.
+**    May you find forgiveness for yourself and forgive others.
+**    May you share freely, never taking more than you give.
+**
+*************************************************************************
+**
+** This file contains the memsys6 memory allocator.  It is enabled by
+** compiling with SQLITE_ENABLE_MEMSYS6, in which case it is layered on
+** top of the system allocator in mem1.c and installed as the default.
+**
+** Small allocations are rounded up to one of MEMSYS6_NCLASS size classes.
+** Each thread keeps a short free-list of blocks for each size class, so
+** that most calls to xMalloc() and xFree() neither take a mutex nor call
+** into the system allocator.  When a thread's free-list for a class grows
+** past its limit, half of it is moved to a global depot, protected by the
+** SQLITE_MUTEX_STATIC_MEM2 mutex, from which any thread may refill its own
+** list.  This way memory freed by one thread can be reused by another.
+** Allocations larger than the biggest size class go straight to the
+** system allocator.
+**
+** The allocator also accumulates, per thread, the changes to the
+** SQLITE_STATUS_MEMORY_USED and SQLITE_STATUS_MALLOC_COUNT counters made
+** by sqlite3Malloc() and sqlite3_free().  These are only added to the
+** global counters, under mem0.mutex, once they exceed MEMSYS6_STAT_BATCH
+** bytes or allocations, or when the thread exits.  This removes the last
+** global lock from the common allocation path when memory statistics are
+** enabled, at the cost of sqlite3_memory_used() and the related status
+** values lagging by up to that amount per thread.  Statistics are not
+** deferred while a soft heap limit or memory alarm is set.
+**
+** Per-thread free-lists use pthread thread-specific data.  On builds
+** without pthreads and with SQLITE_THREADSAFE enabled, the size classes
+** are still used but every block is returned to the system allocator.
+**
+** C-preprocessor macro summary:
+**
+**    SQLITE_MEMSYS6_CACHE_SIZE   The number of bytes each thread may keep
+**                                on its free-list for each size class.
+**                                The default is 65536.
+*/
+#include "sqliteInt.h"
+
+#ifdef SQLITE_ENABLE_MEMSYS6
+
+#ifdef SQLITE_MUTEX_PTHREADS
+# include <pthread.h>
+# define MEMSYS6_PTHREADS 1
+#elif SQLITE_THREADSAFE==0
+# define MEMSYS6_SINGLE 1
+#endif
+
+#ifndef SQLITE_MEMSYS6_CACHE_SIZE
+# define SQLITE_MEMSYS6_CACHE_SIZE 65536
+#endif
+
+/*
+** Sizes 16 to 128 are served in steps of 16 bytes, and each power of
+** two above that, up to 32768, is split into four size classes.
+*/
+#define MEMSYS6_NCLASS  40
+#define MEMSYS6_MAXSIZE 32768
+
+/*
+** A thread's pending statistics are added to the global counters once
+** they exceed this many bytes, or a quarter of this many allocations.
+*/
+#define MEMSYS6_STAT_BATCH 65536
+
+/*
+** Each allocation is preceded by this header.  The header is 8 bytes so
+** that the memory returned to the caller remains 8-byte aligned.
+*/
+typedef struct Mem6Block Mem6Block;
+struct Mem6Block {
+  u32 nSize;              /* Usable size of the allocation */
+  u32 iClass;             /* Size class, or MEMSYS6_NCLASS if none */
+};
+
+/*
+** A free block on a free-list.  This overlays the usable part of the
+** block, which is always at least 16 bytes.
+*/
+typedef struct Mem6Free Mem6Free;
+struct Mem6Free {
+  Mem6Free *pNext;        /* Next free block of the same size class */
+};
+
+/*
+** The free-lists and pending statistics of a single thread.
+*/
+typedef struct Mem6Cache Mem6Cache;
+struct Mem6Cache {
+  Mem6Free *apFree[MEMSYS6_NCLASS];   /* Free blocks of each size class */
+  int anFree[MEMSYS6_NCLASS];         /* Number of blocks on apFree[i] */
+  int nStatUsed;          /* Unreported change to MEMORY_USED status */
+  int nStatCount;         /* Unreported change to MALLOC_COUNT status */
+  Mem6Cache *pNext;       /* Next cache in mem6.pCache list */
+  Mem6Cache **ppPrev;     /* Pointer to this cache in mem6.pCache list */
+};
+
+/*
+** All global state used by the memsys6 allocator.
+*/
+static SQLITE_WSD struct Mem6Global {
+  sqlite3_mem_methods base;           /* Allocator that blocks come from */
+  sqlite3_mutex *mutex;               /* Mutex protecting the depot */
+  int isInit;                         /* True after memsys6Init() */
+  int aSize[MEMSYS6_NCLASS];          /* Usable size of each size class */
+  int anMax[MEMSYS6_NCLASS];          /* Max blocks on a thread free-list */
+  Mem6Free *apDepot[MEMSYS6_NCLASS];  /* Blocks shared by all threads */
+  int anDepot[MEMSYS6_NCLASS];        /* Number of blocks on apDepot[i] */
+  Mem6Cache *pCache;                  /* Every thread cache */
+#ifdef MEMSYS6_PTHREADS
+  int hasKey;                         /* True if key is valid */
+  pthread_key_t key;                  /* Key for the thread cache */
+#endif
+#ifdef MEMSYS6_SINGLE
+  Mem6Cache single;                   /* The only cache */
+#endif
+} mem6;
+
+#define mem6 GLOBAL(struct Mem6Global, mem6)
+
+/*
+** Return the size class for an allocation of n bytes, or MEMSYS6_NCLASS
+** if n is too large for any size class.
+*/
+static int memsys6Class(int n){
+  int k;
+  assert( n>0 );
+  if( n<=128 ) return (n-1)/16;
+  if( n>MEMSYS6_MAXSIZE ) return MEMSYS6_NCLASS;
+  for(k=7; n>(2<<k); k++){}
+  return 8 + (k-7)*4 + (n-1-(1<<k))/(1<<(k-2));
+}
+
+/*
+** Return the calling thread's cache, creating it if necessary.  Return
+** NULL if per-thread caches are not available.
+*/
+static Mem6Cache *memsys6Cache(void){
+#if defined(MEMSYS6_PTHREADS)
+  Mem6Cache *pCache;
+  if( !mem6.hasKey ) return 0;
+  pCache = (Mem6Cache*)pthread_getspecific(mem6.key);
+  if( pCache==0 ){
+    pCache = (Mem6Cache*)mem6.base.xMalloc(
+                               mem6.base.xRoundup(sizeof(Mem6Cache)));
+    if( pCache==0 ) return 0;
+    memset(pCache, 0, sizeof(*pCache));
+    if( pthread_setspecific(mem6.key, pCache) ){
+      mem6.base.xFree(pCache);
+      return 0;
+    }
+    sqlite3_mutex_enter(mem6.mutex);
+    pCache->pNext = mem6.pCache;
+    if( pCache->pNext ) pCache->pNext->ppPrev = &pCache->pNext;
+    pCache->ppPrev = &mem6.pCache;
+    mem6.pCache = pCache;
+    sqlite3_mutex_leave(mem6.mutex);
+  }
+  return pCache;
+#elif defined(MEMSYS6_SINGLE)
+  return &mem6.single;
+#else
+  return 0;
+#endif
+}
+
+/*
+** Move all but the first nKeep blocks on the free-list of pCache for
+** size class iClass to the depot.  Blocks that do not fit in the depot
+** are returned to the system allocator.
+*/
+static void memsys6Spill(Mem6Cache *pCache, int iClass, int nKeep){
+  Mem6Free *pList;
+  Mem6Free **pp = &pCache->apFree[iClass];
+  int i;
+
+  assert( nKeep>=0 && nKeep<=pCache->anFree[iClass] );
+  for(i=0; i<nKeep; i++) pp = &(*pp)->pNext;
+  pList = *pp;
+  *pp = 0;
+  pCache->anFree[iClass] = nKeep;
+
+  sqlite3_mutex_enter(mem6.mutex);
+  while( pList && mem6.anDepot[iClass]<mem6.anMax[iClass]*4 ){
+    Mem6Free *p = pList;
+    pList = p->pNext;
+    p->pNext = mem6.apDepot[iClass];
+    mem6.apDepot[iClass] = p;
+    mem6.anDepot[iClass]++;
+  }
+  sqlite3_mutex_leave(mem6.mutex);
+
+  while( pList ){
+    Mem6Free *p = pList;
+    pList = p->pNext;
+    mem6.base.xFree(((Mem6Block*)p)-1);
+  }
+}
+
+/*
+** Move up to half the free-list limit of blocks of size class iClass
+** from the depot to the free-list of pCache, which is empty.  Return the
+** number of blocks moved.
+**
+** The depot is shared by all threads, so it is only ever examined while
+** holding mem6.mutex, even to find that it is empty.
+*/
+static int memsys6Refill(Mem6Cache *pCache, int iClass){
+  int n = 0;
+  assert( pCache->apFree[iClass]==0 );
+  sqlite3_mutex_enter(mem6.mutex);
+  while( mem6.apDepot[iClass] && n<mem6.anMax[iClass]/2 ){
+    Mem6Free *p = mem6.apDepot[iClass];
+    mem6.apDepot[iClass] = p->pNext;
+    p->pNext = pCache->apFree[iClass];
+    pCache->apFree[iClass] = p;
+    n++;
+  }
+  mem6.anDepot[iClass] -= n;
+  sqlite3_mutex_leave(mem6.mutex);
+  pCache->anFree[iClass] = n;
+  return n;
+}
+
+/*
+** Allocate nByte bytes of memory.
+*/
+static void *memsys6Malloc(int nByte){
+  int iClass = memsys6Class(nByte);
+  Mem6Block *pBlock;
+
+  if( iClass<MEMSYS6_NCLASS ){
+    Mem6Cache *pCache = memsys6Cache();
+    if( pCache
+     && (pCache->apFree[iClass] || memsys6Refill(pCache, iClass))
+    ){
+      Mem6Free *p = pCache->apFree[iClass];
+      pCache->apFree[iClass] = p->pNext;
+      pCache->anFree[iClass]--;
+      return (void*)p;
+    }
+    nByte = mem6.aSize[iClass];
+  }else{
+    nByte = ROUND8(nByte);
+  }
+  pBlock = (Mem6Block*)mem6.base.xMalloc(
+                             mem6.base.xRoundup(nByte+sizeof(Mem6Block)));
+  if( pBlock==0 ) return 0;
+  pBlock->nSize = (u32)nByte;
+  pBlock->iClass = (u32)iClass;
+  return (void*)&pBlock[1];
+}
+
+/*
+** Free memory obtained from memsys6Malloc() or memsys6Realloc().
+*/
+static void memsys6Free(void *pPrior){
+  Mem6Block *pBlock = ((Mem6Block*)pPrior)-1;
+  int iClass = (int)pBlock->iClass;
+  if( iClass<MEMSYS6_NCLASS ){
+    Mem6Cache *pCache = memsys6Cache();
+    if( pCache ){
+      Mem6Free *p = (Mem6Free*)pPrior;
+      p->pNext = pCache->apFree[iClass];
+      pCache->apFree[iClass] = p;
+      if( ++pCache->anFree[iClass]>mem6.anMax[iClass] ){
+        memsys6Spill(pCache, iClass, mem6.anMax[iClass]/2);
+      }
+      return;
+    }
+  }
+  mem6.base.xFree(pBlock);
+}
+
+/*
+** Return the usable size of an allocation.
+*/
+static int memsys6Size(void *pPrior){
+  if( pPrior==0 ) return 0;
+  return (int)(((Mem6Block*)pPrior)[-1].nSize);
+}
+
+/*
+** Round a request size up to the size of the allocation that would be
+** returned for it.
+*/
+static int memsys6Roundup(int n){
+  int iClass = memsys6Class(n);
+  return iClass<MEMSYS6_NCLASS ? mem6.aSize[iClass] : ROUND8(n);
+}
+
+/*
+** Change the size of an allocation.  nByte has already been passed
+** through memsys6Roundup().
+*/
+static void *memsys6Realloc(void *pPrior, int nByte){
+  Mem6Block *pBlock = ((Mem6Block*)pPrior)-1;
+  int iClass = memsys6Class(nByte);
+  void *pNew;
+
+  assert( nByte==memsys6Roundup(nByte) );
+  if( iClass==MEMSYS6_NCLASS && pBlock->iClass==MEMSYS6_NCLASS ){
+    pBlock = (Mem6Block*)mem6.base.xRealloc(pBlock,
+                             mem6.base.xRoundup(nByte+sizeof(Mem6Block)));
+    if( pBlock==0 ) return 0;
+    pBlock->nSize = (u32)nByte;
+    return (void*)&pBlock[1];
+  }
+  if( iClass<MEMSYS6_NCLASS && (u32)iClass==pBlock->iClass ){
+    return pPrior;
+  }
+  pNew = memsys6Malloc(nByte);
+  if( pNew ){
+    memcpy(pNew, pPrior, (u32)nByte<pBlock->nSize ? nByte : pBlock->nSize);
+    memsys6Free(pPrior);
+  }
+  return pNew;
+}
+
+#ifdef MEMSYS6_PTHREADS
+/*
+** Called by pthreads when a thread that used the allocator exits.
+** Return its free blocks to the depot and report its statistics.
+*/
+static void memsys6ThreadExit(void *pArg){
+  Mem6Cache *pCache = (Mem6Cache*)pArg;
+  int i;
+  for(i=0; i<MEMSYS6_NCLASS; i++){
+    if( pCache->anFree[i] ) memsys6Spill(pCache, i, 0);
+  }
+  if( pCache->nStatUsed || pCache->nStatCount ){
+    sqlite3MallocStatAdd(pCache->nStatUsed, pCache->nStatCount);
+  }
+  sqlite3_mutex_enter(mem6.mutex);
+  *pCache->ppPrev = pCache->pNext;
+  if( pCache->pNext ) pCache->pNext->ppPrev = pCache->ppPrev;
+  sqlite3_mutex_leave(mem6.mutex);
+  mem6.base.xFree(pCache);
+}
+#endif
+
+/*
+** Initialize the allocator.
+*/
+static int memsys6Init(void *NotUsed){
+  int rc;
+  int i;
+  UNUSED_PARAMETER(NotUsed);
+  rc = mem6.base.xInit(mem6.base.pAppData);
+  if( rc!=SQLITE_OK ) return rc;
+  for(i=0; i<MEMSYS6_NCLASS; i++){
+    int sz;
+    if( i<8 ){
+      sz = (i+1)*16;
+    }else{
+      int k = 7 + (i-8)/4;
+      sz = (1<<k) + ((i-8)%4 + 1)*(1<<(k-2));
+    }
+    mem6.aSize[i] = sz;
+    mem6.anMax[i] = SQLITE_MEMSYS6_CACHE_SIZE/sz;
+    if( mem6.anMax[i]<4 ) mem6.anMax[i] = 4;
+    assert( memsys6Class(sz)==i );
+  }
+  mem6.mutex = sqlite3MutexAlloc(SQLITE_MUTEX_STATIC_MEM2);
+#ifdef MEMSYS6_PTHREADS
+  mem6.hasKey = pthread_key_create(&mem6.key, memsys6ThreadExit)==0;
+#endif
+  mem6.isInit = 1;
+  return SQLITE_OK;
+}
+
+/*
+** Deinitialize the allocator.  Free blocks held by every thread, as
+** well as those in the depot, are returned to the system allocator.
+*/
+static void memsys6Shutdown(void *NotUsed){
+  int i;
+  UNUSED_PARAMETER(NotUsed);
+#ifdef MEMSYS6_PTHREADS
+  if( mem6.hasKey ) pthread_key_delete(mem6.key);
+  mem6.hasKey = 0;
+#endif
+#ifdef MEMSYS6_SINGLE
+  mem6.single.pNext = 0;
+  mem6.pCache = &mem6.single;
+#endif
+  while( mem6.pCache ){
+    Mem6Cache *pCache = mem6.pCache;
+    mem6.pCache = pCache->pNext;
+    for(i=0; i<MEMSYS6_NCLASS; i++){
+      while( pCache->apFree[i] ){
+        Mem6Free *p = pCache->apFree[i];
+        pCache->apFree[i] = p->pNext;
+        mem6.base.xFree(((Mem6Block*)p)-1);
+      }
+      pCache->anFree[i] = 0;
+    }
+#ifdef MEMSYS6_PTHREADS
+    mem6.base.xFree(pCache);
+#endif
+  }
+  for(i=0; i<MEMSYS6_NCLASS; i++){
+    while( mem6.apDepot[i] ){
+      Mem6Free *p = mem6.apDepot[i];
+      mem6.apDepot[i] = p->pNext;
+      mem6.base.xFree(((Mem6Block*)p)-1);
+    }
+    mem6.anDepot[i] = 0;
+  }
+  mem6.isInit = 0;
+  mem6.mutex = 0;
+  mem6.base.xShutdown(mem6.base.pAppData);
+}
+
+/*
+** Record a change of nByte bytes and nCount allocations to the memory
+** statistics of the calling thread.  Return zero, without recording
+** anything, if this is not possible because memsys6 is not the active
+** allocator or the thread has no cache.  Calling this routine with both
+** arguments set to zero tests whether statistics can be deferred.
+*/
+int sqlite3Memsys6Stat(int nByte, int nCount){
+#ifdef MEMSYS6_PTHREADS
+  Mem6Cache *pCache;
+  if( !mem6.isInit ) return 0;
+  pCache = memsys6Cache();
+  if( pCache==0 ) return 0;
+  pCache->nStatUsed += nByte;
+  pCache->nStatCount += nCount;
+  if( pCache->nStatUsed>=MEMSYS6_STAT_BATCH
+   || pCache->nStatUsed<=-MEMSYS6_STAT_BATCH
+   || pCache->nStatCount>=MEMSYS6_STAT_BATCH/4
+   || pCache->nStatCount<=-MEMSYS6_STAT_BATCH/4
+  ){
+    sqlite3MallocStatAdd(pCache->nStatUsed, pCache->nStatCount);
+    pCache->nStatUsed = 0;
+    pCache->nStatCount = 0;
+  }
+  return 1;
+#else
+  /* Without per-thread caches there is nowhere to keep the statistics.
+  ** In single-threaded builds mem0.mutex is a no-op anyway. */
+  UNUSED_PARAMETER2(nByte, nCount);
+  return 0;
+#endif
+}
+
+/*
+** Return the memsys6 methods, layered over the allocator pBase.
+*/
+const sqlite3_mem_methods *sqlite3MemGetMemsys6(
+  const sqlite3_mem_methods *pBase
+){
+  static const sqlite3_mem_methods memsys6Methods = {
+     memsys6Malloc,
+     memsys6Free,
+     memsys6Realloc,
+     memsys6Size,
+     memsys6Roundup,
+     memsys6Init,
+     memsys6Shutdown,
+     0
+  };
+  mem6.base = *pBase;
+  return &memsys6Methods;
+}
+
+#endif /* SQLITE_ENABLE_MEMSYS6 */
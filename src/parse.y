@@ -485,7 +485,7 @@ as(X) ::= .            {X.n = 0;}
 
 // A complete FROM clause.
 //
-from(A) ::= .                {A = sqlite3DbMallocZero(pParse->db, sizeof(*A));}
+from(A) ::= .                {A = sqlite3ArenaMallocZero(pParse->db, sizeof(*A));}
 from(A) ::= FROM seltablist(X). {
   A = X;
   sqlite3SrcListShiftJoinType(A);
@@ -177,6 +177,9 @@ static int flagPragma(Parse *pParse, const char *zLeft, const char *zRight){
     { "fullfsync",                SQLITE_FullFSync     },
     { "checkpoint_fullfsync",     SQLITE_CkptFullFSync },
     { "reverse_unordered_selects", SQLITE_ReverseOrder  },
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+    { "scan_status",              SQLITE_ScanStatus    },
+#endif
 #ifndef SQLITE_OMIT_AUTOMATIC_INDEX
     { "automatic_index",          SQLITE_AutoIndex     },
 #endif
@@ -480,6 +483,157 @@ void sqlite3Pragma(
     returnSingleInt(pParse, "secure_delete", b);
   }else
 
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+  /*
+  **  PRAGMA cardinality_feedback
+  **  PRAGMA cardinality_feedback=ON/OFF
+  **
+  ** While cardinality feedback is on, the number of rows visited by the
+  ** loops of new statements is measured as they run and used to plan
+  ** statements prepared later.  Turning it off discards the measurements.
+  */
+  if( sqlite3StrICmp(zLeft,"cardinality_feedback")==0 ){
+    if( zRight ){
+      db->bCardFeedback = sqlite3GetBoolean(zRight, 0);
+      if( db->bCardFeedback==0 ) sqlite3WhereFeedbackClear(db);
+    }
+    returnSingleInt(pParse, "cardinality_feedback", db->bCardFeedback);
+  }else
+#endif
+
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+  /*
+  **  PRAGMA lazy_schema
+  **  PRAGMA lazy_schema=ON/OFF
+  **
+  ** While lazy_schema is on, a database schema that is read from disk is
+  ** parsed one table at a time, the first time each table is used, rather
+  ** than all at once.  The setting does not affect schemas that have
+  ** already been read, so it is normally set as soon as the connection is
+  ** opened.
+  */
+  if( sqlite3StrICmp(zLeft,"lazy_schema")==0 ){
+    if( zRight ){
+      db->bLazySchema = sqlite3GetBoolean(zRight, 0);
+    }
+    returnSingleInt(pParse, "lazy_schema", db->bLazySchema);
+  }else
+#endif
+
+#ifndef SQLITE_OMIT_SHARED_SCHEMA
+  /*
+  **  PRAGMA shared_schema
+  **  PRAGMA shared_schema=ON/OFF
+  **
+  ** While shared_schema is on, the parsed schema of a database file is
+  ** shared with other connections in the same process that have it on,
+  ** instead of each connection reading sqlite_master for itself.  The
+  ** setting takes effect the next time the schema is read.
+  */
+  if( sqlite3StrICmp(zLeft,"shared_schema")==0 ){
+    if( zRight ){
+      db->bSharedSchema = sqlite3GetBoolean(zRight, 0);
+    }
+    returnSingleInt(pParse, "shared_schema", db->bSharedSchema);
+  }else
+#endif
+
+#ifndef SQLITE_OMIT_INDEX_ADVISOR
+  /*
+  **  PRAGMA index_advisor
+  **  PRAGMA index_advisor=ON/OFF
+  **
+  ** While the index advisor is on, each index that the query planner
+  ** could have used to avoid a full table scan or an automatic index is
+  ** recorded, together with the estimated saving, every time a statement
+  ** prepared while the advisor was on runs.  Turning it off discards the
+  ** recommendations.
+  */
+  if( sqlite3StrICmp(zLeft,"index_advisor")==0 ){
+    if( zRight ){
+      db->bIndexAdvisor = sqlite3GetBoolean(zRight, 0);
+      if( db->bIndexAdvisor==0 ) sqlite3WhereAdviceClear(db);
+    }
+    returnSingleInt(pParse, "index_advisor", db->bIndexAdvisor);
+  }else
+
+  /*
+  **  PRAGMA index_advice
+  **
+  ** Return one row for each index recommended by the index advisor, the
+  ** most beneficial first.  The columns are the database and table, the
+  ** comma separated list of columns to index, the number of statement
+  ** executions that would have used the index, the total estimated
+  ** saving in query planner cost units and a CREATE INDEX statement.
+  */
+  if( sqlite3StrICmp(zLeft,"index_advice")==0 ){
+    int nAdvice = 0;
+    IndexAdvice **apAdvice = sqlite3WhereAdviceList(db, &nAdvice);
+    int i;
+    sqlite3VdbeSetNumCols(v, 6);
+    pParse->nMem = 6;
+    sqlite3VdbeSetColName(v, 0, COLNAME_NAME, "database", SQLITE_STATIC);
+    sqlite3VdbeSetColName(v, 1, COLNAME_NAME, "table", SQLITE_STATIC);
+    sqlite3VdbeSetColName(v, 2, COLNAME_NAME, "columns", SQLITE_STATIC);
+    sqlite3VdbeSetColName(v, 3, COLNAME_NAME, "uses", SQLITE_STATIC);
+    sqlite3VdbeSetColName(v, 4, COLNAME_NAME, "benefit", SQLITE_STATIC);
+    sqlite3VdbeSetColName(v, 5, COLNAME_NAME, "sql", SQLITE_STATIC);
+    for(i=0; i<nAdvice; i++){
+      IndexAdvice *pAdvice = apAdvice[i];
+      i64 *pUse = sqlite3DbMallocRaw(db, sizeof(i64));
+      double *pBenefit = sqlite3DbMallocRaw(db, sizeof(double));
+      if( pUse ) *pUse = (i64)pAdvice->nUse;
+      if( pBenefit ) *pBenefit = pAdvice->rBenefit;
+      sqlite3VdbeAddOp4(v, OP_String8, 0, 1, 0, pAdvice->zDb, 0);
+      sqlite3VdbeAddOp4(v, OP_String8, 0, 2, 0, pAdvice->zTab, 0);
+      sqlite3VdbeAddOp4(v, OP_String8, 0, 3, 0, pAdvice->zCols, 0);
+      sqlite3VdbeAddOp4(v, OP_Int64, 0, 4, 0, (char*)pUse, P4_INT64);
+      sqlite3VdbeAddOp4(v, OP_Real, 0, 5, 0, (char*)pBenefit, P4_REAL);
+      sqlite3VdbeAddOp4(v, OP_String8, 0, 6, 0, pAdvice->zSql, 0);
+      sqlite3VdbeAddOp2(v, OP_ResultRow, 1, 6);
+    }
+    sqlite3DbFree(db, apAdvice);
+  }else
+#endif
+
+#ifndef SQLITE_OMIT_ANALYZE
+  /*
+  **  PRAGMA analysis_sample
+  **  PRAGMA analysis_sample = N
+  **
+  ** If N is greater than zero, ANALYZE reads only N leaf pages of each
+  ** index, picked at random, and estimates the sqlite_stat1 values from
+  ** them.  No sqlite_stat3 samples are collected in that case.  Zero, the
+  ** default, makes ANALYZE read every entry of every index.
+  */
+  if( sqlite3StrICmp(zLeft,"analysis_sample")==0 ){
+    if( zRight ){
+      int n = sqlite3Atoi(zRight);
+      db->nAnalysisSample = n>0 ? n : 0;
+    }
+    returnSingleInt(pParse, "analysis_sample", db->nAnalysisSample);
+  }else
+
+  /*
+  **  PRAGMA analysis_threshold
+  **  PRAGMA analysis_threshold = N
+  **
+  ** If N is greater than zero, ANALYZE of a whole database only analyzes
+  ** the tables that have no statistics yet, and those whose number of
+  ** rows differs by at least N percent from the count recorded in
+  ** sqlite_stat1.  The number of rows is estimated by sampling a few
+  ** random paths through the table b-tree.  Zero, the default, analyzes
+  ** every table.
+  */
+  if( sqlite3StrICmp(zLeft,"analysis_threshold")==0 ){
+    if( zRight ){
+      int n = sqlite3Atoi(zRight);
+      db->nAnalysisThreshold = n>0 ? n : 0;
+    }
+    returnSingleInt(pParse, "analysis_threshold", db->nAnalysisThreshold);
+  }else
+#endif
+
   /*
   **  PRAGMA [database.]max_page_count
   **  PRAGMA [database.]max_page_count=N
@@ -1209,6 +1363,7 @@ void sqlite3Pragma(
       ** for all tables and indices in the database.
       */
       assert( sqlite3SchemaMutexHeld(db, i, 0) );
+      sqlite3SchemaLazyLoadAll(db, i);
       pTbls = &db->aDb[i].pSchema->tblHash;
       for(x=sqliteHashFirst(pTbls); x; x=sqliteHashNext(x)){
         Table *pTab = sqliteHashData(x);
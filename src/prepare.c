@@ -123,6 +123,324 @@ int sqlite3InitCallback(void *pInit, int argc, char **argv, char **NotUsed){
   return 0;
 }
 
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+/*
+** Lazy schema loading.
+**
+** If PRAGMA lazy_schema is on when the schema of a database other than
+** TEMP is read, the CREATE TABLE and CREATE VIEW statements found in the
+** sqlite_master table are not parsed straight away.  Instead the name,
+** root page and SQL of each table or view is recorded in Schema.lazyHash,
+** together with the indices and triggers that belong to it.  The first
+** time sqlite3FindTable() or sqlite3FindIndex() looks for the table or
+** one of its indices, all of these objects are parsed.  Statistics for
+** them are read from sqlite_stat1 and sqlite_stat3 along with those of
+** every other table when the schema is loaded (see sqlite3AnalysisLoad())
+** and attached once they are parsed, so that no SQL is run while names
+** are being resolved.  Code that needs every table of a database calls
+** sqlite3SchemaLazyLoadAll() first.
+**
+** If a table cannot be parsed, its entry is left in Schema.lazyHash with
+** the error message in SchemaLazy.zErr.  sqlite3LocateTable() reports
+** that message in place of "no such table".
+**
+** The sqlite_* tables, and every table that might have a foreign key,
+** are always parsed straight away.  Parsing a child table records its
+** foreign keys in Schema.fkeyHash, where the parent table looks for
+** them.  Nothing is loaded lazily while db->init.busy is set.
+*/
+
+/*
+** Return true if the CREATE TABLE statement zSql might declare a foreign
+** key constraint.
+*/
+static int lazyMayHaveForeignKey(const char *zSql){
+  for(; *zSql; zSql++){
+    if( sqlite3Tolower(*zSql)=='r'
+     && sqlite3StrNICmp(zSql, "references", 10)==0
+    ){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+** This callback is used in place of sqlite3InitCallback() when the schema
+** is read lazily.  In addition to the arguments of sqlite3InitCallback():
+**
+**     argv[3] = name of the table the object belongs to
+**     argv[4] = type of object: "table", "index", "view" or "trigger"
+*/
+static int initLazyCallback(
+  void *pInit,                    /* An InitData structure */
+  int argc,                       /* Number of columns. Always 5 */
+  char **argv,                    /* Column values */
+  char **NotUsed                  /* Column names */
+){
+  InitData *pData = (InitData*)pInit;
+  sqlite3 *db = pData->db;
+  Schema *pSchema = db->aDb[pData->iDb].pSchema;
+  SchemaLazy *pTab = 0;           /* Entry for the table argv[3] */
+  SchemaLazy *p;                  /* New entry */
+  int nName;                      /* Bytes in argv[0], including nul */
+  int nSql;                       /* Bytes in argv[2], including nul */
+
+  assert( argc==5 );
+  UNUSED_PARAMETER2(NotUsed, argc);
+  if( argv==0 ) return 0;
+  if( db->mallocFailed || argv[0]==0 || argv[1]==0 || argv[3]==0
+   || argv[4]==0
+  ){
+    return sqlite3InitCallback(pInit, 3, argv, 0);
+  }
+  nName = sqlite3Strlen30(argv[0]);
+  if( sqlite3HashFind(&pSchema->lazyHash, argv[0], nName) ){
+    return sqlite3InitCallback(pInit, 3, argv, 0);
+  }
+  if( sqlite3StrICmp(argv[4], "table")==0
+   || sqlite3StrICmp(argv[4], "view")==0
+  ){
+    if( argv[2]==0 || sqlite3StrNICmp(argv[0], "sqlite_", 7)==0
+     || lazyMayHaveForeignKey(argv[2])
+    ){
+      return sqlite3InitCallback(pInit, 3, argv, 0);
+    }
+  }else{
+    pTab = sqlite3HashFind(&pSchema->lazyHash, argv[3],
+                           sqlite3Strlen30(argv[3]));
+    if( pTab==0 || pTab->pTab!=pTab ){
+      return sqlite3InitCallback(pInit, 3, argv, 0);
+    }
+  }
+
+  DbClearProperty(db, pData->iDb, DB_Empty);
+  nSql = argv[2] ? sqlite3Strlen30(argv[2])+1 : 0;
+  p = (SchemaLazy*)sqlite3MallocZero(sizeof(SchemaLazy) + nName+1 + nSql);
+  if( p==0 ){
+    db->mallocFailed = 1;
+    corruptSchema(pData, argv[0], 0);
+    return 1;
+  }
+  p->zName = (char*)&p[1];
+  memcpy(p->zName, argv[0], nName+1);
+  if( nSql ){
+    p->zSql = &p->zName[nName+1];
+    memcpy(p->zSql, argv[2], nSql);
+  }
+  if( sqlite3GetInt32(argv[1], &p->tnum)==0 ){
+    sqlite3_free(p);
+    corruptSchema(pData, argv[0], "invalid rootpage");
+    return 0;
+  }
+  p->isTrigger = sqlite3StrICmp(argv[4], "trigger")==0;
+  if( !p->isTrigger
+   && sqlite3HashInsert(&pSchema->lazyHash, p->zName, nName, p)==p
+  ){
+    /* Malloc failed within the hash table */
+    sqlite3_free(p);
+    db->mallocFailed = 1;
+    corruptSchema(pData, argv[0], 0);
+    return 1;
+  }
+  if( pTab==0 ){
+    p->pTab = p->pLast = p;
+  }else{
+    p->pTab = pTab;
+    pTab->pLast->pNext = p;
+    pTab->pLast = p;
+  }
+  return 0;
+}
+
+/*
+** Parse the objects in the list headed by table entry pTab, then free
+** the list.  If the table itself cannot be parsed, its entry is put back
+** into Schema.lazyHash with the error message in SchemaLazy.zErr for
+** sqlite3LocateTable() to report.  Other errors are written to
+** sqlite3_log().
+*/
+static void lazyLoadTable(sqlite3 *db, int iDb, SchemaLazy *pTab){
+  Schema *pSchema = db->aDb[iDb].pSchema;
+  struct sqlite3InitInfo saved = db->init;
+  InitData initData;
+  char *zErr = 0;
+  SchemaLazy *p;
+  SchemaLazy *pNext;
+
+  assert( pTab->pTab==pTab );
+  for(p=pTab; p; p=p->pNext){
+    if( !p->isTrigger ){
+      sqlite3HashInsert(&pSchema->lazyHash, p->zName,
+                        sqlite3Strlen30(p->zName), 0);
+    }
+  }
+
+  initData.db = db;
+  initData.iDb = iDb;
+  initData.rc = SQLITE_OK;
+  initData.pzErrMsg = &zErr;
+  db->init.busy = 1;
+#ifndef SQLITE_OMIT_AUTHORIZATION
+  {
+    int (*xAuth)(void*,int,const char*,const char*,const char*,const char*);
+    xAuth = db->xAuth;
+    db->xAuth = 0;
+#endif
+    for(p=pTab; p && initData.rc==SQLITE_OK; p=p->pNext){
+      char zRoot[16];
+      char *azArg[4];
+      sqlite3_snprintf(sizeof(zRoot), zRoot, "%d", p->tnum);
+      azArg[0] = p->zName;
+      azArg[1] = zRoot;
+      azArg[2] = p->zSql;
+      azArg[3] = 0;
+      sqlite3InitCallback(&initData, 3, azArg, 0);
+    }
+#ifndef SQLITE_OMIT_AUTHORIZATION
+    db->xAuth = xAuth;
+  }
+#endif
+  db->init = saved;
+
+  if( initData.rc!=SQLITE_OK ){
+    if( !db->mallocFailed
+     && sqlite3HashFind(&pSchema->tblHash, pTab->zName,
+                        sqlite3Strlen30(pTab->zName))==0
+    ){
+      pNext = pTab->pNext;
+      pTab->pNext = 0;
+      pTab->pLast = pTab;
+      pTab->zErr = sqlite3_mprintf("%s", zErr ? zErr : "cannot load schema");
+      if( pTab->zErr==0
+       || sqlite3HashInsert(&pSchema->lazyHash, pTab->zName,
+                            sqlite3Strlen30(pTab->zName), pTab)==pTab
+      ){
+        sqlite3_free(pTab->zErr);
+        pTab->pNext = pNext;
+        db->mallocFailed = 1;
+      }else{
+        pTab = pNext;
+      }
+    }else{
+      sqlite3_log(initData.rc, "%s", zErr ? zErr : "cannot load schema");
+    }
+  }
+#ifndef SQLITE_OMIT_ANALYZE
+  else{
+    sqlite3AnalysisLazyApply(db, iDb, pTab);
+  }
+#endif
+  sqlite3DbFree(db, zErr);
+  for(p=pTab; p; p=pNext){
+    pNext = p->pNext;
+#ifndef SQLITE_OMIT_ANALYZE
+    sqlite3AnalysisLazyClear(p);
+#endif
+    sqlite3_free(p);
+  }
+}
+
+/*
+** If the table, view or index zName of database iDb has not been parsed
+** yet, parse it now along with the other objects that belong to the same
+** table.  Return true if anything was parsed, or false otherwise.
+*/
+int sqlite3SchemaLazyLoad(sqlite3 *db, int iDb, const char *zName){
+  Schema *pSchema = db->aDb[iDb].pSchema;
+  SchemaLazy *p;
+  if( pSchema->lazyHash.count==0 || db->init.busy ) return 0;
+  p = sqlite3HashFind(&pSchema->lazyHash, zName, sqlite3Strlen30(zName));
+  if( p==0 || p->pTab->zErr ) return 0;
+  lazyLoadTable(db, iDb, p->pTab);
+  return 1;
+}
+
+/*
+** Parse every object of database iDb that has not been parsed yet.
+** Tables that could not be parsed before are skipped.
+*/
+void sqlite3SchemaLazyLoadAll(sqlite3 *db, int iDb){
+  Schema *pSchema = db->aDb[iDb].pSchema;
+  if( db->init.busy ) return;
+  while( !db->mallocFailed ){
+    HashElem *pElem;
+    SchemaLazy *p = 0;
+    for(pElem=sqliteHashFirst(&pSchema->lazyHash); pElem;
+        pElem=sqliteHashNext(pElem)){
+      p = (SchemaLazy*)sqliteHashData(pElem);
+      if( p->pTab->zErr==0 ) break;
+    }
+    if( pElem==0 ) break;
+    lazyLoadTable(db, iDb, p->pTab);
+  }
+}
+
+/*
+** Return the message saved by lazyLoadTable() if table zName could not
+** be parsed, or NULL otherwise.  Databases are searched in the same
+** order as sqlite3FindTable().
+*/
+const char *sqlite3SchemaLazyError(
+  sqlite3 *db,                    /* The database connection */
+  const char *zName,              /* Name of the table */
+  const char *zDb                 /* Name of the database.  May be NULL */
+){
+  int i;
+  for(i=OMIT_TEMPDB; i<db->nDb; i++){
+    int j = (i<2) ? i^1 : i;   /* Search TEMP before MAIN */
+    Schema *pSchema = db->aDb[j].pSchema;
+    SchemaLazy *p;
+    if( zDb && sqlite3StrICmp(zDb, db->aDb[j].zName) ) continue;
+    if( pSchema==0 || pSchema->lazyHash.count==0 ) continue;
+    p = sqlite3HashFind(&pSchema->lazyHash, zName, sqlite3Strlen30(zName));
+    if( p && p->pTab==p && p->zErr ) return p->zErr;
+  }
+  return 0;
+}
+
+/*
+** The b-tree with root page iFrom has been moved to page iTo.  Update
+** any objects of pSchema that have not been parsed yet.  See also
+** sqlite3RootPageMoved().
+*/
+void sqlite3SchemaLazyMoved(Schema *pSchema, int iFrom, int iTo){
+  HashElem *pElem;
+  for(pElem=sqliteHashFirst(&pSchema->lazyHash); pElem;
+      pElem=sqliteHashNext(pElem)){
+    SchemaLazy *p = (SchemaLazy*)sqliteHashData(pElem);
+    if( p->pTab==p ){
+      for(; p; p=p->pNext){
+        if( p->tnum==iFrom ) p->tnum = iTo;
+      }
+    }
+  }
+}
+
+/*
+** Discard the objects of pSchema that have not been parsed yet.
+*/
+void sqlite3SchemaLazyClear(Schema *pSchema){
+  HashElem *pElem;
+  for(pElem=sqliteHashFirst(&pSchema->lazyHash); pElem;
+      pElem=sqliteHashNext(pElem)){
+    SchemaLazy *p = (SchemaLazy*)sqliteHashData(pElem);
+    if( p->pTab==p ){
+      sqlite3_free(p->zErr);
+      while( p ){
+        SchemaLazy *pNext = p->pNext;
+#ifndef SQLITE_OMIT_ANALYZE
+        sqlite3AnalysisLazyClear(p);
+#endif
+        sqlite3_free(p);
+        p = pNext;
+      }
+    }
+  }
+  sqlite3HashClear(&pSchema->lazyHash);
+}
+#endif /* SQLITE_OMIT_LAZY_SCHEMA */
+
 /*
 ** Attempt to read the database schema and initialize internal
 ** data structures for a single database file.  The index of the
@@ -175,6 +493,11 @@ static int sqlite3InitOne(sqlite3 *db, int iDb, char **pzErrMsg){
   assert( sqlite3_mutex_held(db->mutex) );
   assert( iDb==1 || sqlite3BtreeHoldsMutex(db->aDb[iDb].pBt) );
 
+  /* If the schema may be shared with other connections, read it into a
+  ** standalone Schema object.  See callback.c. */
+  rc = sqlite3SchemaShareBegin(db, iDb);
+  if( rc ) goto error_out;
+
   /* zMasterSchema and zInitScript are set to point at the master schema
   ** and initialisation script appropriate for the database being
   ** initialised. zMasterName is the name of the master table.
@@ -312,21 +635,37 @@ static int sqlite3InitOne(sqlite3 *db, int iDb, char **pzErrMsg){
     db->flags &= ~SQLITE_LegacyFileFmt;
   }
 
+  /* If another connection has already read this version of the schema,
+  ** use its copy.
+  */
+  if( sqlite3SchemaShareAttach(db, iDb) ){
+    rc = SQLITE_OK;
+    goto initone_error_out;
+  }
+
   /* Read the schema information out of the schema tables
   */
   assert( db->init.busy );
   {
     char *zSql;
+    sqlite3_callback xInit = sqlite3InitCallback;
+    const char *zCols = "name, rootpage, sql";
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+    if( db->bLazySchema && iDb!=1 ){
+      xInit = initLazyCallback;
+      zCols = "name, rootpage, sql, tbl_name, type";
+    }
+#endif
     zSql = sqlite3MPrintf(db, 
-        "SELECT name, rootpage, sql FROM '%q'.%s ORDER BY rowid",
-        db->aDb[iDb].zName, zMasterName);
+        "SELECT %s FROM '%q'.%s ORDER BY rowid",
+        zCols, db->aDb[iDb].zName, zMasterName);
 #ifndef SQLITE_OMIT_AUTHORIZATION
     {
       int (*xAuth)(void*,int,const char*,const char*,const char*,const char*);
       xAuth = db->xAuth;
       db->xAuth = 0;
 #endif
-      rc = sqlite3_exec(db, zSql, sqlite3InitCallback, &initData, 0);
+      rc = sqlite3_exec(db, zSql, xInit, &initData, 0);
 #ifndef SQLITE_OMIT_AUTHORIZATION
       db->xAuth = xAuth;
     }
@@ -353,6 +692,7 @@ static int sqlite3InitOne(sqlite3 *db, int iDb, char **pzErrMsg){
     ** even when its contents have been corrupted.
     */
     DbSetProperty(db, iDb, DB_SchemaLoaded);
+    if( rc==SQLITE_OK ) sqlite3SchemaSharePublish(db, iDb);
     rc = SQLITE_OK;
   }
 
@@ -416,6 +756,9 @@ int sqlite3Init(sqlite3 *db, char **pzErrMsg){
   if( rc==SQLITE_OK && commit_internal ){
     sqlite3CommitInternalChanges(db);
   }
+  if( rc==SQLITE_OK ){
+    sqlite3SchemaSharePin(db);
+  }
 
   return rc; 
 }
@@ -534,6 +877,7 @@ static int sqlite3Prepare(
   char *zErrMsg = 0;        /* Error message */
   int rc = SQLITE_OK;       /* Result code */
   int i;                    /* Loop counter */
+  ParseArena *pSavedArena = db->pArena;  /* Arena of the enclosing prepare */
 
   /* Allocate the parsing context */
   pParse = sqlite3StackAllocZero(db, sizeof(*pParse));
@@ -541,6 +885,9 @@ static int sqlite3Prepare(
     rc = SQLITE_NOMEM;
     goto end_prepare;
   }
+#ifndef SQLITE_OMIT_PARSE_ARENA
+  db->pArena = &pParse->sArena;
+#endif
   pParse->pReprepare = pReprepare;
   assert( ppStmt && *ppStmt==0 );
   assert( !db->mallocFailed );
@@ -676,6 +1023,11 @@ static int sqlite3Prepare(
 
 end_prepare:
 
+  /* The parse tree has been deleted, so the arena may be released */
+  if( pParse ){
+    sqlite3ArenaClear(&pParse->sArena);
+  }
+  db->pArena = pSavedArena;
   sqlite3StackFree(db, pParse);
   rc = sqlite3ApiExit(db, rc);
   assert( (rc&db->errMask)==rc );
@@ -691,6 +1043,7 @@ static int sqlite3LockAndPrepare(
   const char **pzTail       /* OUT: End of parsed string */
 ){
   int rc;
+  u8 bShareHeld;
   assert( ppStmt!=0 );
   *ppStmt = 0;
   if( !sqlite3SafetyCheckOk(db) ){
@@ -698,11 +1051,13 @@ static int sqlite3LockAndPrepare(
   }
   sqlite3_mutex_enter(db->mutex);
   sqlite3BtreeEnterAll(db);
+  bShareHeld = sqlite3SchemaShareEnter(db);
   rc = sqlite3Prepare(db, zSql, nBytes, saveSqlFlag, pOld, ppStmt, pzTail);
   if( rc==SQLITE_SCHEMA ){
     sqlite3_finalize(*ppStmt);
     rc = sqlite3Prepare(db, zSql, nBytes, saveSqlFlag, pOld, ppStmt, pzTail);
   }
+  sqlite3SchemaShareLeave(db, bShareHeld);
   sqlite3BtreeLeaveAll(db);
   sqlite3_mutex_leave(db->mutex);
   assert( rc==SQLITE_OK || *ppStmt==0 );
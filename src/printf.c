@@ -118,33 +118,405 @@ static const et_info fmtinfo[] = {
 */
 #ifndef SQLITE_OMIT_FLOATING_POINT
 /*
-** "*val" is a double such that 0.1 <= *val < 10.0
-** Return the ascii code for the leading digit of *val, then
-** multiply "*val" by 10.0 to renormalize.
+** Multiply the double-double value x[0]+x[1] by y+yy, where y is a power
+** of ten and yy is the error in its representation as a double.  This is
+** Dekker's algorithm, which keeps about 106 bits of precision using only
+** double arithmetic.  The high halves hx and hy keep 26 significant bits
+** so that the partial products are exact.  The volatile qualifiers stop
+** the compiler from fusing or reordering the operations.
+*/
+static void et_dekkerMul2(volatile double *x, double y, double yy){
+  volatile double tx, ty, p, q, c, cc;
+  double hx, hy;
+  u64 m;
+  memcpy(&m, (void*)&x[0], 8);
+  m &= 0xfffffffff8000000LL;
+  memcpy(&hx, &m, 8);
+  tx = x[0] - hx;
+  memcpy(&m, &y, 8);
+  m &= 0xfffffffff8000000LL;
+  memcpy(&hy, &m, 8);
+  ty = y - hy;
+  p = hx*hy;
+  q = hx*ty + tx*hy;
+  c = p+q;
+  cc = p - c + q + tx*ty;
+  cc = x[0]*yy + x[1]*y + cc;
+  x[0] = c + cc;
+  x[1] = c - x[0];
+  x[1] += cc;
+}
+
+/*
+** Powers of ten as double-double values.  aEtPow10[k] holds 10**(k-27)
+** for 0<=k<=54.  The first element of each pair is the nearest double
+** and the second is the error in that approximation.
+*/
+static const double aEtPow10[][2] = {
+  { 1.0e-27, -3.84948697491918407e-44 },
+  { 1.0e-26, -3.84948697491918417e-43 },
+  { 1.0e-25, -3.84948697491918369e-42 },
+  { 1.0e-24, 7.62995004482971775e-41 },
+  { 1.0e-23, 3.95653019851006929e-40 },
+  { 1.0e-22, -4.85967743265708718e-39 },
+  { 1.0e-21, 9.24625477721036252e-38 },
+  { 1.0e-20, 5.48467285457904291e-37 },
+  { 1.0e-19, 2.47540731647398689e-36 },
+  { 1.0e-18, -7.15424240546219257e-35 },
+  { 1.0e-17, -7.15424240546219214e-34 },
+  { 1.0e-16, 2.09022132759653978e-33 },
+  { 1.0e-15, -7.77053998766610758e-32 },
+  { 1.0e-14, 1.18069064544010129e-32 },
+  { 1.0e-13, -3.03737455634003710e-30 },
+  { 1.0e-12, 2.01133523707443852e-29 },
+  { 1.0e-11, 6.05030307180601908e-28 },
+  { 1.0e-10, -3.64321973154977434e-27 },
+  { 1.0e-09, -6.22815914577798525e-26 },
+  { 1.0e-08, -2.09225608301284711e-25 },
+  { 1.0e-07, 4.52518881741137392e-24 },
+  { 1.0e-06, 4.52518881741137407e-23 },
+  { 1.0e-05, -8.18030539140313055e-22 },
+  { 1.0e-04, -4.79217360238592994e-21 },
+  { 1.0e-03, -2.08166817117216856e-20 },
+  { 1.0e-02, -2.08166817117216844e-19 },
+  { 1.0e-01, -5.55111512312578301e-18 },
+  { 1.0e+00, 0.0 },
+  { 1.0e+01, 0.0 },
+  { 1.0e+02, 0.0 },
+  { 1.0e+03, 0.0 },
+  { 1.0e+04, 0.0 },
+  { 1.0e+05, 0.0 },
+  { 1.0e+06, 0.0 },
+  { 1.0e+07, 0.0 },
+  { 1.0e+08, 0.0 },
+  { 1.0e+09, 0.0 },
+  { 1.0e+10, 0.0 },
+  { 1.0e+11, 0.0 },
+  { 1.0e+12, 0.0 },
+  { 1.0e+13, 0.0 },
+  { 1.0e+14, 0.0 },
+  { 1.0e+15, 0.0 },
+  { 1.0e+16, 0.0 },
+  { 1.0e+17, 0.0 },
+  { 1.0e+18, 0.0 },
+  { 1.0e+19, 0.0 },
+  { 1.0e+20, 0.0 },
+  { 1.0e+21, 0.0 },
+  { 1.0e+22, 0.0 },
+  { 1.0e+23, 8.38860800000000000e+06 },
+  { 1.0e+24, 1.67772160000000000e+07 },
+  { 1.0e+25, -9.05969664000000000e+08 },
+  { 1.0e+26, -4.76472934400000000e+09 },
+  { 1.0e+27, -1.32875550720000000e+10 },
+};
+
+/*
+** aEtPow10x28[j] holds 10**(28*(j-10)) for 0<=j<=20 in the same format.
+*/
+static const double aEtPow10x28[][2] = {
+  { 1.0e-280, 4.26356118305248306e-297 },
+  { 1.0e-252, 5.74534431005156116e-269 },
+  { 1.0e-224, -1.88842045074720978e-241 },
+  { 1.0e-196, -4.61507106775817984e-213 },
+  { 1.0e-168, -4.95359250313018814e-185 },
+  { 1.0e-140, 1.67494959781369210e-157 },
+  { 1.0e-112, 5.03408013151029021e-129 },
+  { 1.0e-084, -3.45765105554531593e-101 },
+  { 1.0e-056, -3.98544412264054368e-73 },
+  { 1.0e-028, 2.87674565383993787e-45 },
+  { 1.0e+000, 0.0 },
+  { 1.0e+028, 4.16880263168000000e+11 },
+  { 1.0e+056, -9.19028350814337858e+39 },
+  { 1.0e+084, -5.77666098981158944e+67 },
+  { 1.0e+112, 6.98800653073695585e+95 },
+  { 1.0e+140, -5.92838012408148721e+123 },
+  { 1.0e+168, 6.61395051652570265e+151 },
+  { 1.0e+196, 4.88567075360764896e+179 },
+  { 1.0e+224, 3.04509648205168069e+207 },
+  { 1.0e+252, -9.91520280529984060e+235 },
+  { 1.0e+280, -3.27822459828620996e+263 },
+};
+
+/*
+** The value of a positive, finite double r after scaling by et_decode().
+** v+frac is r*10^(-e), computed to better than one part in 10^28, with
+** v a u64 of nd digits (18 or 19) and 0<=frac<1.  r is also kept exactly
+** as m*2^b.
+*/
+typedef struct EtDecimal EtDecimal;
+struct EtDecimal {
+  u64 m;                     /* Significand of r */
+  int b;                     /* Binary exponent of r */
+  u64 v;                     /* Integer part of the scaled value */
+  double frac;               /* Fractional part of the scaled value */
+  int e;                     /* Power of ten that v+frac is scaled by */
+  int nd;                    /* Number of decimal digits in v */
+};
+
+/*
+** Scale the positive, finite value r so that its integer part holds 18 or
+** 19 digits and fill in *p.  Return the decimal exponent of the first
+** significant digit, so that r is d.ddd * 10^exponent before rounding.
 **
-** Example:
-**     input:     *val = 3.14159
-**     output:    *val = 1.4159    function return = '3'
+** The scaling uses at most three double-double multiplications from the
+** tables above, which is much cheaper than extracting the digits one at
+** a time with floating point multiplications.
+*/
+static int et_decode(double r, EtDecimal *p){
+  volatile double rr[2];
+  u64 v;
+  i64 t;
+  int e;                     /* r == rr[0]+rr[1] times 10^e */
+  int q, j;                  /* Power of ten to scale by */
+
+  /* Estimate the decimal exponent of r from its binary exponent and
+  ** multiply by the power of ten that brings it close to 1e18 using the
+  ** tables.  The estimate may be off by one, and is further off for
+  ** denormals, so finish with single steps. */
+  memcpy(&v, &r, 8);
+  p->b = (int)((v>>52)&0x7ff);
+  p->m = v & ((((u64)1)<<52)-1);
+  if( p->b ){
+    p->m |= ((u64)1)<<52;
+    p->b -= 1075;
+  }else{
+    p->b = -1074;
+  }
+  q = 18 - ((int)((v>>52)&0x7ff) - 1023)*78913/262144;
+  e = -q;
+  rr[0] = r;
+  rr[1] = 0.0;
+  if( q>280 ){
+    et_dekkerMul2(rr, aEtPow10x28[20][0], aEtPow10x28[20][1]);
+    q -= 280;
+  }
+  j = q/28;
+  if( j ){
+    et_dekkerMul2(rr, aEtPow10x28[j+10][0], aEtPow10x28[j+10][1]);
+    q -= j*28;
+  }
+  if( q ){
+    et_dekkerMul2(rr, aEtPow10[q+27][0], aEtPow10[q+27][1]);
+  }
+  while( rr[0]>9.223372036854774784e+18 ){
+    e++;
+    et_dekkerMul2(rr, aEtPow10[26][0], aEtPow10[26][1]);
+  }
+  while( rr[0]<9.22337203685477478e+17 ){
+    e--;
+    et_dekkerMul2(rr, 1.0e+01, 0.0);
+  }
+
+  /* rr[0] is larger than 2^53 and so is a whole number.  rr[1] is no more
+  ** than half an ulp of rr[0], so taking its floor is exact. */
+  t = (i64)rr[1];
+  if( (double)t>rr[1] ) t--;
+  p->v = (u64)rr[0] + t;
+  p->frac = rr[1] - (double)t;
+  p->e = e;
+  for(p->nd=0, v=p->v; v; v/=10) p->nd++;
+  return e + p->nd - 1;
+}
+
+/*
+** A non-negative integer of up to 1280 bits, least significant word
+** first.  Only used to settle roundings that are too close to a half
+** for the double-double arithmetic of et_decode() to decide.
+*/
+typedef struct EtBignum EtBignum;
+struct EtBignum {
+  int n;                     /* Number of words in use */
+  u32 a[40];                 /* The words */
+};
+
+/* Set *p to x */
+static void et_bigInit(EtBignum *p, u64 x){
+  p->a[0] = (u32)x;
+  p->a[1] = (u32)(x>>32);
+  p->n = 2;
+}
+
+/* Multiply *p by 5^n */
+static void et_bigMul5(EtBignum *p, int n){
+  while( n>0 ){
+    u32 m = 1;
+    u64 c = 0;
+    int i;
+    for(i=0; i<13 && i<n; i++) m *= 5;
+    n -= i;
+    for(i=0; i<p->n; i++){
+      c += (u64)p->a[i]*m;
+      p->a[i] = (u32)c;
+      c >>= 32;
+    }
+    if( c ) p->a[p->n++] = (u32)c;
+  }
+}
+
+/* Multiply *p by 2^n */
+static void et_bigShl(EtBignum *p, int n){
+  int w = n/32, b = n%32, i;
+  p->a[p->n] = 0;
+  for(i=p->n; i>=0; i--){
+    u32 x = p->a[i]<<b;
+    if( b && i>0 ) x |= p->a[i-1]>>(32-b);
+    p->a[i+w] = x;
+  }
+  for(i=0; i<w; i++) p->a[i] = 0;
+  p->n += w+1;
+}
+
+/* Return negative, zero or positive as *p is less, equal or greater */
+static int et_bigCmp(EtBignum *p, EtBignum *q){
+  int i;
+  while( p->n>0 && p->a[p->n-1]==0 ) p->n--;
+  while( q->n>0 && q->a[q->n-1]==0 ) q->n--;
+  if( p->n!=q->n ) return p->n - q->n;
+  for(i=p->n-1; i>=0; i--){
+    if( p->a[i]!=q->a[i] ) return p->a[i]<q->a[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+/*
+** Compare m*2^b exactly against N*10^s.  Return negative, zero or
+** positive as m*2^b is less than, equal to or greater than N*10^s.
+*/
+static int et_cmpexact(u64 m, int b, u64 N, int s){
+  EtBignum x, y;
+  et_bigInit(&x, m);
+  et_bigInit(&y, N);
+  if( s>=0 ){
+    et_bigMul5(&y, s);
+  }else{
+    et_bigMul5(&x, -s);
+  }
+  if( b>s ){
+    et_bigShl(&x, b-s);
+  }else{
+    et_bigShl(&y, s-b);
+  }
+  return et_bigCmp(&x, &y);
+}
+
+/*
+** Round the value decoded into *p to nKeep significant digits, rounding
+** halves away from zero, and write them into zDigit[] as a zero
+** terminated string without trailing zeros.  Return the number of digits
+** and set *pExp to the decimal exponent of the first one.  If the value
+** rounds to zero, 0 is returned and *pExp is set to zero.  No more than
+** 17 digits are ever produced, as that is enough to identify any double.
 **
-** The counter *cnt is incremented each time.  After counter exceeds
-** 16 (the number of significant digits in a 64-bit float) '0' is
-** always returned.
-val 是一个double类型的4，例如0.1<=*val<10.0，返回一个数的最前的数字的ascii码，然后再把*val乘以10之后，重新正常化表示出来。
-例如：输入时*val = 3.14159，输出为*val = 1.4159
-cnt是一个计数器用来每次进行增加的，如果超过16（这个是64浮点数中的有效位数）之后，就返回0。
-这个函数用于得到数字的有效数字。
-
-*/
-static char et_getdigit(LONGDOUBLE_TYPE *val, int *cnt){
-  int digit;
-  LONGDOUBLE_TYPE d;
-  if( (*cnt)<=0 ) return '0';
-  (*cnt)--;
-  digit = (int)*val;
-  d = digit;
-  digit += '0';
-  *val = (*val - d)*10.0;
-  return (char)digit;
+** If pDist is not NULL, *pDist is set to the signed distance from the
+** value to the rounded digits, in units of 10^(p->e).
+**
+** Rounding is decided from v+frac.  Only when that is within 10^-6 of a
+** half, where the error in the double-double scaling could matter, is the
+** digit settled by an exact comparison against the original double.
+*/
+static int et_digits(
+  EtDecimal *p,              /* The decoded value */
+  int nKeep,                 /* Number of significant digits wanted */
+  char *zDigit,              /* Write the digits here */
+  int *pExp,                 /* Write the exponent of the first digit here */
+  double *pDist              /* If not NULL, the distance rounded */
+){
+  u64 unit = 1, half, t, q;
+  int k, i, n;
+  int up;
+  char zBuf[20];
+
+  if( nKeep>17 ) nKeep = 17;
+  if( nKeep<0 ){
+    *pExp = 0;
+    zDigit[0] = 0;
+    return 0;
+  }
+  k = p->nd - nKeep;
+  for(i=0; i<k; i++) unit *= 10;
+  half = unit/2;
+  q = p->v/unit;
+  t = p->v%unit;
+  if( t>half || (t==half && p->frac>1.0e-6) ){
+    up = 1;
+  }else if( t+1<half || (t+1==half && p->frac<1.0-1.0e-6) ){
+    up = 0;
+  }else{
+    up = et_cmpexact(p->m, p->b, q*10+5, p->e+k-1)>=0;
+  }
+  if( pDist ){
+    *pDist = up ? (double)(unit-t) - p->frac : -((double)t + p->frac);
+  }
+  q += up;
+  if( q==0 ){
+    *pExp = 0;
+    zDigit[0] = 0;
+    return 0;
+  }
+  i = sizeof(zBuf);
+  while( q ){
+    zBuf[--i] = (char)(q%10 + '0');
+    q /= 10;
+  }
+  n = sizeof(zBuf) - i;
+  *pExp = p->e + k + n - 1;
+  while( zBuf[i+n-1]=='0' ) n--;
+  memcpy(zDigit, &zBuf[i], n);
+  zDigit[n] = 0;
+  return n;
+}
+
+/*
+** Write into zDigit[] the shortest string of significant digits that
+** converts back to exactly the value decoded into *p, in the same way
+** as et_digits().
+**
+** For a normal double, any string of 15 or fewer digits that round-trips
+** is also what rounding to 15 digits gives once trailing zeros are
+** removed, because half a unit in the 15th digit is wider than half an
+** ulp.  So it is enough to try 15, 16 and then 17 digits, which always
+** round-trip.  Denormals have fewer bits of precision and are tried from
+** a single digit up.
+**
+** A candidate round-trips if it lies within half an ulp of the value, or
+** a quarter of an ulp below a power of two where the next smaller double
+** is closer, with a candidate exactly on that bound reading back as the
+** value only if m is even.  Candidates that the double-double distance
+** puts within 10^-6 of the bound are checked exactly.
+*/
+static int et_shortest(EtDecimal *p, char *zDigit, int *pExp){
+  double h, hBelow, rDist;
+  u64 N;
+  int n, i, c, nKeep;
+  int bPow2 = p->m==(((u64)1)<<52) && p->b>-1074;
+
+  h = ((double)p->v + p->frac)/(2.0*(double)p->m);
+  hBelow = bPow2 ? h/2.0 : h;
+  nKeep = p->m<(((u64)1)<<52) ? 1 : 15;
+  for(; nKeep<17; nKeep++){
+    n = et_digits(p, nKeep, zDigit, pExp, &rDist);
+    if( rDist>=0.0 ? rDist<h-1.0e-6 : -rDist<hBelow-1.0e-6 ) return n;
+    if( rDist>=0.0 ? rDist>h+1.0e-6 : -rDist>hBelow+1.0e-6 ) continue;
+    for(N=0, i=0; i<n; i++) N = N*10 + (zDigit[i]-'0');
+    if( rDist>=0.0 ){
+      c = -et_cmpexact(2*p->m+1, p->b-1, N, *pExp-n+1);
+    }else if( bPow2 ){
+      c = et_cmpexact(4*p->m-1, p->b-2, N, *pExp-n+1);
+    }else{
+      c = et_cmpexact(2*p->m-1, p->b-1, N, *pExp-n+1);
+    }
+    if( c<0 || (c==0 && (p->m&1)==0) ) return n;
+  }
+  return et_digits(p, 17, zDigit, pExp, 0);
+}
+
+/*
+** Return the next digit from the string of significant digits *pz and
+** advance *pz.  Once the string is used up, '0' is always returned.
+*/
+static char et_getdigit(const char **pz){
+  if( **pz==0 ) return '0';
+  return *(*pz)++;
 }
 #endif /* SQLITE_OMIT_FLOATING_POINT */
 
@@ -209,9 +581,12 @@ void sqlite3VXPrintf(
 #ifndef SQLITE_OMIT_FLOATING_POINT
   int  exp, e2;              /* exponent of real numbers;实数指数 */
   int nsd;                   /* Number of significant digits returned ;有效位数回归*/
-  double rounder;            /* Used for rounding floating point values ;用于舍入浮点值*/
+  int nDigit;                /* Number of digits in zDigit[] */
+  char zDigit[24];           /* Significant digits of a real value */
+  const char *zDig;          /* Next digit of zDigit[] to output */
   etByte flag_dp;            /* True if decimal point should be shown ;如果要显示小数点*/
   etByte flag_rtz;           /* True if trailing zeros should be removed ;如果要移除尾随零*/
+  etByte flag_shortest;      /* True for "%!g": shortest round-trip digits */
 #endif
   char buf[etBUFSIZE];       /* Conversion buffer;转换缓冲器 */
 
@@ -421,6 +796,10 @@ void sqlite3VXPrintf(
 #ifdef SQLITE_OMIT_FLOATING_POINT
         length = 0;
 #else
+        /* "%!g" with no precision gives the fewest digits that convert
+        ** back to the same value, laid out as for "%!.15g". */
+        flag_shortest = flag_altform2 && precision<0 && xtype==etGENERIC;
+        if( flag_shortest ) precision = 15;
         if( precision<0 ) precision = 6;         /* Set default precision;设置默认的精密 */
         if( realvalue<0.0 ){
           realvalue = -realvalue;
@@ -431,52 +810,48 @@ void sqlite3VXPrintf(
           else                         prefix = 0;
         }
         if( xtype==etGENERIC && precision>0 ) precision--;
-#if 0
-        /* Rounding works like BSD when the constant 0.4999 is used.  Wierd! ;舍入像BSD常数0.4999时使用*/
-        for(idx=precision, rounder=0.4999; idx>0; idx--, rounder*=0.1);
-#else
-        /* It makes more sense to use 0.5 ;更有意义使用0.5*/
-        for(idx=precision, rounder=0.5; idx>0; idx--, rounder*=0.1){}
-#endif
-        if( xtype==etFLOAT ) realvalue += rounder;
-        /* Normalize realvalue to within 10.0 > realvalue >= 1.0;如果etGENERIC字段类型,然后将etEXP或etFLOAT,如合适 */
         exp = 0;
         if( sqlite3IsNaN((double)realvalue) ){
           bufpt = "NaN";
           length = 3;
           break;
         }
+        if( realvalue>1.7976931348623157081e+308 ){
+          if( prefix=='-' ){
+            bufpt = "-Inf";
+          }else if( prefix=='+' ){
+            bufpt = "+Inf";
+          }else{
+            bufpt = "Inf";
+          }
+          length = sqlite3Strlen30(bufpt);
+          break;
+        }
+        /* Find the significant digits of realvalue and round them to
+        ** precision places after the decimal point for etFLOAT or to
+        ** precision+1 significant digits otherwise.  No more than nsd
+        ** significant digits are ever output. */
+        nsd = 16 + flag_altform2*10;
+        nDigit = 0;
+        zDigit[0] = 0;
         if( realvalue>0.0 ){
-          LONGDOUBLE_TYPE scale = 1.0;
-          while( realvalue>=1e100*scale && exp<=350 ){ scale *= 1e100;exp+=100;}
-          while( realvalue>=1e64*scale && exp<=350 ){ scale *= 1e64; exp+=64; }
-          while( realvalue>=1e8*scale && exp<=350 ){ scale *= 1e8; exp+=8; }
-          while( realvalue>=10.0*scale && exp<=350 ){ scale *= 10.0; exp++; }
-          realvalue /= scale;
-          while( realvalue<1e-8 ){ realvalue *= 1e8; exp-=8; }
-          while( realvalue<1.0 ){ realvalue *= 10.0; exp--; }
-          if( exp>350 ){
-            if( prefix=='-' ){
-              bufpt = "-Inf";
-            }else if( prefix=='+' ){
-              bufpt = "+Inf";
-            }else{
-              bufpt = "Inf";
-            }
-            length = sqlite3Strlen30(bufpt);
-            break;
+          EtDecimal x;
+          exp = et_decode((double)realvalue, &x);
+          if( flag_shortest ){
+            nDigit = et_shortest(&x, zDigit, &exp);
+          }else{
+            int nKeep = (xtype==etFLOAT ? exp+1+precision : precision+1);
+            if( nKeep>nsd ) nKeep = nsd;
+            nDigit = et_digits(&x, nKeep, zDigit, &exp, 0);
           }
         }
+        zDig = zDigit;
         bufpt = buf;
         /*
         ** If the field type is etGENERIC, then convert to either etEXP
         ** or etFLOAT, as appropriate.
 		如果字段类型是etgeneric，然后将两etexp或etfloat，适当。
         */
-        if( xtype!=etFLOAT ){
-          realvalue += rounder;
-          if( realvalue>=10.0 ){ realvalue *= 0.1; exp++; }
-        }
         if( xtype==etGENERIC ){
           flag_rtz = !flag_alternateform;
           if( exp<-4 || exp>precision ){
@@ -493,6 +868,9 @@ void sqlite3VXPrintf(
         }else{
           e2 = exp;
         }
+        if( flag_shortest && precision<nDigit-1-e2 ){
+          precision = nDigit-1-e2;
+        }
         if( e2+precision+width > etBUFSIZE - 15 ){
           bufpt = zExtra = sqlite3Malloc( e2+precision+width+15 );
           if( bufpt==0 ){
@@ -501,7 +879,6 @@ void sqlite3VXPrintf(
           }
         }
         zOut = bufpt;
-        nsd = 16 + flag_altform2*10;
         flag_dp = (precision>0 ?1:0) | flag_alternateform | flag_altform2;
         /* The sign in front of the number ;在前面的号码牌*/
         if( prefix ){
@@ -512,7 +889,7 @@ void sqlite3VXPrintf(
           *(bufpt++) = '0';
         }else{
           for(; e2>=0; e2--){
-            *(bufpt++) = et_getdigit(&realvalue,&nsd);
+            *(bufpt++) = et_getdigit(&zDig);
           }
         }
         /* The decimal point;小数点 */
@@ -528,7 +905,7 @@ void sqlite3VXPrintf(
         }
         /* Significant digits after the decimal point;有效数字的小数点后 */
         while( (precision--)>0 ){
-          *(bufpt++) = et_getdigit(&realvalue,&nsd);
+          *(bufpt++) = et_getdigit(&zDig);
         }
         /* Remove trailing zeros and the "." if no digits follow the "." ;移除尾随零和”。“如果没有数字遵循“。”*/
         if( flag_rtz && flag_dp ){
@@ -0,0 +1,707 @@
+/*
+** 2012 October 19
+**
+** The author disclaims copyright to this source code.  In place of
+** a legal notice, here is a blessing:
+**
+**    May you do good and not evil.
+**    May you find forgiveness for yourself and forgive others.
+**    May you share freely, never taking more than you give.
+**
+*************************************************************************
+**
+** This file contains the built-in implementation of the regexp() SQL
+** function, which is what the "X REGEXP Y" operator invokes as
+** regexp(Y,X).  An application that registers its own regexp() function
+** overrides this one.
+**
+** The pattern is compiled into a small program for a non-backtracking
+** matcher (a "Pike VM").  The matcher keeps the set of all program
+** positions that are live after each input character, so the time taken
+** is proportional to the length of the string times the length of the
+** program, whatever the pattern.  The compiled program is saved with
+** sqlite3_set_auxdata(), so a constant pattern is compiled only once
+** per statement.  If every match must begin with a fixed ASCII string,
+** strstr() is used to skip directly to the places where it occurs.
+**
+** A match may occur anywhere in the string.  The supported syntax is:
+**
+**     X*      zero or more occurrences of X
+**     X+      one or more occurrences of X
+**     X?      zero or one occurrences of X
+**     X{p,q}  between p and q occurrences of X  (also X{p} and X{p,})
+**     (X)     match X
+**     X|Y     X or Y
+**     ^X      X occurring at the beginning of the string
+**     X$      X occurring at the end of the string
+**     .       any single character
+**     \c      the character c, for c one of the punctuation characters
+**     \n \t \r \f \v     newline, tab, carriage return, form feed, VT
+**     \d \w \s           a digit, word character or space character
+**     \D \W \S           anything but a digit, word or space character
+**     [abc]   any one of the characters a, b and c
+**     [a-z]   any one character between a and z, inclusive
+**     [^abc]  any one character other than a, b and c
+**
+** Characters are UTF-8 code points.  Matching is case sensitive.
+*/
+#include "sqliteInt.h"
+
+#ifndef SQLITE_OMIT_REGEXP
+
+/*
+** Opcodes of the compiled program.  Each ReInst is one instruction.
+** RE_OP_CLASS and RE_OP_NCLASS are followed by ReInst.a RE_OP_RANGE
+** instructions, each of which holds an inclusive range of characters in
+** ReInst.a and ReInst.b.  The targets of RE_OP_SPLIT and RE_OP_JUMP are
+** relative, so that a compiled subexpression can be copied to implement
+** X{p,q}.
+*/
+#define RE_OP_MATCH   1    /* The pattern has matched */
+#define RE_OP_CHAR    2    /* Match the single character ReInst.a */
+#define RE_OP_ANY     3    /* Match any one character */
+#define RE_OP_CLASS   4    /* Match a character in the ranges that follow */
+#define RE_OP_NCLASS  5    /* Match a character not in the ranges */
+#define RE_OP_RANGE   6    /* A range of characters for CLASS or NCLASS */
+#define RE_OP_SPLIT   7    /* Continue at both pc+1 and pc+ReInst.a */
+#define RE_OP_JUMP    8    /* Continue at pc+ReInst.a */
+#define RE_OP_BOL     9    /* Match the beginning of the string */
+#define RE_OP_EOL    10    /* Match the end of the string */
+
+/*
+** The program may not grow larger than this many instructions.  This
+** bounds both the memory used and the per-character cost of matching
+** patterns such as "(a{1000}){1000}".
+*/
+#ifndef SQLITE_MAX_REGEXP_PROGRAM
+# define SQLITE_MAX_REGEXP_PROGRAM 10000
+#endif
+
+typedef struct ReInst ReInst;
+typedef struct ReCompiled ReCompiled;
+
+struct ReInst {
+  u8 op;                  /* One of the RE_OP_* values */
+  int a;                  /* Character, jump offset or range count */
+  int b;                  /* Upper bound of an RE_OP_RANGE */
+};
+
+/*
+** A compiled pattern.  The aSeen[], aList[] and aStack[] arrays are
+** scratch space for reMatch(), allocated once along with the program.
+*/
+struct ReCompiled {
+  ReInst *aOp;            /* The program */
+  int nOp;                /* Number of instructions in aOp[] */
+  int nAlloc;             /* Number of slots allocated for aOp[] */
+  const u8 *zIn;          /* Parse position in the pattern */
+  const char *zErr;       /* Error message, or NULL */
+  int nPrefix;            /* Bytes in zPrefix[] */
+  char *zPrefix;          /* Every match begins with this ASCII text */
+  u32 iGen;               /* Generation number for aSeen[] */
+  u32 *aSeen;             /* aSeen[pc]==iGen if pc is in the current list */
+  int *aList;             /* Two lists of nOp program counters each */
+  int *aStack;            /* Stack for reAddThread() */
+  int nPattern;           /* Bytes in zPattern[] */
+  char *zPattern;         /* Copy of the pattern that was compiled */
+};
+
+/*
+** Append an instruction to the program.  Return its index, or -1 if
+** the program has become too large or a malloc fails.
+*/
+static int reAppend(ReCompiled *p, u8 op, int a, int b){
+  if( p->zErr ) return -1;
+  if( p->nOp>=p->nAlloc ){
+    int nNew = p->nAlloc ? p->nAlloc*2 : 32;
+    ReInst *aNew;
+    if( p->nOp>=SQLITE_MAX_REGEXP_PROGRAM ){
+      p->zErr = "REGEXP pattern too complex";
+      return -1;
+    }
+    aNew = sqlite3_realloc(p->aOp, nNew*sizeof(ReInst));
+    if( aNew==0 ){
+      p->zErr = "out of memory";
+      return -1;
+    }
+    p->aOp = aNew;
+    p->nAlloc = nNew;
+  }
+  p->aOp[p->nOp].op = op;
+  p->aOp[p->nOp].a = a;
+  p->aOp[p->nOp].b = b;
+  return p->nOp++;
+}
+
+/*
+** Insert an instruction at index iBefore, moving the instructions that
+** follow it up by one.  Relative jumps are unaffected because the code
+** being moved is moved as a block.
+*/
+static void reInsert(ReCompiled *p, int iBefore, u8 op, int a){
+  if( reAppend(p, 0, 0, 0)<0 ) return;
+  memmove(&p->aOp[iBefore+1], &p->aOp[iBefore],
+          (p->nOp-1-iBefore)*sizeof(ReInst));
+  p->aOp[iBefore].op = op;
+  p->aOp[iBefore].a = a;
+  p->aOp[iBefore].b = 0;
+}
+
+/*
+** Append a copy of the nOp instructions starting at iFrom.
+*/
+static void reCopy(ReCompiled *p, int iFrom, int nOp){
+  int i;
+  for(i=0; i<nOp; i++){
+    ReInst *pOp;
+    if( reAppend(p, 0, 0, 0)<0 ) return;
+    pOp = &p->aOp[iFrom+i];
+    p->aOp[p->nOp-1] = *pOp;
+  }
+}
+
+/*
+** Read a non-negative decimal integer of at most four digits from the
+** pattern.  Return -1 if there is none.
+*/
+static int reNumber(ReCompiled *p){
+  int n = -1;
+  int nDigit = 0;
+  while( sqlite3Isdigit(p->zIn[0]) && nDigit<4 ){
+    n = (n<0 ? 0 : n*10) + p->zIn[0] - '0';
+    p->zIn++;
+    nDigit++;
+  }
+  return n;
+}
+
+/*
+** Append the ranges of character class \d, \w or \s (selected by c) and
+** return how many were added.  Return 0 if c is not one of these.
+*/
+static int reAppendShorthand(ReCompiled *p, u32 c){
+  switch( c ){
+    case 'd':
+      reAppend(p, RE_OP_RANGE, '0', '9');
+      return 1;
+    case 'w':
+      reAppend(p, RE_OP_RANGE, '0', '9');
+      reAppend(p, RE_OP_RANGE, 'A', 'Z');
+      reAppend(p, RE_OP_RANGE, 'a', 'z');
+      reAppend(p, RE_OP_RANGE, '_', '_');
+      return 4;
+    case 's':
+      reAppend(p, RE_OP_RANGE, ' ', ' ');
+      reAppend(p, RE_OP_RANGE, '\t', '\r');   /* \t \n \v \f \r */
+      return 2;
+  }
+  return 0;
+}
+
+/*
+** The character following a backslash is c.  Return the character it
+** stands for, or 0 and leave an error message if it is not a valid
+** single-character escape.
+*/
+static u32 reEscapedChar(ReCompiled *p, u32 c){
+  switch( c ){
+    case 'n':  return '\n';
+    case 't':  return '\t';
+    case 'r':  return '\r';
+    case 'f':  return '\f';
+    case 'v':  return '\v';
+  }
+  if( c==0 || (c<0x80 && sqlite3Isalnum(c)) ){
+    p->zErr = "unknown escape sequence in REGEXP pattern";
+    return 0;
+  }
+  return c;
+}
+
+/*
+** Read one character of a bracket expression, handling escapes.
+*/
+static u32 reClassChar(ReCompiled *p){
+  u32 c = sqlite3Utf8Read(p->zIn, &p->zIn);
+  if( c=='\\' ){
+    c = reEscapedChar(p, sqlite3Utf8Read(p->zIn, &p->zIn));
+  }
+  return c;
+}
+
+/*
+** Compile a bracket expression.  The opening '[' has been consumed.
+*/
+static void reCompileClass(ReCompiled *p){
+  int iClass;
+  int nRange = 0;
+  u8 op = RE_OP_CLASS;
+
+  if( p->zIn[0]=='^' ){
+    op = RE_OP_NCLASS;
+    p->zIn++;
+  }
+  iClass = reAppend(p, op, 0, 0);
+  if( p->zIn[0]==']' ){
+    reAppend(p, RE_OP_RANGE, ']', ']');
+    nRange++;
+    p->zIn++;
+  }
+  while( p->zErr==0 && p->zIn[0]!=']' ){
+    u32 c, c2;
+    if( p->zIn[0]==0 ){
+      p->zErr = "unmatched '[' in REGEXP pattern";
+      return;
+    }
+    if( p->zIn[0]=='\\' ){
+      int n = reAppendShorthand(p, p->zIn[1]);
+      if( n ){
+        nRange += n;
+        p->zIn += 2;
+        continue;
+      }
+    }
+    c = reClassChar(p);
+    if( p->zErr ) return;
+    c2 = c;
+    if( p->zIn[0]=='-' && p->zIn[1]!=']' && p->zIn[1]!=0 ){
+      p->zIn++;
+      c2 = reClassChar(p);
+      if( p->zErr ) return;
+      if( c2<c ){
+        p->zErr = "invalid range in REGEXP pattern";
+        return;
+      }
+    }
+    reAppend(p, RE_OP_RANGE, (int)c, (int)c2);
+    nRange++;
+  }
+  if( p->zErr ) return;
+  p->zIn++;
+  p->aOp[iClass].a = nRange;
+}
+
+static void reCompileAlternation(ReCompiled *p);
+
+/*
+** Compile a single atom, without any quantifier that follows it.
+*/
+static void reCompileAtom(ReCompiled *p){
+  u32 c = sqlite3Utf8Read(p->zIn, &p->zIn);
+  switch( c ){
+    case '(': {
+      if( p->zIn[0]=='?' && p->zIn[1]==':' ) p->zIn += 2;
+      reCompileAlternation(p);
+      if( p->zErr ) return;
+      if( p->zIn[0]!=')' ){
+        p->zErr = "unmatched '(' in REGEXP pattern";
+        return;
+      }
+      p->zIn++;
+      break;
+    }
+    case '.': {
+      reAppend(p, RE_OP_ANY, 0, 0);
+      break;
+    }
+    case '^': {
+      reAppend(p, RE_OP_BOL, 0, 0);
+      break;
+    }
+    case '$': {
+      reAppend(p, RE_OP_EOL, 0, 0);
+      break;
+    }
+    case '[': {
+      reCompileClass(p);
+      break;
+    }
+    case '*':
+    case '+':
+    case '?':
+    case '{': {
+      p->zErr = "nothing to repeat in REGEXP pattern";
+      break;
+    }
+    case '\\': {
+      u32 c2 = p->zIn[0];
+      if( c2=='d' || c2=='w' || c2=='s' || c2=='D' || c2=='W' || c2=='S' ){
+        int iClass = reAppend(p, (c2>='a' ? RE_OP_CLASS : RE_OP_NCLASS), 0, 0);
+        int n = reAppendShorthand(p, sqlite3Tolower(c2));
+        if( iClass>=0 && p->zErr==0 ) p->aOp[iClass].a = n;
+        p->zIn++;
+      }else{
+        c = reEscapedChar(p, sqlite3Utf8Read(p->zIn, &p->zIn));
+        reAppend(p, RE_OP_CHAR, (int)c, 0);
+      }
+      break;
+    }
+    default: {
+      reAppend(p, RE_OP_CHAR, (int)c, 0);
+      break;
+    }
+  }
+}
+
+/*
+** Compile an atom and any quantifiers that follow it.
+*/
+static void reCompilePiece(ReCompiled *p){
+  int iStart = p->nOp;
+  int nAtom;
+
+  reCompileAtom(p);
+  while( p->zErr==0 ){
+    nAtom = p->nOp - iStart;
+    switch( p->zIn[0] ){
+      case '*': {
+        /* SPLIT over the loop; atom; JUMP back to the SPLIT */
+        reInsert(p, iStart, RE_OP_SPLIT, nAtom+2);
+        reAppend(p, RE_OP_JUMP, -(nAtom+1), 0);
+        break;
+      }
+      case '+': {
+        /* atom; SPLIT back to the atom */
+        reAppend(p, RE_OP_SPLIT, -nAtom, 0);
+        break;
+      }
+      case '?': {
+        reInsert(p, iStart, RE_OP_SPLIT, nAtom+1);
+        break;
+      }
+      case '{': {
+        int m, n, i;
+        int iAtom = iStart;       /* A copy of the atom to repeat */
+        p->zIn++;
+        m = reNumber(p);
+        n = m;
+        if( m>=0 && p->zIn[0]==',' ){
+          p->zIn++;
+          n = reNumber(p);
+        }
+        if( m<0 || p->zIn[0]!='}' || (n>=0 && n<m) ){
+          p->zErr = "invalid repetition count in REGEXP pattern";
+          return;
+        }
+        /* X{m,n} becomes m copies of X followed by n-m copies of X?.
+        ** If n is omitted the last copy of X loops as for X+, and
+        ** X{0,} is the same as X*. */
+        if( m==0 ){
+          if( n==0 ){
+            p->nOp = iStart;
+            break;
+          }
+          if( n<0 ){
+            reInsert(p, iStart, RE_OP_SPLIT, nAtom+2);
+            reAppend(p, RE_OP_JUMP, -(nAtom+1), 0);
+            break;
+          }
+          reInsert(p, iStart, RE_OP_SPLIT, nAtom+1);
+          iAtom = iStart+1;
+          m = 1;
+        }else{
+          for(i=1; i<m; i++) reCopy(p, iAtom, nAtom);
+          if( n<0 ) reAppend(p, RE_OP_SPLIT, -nAtom, 0);
+        }
+        for(i=m; i<n && p->zErr==0; i++){
+          reAppend(p, RE_OP_SPLIT, nAtom+1, 0);
+          reCopy(p, iAtom, nAtom);
+        }
+        break;
+      }
+      default: {
+        return;
+      }
+    }
+    p->zIn++;
+  }
+}
+
+/*
+** Compile a sequence of pieces, up to the next '|' or ')' or the end
+** of the pattern.
+*/
+static void reCompileSequence(ReCompiled *p){
+  while( p->zErr==0 && p->zIn[0]!=0 && p->zIn[0]!='|' && p->zIn[0]!=')' ){
+    reCompilePiece(p);
+  }
+}
+
+/*
+** Compile X|Y|... :
+**
+**       SPLIT L1
+**       <X>
+**       JUMP L2
+**   L1: <Y>
+**   L2:
+*/
+static void reCompileAlternation(ReCompiled *p){
+  int iStart = p->nOp;
+  reCompileSequence(p);
+  while( p->zErr==0 && p->zIn[0]=='|' ){
+    int iJump;
+    p->zIn++;
+    reInsert(p, iStart, RE_OP_SPLIT, p->nOp - iStart + 2);
+    iJump = reAppend(p, RE_OP_JUMP, 0, 0);
+    reCompileSequence(p);
+    if( iJump>=0 ) p->aOp[iJump].a = p->nOp - iJump;
+  }
+}
+
+/*
+** Free a compiled pattern.
+*/
+static void reFree(void *pArg){
+  ReCompiled *p = (ReCompiled*)pArg;
+  if( p ){
+    sqlite3_free(p->aOp);
+    sqlite3_free(p->aSeen);
+    sqlite3_free(p);
+  }
+}
+
+/*
+** Compile zPattern.  Return NULL if a malloc fails.  Otherwise the
+** caller must check ReCompiled.zErr and free the object with reFree().
+*/
+static ReCompiled *reCompile(const u8 *zPattern, int nPattern){
+  ReCompiled *p;
+  int n;
+
+  p = sqlite3_malloc(sizeof(*p) + nPattern);
+  if( p==0 ) return 0;
+  memset(p, 0, sizeof(*p));
+  p->nPattern = nPattern;
+  p->zPattern = (char*)&p[1];
+  memcpy(p->zPattern, zPattern, nPattern);
+  p->zIn = zPattern;
+  reCompileAlternation(p);
+  if( p->zErr==0 && p->zIn[0]!=0 ){
+    p->zErr = "unmatched ')' in REGEXP pattern";
+  }
+  reAppend(p, RE_OP_MATCH, 0, 0);
+  if( p->zErr ) return p;
+
+  /* Allocate the matcher's scratch space and the literal prefix in a
+  ** single block */
+  n = p->nOp;
+  p->aSeen = sqlite3_malloc(n*sizeof(u32) + (4*n+1)*sizeof(int) + n + 1);
+  if( p->aSeen==0 ){
+    reFree(p);
+    return 0;
+  }
+  memset(p->aSeen, 0, n*sizeof(u32));
+  p->aList = (int*)&p->aSeen[n];
+  p->aStack = &p->aList[2*n];
+  p->zPrefix = (char*)&p->aStack[2*n+1];
+  while( p->nPrefix<n
+      && p->aOp[p->nPrefix].op==RE_OP_CHAR
+      && p->aOp[p->nPrefix].a<0x80
+  ){
+    p->zPrefix[p->nPrefix] = (char)p->aOp[p->nPrefix].a;
+    p->nPrefix++;
+  }
+  p->zPrefix[p->nPrefix] = 0;
+  return p;
+}
+
+/*
+** Return true if character c is matched by the RE_OP_CLASS or
+** RE_OP_NCLASS instruction pOp.
+*/
+static int reClassMatch(const ReInst *pOp, u32 c){
+  int i;
+  int bFound = 0;
+  for(i=1; i<=pOp->a; i++){
+    if( c>=(u32)pOp[i].a && c<=(u32)pOp[i].b ){
+      bFound = 1;
+      break;
+    }
+  }
+  return bFound ^ (pOp->op==RE_OP_NCLASS);
+}
+
+/*
+** Add program counter pc, and everything reachable from it without
+** consuming a character, to the list aList[] of *pnList entries.
+** Return true if RE_OP_MATCH is reachable.
+*/
+static int reAddThread(
+  ReCompiled *p,          /* The program */
+  int *aList,             /* The list to add to */
+  int *pnList,            /* IN/OUT: Number of entries in aList[] */
+  int pc,                 /* First program counter to add */
+  int bStart,             /* True at the beginning of the string */
+  int bEnd                /* True at the end of the string */
+){
+  int nStack = 0;
+  p->aStack[nStack++] = pc;
+  while( nStack>0 ){
+    ReInst *pOp;
+    pc = p->aStack[--nStack];
+    if( p->aSeen[pc]==p->iGen ) continue;
+    p->aSeen[pc] = p->iGen;
+    pOp = &p->aOp[pc];
+    switch( pOp->op ){
+      case RE_OP_MATCH:
+        return 1;
+      case RE_OP_JUMP:
+        p->aStack[nStack++] = pc + pOp->a;
+        break;
+      case RE_OP_SPLIT:
+        p->aStack[nStack++] = pc + pOp->a;
+        p->aStack[nStack++] = pc + 1;
+        break;
+      case RE_OP_BOL:
+        if( bStart ) p->aStack[nStack++] = pc + 1;
+        break;
+      case RE_OP_EOL:
+        if( bEnd ) p->aStack[nStack++] = pc + 1;
+        break;
+      default:
+        aList[(*pnList)++] = pc;
+        break;
+    }
+  }
+  return 0;
+}
+
+/*
+** Start a new generation of the aSeen[] array.
+*/
+static void reNextGen(ReCompiled *p){
+  p->iGen++;
+  if( p->iGen==0 ){
+    memset(p->aSeen, 0, p->nOp*sizeof(u32));
+    p->iGen = 1;
+  }
+}
+
+/*
+** Return true if the compiled pattern p matches somewhere in zString.
+*/
+static int reMatch(ReCompiled *p, const u8 *zString){
+  int *aCur = p->aList;           /* Threads live at the current position */
+  int *aNext = &p->aList[p->nOp]; /* Threads live at the next position */
+  int nCur = 0;
+  int nNext;
+  int bAnchored = p->aOp[0].op==RE_OP_BOL;
+  const u8 *z = zString;
+
+  reNextGen(p);
+  for(;;){
+    const u8 *zNext;
+    u32 c;
+    int i;
+
+    if( nCur==0 ){
+      if( bAnchored && z!=zString ) return 0;
+      if( p->nPrefix ){
+        z = (const u8*)strstr((const char*)z, p->zPrefix);
+        if( z==0 ) return 0;
+      }
+    }
+    if( !bAnchored || z==zString ){
+      if( reAddThread(p, aCur, &nCur, 0, z==zString, z[0]==0) ) return 1;
+    }
+    if( z[0]==0 ) return 0;
+
+    c = sqlite3Utf8Read(z, &zNext);
+    reNextGen(p);
+    nNext = 0;
+    for(i=0; i<nCur; i++){
+      int pc = aCur[i];
+      ReInst *pOp = &p->aOp[pc];
+      int bMatch;
+      switch( pOp->op ){
+        case RE_OP_CHAR:   bMatch = (c==(u32)pOp->a);          break;
+        case RE_OP_ANY:    bMatch = 1;                         break;
+        default:
+          assert( pOp->op==RE_OP_CLASS || pOp->op==RE_OP_NCLASS );
+          bMatch = reClassMatch(pOp, c);
+          break;
+      }
+      if( bMatch ){
+        int pcNext = pc + 1 + (pOp->op>=RE_OP_CLASS ? pOp->a : 0);
+        if( reAddThread(p, aNext, &nNext, pcNext, 0, zNext[0]==0) ) return 1;
+      }
+    }
+    { int *aTmp = aCur; aCur = aNext; aNext = aTmp; }
+    nCur = nNext;
+    z = zNext;
+  }
+}
+
+/*
+** Implementation of regexp(PATTERN, STRING).  Return true if STRING
+** contains a match for PATTERN, or NULL if either argument is NULL.
+*/
+static void regexpFunc(
+  sqlite3_context *context,
+  int argc,
+  sqlite3_value **argv
+){
+  const u8 *zPattern;
+  int nPattern;
+  const u8 *zString;
+  ReCompiled *p;
+
+  UNUSED_PARAMETER(argc);
+  zPattern = sqlite3_value_text(argv[0]);
+  if( zPattern==0 ) return;
+  nPattern = sqlite3_value_bytes(argv[0]);
+
+  /* Auxiliary data survives sqlite3_reset(), so a pattern bound to a
+  ** parameter may have changed since it was compiled.  The saved program
+  ** is only reused if it was compiled from the same pattern. */
+  p = (ReCompiled*)sqlite3_get_auxdata(context, 0);
+  if( p && (p->nPattern!=nPattern
+            || memcmp(p->zPattern, zPattern, nPattern)!=0) ){
+    p = 0;
+  }
+  if( p==0 ){
+    sqlite3 *db = sqlite3_context_db_handle(context);
+    if( nPattern>db->aLimit[SQLITE_LIMIT_LIKE_PATTERN_LENGTH] ){
+      sqlite3_result_error(context, "REGEXP pattern too complex", -1);
+      return;
+    }
+    p = reCompile(zPattern, nPattern);
+    if( p==0 ){
+      sqlite3_result_error_nomem(context);
+      return;
+    }
+    if( p->zErr ){
+      sqlite3_result_error(context, p->zErr, -1);
+      reFree(p);
+      return;
+    }
+    sqlite3_set_auxdata(context, 0, p, reFree);
+    p = (ReCompiled*)sqlite3_get_auxdata(context, 0);
+    if( p==0 ){
+      sqlite3_result_error_nomem(context);
+      return;
+    }
+  }
+  zString = sqlite3_value_text(argv[1]);
+  if( zString==0 ) return;
+  sqlite3_result_int(context, reMatch(p, zString));
+}
+
+/*
+** Register the regexp() function.
+*/
+void sqlite3RegisterRegexpFunctions(void){
+  static SQLITE_WSD FuncDef aRegexpFuncs[] = {
+    FUNCTION(regexp,             2, 0, 0, regexpFunc    ),
+  };
+  int i;
+  FuncDefHash *pHash = &GLOBAL(FuncDefHash, sqlite3GlobalFunctions);
+  FuncDef *aFunc = (FuncDef*)&GLOBAL(FuncDef, aRegexpFuncs);
+
+  for(i=0; i<ArraySize(aRegexpFuncs); i++){
+    sqlite3FuncDefInsert(pHash, &aFunc[i]);
+  }
+}
+
+#endif /* SQLITE_OMIT_REGEXP */
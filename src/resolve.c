@@ -613,6 +613,16 @@ static int resolveExprStep(Walker *pWalker, Expr *pExpr){
         }
         if( pNC2 ) pNC2->ncFlags |= NC_HasAgg;
         pNC->ncFlags |= NC_AllowAgg;
+      }else if( pDef && (pDef->flags & SQLITE_FUNC_CONSTANT)!=0 ){
+        /* A deterministic function whose arguments are all constant is
+        ** itself a constant.  Mark it TK_CONST_FUNC, as is done for
+        ** CURRENT_TIME and friends, so that sqlite3ExprCodeConstants()
+        ** evaluates it once rather than once per row. */
+        int i;
+        for(i=0; i<n; i++){
+          if( !sqlite3ExprIsConstant(pList->a[i].pExpr) ) break;
+        }
+        if( i==n ) pExpr->op = TK_CONST_FUNC;
       }
       /* FIX ME:  Compute pExpr->affinity based on the expected return
       ** type of the function 
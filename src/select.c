@@ -125,7 +125,7 @@ Select *sqlite3SelectNew(
 	Select *pNew;/*定义结构体指针pNew*/
 	Select standin;/*定义结构体类型变量standin*/
 	sqlite3 *db = pParse->db;/*结构体Parse的成员db赋值给结构体sqlite3指针db*/
-	pNew = sqlite3DbMallocZero(db, sizeof(*pNew));  /* 分配和零内存，如果分配失败，使mallocFaied标志在连接指针中。 */
+	pNew = sqlite3ArenaMallocZero(db, sizeof(*pNew));  /* 分配和零内存，如果分配失败，使mallocFaied标志在连接指针中。 */
 	assert(db->mallocFailed || !pOffset || pLimit); /* 判断分配是否失败,或pOffset值为空,或pLimit值不为空*/
 	if (pNew == 0){/*如果结构体指针变量pNew分配失败*/
 		assert(db->mallocFailed);/*如果分配失败，使mallocFaied标志在连接指针中*/
@@ -988,6 +988,25 @@ static void explainTempTable(Parse *pParse, const char *zUsage){
   }
 }
 
+#ifndef SQLITE_OMIT_VDBEHASH
+/*
+** Unless an "EXPLAIN QUERY PLAN" command is being processed, this function
+** is a no-op. Otherwise, it adds a single row of output to the EQP result,
+** where the caption is of the form:
+**
+**   "USE HASH TABLE FOR xxx"
+**
+** where xxx is "DISTINCT" or "GROUP BY", as determined by zUsage.
+*/
+static void explainHashTable(Parse *pParse, const char *zUsage){
+	if (pParse->explain == 2){
+		Vdbe *v = pParse->pVdbe;
+		char *zMsg = sqlite3MPrintf(pParse->db, "USE HASH TABLE FOR %s", zUsage);
+		sqlite3VdbeAddOp4(v, OP_Explain, pParse->iSelectId, 0, 0, zMsg, P4_DYNAMIC);
+	}
+}
+#endif
+
 /*
 ** Assign expression b to lvalue a. A second, no-op, version of this macro
 ** is provided when SQLITE_OMIT_EXPLAIN is defined. This allows the code
@@ -1003,9 +1022,32 @@ static void explainTempTable(Parse *pParse, const char *zUsage){
 #else
 /* No-op versions of the explainXXX() functions and macros. explainXXX() 函数和宏无操作符的版本。*/
 # define explainTempTable(y,z)
+# define explainHashTable(y,z)
 # define explainSetInteger(y,z)
 #endif
 
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+/*
+** If sqlite3_stmt_scanstatus() data is being collected, add the loop that
+** starts at instruction addrLoop and reads back the rows of a sorter or
+** hash table to the loops reported for the statement, with zCaption as
+** its EQP text.  Return the handle for sqlite3VdbeScanStatusVisit() and
+** sqlite3VdbeScanStatusEnd(), or zero if no data is collected.
+*/
+static int scanStatusTempLoop(
+	Parse *pParse,          /* Parsing context */
+	int addrLoop,           /* First instruction of the loop */
+	double nRow,            /* Estimated number of rows read back */
+	const char *zCaption    /* Text for the loop */
+){
+	if (pParse->explain != 0 || (pParse->db->flags & SQLITE_ScanStatus) == 0){
+		return 0;
+	}
+	return sqlite3VdbeScanStatus(pParse->pVdbe, addrLoop, nRow,
+		pParse->iSelectId, 0, sqlite3MPrintf(pParse->db, "%s", zCaption));
+}
+#endif
+
 #if !defined(SQLITE_OMIT_EXPLAIN) && !defined(SQLITE_OMIT_COMPOUND_SELECT)
 /*
 ** Unless an "EXPLAIN QUERY PLAN" command is being processed, this function
@@ -1078,6 +1120,9 @@ static void generateSortTail(
 
 	int regRow;
 	int regRowid;
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+	int iScan = 0;    /* sqlite3_stmt_scanstatus() handle for the sort */
+#endif
 
 	iTab = pOrderBy->iECursor;/*把pOrderBy->iECursor赋给整型iTab*/
 	regRow = sqlite3GetTempReg(pParse);/*为pParse语法树分配一个寄存器,存储计算的中间结果*/
@@ -1104,6 +1149,13 @@ static void generateSortTail(
 		codeOffset(v, p, addrContinue);/*设置偏移量，其中addrContinue是下一次循环要调到的地址*/
 		sqlite3VdbeAddOp3(v, OP_Column, iTab, pOrderBy->nExpr + 1, regRow);/*将OP_Column操作交给VDBE，再把OP_Column的地址返回*/
 	}
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+	/* Report the sort and the loop that reads back its output as one loop
+	** of sqlite3_stmt_scanstatus(). */
+	iScan = scanStatusTempLoop(pParse, addr - 1, p->nSelectRow,
+		"USE TEMP B-TREE FOR ORDER BY");
+	sqlite3VdbeScanStatusVisit(v, iScan, addr, addr);
+#endif
 	switch (eDest){/*switch函数，参数eDest，选择结果集的处理方法*/
 	case SRT_Table:/*如果eDest为SRT_Table，则结果按照自动的rowid自动保存*/
 	case SRT_EphemTab: {/*如果eDest为SRT_EphemTab，则创建临时表并存储为像SRT_Table的表*/
@@ -1167,6 +1219,9 @@ static void generateSortTail(
 	else{
 		sqlite3VdbeAddOp2(v, OP_Next, iTab, addr);/*将OP_Next操作交给VDBE，再返回这个操作的地址*/
 	}
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+	sqlite3VdbeScanStatusEnd(v, iScan, sqlite3VdbeCurrentAddr(v));
+#endif
 	sqlite3VdbeResolveLabel(v, addrBreak);/*addrBreak作为下一条插入指令的地址，其中addrBreak能优先调用sqlite3VdbeMakeLabel（）*/
 	if (eDest == SRT_Output || eDest == SRT_Coroutine){/*如果结果集的处理方式SRT_Output或SRT_Coroutine*/
 		sqlite3VdbeAddOp2(v, OP_Close, pseudoTab, 0);/*将OP_Close操作交给VDBE，再返回这个操作的地址*/
@@ -1795,6 +1850,20 @@ static CollSeq *multiSelectCollSeq(Parse *pParse, Select *p, int iCol){
 	}
 	return pRet;
 }
+
+/*
+** Return true if the temporary table used to compute the compound select
+** "p" is only ever inserted into, probed and then read back.  The table
+** is shared with any compound select to the left of p, and an EXCEPT
+** anywhere to the left deletes rows from it, so an in-memory hash set
+** may only be used to buffer the table if there is no EXCEPT.
+*/
+static int compoundIsUnionOnly(Select *p){
+	for (; p; p = p->pPrior){
+		if (p->op == TK_EXCEPT) return 0;
+	}
+	return 1;
+}
 #endif /* SQLITE_OMIT_COMPOUND_SELECT */
 
 /* Forward reference 向前引用*/
@@ -1991,7 +2060,8 @@ static int multiSelect(
 			*/
 			unionTab = pParse->nTab++;
 			assert(p->pOrderBy == 0);
-			addr = sqlite3VdbeAddOp2(v, OP_OpenEphemeral, unionTab, 0);
+			addr = sqlite3VdbeAddOp3(v, OP_OpenEphemeral, unionTab, 0,
+				compoundIsUnionOnly(p));
 			assert(p->addrOpenEphm[0] == -1);
 			p->addrOpenEphm[0] = addr;
 			p->pRightmost->selFlags |= SF_UsesEphemeral;
@@ -3818,7 +3888,7 @@ static u8 minMaxQuery(Select *p){
 		  pFrom->pTab = pTab = 
 			sqlite3LocateTable(pParse,0,pFrom->zName,pFrom->zDatabase);//由语法解析，数据库连接，数据库名字定位所寻找的表
 		  if( pTab==0 ) return WRC_Abort;//不存在该表则终止
-		  pTab->nRef++;//自加
+		  sqlite3TableRef(pTab);//自加
 	#if !defined(SQLITE_OMIT_VIEW) || !defined (SQLITE_OMIT_VIRTUALTABLE)
 		  if( pTab->pSelect || IsVirtual(pTab) ){//若表中SELECT非空或pTab是虚表
 			/* We reach here if the named table is a really a view *//*到达这一步，如果，说明这个表是一个真正的视图*/
@@ -4176,7 +4246,7 @@ static u8 minMaxQuery(Select *p){
 			pFunc->iDistinct = -1;//临时表置为-1（无效）
 		  }else{
 			KeyInfo *pKeyInfo = keyInfoFromExprList(pParse, pE->x.pList);//从表达式列表中获取信息
-			sqlite3VdbeAddOp4(v, OP_OpenEphemeral, pFunc->iDistinct, 0, 0,
+			sqlite3VdbeAddOp4(v, OP_OpenEphemeral, pFunc->iDistinct, 0, 1,
 							  (char*)pKeyInfo, P4_KEYINFO_HANDOFF);//添加了一个操作符OP_OpenEphemeral
 		  }
 		}
@@ -4299,6 +4369,129 @@ static void updateAccumulator(Parse *pParse, AggInfo *pAggInfo){
 	}
 }
 
+#ifndef SQLITE_OMIT_VDBEHASH
+/*
+** A GROUP BY whose estimated number of groups is larger than this is
+** computed by sorting the input rows rather than by using an in-memory
+** hash table.  Compile with -DSQLITE_HASH_AGGREGATE_MAX_GROUPS=0 to never
+** use a hash table for GROUP BY, so that a GROUP BY without an ORDER BY
+** always returns its rows in GROUP BY order.
+*/
+#ifndef SQLITE_HASH_AGGREGATE_MAX_GROUPS
+# define SQLITE_HASH_AGGREGATE_MAX_GROUPS 10000
+#endif
+
+/*
+** Use the sqlite_stat1 data to estimate the number of distinct values
+** taken by the terms of the GROUP BY clause pGroupBy.  An estimate is
+** only possible if every term is a column of the same table and some
+** index on that table has exactly those columns, in any order, as its
+** left-most columns.  Indices whose aiRowEst[] holds only the defaults
+** set by sqlite3DefaultRowEst() are ignored, since those figures say
+** nothing about the data.  Return 0 if no estimate can be made.
+*/
+static tRowcnt groupByEstimate(SrcList *pTabList, ExprList *pGroupBy){
+	int nTerm = pGroupBy->nExpr;
+	int iTable = -1;
+	Table *pTab = 0;
+	Index *pIdx;
+	tRowcnt nBest = 0;
+	int i, j, k;
+
+	for (i = 0; i < nTerm; i++){
+		Expr *pE = pGroupBy->a[i].pExpr;
+		if (pE->op != TK_COLUMN) return 0;
+		if (i > 0 && pE->iTable != iTable) return 0;
+		iTable = pE->iTable;
+	}
+	for (i = 0; i < pTabList->nSrc; i++){
+		if (pTabList->a[i].iCursor == iTable) pTab = pTabList->a[i].pTab;
+	}
+	if (pTab == 0) return 0;
+
+	for (pIdx = pTab->pIndex; pIdx; pIdx = pIdx->pNext){
+		tRowcnt nGroup;
+		if (pIdx->nColumn < nTerm || pIdx->hasStat1 == 0) continue;
+		for (j = 0; j < nTerm; j++){
+			for (k = 0; k < nTerm; k++){
+				if (pIdx->aiColumn[j] == pGroupBy->a[k].pExpr->iColumn) break;
+			}
+			if (k == nTerm) break;
+		}
+		if (j < nTerm || pIdx->aiRowEst[nTerm] == 0) continue;
+		nGroup = pIdx->aiRowEst[0] / pIdx->aiRowEst[nTerm];
+		if (nGroup == 0) nGroup = 1;
+		if (nBest == 0 || nGroup < nBest) nBest = nGroup;
+	}
+	return nBest;
+}
+
+/*
+** Return true if the GROUP BY aggregate query p should group its input
+** rows using an in-memory hash table (see vdbehash.c) instead of sorting
+** them, should it turn out that the rows cannot be delivered in GROUP BY
+** order by an index.
+**
+** A hash table is not used if the output must be in GROUP BY order
+** because an ORDER BY clause was dropped in favor of the GROUP BY, if an
+** aggregate uses DISTINCT (the per-aggregate DISTINCT tables cannot be
+** shared between groups), if a GROUP BY term uses a collating sequence
+** other than BINARY, or if sqlite_stat1 data suggests that the number of
+** groups is large.  If there are no statistics for the GROUP BY terms
+** the hash table is used, since the memory budget of the hash table
+** ensures that a poor guess costs little: once the budget is used up the
+** remaining groups are computed by sorting as usual.
+**
+** Groups held by the hash table are returned in the order in which they
+** were first seen, followed by any spilled groups in GROUP BY order.  So
+** a GROUP BY query without an ORDER BY clause no longer returns its rows
+** in GROUP BY order when a hash table is used.  SQL never promised that
+** order; applications that depend on it must add an ORDER BY clause, or
+** be built with SQLITE_HASH_AGGREGATE_MAX_GROUPS set to zero.
+*/
+static int groupByUseHash(
+	Select *p,              /* The SELECT statement */
+	ExprList *pOrderBy,     /* ORDER BY clause still to be processed */
+	KeyInfo *pKeyInfo,      /* KeyInfo for the GROUP BY terms */
+	AggInfo *pAggInfo       /* Aggregate information for p */
+){
+	tRowcnt nGroup;
+	int i;
+
+	if (p->pOrderBy && pOrderBy == 0) return 0;
+	for (i = 0; i < pAggInfo->nFunc; i++){
+		if (pAggInfo->aFunc[i].iDistinct >= 0) return 0;
+	}
+	for (i = 0; i < pKeyInfo->nField; i++){
+		CollSeq *pColl = pKeyInfo->aColl[i];
+		if (pColl && sqlite3StrICmp(pColl->zName, "BINARY")) return 0;
+	}
+	if (SQLITE_HASH_AGGREGATE_MAX_GROUPS <= 0) return 0;
+	nGroup = groupByEstimate(p->pSrc, p->pGroupBy);
+	return nGroup <= SQLITE_HASH_AGGREGATE_MAX_GROUPS;
+}
+
+/*
+** Assign a contiguous block of registers to the aggregate accumulators
+** of pAggInfo, so that they can be moved in and out of a hash table entry
+** as a unit.  Return the first register of the block.
+**
+** This must be called before any code that uses the accumulators is
+** generated.
+*/
+static int aggInfoPackRegisters(Parse *pParse, AggInfo *pAggInfo){
+	int iBase = pParse->nMem + 1;
+	int i;
+	for (i = 0; i < pAggInfo->nColumn; i++){
+		pAggInfo->aCol[i].iMem = ++pParse->nMem;
+	}
+	for (i = 0; i < pAggInfo->nFunc; i++){
+		pAggInfo->aFunc[i].iMem = ++pParse->nMem;
+	}
+	return iBase;
+}
+#endif /* SQLITE_OMIT_VDBEHASH */
+
 /*
 ** Add a single OP_Explain instruction to the VDBE to explain a simple
 ** count(*) query ("SELECT count(*) FROM pTab").
@@ -4666,7 +4859,7 @@ int sqlite3Select(
 		KeyInfo *pKeyInfo;/*声明一个关键信息结构体*/
 		distinct = pParse->nTab++;
 		pKeyInfo = keyInfoFromExprList(pParse, p->pEList);
-		addrDistinctIndex = sqlite3VdbeAddOp4(v, OP_OpenEphemeral, distinct, 0, 0,
+		addrDistinctIndex = sqlite3VdbeAddOp4(v, OP_OpenEphemeral, distinct, 0, 1,
 			(char*)pKeyInfo, P4_KEYINFO_HANDOFF);
 		sqlite3VdbeChangeP5(v, BTREE_UNORDERED);
 	}
@@ -4679,11 +4872,12 @@ int sqlite3Select(
 	  */
 	if (!isAgg && pGroupBy == 0){
 		ExprList *pDist = (isDistinct ? p->pEList : 0);/*如果isAgg没有GroupBy，判断isDistinct是否为true，否则将p->pEList赋值给pDist*/
+		Select *pLimit = (isDistinct || p->pNext ? 0 : p);/*LIMIT与OFFSET可以下推到虚表*/
 
 		/* Begin the database scan.
 		**开始数据库扫描
 		*/
-		pWInfo = sqlite3WhereBegin(pParse, pTabList, pWhere, &pOrderBy, pDist, 0, 0);/*生成用于WHERE子句处理的循环语句，并返回结束指针*/
+		pWInfo = sqlite3WhereBegin(pParse, pTabList, pWhere, &pOrderBy, pDist, pLimit, 0, 0);/*生成用于WHERE子句处理的循环语句，并返回结束指针*/
 		if (pWInfo == 0) goto select_end;/*如果返回指针为0，跳到查询结束*/
 		if (pWInfo->nRowOut < p->nSelectRow) p->nSelectRow = pWInfo->nRowOut;/*输出行数*/
 
@@ -4831,6 +5025,14 @@ int sqlite3Select(
 			int addrSortingIdx; /* The OP_OpenEphemeral for the sorting index */
 			int addrReset;      /* Subroutine for resetting the accumulator   重置累加器的子程序*/
 			int regReset;       /* Return address register for reset subroutine  为重置子程序返回地址寄存器*/
+			int useHash = 0;    /* True to group rows using a hash table */
+			int iHashTab = 0;   /* Cursor number of the hash table */
+			int addrHashOpen = 0; /* The OP_HashOpen instruction */
+			int iAccBase = 0;   /* First accumulator register */
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+			int iScanSort = 0;  /* sqlite3_stmt_scanstatus() handle for the sort */
+			const char *zSortUsage = 0;  /* EQP text for the sort */
+#endif
 
 			/* If there is a GROUP BY clause we might need a sorting index to
 			** implement it.  Allocate that sorting index now.  If it turns out
@@ -4845,6 +5047,24 @@ int sqlite3Select(
 				sAggInfo.sortingIdx, sAggInfo.nSortingColumn,
 				0, (char*)pKeyInfo, P4_KEYINFO_HANDOFF);
 
+#ifndef SQLITE_OMIT_VDBEHASH
+			/* If the rows cannot be delivered in GROUP BY order, they might be
+			** grouped using a hash table instead of the sorter.  The hash table
+			** entries hold the accumulators, which must therefore occupy a
+			** contiguous range of registers.  As with the sorter, if it turns
+			** out that the hash table is not needed the OP_HashOpen instruction
+			** is converted into a Noop.
+			*/
+			useHash = groupByUseHash(p, pOrderBy, pKeyInfo, &sAggInfo);
+			if (useHash){
+				iAccBase = aggInfoPackRegisters(pParse, &sAggInfo);
+				iHashTab = pParse->nTab++;
+				addrHashOpen = sqlite3VdbeAddOp4(v, OP_HashOpen, iHashTab,
+					pGroupBy->nExpr, sAggInfo.nColumn + sAggInfo.nFunc,
+					(char*)pKeyInfo, P4_KEYINFO);
+			}
+#endif
+
 			/* Initialize memory locations used by GROUP BY aggregate processing
 			**初始化被groupby 聚合处理的内存单元
 			*/
@@ -4872,7 +5092,7 @@ int sqlite3Select(
 			**启动一个循环，提取GROUP BY命令的所有的原列。
 			*/
 			sqlite3VdbeAddOp2(v, OP_Gosub, regReset, addrReset);
-			pWInfo = sqlite3WhereBegin(pParse, pTabList, pWhere, &pGroupBy, 0, 0, 0);
+			pWInfo = sqlite3WhereBegin(pParse, pTabList, pWhere, &pGroupBy, 0, 0, 0, 0);
 			if (pWInfo == 0) goto select_end;
 			if (pGroupBy == 0){
 				/* The optimizer is able to deliver rows in group by order so
@@ -4884,6 +5104,10 @@ int sqlite3Select(
 				*/
 				pGroupBy = p->pGroupBy;
 				groupBySort = 0;
+				if (useHash){
+					sqlite3VdbeChangeToNoop(v, addrHashOpen);
+					useHash = 0;
+				}
 			}
 			else{
 				/* Rows are coming out in undetermined order.  We have to push
@@ -4898,9 +5122,20 @@ int sqlite3Select(
 				int regRecord;/*寄存器中记录*/
 				int nCol;/*列数*/
 				int nGroupBy;/*GROUP BY的个数*/
+				int addrSpill = 0;  /* Rows for groups not in the hash table */
+				int addrNextRow = 0;  /* Done with the current input row */
 
-				explainTempTable(pParse,
-					isDistinct && !(p->selFlags&SF_Distinct) ? "DISTINCT" : "GROUP BY");/*执行出错才会使用该函数，输出错误信息到语法解析树中*/
+				if (useHash){
+					explainHashTable(pParse,
+						isDistinct && !(p->selFlags&SF_Distinct) ? "DISTINCT" : "GROUP BY");
+				}else{
+					explainTempTable(pParse,
+						isDistinct && !(p->selFlags&SF_Distinct) ? "DISTINCT" : "GROUP BY");/*执行出错才会使用该函数，输出错误信息到语法解析树中*/
+				}
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+				zSortUsage = isDistinct && !(p->selFlags&SF_Distinct) ?
+					"USE TEMP B-TREE FOR DISTINCT" : "USE TEMP B-TREE FOR GROUP BY";
+#endif
 
 
 				groupBySort = 1;
@@ -4916,6 +5151,22 @@ int sqlite3Select(
 				regBase = sqlite3GetTempRange(pParse, nCol);
 				sqlite3ExprCacheClear(pParse);
 				sqlite3ExprCodeExprList(pParse, pGroupBy, regBase, 0);
+				if (useHash){
+					/* Load the accumulators for the group from the hash table,
+					** update them and store them back.  If the group is not in the
+					** hash table and the table is full, jump to the code that writes
+					** the row into the sorter instead.
+					*/
+					addrSpill = sqlite3VdbeMakeLabel(v);
+					addrNextRow = sqlite3VdbeMakeLabel(v);
+					sqlite3VdbeAddOp4Int(v, OP_HashAggLoad, iHashTab, addrSpill,
+						regBase, iAccBase);
+					updateAccumulator(pParse, &sAggInfo);
+					sqlite3VdbeAddOp2(v, OP_HashAggStore, iHashTab, iAccBase);
+					sqlite3VdbeAddOp2(v, OP_Goto, 0, addrNextRow);
+					sqlite3VdbeResolveLabel(v, addrSpill);
+					sqlite3ExprCacheClear(pParse);
+				}
 				sqlite3VdbeAddOp2(v, OP_Sequence, sAggInfo.sortingIdx, regBase + nGroupBy);
 				j = nGroupBy + 1;
 				for (i = 0; i < sAggInfo.nColumn; i++){
@@ -4935,12 +5186,51 @@ int sqlite3Select(
 				regRecord = sqlite3GetTempReg(pParse);
 				sqlite3VdbeAddOp3(v, OP_MakeRecord, regBase, nCol, regRecord);
 				sqlite3VdbeAddOp2(v, OP_SorterInsert, sAggInfo.sortingIdx, regRecord);
+				if (useHash){
+					sqlite3VdbeResolveLabel(v, addrNextRow);
+				}
 				sqlite3ReleaseTempReg(pParse, regRecord);
 				sqlite3ReleaseTempRange(pParse, regBase, nCol);
 				sqlite3WhereEnd(pWInfo);
+				if (useHash){
+					/* Output one row for each group in the hash table.  Then reset
+					** the accumulators and fall through to process any rows that
+					** were spilled into the sorter.
+					*/
+					int addrHashTop;
+					int addrHashDone = sqlite3VdbeMakeLabel(v);
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+					int iScanHash;
+#endif
+					sqlite3VdbeAddOp2(v, OP_Integer, 1, iUseFlag);
+					sqlite3VdbeAddOp3(v, OP_HashRewind, iHashTab, addrHashDone, iAccBase);
+					addrHashTop = sqlite3VdbeAddOp2(v, OP_Gosub, regOutputRow, addrOutputRow);
+					VdbeComment((v, "output one hashed group"));
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+					iScanHash = scanStatusTempLoop(pParse, addrHashTop - 1,
+						p->nSelectRow, isDistinct && !(p->selFlags&SF_Distinct) ?
+						"USE HASH TABLE FOR DISTINCT" : "USE HASH TABLE FOR GROUP BY");
+					sqlite3VdbeScanStatusVisit(v, iScanHash, addrHashTop, addrHashTop);
+#endif
+					sqlite3VdbeAddOp2(v, OP_IfPos, iAbortFlag, addrEnd);
+					sqlite3VdbeAddOp3(v, OP_HashNext, iHashTab, addrHashTop, iAccBase);
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+					sqlite3VdbeScanStatusEnd(v, iScanHash, sqlite3VdbeCurrentAddr(v));
+#endif
+					sqlite3VdbeResolveLabel(v, addrHashDone);
+					sqlite3VdbeAddOp2(v, OP_Integer, 0, iUseFlag);
+					sqlite3VdbeAddOp2(v, OP_Gosub, regReset, addrReset);
+					sqlite3ExprCacheClear(pParse);
+				}
 				sAggInfo.sortingIdxPTab = sortPTab = pParse->nTab++;
 				sortOut = sqlite3GetTempReg(pParse);
 				sqlite3VdbeAddOp3(v, OP_OpenPseudo, sortPTab, sortOut, nCol);
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+				/* The sort and the loop over its output are reported as one loop
+				** of sqlite3_stmt_scanstatus(), as for ORDER BY. */
+				iScanSort = scanStatusTempLoop(pParse, sqlite3VdbeCurrentAddr(v),
+					p->nSelectRow, zSortUsage);
+#endif
 				sqlite3VdbeAddOp2(v, OP_SorterSort, sAggInfo.sortingIdx, addrEnd);
 				VdbeComment((v, "GROUP BY sort"));
 				sAggInfo.useSortingIdx = 1;
@@ -4954,6 +5244,9 @@ int sqlite3Select(
 		  *//*计算当前GROUP BY的条款并且存储在b0,b1,b2…（b0的内存地址为iBMem+0，b1的内存地址为iBMem+1…依次类推）
 		  **然后将当前GROUP BY的条款与存储在a0,a1,a2的以前的行的the GROUP BY 的条款*/
 			addrTopOfLoop = sqlite3VdbeCurrentAddr(v);/*返回下一个被插入的指令的地址*/
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+			sqlite3VdbeScanStatusVisit(v, iScanSort, addrTopOfLoop, addrTopOfLoop);
+#endif
 			sqlite3ExprCacheClear(pParse);/*清除所有列缓存条目*/
 			if (groupBySort){
 				sqlite3VdbeAddOp2(v, OP_SorterData, sAggInfo.sortingIdx, sortOut);
@@ -5006,6 +5299,9 @@ int sqlite3Select(
 			*/
 			if (groupBySort){
 				sqlite3VdbeAddOp2(v, OP_SorterNext, sAggInfo.sortingIdx, addrTopOfLoop);
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+				sqlite3VdbeScanStatusEnd(v, iScanSort, sqlite3VdbeCurrentAddr(v));
+#endif
 			}
 			else{
 				sqlite3WhereEnd(pWInfo);
@@ -5189,7 +5485,7 @@ int sqlite3Select(
 				**只有一个单独的行输出。
 				*/
 				resetAccumulator(pParse, &sAggInfo);/*重置聚合累加器*/
-				pWInfo = sqlite3WhereBegin(pParse, pTabList, pWhere, &pMinMax, 0, flag, 0);/*生成处理where子句的循环的开始*/
+				pWInfo = sqlite3WhereBegin(pParse, pTabList, pWhere, &pMinMax, 0, 0, flag, 0);/*生成处理where子句的循环的开始*/
 				if (pWInfo == 0){/*若为空，则删除并结束select*/
 					sqlite3ExprListDelete(db, pDel);/*删除执行最值的表达式列表*/
 					goto select_end;/*跳到查询结束*/
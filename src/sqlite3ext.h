@@ -236,6 +236,18 @@ struct sqlite3_api_routines {
   int (*blob_reopen)(sqlite3_blob*,sqlite3_int64);
   int (*vtab_config)(sqlite3*,int op,...);
   int (*vtab_on_conflict)(sqlite3*);
+  int (*stmt_scanstatus)(sqlite3_stmt*,int,int,void*);
+  void (*stmt_scanstatus_reset)(sqlite3_stmt*);
+  int (*vtab_distinct)(sqlite3_index_info*);
+  int (*vtab_in)(sqlite3_index_info*,int,int);
+  int (*vtab_in_first)(sqlite3_value*,sqlite3_value**);
+  int (*vtab_in_next)(sqlite3_value*,sqlite3_value**);
+  int (*stmt_serialize)(sqlite3_stmt*,void**,int*);
+  int (*stmt_deserialize)(sqlite3*,const void*,int,sqlite3_stmt**);
+  int (*bind_array)(sqlite3_stmt*,int,int,const void*,const int*,
+                    const unsigned char*);
+  int (*step_array)(sqlite3_stmt*,int,int*);
+  int (*step_columns)(sqlite3_stmt*,int,sqlite3_column_buffer*,int*);
 };
 
 /*
@@ -439,6 +451,17 @@ struct sqlite3_api_routines {
 #define sqlite3_blob_reopen            sqlite3_api->blob_reopen
 #define sqlite3_vtab_config            sqlite3_api->vtab_config
 #define sqlite3_vtab_on_conflict       sqlite3_api->vtab_on_conflict
+#define sqlite3_stmt_scanstatus        sqlite3_api->stmt_scanstatus
+#define sqlite3_stmt_scanstatus_reset  sqlite3_api->stmt_scanstatus_reset
+#define sqlite3_vtab_distinct          sqlite3_api->vtab_distinct
+#define sqlite3_vtab_in                sqlite3_api->vtab_in
+#define sqlite3_vtab_in_first          sqlite3_api->vtab_in_first
+#define sqlite3_vtab_in_next           sqlite3_api->vtab_in_next
+#define sqlite3_stmt_serialize         sqlite3_api->stmt_serialize
+#define sqlite3_stmt_deserialize       sqlite3_api->stmt_deserialize
+#define sqlite3_bind_array             sqlite3_api->bind_array
+#define sqlite3_step_array             sqlite3_api->step_array
+#define sqlite3_step_columns           sqlite3_api->step_columns
 #endif /* SQLITE_CORE */
 
 #define SQLITE_EXTENSION_INIT1     const sqlite3_api_routines *sqlite3_api = 0;
@@ -351,6 +351,38 @@
 # define SQLITE_BIG_DBL (1e99)
 #endif
 
+/*
+** The loop descriptions reported by sqlite3_stmt_scanstatus() are built
+** by the same code that generates EXPLAIN QUERY PLAN output.
+*/
+#if defined(SQLITE_OMIT_EXPLAIN) && !defined(SQLITE_OMIT_STMT_SCANSTATUS)
+# define SQLITE_OMIT_STMT_SCANSTATUS 1
+#endif
+
+/*
+** The sqlite_stat4 samples of multi-column index prefixes are gathered
+** and used by the same code as the sqlite_stat3 samples.
+*/
+#if defined(SQLITE_ENABLE_STAT4) && !defined(SQLITE_ENABLE_STAT3)
+# define SQLITE_ENABLE_STAT3 1
+#endif
+
+/*
+** Cardinality feedback measures loops with the sqlite3_stmt_scanstatus()
+** counters.
+*/
+#if defined(SQLITE_OMIT_STMT_SCANSTATUS) && !defined(SQLITE_OMIT_CARD_FEEDBACK)
+# define SQLITE_OMIT_CARD_FEEDBACK 1
+#endif
+
+/*
+** The index advisor uses the same test as automatic indexes to decide
+** which WHERE clause terms an index could be built on.
+*/
+#if defined(SQLITE_OMIT_AUTOMATIC_INDEX) && !defined(SQLITE_OMIT_INDEX_ADVISOR)
+# define SQLITE_OMIT_INDEX_ADVISOR 1
+#endif
+
 /*
 ** OMIT_TEMPDB is set to 1 if SQLITE_OMIT_TEMPDB is defined, or 0       如果SQLITE_OMIT_TEMPDB被定义了，OMIT_TEMPDB被设置为1，否则，设为0
 ** afterward. Having this macro allows us to cause the C compiler     这个宏允许我们触发C编译器忽略没有凌乱的#ifndef语句的TEMP表的代码的使用。 
@@ -642,6 +674,7 @@ typedef struct CollSeq CollSeq;
 typedef struct Column Column;
 typedef struct Db Db;
 typedef struct Schema Schema;
+typedef struct SchemaLazy SchemaLazy;
 typedef struct Expr Expr;
 typedef struct ExprList ExprList;
 typedef struct ExprSpan ExprSpan;
@@ -651,14 +684,18 @@ typedef struct FuncDef FuncDef;
 typedef struct FuncDefHash FuncDefHash;
 typedef struct IdList IdList;
 typedef struct Index Index;
+typedef struct IndexAdvice IndexAdvice;
 typedef struct IndexSample IndexSample;
 typedef struct KeyClass KeyClass;
 typedef struct KeyInfo KeyInfo;
 typedef struct Lookaside Lookaside;
+typedef struct LookasideChunk LookasideChunk;
 typedef struct LookasideSlot LookasideSlot;
 typedef struct Module Module;
 typedef struct NameContext NameContext;
 typedef struct Parse Parse;
+typedef struct ParseArena ParseArena;
+typedef struct ParseArenaChunk ParseArenaChunk;
 typedef struct RowSet RowSet;
 typedef struct Savepoint Savepoint;
 typedef struct Select Select;
@@ -739,11 +776,49 @@ struct Schema {
   Hash idxHash;        /* All (named) indices indexed by name 用名字索引已命名的索引*/
   Hash trigHash;       /* All triggers indexed by name所有的触发器利用名字进行索引 */
   Hash fkeyHash;       /* All foreign keys by referenced table name 外键通过所参照表的名字进行索引*/
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+  Hash lazyHash;       /* Objects not yet parsed, by name. See prepare.c */
+#endif
   Table *pSeqTab;      /* The sqlite_sequence table used by AUTOINCREMENT 被AUTOINCREMENThe使用的sqlite_sequence表*/
   u8 file_format;      /* Schema format version for this fil文件的模式格式版本 */
   u8 enc;              /* Text encoding used by this database数据库所使用的文字编码 */
   u16 flags;           /* Flags associated with this schema 与该模式相关联的标志*/
   int cache_size;      /* Number of pages to use in the cache 在缓存cache中使用的快数*/
+#ifndef SQLITE_OMIT_SHARED_SCHEMA
+  int nShareRef;       /* References to a standalone schema.  See callback.c */
+  char *zShareFile;    /* Database file of a published schema, or NULL */
+  Schema *pShareNext;  /* Next published schema */
+#endif
+};
+
+/*
+** While the schema of a database is loaded lazily, each table or view
+** that has not yet been referred to is described by an instance of the
+** following structure, as are the indices and triggers that belong to
+** it.  The table's entry heads a list of the objects in the order that
+** they appear in the sqlite_master table.  Tables, views and indices
+** are also entered into Schema.lazyHash by name.  See prepare.c.
+**
+** Statistics read from sqlite_stat1, sqlite_stat3 and sqlite_stat4 for
+** objects that have not been parsed are kept here until they are.  The
+** row count of a table is kept in its own entry.  The statistics of an
+** index are kept in an Index object that holds nothing else.  See
+** analyze.c.
+*/
+struct SchemaLazy {
+  SchemaLazy *pTab;    /* Entry for the table this object belongs to */
+  SchemaLazy *pNext;   /* Next object of the same table */
+  SchemaLazy *pLast;   /* Last object in the pNext list.  Tables only */
+  int tnum;            /* Root page.  0 for views and triggers */
+  char *zName;         /* Name of the object */
+  char *zSql;          /* CREATE statement.  NULL for automatic indices */
+  char *zErr;          /* Why the table could not be parsed.  Tables only */
+  u8 isTrigger;        /* True for a trigger */
+#ifndef SQLITE_OMIT_ANALYZE
+  u8 hasStat1;         /* True if nRowEst was read.  Tables only */
+  tRowcnt nRowEst;     /* Rows in the table, from sqlite_stat1 */
+  Index *pStat;        /* Statistics of an index, or NULL */
+#endif
 };
 
 /*
@@ -794,7 +869,25 @@ struct Schema {
 ** is shared by multiple database connections.  Therefore, while parsing
 ** schema information, the Lookaside.bEnabled flag is cleared so that
 ** lookaside allocations are not used to construct the schema objects. //因此，当解析模式信息时，Lookaside.bEnabled标志将会被清除，来保证后备内存分配不会被用来构建模式对象。
-*/
+**
+** Lookaside memory is divided into LOOKASIDE_NCLASS classes of slots of
+** half, once and twice the configured slot size.  A request is served
+** from the smallest class large enough for it, or from a larger class if
+** that one is exhausted.  The memory comes in chunks of szChunk bytes,
+** each holding anSlot[i] slots of class i in order of increasing size.
+** The first chunk is set up by sqlite3_db_config() or when the connection
+** is opened.  When every suitable slot is in use, further chunks are
+** obtained from sqlite3_malloc(), up to nChunkMax chunks in total.
+*/
+#define LOOKASIDE_NCLASS 3
+#define LOOKASIDE_NCHUNK 8
+#ifndef SQLITE_DEFAULT_LOOKASIDE_MAX
+# define SQLITE_DEFAULT_LOOKASIDE_MAX 262144
+#endif
+struct LookasideChunk {
+  void *pStart;                   /* First byte of the chunk */
+  void *aEnd[LOOKASIDE_NCLASS];   /* First byte past the slots of each class */
+};
 struct Lookaside {
   u16 sz;                 /* Size of each buffer in bytes , u16是sqlite内部自定义的一个类型，即是UINT16_TYPE，2-byte unsigned integer，两字节的无符号整数，sz代表每一个缓冲区的大小，即其所包含的字节数。*/
   u8 bEnabled;            /* False to disable new lookaside allocations , bEnabled是一个标志位，占用两个字节的无符号整数，表示可以进行新的后备内存区的分配。*/
@@ -802,7 +895,16 @@ struct Lookaside {
   int nOut;               /* Number of buffers currently checked out 当前已知的缓冲区数量。 */
   int mxOut;              /* Highwater mark for nOut nOut的最大标记? */
   int anStat[3];          /* 0: hits.  1: size misses.  2: full misses   */
-  LookasideSlot *pFree;   /* List of available buffers  可用缓冲区列表*/
+  u16 aSz[LOOKASIDE_NCLASS];      /* Slot size of each class, or 0 */
+  int anSlot[LOOKASIDE_NCLASS];   /* Slots of each class in a chunk */
+  int anOut[LOOKASIDE_NCLASS];    /* Slots of each class checked out */
+  int aClassStat[LOOKASIDE_NCLASS][3]; /* Per-class hits, misses, fulls */
+  LookasideSlot *apFree[LOOKASIDE_NCLASS];  /* Available slots of each class */
+  int szChunk;            /* Size of each chunk in bytes */
+  int szMax;              /* Maximum bytes of lookaside memory */
+  int nChunk;             /* Number of chunks in aChunk[] */
+  int nChunkMax;          /* Maximum number of chunks */
+  LookasideChunk aChunk[LOOKASIDE_NCHUNK];  /* Memory for lookaside slots */
   void *pStart;           /* First byte of available memory space  可用内存空间的第一个字节*/
   void *pEnd;             /* First byte past end of available space 可用空间后的首个字节*/
 };
@@ -810,6 +912,39 @@ struct LookasideSlot {
   LookasideSlot *pNext;    /* Next buffer in the list of free buffers , pNext是一个LookasideSlot结构体类型的指针，指向的是空间缓冲区列表中的下一个缓冲区。*/
 };
 
+/*
+** A ParseArena is a bump-pointer allocator that holds the parse tree
+** (Expr, ExprList, SrcList and Select objects) and the WhereInfo objects
+** of a single statement.  Each Parse object that sqlite3Prepare() creates
+** owns one, and sqlite3.pArena points to it while the statement is being
+** compiled.  Freeing memory from the arena does nothing.  All of it is
+** released at once when sqlite3Prepare() finishes.
+**
+** Memory is only taken from the arena while lookaside is enabled and
+** the schema is not being parsed.  Objects that may outlive the
+** statement are built with lookaside disabled, so the same rule keeps
+** them out of the arena.  Each allocation is preceded by an 8-byte
+** header that records its size.  Chunks come from sqlite3_malloc() and
+** double in size up to PARSE_ARENA_MAXCHUNK bytes.
+*/
+#ifndef PARSE_ARENA_MINCHUNK
+# define PARSE_ARENA_MINCHUNK 4096
+#endif
+#ifndef PARSE_ARENA_MAXCHUNK
+# define PARSE_ARENA_MAXCHUNK 65536
+#endif
+struct ParseArenaChunk {
+  ParseArenaChunk *pNext;  /* Next older chunk */
+  u8 *pEnd;                /* First byte past the end of this chunk */
+};
+struct ParseArena {
+  ParseArenaChunk *pChunk; /* Most recently allocated chunk */
+  u8 *pFree;               /* First unused byte of pChunk */
+  int szChunk;             /* Size of the next chunk to allocate */
+  void *pStart;            /* First byte of the lowest chunk */
+  void *pEnd;              /* First byte past the end of the highest chunk */
+};
+
 /*
 ** A hash table for function definitions.   //用于函数定义的哈希表
 **
@@ -884,6 +1019,7 @@ struct sqlite3 {
     double notUsed1;            /* Spacer */
   } u1;
   Lookaside lookaside;          /* Lookaside malloc configuration 后备动态内存分配配置*/
+  ParseArena *pArena;           /* Arena of the statement being prepared */
 #ifndef SQLITE_OMIT_AUTHORIZATION
   int (*xAuth)(void*,int,const char*,const char*,const char*,const char*);
                                 /* Access authorization function 访问授权功能*/
@@ -911,6 +1047,27 @@ struct sqlite3 {
   int nStatement;               /* Number of nested statement-transactions  嵌套事务语句的数量*/
   i64 nDeferredCons;            /* Net deferred constraints this transaction. 网络延迟约束这个交易*/
   int *pnBytesFreed;            /* If not NULL, increment this in DbFree() 若不为空，将其加入函数DbFree()中*/
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+  u8 bCardFeedback;             /* True if PRAGMA cardinality_feedback is on */
+  Hash aCardFeedback;           /* Observed loop cardinalities. See where.c */
+#endif
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+  u8 bLazySchema;               /* True if PRAGMA lazy_schema is on */
+#endif
+#ifndef SQLITE_OMIT_SHARED_SCHEMA
+  u8 bSharedSchema;             /* True if PRAGMA shared_schema is on */
+  u8 nSchemaShareHeld;          /* Entries in aSchemaShareHeld[] */
+  int nSchemaShareUse;          /* Depth of sqlite3SchemaShareEnter() calls */
+  Schema *aSchemaShareHeld[SQLITE_MAX_ATTACHED+2]; /* Schemas pinned by db */
+#endif
+#ifndef SQLITE_OMIT_INDEX_ADVISOR
+  u8 bIndexAdvisor;             /* True if PRAGMA index_advisor is on */
+  Hash aIndexAdvice;            /* Candidate indexes. See where.c */
+#endif
+#ifndef SQLITE_OMIT_ANALYZE
+  int nAnalysisSample;          /* Leaf pages ANALYZE samples per index, or 0 */
+  int nAnalysisThreshold;       /* Percent change in rows before re-ANALYZE */
+#endif
 
 #ifdef SQLITE_ENABLE_UNLOCK_NOTIFY
   /* The following variables are all protected by the STATIC_MASTER //以下变量是由STATIC_MASTER互斥保护的，而不是sqlite3.mutex。
@@ -951,7 +1108,7 @@ struct sqlite3 {
 #define SQLITE_SqlTrace       0x00004000  /* Debug print SQL as it executes 当SQL执行时将其调试打印*/
 #define SQLITE_VdbeListing    0x00008000  /* Debug listings of VDBE programs，VDBE程序的调试列表 */
 #define SQLITE_WriteSchema    0x00010000  /* OK to update SQLITE_MASTER 可以更新SQLITE_MASTER*/
-                         /*   0x00020000  Unused */
+#define SQLITE_ScanStatus     0x00020000  /* Collect sqlite3_stmt_scanstatus() data */
 #define SQLITE_IgnoreChecks   0x00040000  /* Do not enforce check constraints 忽略强制检查约束*/
 #define SQLITE_ReadUncommitted 0x0080000  /* For shared-cache mode 对于共享缓存模式*/
 #define SQLITE_LegacyFileFmt  0x00100000  /* Create new databases in format 1 创建格式1的新数据库*/
@@ -1006,7 +1163,7 @@ struct sqlite3 {
 struct FuncDef {
   i16 nArg;            /* Number of arguments.  -1 means unlimited 参数的数量，1表示无限制*/
   u8 iPrefEnc;         /* Preferred text encoding (SQLITE_UTF8, 16LE, 16BE) 所选择的文本编码方式*/
-  u8 flags;            /* Some combination of SQLITE_FUNC_* ， SQLITE_FUNC_*的某种组合*/
+  u16 flags;           /* Some combination of SQLITE_FUNC_* ， SQLITE_FUNC_*的某种组合*/
   void *pUserData;     /* User data parameter 用户数据参数*/
   FuncDef *pNext;      /* Next function with same name 重名的下一个函数*/
   void (*xFunc)(sqlite3_context*,int,sqlite3_value**); /* Regular function 常规功能*/
@@ -1056,6 +1213,7 @@ FuncDef.flags的可能的值。需要注意的是_length和_TYPEOF值必须与OP
 #define SQLITE_FUNC_COALESCE 0x20 /* Built-in coalesce() or ifnull() function 内置coalesce()或ifnull()函数*/
 #define SQLITE_FUNC_LENGTH   0x40 /* Built-in length() function 内置length()函数*/
 #define SQLITE_FUNC_TYPEOF   0x80 /* Built-in typeof() function 内置typeof()函数*/
+#define SQLITE_FUNC_CONSTANT 0x100 /* Result depends only on the arguments */
 
 /*
 ** The following three macros, FUNCTION(), LIKEFUNC() and AGGREGATE() are
@@ -1406,6 +1564,16 @@ struct Table {
 #define TF_HasPrimaryKey   0x04    /* Table has a primary key 有主键的表*/
 #define TF_Autoincrement   0x08    /* Integer primary key is autoincrement 自增的整型主键*/
 #define TF_Virtual         0x10    /* Is a virtual table 是一个虚表*/
+#define TF_HasStat1        0x20    /* nRowEst was loaded from sqlite_stat1 */
+#define TF_Shared          0x40    /* Part of a published schema. See callback.c */
+
+/*
+** Count a reference to table T held by a statement that is being
+** prepared.  The tables of a published schema are kept alive by the
+** reference count of the schema instead, so that they are never
+** written to.  See sqlite3DeleteTable().
+*/
+#define sqlite3TableRef(T)  ((T)->nRef += ((T)->tabFlags & TF_Shared)==0)
 
 
 /*
@@ -1615,11 +1783,16 @@ struct Index {
   u8 onError;      /* OE_Abort, OE_Ignore, OE_Replace, or OE_None */
   u8 autoIndex;    /* True if is automatically created (ex: by UNIQUE) 若是系统自动创建则为真*/
   u8 bUnordered;   /* Use this index for == or IN queries only 对于==使用该索引，或者是仅仅对IN 查询使用*/
+  u8 hasStat1;     /* aiRowEst[] was loaded from sqlite_stat1 */
 #ifdef SQLITE_ENABLE_STAT3
   int nSample;             /* Number of elements in aSample[] 数组aSample中的元素数目*/
   tRowcnt avgEq;           /* Average nEq value for key values not in aSample 不在aSample数组中的键值的平均nEq值*/
   IndexSample *aSample;    /* Samples of the left-most key 最左边键的值*/
 #endif
+#ifdef SQLITE_ENABLE_STAT4
+  int nPrefixSample;       /* Number of elements in aPrefixSample[] */
+  IndexSample *aPrefixSample; /* Samples of multi-column key prefixes */
+#endif
 };
 
 /*
@@ -1637,11 +1810,30 @@ struct IndexSample {
   } u;
   u8 eType;         /* SQLITE_NULL, SQLITE_INTEGER ... etc. */
   int nByte;        /* Size in byte of text or blob. 文本或者是二进制大对象的字节长度*/
+  u8 nField;        /* Columns in an sqlite_stat4 prefix sample, else 0 */
   tRowcnt nEq;      /* Est. number of rows where the key equals this sample 键与该样本相同的行的Est. number*/
   tRowcnt nLt;      /* Est. number of rows where key is less than this sample 键少于该样本的行的Est. number*/
   tRowcnt nDLt;     /* Est. number of distinct keys less than this sample 少于该样本的不重复的键的Est. number*/
 };
 
+/*
+** While PRAGMA index_advisor is on, each index that the query planner
+** would have liked to use but could not find is recorded in the
+** sqlite3.aIndexAdvice hash table using an instance of this structure.
+** The benefit is measured in the same units as the planner's cost
+** estimates and is summed over all executions of the statements that
+** wanted the index.  See the index advisor in where.c.
+*/
+struct IndexAdvice {
+  u64 nUse;         /* Number of statement executions that wanted the index */
+  double rBenefit;  /* Total estimated saving over those executions */
+  const char *zDb;  /* Database holding the table */
+  const char *zTab; /* Table to be indexed */
+  const char *zCols;/* Comma separated list of columns to index */
+  const char *zSql; /* CREATE INDEX statement for the index */
+  char zKey[1];     /* Hash key.  MUST BE LAST */
+};
+
 /*
 ** Each token coming out of the lexer is an instance of
 ** this structure.  Tokens are also used as part of an expression.
@@ -2072,6 +2264,7 @@ struct WhereLevel {
   u8 iFrom;             /* Which entry in the FROM clause 			FORM子句中的条目*/
   u8 op, p5;            /* Opcode and P5 of the opcode that ends the loop 	操作码和循环结束的操作码P5*/
   int p1, p2;           /* Operands of the opcode used to ends the loop 	用于结束循环的操作码的操作数*/
+  int iScan;            /* sqlite3_stmt_scanstatus() handle, or 0 */
   union {               /* Information that depends on plan.wsFlags 		取决于plan.wsFlags的信息*/
     struct {
       int nIn;              /* Number of entries in aInLoop[] 			在alnLoop[]条目数*/
@@ -2389,6 +2582,7 @@ struct Parse {
   u8 eTriggerOp;       /* TK_UPDATE, TK_INSERT or TK_DELETE */
   u8 eOrconf;          /* Default ON CONFLICT policy for trigger steps 		默认ON CONFICT规则的触发步骤*/
   u8 disableTriggers;  /* True to disable triggers 				禁用触发器*/
+  ParseArena sArena;   /* Parse tree memory, if prepared by sqlite3Prepare() */
 
   /* Above is constant between recursions.  Below is reset before and after	以上在每次递归时不变，以下在每次递归前和递归后复位
   ** each recursion */
@@ -2747,6 +2941,16 @@ void *sqlite3Realloc(void*, int);
 void *sqlite3DbReallocOrFree(sqlite3 *, void *, int);
 void *sqlite3DbRealloc(sqlite3 *, void *, int);
 void sqlite3DbFree(sqlite3*, void*);
+void sqlite3LookasideAddChunk(sqlite3*, void*);
+#ifndef SQLITE_OMIT_PARSE_ARENA
+void *sqlite3ArenaMallocRaw(sqlite3*, int);
+void *sqlite3ArenaMallocZero(sqlite3*, int);
+void sqlite3ArenaClear(ParseArena*);
+#else
+# define sqlite3ArenaMallocRaw(X,Y) sqlite3DbMallocRaw(X,Y)
+# define sqlite3ArenaMallocZero(X,Y) sqlite3DbMallocZero(X,Y)
+# define sqlite3ArenaClear(X)
+#endif
 int sqlite3MallocSize(void*);
 int sqlite3DbMallocSize(sqlite3*, void*);
 void *sqlite3ScratchMalloc(int);
@@ -2783,6 +2987,13 @@ const sqlite3_mem_methods *sqlite3MemGetMemsys3(void);
 #ifdef SQLITE_ENABLE_MEMSYS5
 const sqlite3_mem_methods *sqlite3MemGetMemsys5(void);
 #endif
+#ifdef SQLITE_ENABLE_MEMSYS6
+const sqlite3_mem_methods *sqlite3MemGetMemsys6(const sqlite3_mem_methods*);
+int sqlite3Memsys6Stat(int,int);
+void sqlite3MallocStatAdd(int,int);
+#else
+# define sqlite3Memsys6Stat(X,Y) 0
+#endif
 
 
 #ifndef SQLITE_MUTEX_OMIT
@@ -2864,6 +3075,40 @@ void sqlite3ExprListSetSpan(Parse*,ExprList*,ExprSpan*);
 void sqlite3ExprListDelete(sqlite3*, ExprList*);
 int sqlite3Init(sqlite3*, char**);
 int sqlite3InitCallback(void*, int, char**, char**);
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+int sqlite3SchemaLazyLoad(sqlite3*, int, const char*);
+void sqlite3SchemaLazyLoadAll(sqlite3*, int);
+void sqlite3SchemaLazyMoved(Schema*, int, int);
+void sqlite3SchemaLazyClear(Schema*);
+const char *sqlite3SchemaLazyError(sqlite3*, const char*, const char*);
+#else
+# define sqlite3SchemaLazyLoad(A,B,C) 0
+# define sqlite3SchemaLazyLoadAll(A,B)
+# define sqlite3SchemaLazyMoved(A,B,C)
+# define sqlite3SchemaLazyClear(A)
+# define sqlite3SchemaLazyError(A,B,C) 0
+#endif
+#ifndef SQLITE_OMIT_SHARED_SCHEMA
+int sqlite3SchemaShareBegin(sqlite3*, int);
+int sqlite3SchemaShareAttach(sqlite3*, int);
+void sqlite3SchemaSharePublish(sqlite3*, int);
+void sqlite3SchemaShareDetach(sqlite3*, int);
+int sqlite3SchemaUnshare(sqlite3*, int);
+u8 sqlite3SchemaShareEnter(sqlite3*);
+void sqlite3SchemaSharePin(sqlite3*);
+void sqlite3SchemaShareLeave(sqlite3*, u8);
+void sqlite3SchemaShareShutdown(void);
+#else
+# define sqlite3SchemaShareBegin(A,B) SQLITE_OK
+# define sqlite3SchemaShareAttach(A,B) 0
+# define sqlite3SchemaSharePublish(A,B)
+# define sqlite3SchemaShareDetach(A,B)
+# define sqlite3SchemaUnshare(A,B) 0
+# define sqlite3SchemaShareEnter(A) 0
+# define sqlite3SchemaSharePin(A)
+# define sqlite3SchemaShareLeave(A,B) UNUSED_PARAMETER(B)
+# define sqlite3SchemaShareShutdown()
+#endif
 void sqlite3Pragma(Parse*,Token*,Token*,Token*,int);
 void sqlite3ResetAllSchemasOfConnection(sqlite3*);
 void sqlite3ResetOneSchema(sqlite3*,int);
@@ -2948,8 +3193,21 @@ Expr *sqlite3LimitWhere(Parse *, SrcList *, Expr *, ExprList *, Expr *, Expr *,
 void sqlite3DeleteFrom(Parse*, SrcList*, Expr*);
 void sqlite3Update(Parse*, SrcList*, ExprList*, Expr*, int);
 WhereInfo *sqlite3WhereBegin(
-    Parse*,SrcList*,Expr*,ExprList**,ExprList*,u16,int);
+    Parse*,SrcList*,Expr*,ExprList**,ExprList*,Select*,u16,int);
 void sqlite3WhereEnd(WhereInfo*);
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+void sqlite3WhereFeedback(sqlite3*, const char*, double);
+void sqlite3WhereFeedbackClear(sqlite3*);
+#else
+# define sqlite3WhereFeedbackClear(X)
+#endif
+#ifndef SQLITE_OMIT_INDEX_ADVISOR
+void sqlite3WhereAdvice(sqlite3*, const char*, double);
+void sqlite3WhereAdviceClear(sqlite3*);
+IndexAdvice **sqlite3WhereAdviceList(sqlite3*, int*);
+#else
+# define sqlite3WhereAdviceClear(X)
+#endif
 int sqlite3ExprCodeGetColumn(Parse*, Table*, int, int, int, u8);
 void sqlite3ExprCodeGetColumnOfTable(Vdbe*, Table*, int, int, int);
 void sqlite3ExprCodeMove(Parse*, int, int, int);
@@ -3022,6 +3280,9 @@ void sqlite3FuncDefInsert(FuncDefHash*, FuncDef*);
 FuncDef *sqlite3FindFunction(sqlite3*,const char*,int,int,u8,u8);
 void sqlite3RegisterBuiltinFunctions(sqlite3*);
 void sqlite3RegisterDateTimeFunctions(void);
+#ifndef SQLITE_OMIT_REGEXP
+void sqlite3RegisterRegexpFunctions(void);
+#endif
 void sqlite3RegisterGlobalFunctions(void);
 int sqlite3SafetyCheckOk(sqlite3*);
 int sqlite3SafetyCheckSickOrOk(sqlite3*);
@@ -3136,6 +3397,7 @@ int sqlite3VarintLen(u64 v);
 
 const char *sqlite3IndexAffinityStr(Vdbe *, Index *);
 void sqlite3TableAffinityStr(Vdbe *, Table *);
+int sqlite3TableAffinityInit(sqlite3*, Table*);
 char sqlite3CompareAffinity(Expr *pExpr, char aff2);
 int sqlite3IndexAffinityOk(Expr *pExpr, char idx_affinity);
 char sqlite3ExprAffinity(Expr *pExpr);
@@ -3179,6 +3441,7 @@ int sqlite3ValueFromExpr(sqlite3 *, Expr *, u8, u8, sqlite3_value **);
 void sqlite3ValueApplyAffinity(sqlite3_value *, u8, u8);
 #ifndef SQLITE_AMALGAMATION
 extern const unsigned char sqlite3OpcodeProperty[];
+extern const int sqlite3OpcodeCount;
 extern const unsigned char sqlite3UpperToLower[];
 extern const unsigned char sqlite3CtypeMap[];
 extern const Token sqlite3IntTokens[];
@@ -3210,6 +3473,13 @@ int sqlite3InvokeBusyHandler(BusyHandler*);
 int sqlite3FindDb(sqlite3*, Token*);
 int sqlite3FindDbName(sqlite3 *, const char *);
 int sqlite3AnalysisLoad(sqlite3*,int iDB);
+#if !defined(SQLITE_OMIT_ANALYZE) && !defined(SQLITE_OMIT_LAZY_SCHEMA)
+void sqlite3AnalysisLazyApply(sqlite3*, int, SchemaLazy*);
+void sqlite3AnalysisLazyClear(SchemaLazy*);
+#endif
+#ifndef SQLITE_OMIT_ANALYZE
+int sqlite3AnalysisIsStale(sqlite3*, int, const char*, i64, int);
+#endif
 void sqlite3DeleteIndexSamples(sqlite3*,Index*);
 void sqlite3DefaultRowEst(Index*);
 void sqlite3RegisterLikeFunctions(sqlite3*, int);
@@ -3328,8 +3598,10 @@ fkey.c文件中的函数声明。如果 OMIT_FOREIGN_KEY没有被定义那所有
   int sqlite3FkRequired(Parse*, Table*, int*, int);
   u32 sqlite3FkOldmask(Parse*, Table*);
   FKey *sqlite3FkReferences(Table *);
+  int sqlite3FkBuildActions(Parse*, Table*);
 #else
   #define sqlite3FkActions(a,b,c,d)
+  #define sqlite3FkBuildActions(a,b) 0
   #define sqlite3FkCheck(a,b,c,d)
   #define sqlite3FkDropTable(a,b,c)
   #define sqlite3FkOldmask(a,b)      0
@@ -132,6 +132,36 @@ int sqlite3_db_status(
       break;
     }
 
+    /*
+    ** Per-class lookaside statistics.  The verbs for each class are
+    ** consecutive, in the order HIT, MISS, FULL.
+    */
+    case SQLITE_DBSTATUS_LOOKASIDE_SMALL_HIT:
+    case SQLITE_DBSTATUS_LOOKASIDE_SMALL_MISS:
+    case SQLITE_DBSTATUS_LOOKASIDE_SMALL_FULL:
+    case SQLITE_DBSTATUS_LOOKASIDE_MEDIUM_HIT:
+    case SQLITE_DBSTATUS_LOOKASIDE_MEDIUM_MISS:
+    case SQLITE_DBSTATUS_LOOKASIDE_MEDIUM_FULL:
+    case SQLITE_DBSTATUS_LOOKASIDE_LARGE_HIT:
+    case SQLITE_DBSTATUS_LOOKASIDE_LARGE_MISS:
+    case SQLITE_DBSTATUS_LOOKASIDE_LARGE_FULL: {
+      int iClass = (op - SQLITE_DBSTATUS_LOOKASIDE_SMALL_HIT)/3;
+      int iStat = (op - SQLITE_DBSTATUS_LOOKASIDE_SMALL_HIT)%3;
+      assert( iClass>=0 && iClass<LOOKASIDE_NCLASS );
+      *pCurrent = db->lookaside.anOut[iClass];
+      *pHighwater = db->lookaside.aClassStat[iClass][iStat];
+      if( resetFlag ){
+        db->lookaside.aClassStat[iClass][iStat] = 0;
+      }
+      break;
+    }
+
+    case SQLITE_DBSTATUS_LOOKASIDE_GROWTH: {
+      *pCurrent = db->lookaside.nChunk;
+      *pHighwater = db->lookaside.nChunkMax;
+      break;
+    }
+
     /* 
     ** Return an approximation for the amount of memory currently used
     ** by all pagers associated with the given database connection.  The
@@ -180,6 +210,19 @@ int sqlite3_db_status(
           nByte += sqlite3MallocSize(pSchema->trigHash.ht);
           nByte += sqlite3MallocSize(pSchema->idxHash.ht);
           nByte += sqlite3MallocSize(pSchema->fkeyHash.ht);
+#ifndef SQLITE_OMIT_LAZY_SCHEMA
+          nByte += sqlite3GlobalConfig.m.xRoundup(sizeof(HashElem))
+                     * pSchema->lazyHash.count;
+          nByte += sqlite3MallocSize(pSchema->lazyHash.ht);
+          for(p=sqliteHashFirst(&pSchema->lazyHash); p; p=sqliteHashNext(p)){
+            SchemaLazy *pLazy = (SchemaLazy*)sqliteHashData(p);
+            if( pLazy->pTab==pLazy ){
+              for(; pLazy; pLazy=pLazy->pNext){
+                nByte += sqlite3MallocSize(pLazy);
+              }
+            }
+          }
+#endif
 
           for(p=sqliteHashFirst(&pSchema->trigHash); p; p=sqliteHashNext(p)){
             sqlite3DeleteTrigger(db, (Trigger*)sqliteHashData(p));
@@ -1324,7 +1324,17 @@ static int test_db_status(
     { "LOOKASIDE_MISS_FULL", SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL },
     { "CACHE_HIT",           SQLITE_DBSTATUS_CACHE_HIT           },
     { "CACHE_MISS",          SQLITE_DBSTATUS_CACHE_MISS          },
-    { "CACHE_WRITE",         SQLITE_DBSTATUS_CACHE_WRITE         }
+    { "CACHE_WRITE",         SQLITE_DBSTATUS_CACHE_WRITE         },
+    { "LOOKASIDE_SMALL_HIT",   SQLITE_DBSTATUS_LOOKASIDE_SMALL_HIT   },
+    { "LOOKASIDE_SMALL_MISS",  SQLITE_DBSTATUS_LOOKASIDE_SMALL_MISS  },
+    { "LOOKASIDE_SMALL_FULL",  SQLITE_DBSTATUS_LOOKASIDE_SMALL_FULL  },
+    { "LOOKASIDE_MEDIUM_HIT",  SQLITE_DBSTATUS_LOOKASIDE_MEDIUM_HIT  },
+    { "LOOKASIDE_MEDIUM_MISS", SQLITE_DBSTATUS_LOOKASIDE_MEDIUM_MISS },
+    { "LOOKASIDE_MEDIUM_FULL", SQLITE_DBSTATUS_LOOKASIDE_MEDIUM_FULL },
+    { "LOOKASIDE_LARGE_HIT",   SQLITE_DBSTATUS_LOOKASIDE_LARGE_HIT   },
+    { "LOOKASIDE_LARGE_MISS",  SQLITE_DBSTATUS_LOOKASIDE_LARGE_MISS  },
+    { "LOOKASIDE_LARGE_FULL",  SQLITE_DBSTATUS_LOOKASIDE_LARGE_FULL  },
+    { "LOOKASIDE_GROWTH",      SQLITE_DBSTATUS_LOOKASIDE_GROWTH      }
   };
   Tcl_Obj *pResult;
   if( objc!=4 ){
@@ -394,6 +394,139 @@ static int clock_seconds_proc(
   return TCL_OK;
 }
 
+#ifndef SQLITE_OMIT_SHARED_SCHEMA
+/*
+** State shared by [sqlite3_shared_schema_ddl] and the thread it starts.
+*/
+typedef struct SchemaDdlTest SchemaDdlTest;
+struct SchemaDdlTest {
+  sqlite3 *db;             /* Connection used by the reading thread */
+  int nIter;               /* Number of queries to run */
+  int nError;              /* Number of queries that failed */
+};
+
+/*
+** Run "SELECT count(*) FROM v1" SchemaDdlTest.nIter times, counting the
+** queries that fail.
+*/
+static Tcl_ThreadCreateType schemaDdlReader(ClientData pArg){
+  SchemaDdlTest *p = (SchemaDdlTest *)pArg;
+  int i;
+  for(i=0; i<p->nIter; i++){
+    sqlite3_stmt *pStmt = 0;
+    int rc = sqlite3_prepare_v2(p->db, "SELECT count(*) FROM v1", -1,&pStmt,0);
+    if( rc==SQLITE_OK ){
+      while( sqlite3_step(pStmt)==SQLITE_ROW ){}
+      rc = sqlite3_finalize(pStmt);
+    }
+    if( rc!=SQLITE_OK ) p->nError++;
+  }
+  TCL_THREAD_CREATE_RETURN;
+}
+
+/*
+** Return 1 if connections db1 and db2 use the same schema object for
+** their main databases, loading the schemas first.
+*/
+static int schemaDdlShared(sqlite3 *db1, sqlite3 *db2){
+  const char *zSql = "SELECT count(*) FROM v1";
+  if( sqlite3_exec(db1, zSql, 0, 0, 0) || sqlite3_exec(db2, zSql, 0, 0, 0) ){
+    return 0;
+  }
+  return db1->aDb[0].pSchema==db2->aDb[0].pSchema;
+}
+
+/*
+** Usage: sqlite3_shared_schema_ddl FILENAME NITER
+**
+** Open two connections to database FILENAME with PRAGMA shared_schema
+** on.  A second thread then queries a view through the first connection
+** NITER times while this thread creates and drops an index through the
+** second one NITER times.  The result is a list of four values: 1 if the
+** two connections shared a schema beforehand, the number of queries that
+** failed, the number of DDL statements that failed, and 1 if the two
+** connections share a schema again afterwards.
+*/
+static int shared_schema_ddl_proc(
+  ClientData clientData,
+  Tcl_Interp *interp,
+  int objc,
+  Tcl_Obj *CONST objv[]
+){
+  const int flags = SQLITE_OPEN_READWRITE|SQLITE_OPEN_CREATE
+                  | SQLITE_OPEN_FULLMUTEX;
+  sqlite3 *db1 = 0;
+  sqlite3 *db2 = 0;
+  SchemaDdlTest t;
+  Tcl_ThreadId x;
+  Tcl_Obj *pRes;
+  int bBefore;
+  int bAfter;
+  int nDdlError = 0;
+  int i, rc;
+
+  UNUSED_PARAMETER(clientData);
+  if( objc!=3 ){
+    Tcl_WrongNumArgs(interp, 1, objv, "FILENAME NITER");
+    return TCL_ERROR;
+  }
+  memset(&t, 0, sizeof(t));
+  if( Tcl_GetIntFromObj(interp, objv[2], &t.nIter) ) return TCL_ERROR;
+
+  rc = sqlite3_open_v2(Tcl_GetString(objv[1]), &db1, flags, 0);
+  if( rc==SQLITE_OK ){
+    rc = sqlite3_open_v2(Tcl_GetString(objv[1]), &db2, flags, 0);
+  }
+  if( rc==SQLITE_OK ){
+    sqlite3_busy_timeout(db1, 10000);
+    sqlite3_busy_timeout(db2, 10000);
+    rc = sqlite3_exec(db1, 
+        "PRAGMA shared_schema = ON;"
+        "CREATE TABLE IF NOT EXISTS t1(a, b);"
+        "CREATE VIEW IF NOT EXISTS v1 AS SELECT a, b FROM t1;"
+        "INSERT INTO t1 VALUES(1, 2);", 0, 0, 0
+    );
+  }
+  if( rc==SQLITE_OK ){
+    rc = sqlite3_exec(db2, "PRAGMA shared_schema = ON", 0, 0, 0);
+  }
+  if( rc!=SQLITE_OK ){
+    Tcl_AppendResult(interp, sqlite3_errmsg(db2 ? db2 : db1), 0);
+    sqlite3_close(db1);
+    sqlite3_close(db2);
+    return TCL_ERROR;
+  }
+  bBefore = schemaDdlShared(db1, db2);
+
+  t.db = db1;
+  rc = Tcl_CreateThread(&x, schemaDdlReader, (void *)&t,
+                        TCL_THREAD_STACK_DEFAULT, TCL_THREAD_JOINABLE);
+  if( rc!=TCL_OK ){
+    Tcl_AppendResult(interp, "Error in Tcl_CreateThread()", 0);
+    sqlite3_close(db1);
+    sqlite3_close(db2);
+    return TCL_ERROR;
+  }
+  for(i=0; i<t.nIter; i++){
+    const char *zDdl = (i&1) ? "DROP INDEX IF EXISTS i1"
+                             : "CREATE INDEX IF NOT EXISTS i1 ON t1(a)";
+    if( sqlite3_exec(db2, zDdl, 0, 0, 0)!=SQLITE_OK ) nDdlError++;
+  }
+  Tcl_JoinThread(x, &rc);
+  bAfter = schemaDdlShared(db1, db2);
+
+  pRes = Tcl_NewObj();
+  Tcl_ListObjAppendElement(interp, pRes, Tcl_NewIntObj(bBefore));
+  Tcl_ListObjAppendElement(interp, pRes, Tcl_NewIntObj(t.nError));
+  Tcl_ListObjAppendElement(interp, pRes, Tcl_NewIntObj(nDdlError));
+  Tcl_ListObjAppendElement(interp, pRes, Tcl_NewIntObj(bAfter));
+  sqlite3_close(db1);
+  sqlite3_close(db2);
+  Tcl_SetObjResult(interp, pRes);
+  return TCL_OK;
+}
+#endif /* SQLITE_OMIT_SHARED_SCHEMA */
+
 /*************************************************************************
 ** This block contains the implementation of the [sqlite3_blocking_step]
 ** command available to threads created by [sqlthread spawn] commands. It
@@ -629,6 +762,10 @@ static int blocking_prepare_v2_proc(
 int SqlitetestThread_Init(Tcl_Interp *interp){
   Tcl_CreateObjCommand(interp, "sqlthread", sqlthread_proc, 0, 0);
   Tcl_CreateObjCommand(interp, "clock_seconds", clock_seconds_proc, 0, 0);
+#ifndef SQLITE_OMIT_SHARED_SCHEMA
+  Tcl_CreateObjCommand(interp, 
+      "sqlite3_shared_schema_ddl", shared_schema_ddl_proc, 0, 0);
+#endif
 #if SQLITE_OS_UNIX && defined(SQLITE_ENABLE_UNLOCK_NOTIFY)
   Tcl_CreateObjCommand(interp, "sqlite3_blocking_step", blocking_step_proc,0,0);
   Tcl_CreateObjCommand(interp, 
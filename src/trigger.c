@@ -192,6 +192,7 @@ void sqlite3BeginTrigger(
 		goto trigger_cleanup;
 	}
 	assert(sqlite3SchemaMutexHeld(db, iDb, 0));
+	sqlite3SchemaLazyLoadAll(db, iDb);   /* Triggers are not in Schema.lazyHash */
 	if (sqlite3HashFind(&(db->aDb[iDb].pSchema->trigHash),
 		zName, sqlite3Strlen30(zName))){
 		if (!noErr){
@@ -524,6 +525,7 @@ void sqlite3DropTrigger(Parse *pParse, SrcList *pName, int noErr){
 		int j = (i < 2) ? i ^ 1 : i;  /* Search TEMP before MAIN  搜索TEMP在MAIN之后 */
 		if (zDb && sqlite3StrICmp(db->aDb[j].zName, zDb)) continue;
 		assert(sqlite3SchemaMutexHeld(db, j, 0));
+		sqlite3SchemaLazyLoadAll(db, j);
 		pTrigger = sqlite3HashFind(&(db->aDb[j].pSchema->trigHash), zName, nName);
 		if (pTrigger) break;
 	}
@@ -276,7 +276,9 @@ void sqlite3Update(
   /* Begin generating code. 开始生成代码*/
   v = sqlite3GetVdbe(pParse);
   if( v==0 ) goto update_cleanup;
-  if( pParse->nested==0 ) sqlite3VdbeCountChanges(v);
+  if( pParse->nested==0 ){
+    sqlite3VdbeCountChanges(v);
+  }
   sqlite3BeginWriteOperation(pParse, 1, iDb);
 
 #ifndef SQLITE_OMIT_VIRTUALTABLE
@@ -330,7 +332,7 @@ void sqlite3Update(
   */
   sqlite3VdbeAddOp3(v, OP_Null, 0, regRowSet, regOldRowid);
   pWInfo = sqlite3WhereBegin(
-      pParse, pTabList, pWhere, 0, 0, WHERE_ONEPASS_DESIRED, 0
+      pParse, pTabList, pWhere, 0, 0, 0, WHERE_ONEPASS_DESIRED, 0
   );
   if( pWInfo==0 ) goto update_cleanup;
   okOnePass = pWInfo->okOnePass;
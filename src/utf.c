@@ -240,7 +240,55 @@ u32 sqlite3Utf8Read(
 */ 
 /* #define TRANSLATE_TRACE 1 */
 
+/*
+** Masks used to test eight bytes at a time for 7-bit ASCII characters.
+** UTF_HIBITS has the high bit of every byte set and UTF_ONES has the
+** low bit of every byte set.
+*/
+#define UTF_HIBITS  (0x80808080|(((u64)0x80808080)<<32))
+#define UTF_ONES    (0x01010101|(((u64)0x01010101)<<32))
+
 #ifndef SQLITE_OMIT_UTF16
+/*
+** Return the number of bytes at the start of the n-byte UTF-8 string z
+** that are 7-bit ASCII characters.  The test is done eight bytes at a
+** time using a single 64-bit load, so that runs of plain text can be
+** translated without decoding each character.
+*/
+static int utf8AsciiPrefix(const u8 *z, int n){
+  int i = 0;
+  u64 x;
+  while( i+8<=n ){
+    memcpy(&x, &z[i], 8);
+    if( x & UTF_HIBITS ) break;
+    i += 8;
+  }
+  while( i<n && z[i]<0x80 ) i++;
+  return i;
+}
+
+/*
+** Return the number of 16-bit characters at the start of the n-byte
+** UTF-16 string z that are 7-bit ASCII characters.  bBE is true for
+** big-endian input.  Four characters are tested at a time.
+*/
+static int utf16AsciiPrefix(const u8 *z, int n, int bBE){
+  static const u8 aMask[2][8] = {
+    { 0x80, 0xff, 0x80, 0xff, 0x80, 0xff, 0x80, 0xff },   /* UTF-16LE */
+    { 0xff, 0x80, 0xff, 0x80, 0xff, 0x80, 0xff, 0x80 },   /* UTF-16BE */
+  };
+  int i = 0;
+  u64 x, mask;
+  memcpy(&mask, aMask[bBE], 8);
+  while( i+8<=n ){
+    memcpy(&x, &z[i], 8);
+    if( x & mask ) break;
+    i += 8;
+  }
+  while( i+2<=n && z[i+bBE]<0x80 && z[i+1-bBE]==0 ) i += 2;
+  return i/2;
+}
+
 /*
 ** This routine transforms the internal text encoding used by pMem to
 ** desiredEnc. It is an error if the string is already of the desired
@@ -257,6 +305,8 @@ int sqlite3VdbeMemTranslate(Mem *pMem, u8 desiredEnc){
   unsigned char *zTerm;                 /* 输入结束 */
   unsigned char *z;                     /* 输出迭代器 */
   unsigned int c;
+  int nAscii;                 /* Length of a run of ASCII characters */
+  int i;
 
   assert( pMem->db==0 || sqlite3_mutex_held(pMem->db->mutex) );
   assert( pMem->flags&MEM_Str );
@@ -344,10 +394,21 @@ int sqlite3VdbeMemTranslate(Mem *pMem, u8 desiredEnc){
   }
   z = zOut;
 
+  /* In each of the loops below, runs of 7-bit ASCII characters are
+  ** copied directly, and only the remaining characters are decoded and
+  ** re-encoded one at a time. */
   if( pMem->enc==SQLITE_UTF8 ){
     if( desiredEnc==SQLITE_UTF16LE ){
       /* UTF-8 -> UTF-16 Little-endian */
       while( zIn<zTerm ){
+        nAscii = utf8AsciiPrefix(zIn, (int)(zTerm-zIn));
+        for(i=0; i<nAscii; i++){
+          z[2*i] = zIn[i];
+          z[2*i+1] = 0;
+        }
+        z += 2*nAscii;
+        zIn += nAscii;
+        if( zIn>=zTerm ) break;
         /* c = sqlite3Utf8Read(zIn, zTerm, (const u8**)&zIn); */
         READ_UTF8(zIn, zTerm, c);
         WRITE_UTF16LE(z, c);
@@ -356,6 +417,14 @@ int sqlite3VdbeMemTranslate(Mem *pMem, u8 desiredEnc){
       assert( desiredEnc==SQLITE_UTF16BE );
       /* UTF-8 -> UTF-16 Big-endian */
       while( zIn<zTerm ){
+        nAscii = utf8AsciiPrefix(zIn, (int)(zTerm-zIn));
+        for(i=0; i<nAscii; i++){
+          z[2*i] = 0;
+          z[2*i+1] = zIn[i];
+        }
+        z += 2*nAscii;
+        zIn += nAscii;
+        if( zIn>=zTerm ) break;
         /* c = sqlite3Utf8Read(zIn, zTerm, (const u8**)&zIn); */
         READ_UTF8(zIn, zTerm, c);
         WRITE_UTF16BE(z, c);
@@ -364,19 +433,24 @@ int sqlite3VdbeMemTranslate(Mem *pMem, u8 desiredEnc){
     pMem->n = (int)(z - zOut);
     *z++ = 0;
   }else{
+    int bBE = pMem->enc==SQLITE_UTF16BE;
     assert( desiredEnc==SQLITE_UTF8 );
-    if( pMem->enc==SQLITE_UTF16LE ){
-      /* UTF-16 Little-endian -> UTF-8 */
-      while( zIn<zTerm ){
-        READ_UTF16LE(zIn, zIn<zTerm, c); 
-        WRITE_UTF8(z, c);
+    while( zIn<zTerm ){
+      nAscii = utf16AsciiPrefix(zIn, (int)(zTerm-zIn), bBE);
+      for(i=0; i<nAscii; i++){
+        z[i] = zIn[2*i+bBE];
       }
-    }else{
-      /* UTF-16 Big-endian -> UTF-8 */
-      while( zIn<zTerm ){
+      z += nAscii;
+      zIn += 2*nAscii;
+      if( zIn>=zTerm ) break;
+      if( bBE ){
+        /* UTF-16 Big-endian -> UTF-8 */
         READ_UTF16BE(zIn, zIn<zTerm, c); 
-        WRITE_UTF8(z, c);
+      }else{
+        /* UTF-16 Little-endian -> UTF-8 */
+        READ_UTF16LE(zIn, zIn<zTerm, c); 
       }
+      WRITE_UTF8(z, c);
     }
     pMem->n = (int)(z - zOut);
   }
@@ -470,6 +544,18 @@ int sqlite3Utf8CharLen(const char *zIn, int nByte){
   }
   assert( z<=zTerm );
   while( *z!=0 && z<zTerm ){
+    if( nByte>=0 && zTerm-z>=8 ){
+      /* If the next eight bytes are all non-zero ASCII characters, count
+      ** them with a single test.  This is only done when the length is
+      ** known, so that no bytes past the end of the string are read. */
+      u64 x;
+      memcpy(&x, z, 8);
+      if( ((x | (x-UTF_ONES)) & UTF_HIBITS)==0 ){
+        z += 8;
+        r += 8;
+        continue;
+      }
+    }
     SQLITE_SKIP_UTF8(z);
     r++;
   }
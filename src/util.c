@@ -17,6 +17,7 @@
 */
 #include "sqliteInt.h"
 #include <stdarg.h>
+#include <float.h>
 #ifdef SQLITE_HAVE_ISNAN
 # include <math.h>
 #endif
@@ -357,6 +358,28 @@ do_atof_calc:
     /* In the IEEE 754 standard, zero is signed.
     ** Add the sign if we've seen at least one digit */
     result = (sign<0 && nDigits) ? -(double)0 : (double)0;
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD==0
+  }else if( e<=22 && s<=((i64)1<<53) ){
+    /* Both s and 10^e are exactly representable as doubles, so a single
+    ** multiplication or division gives the correctly rounded result.
+    ** That only holds if the operation is evaluated in double precision.
+    ** Where intermediates are kept in extended precision, as on the x87,
+    ** the result is rounded twice and can be off by one ulp, so the
+    ** general path below is used instead. */
+    static const double aPow10[] = {
+      1.0e+00, 1.0e+01, 1.0e+02, 1.0e+03, 1.0e+04, 1.0e+05, 1.0e+06,
+      1.0e+07, 1.0e+08, 1.0e+09, 1.0e+10, 1.0e+11, 1.0e+12, 1.0e+13,
+      1.0e+14, 1.0e+15, 1.0e+16, 1.0e+17, 1.0e+18, 1.0e+19, 1.0e+20,
+      1.0e+21, 1.0e+22
+    };
+    result = (double)s;
+    if( esign<0 ){
+      result /= aPow10[e];
+    }else{
+      result *= aPow10[e];
+    }
+    if( sign<0 ) result = -result;
+#endif
   } else {
     /* attempt to reduce exponent */
     if( esign>0 ){
@@ -532,17 +532,67 @@ static void registerTrace(FILE *out, int iReg, Mem *p){
 #endif
 
 
-#ifdef VDBE_PROFILE
+#if defined(VDBE_PROFILE) || !defined(SQLITE_OMIT_STMT_SCANSTATUS)
 
 /*
 ** hwtime.h contains inline assembler code for implementing
 ** high-performance timing routines.
 ** hwtime.h包含了内联汇编代码用来执行高性能时间程序(还不清楚是计时还是定时)
+**
+** The scan-status counters are useful even without cycle counts, so
+** they do not require sqlite3Hwtime() to be implemented for the host.
 */
+#ifndef VDBE_PROFILE
+# define SQLITE_HWTIME_OPTIONAL
+#endif
 #include "hwtime.h"
 
 #endif
 
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+/*
+** Return the total number of pages read from disk by all pagers of
+** database connection db.  This is used to attribute page reads to
+** individual opcodes for sqlite3_stmt_scanstatus().
+*/
+static int vdbeScanPageCount(sqlite3 *db){
+  int nPage = 0;
+  int i;
+  for(i=0; i<db->nDb; i++){
+    Btree *pBt = db->aDb[i].pBt;
+    if( pBt ){
+      sqlite3PagerCacheStat(sqlite3BtreePager(pBt), SQLITE_DBSTATUS_CACHE_MISS,
+                            0, &nPage);
+    }
+  }
+  return nPage;
+}
+
+/*
+** Return true if opcode op may cause btree pages to be loaded.  Pages
+** read by any other opcode are charged to the next opcode for which
+** this routine returns true, which avoids querying every pager of the
+** connection once per opcode executed.
+*/
+static int vdbeScanReadsPages(u8 op){
+  switch( op ){
+    case OP_Column:     case OP_Count:      case OP_Transaction:
+    case OP_ReadCookie: case OP_VerifyCookie:
+    case OP_OpenRead:   case OP_OpenWrite:
+    case OP_SeekLt:     case OP_SeekLe:     case OP_SeekGe:
+    case OP_SeekGt:     case OP_Seek:       case OP_NotFound:
+    case OP_Found:      case OP_IsUnique:   case OP_NotExists:
+    case OP_NewRowid:   case OP_Insert:     case OP_InsertInt:
+    case OP_Delete:     case OP_RowKey:     case OP_RowData:
+    case OP_Rowid:      case OP_Last:       case OP_Rewind:
+    case OP_Prev:       case OP_Next:       case OP_IdxInsert:
+    case OP_Destroy:    case OP_Clear:      case OP_IntegrityCk:
+      return 1;
+  }
+  return 0;
+}
+#endif
+
 /*
 ** The CHECK_FOR_INTERRUPT macro defined here looks to see if the
 ** sqlite3_interrupt() routine has been called.  If it has been, then
@@ -672,6 +722,11 @@ int sqlite3VdbeExec(Vdbe *p/* The VDBE */){
 #ifdef VDBE_PROFILE
   u64 start;                 /* CPU clock count at start of opcode */
   int origPc;              /* Program counter at start of opcode */
+#endif
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+  u64 scanStart = 0;         /* CPU clock count at start of opcode */
+  int scanPage = -1;         /* Pages read as of the last sample taken */
+  int scanPc = -1;           /* Program counter at start of opcode */
 #endif
   /* Program counter at start of opcode */
 #endif
@@ -712,6 +767,17 @@ int sqlite3VdbeExec(Vdbe *p/* The VDBE */){
 #ifdef VDBE_PROFILE
     origPc = pc;
     start = sqlite3Hwtime();
+#endif
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+    /* Opcodes of trigger sub-programs are not counted */
+    if( p->anExec && p->pFrame==0 ){
+      p->anExec[pc]++;
+      if( p->anCycle ){
+        scanPc = pc;
+        if( scanPage<0 ) scanPage = vdbeScanPageCount(db);
+        scanStart = sqlite3Hwtime();
+      }
+    }
 #endif
     pOp = &aOp[pc];
 
@@ -1588,6 +1654,23 @@ case OP_Function: {
     ctx.pFunc = ctx.pVdbeFunc->pFunc;
   }
 
+#ifndef SQLITE_OMIT_FUNC_MEMO
+  /* A deterministic function invoked with the same arguments as on its
+  ** previous call from this opcode yields the same result, so reuse it.
+  ** Otherwise remember the arguments so that the result can be cached.
+  */
+  if( ctx.pFunc->flags & SQLITE_FUNC_CONSTANT ){
+    if( sqlite3VdbeFuncMemoLookup(ctx.pVdbeFunc, n, apVal, pOut) ){
+      if( db->mallocFailed ) goto no_mem;
+      REGISTER_TRACE(pOp->p3, pOut);
+      UPDATE_MAX_BLOBSIZE(pOut);
+      break;
+    }
+    ctx.pVdbeFunc = sqlite3VdbeFuncMemoBegin(db, ctx.pVdbeFunc, ctx.pFunc,
+                                             n, apVal);
+  }
+#endif
+
   ctx.s.flags = MEM_Null;
   ctx.s.db = db;
   ctx.s.xDel = 0;
@@ -1648,6 +1731,12 @@ case OP_Function: {
     goto too_big;
   }
 
+#ifndef SQLITE_OMIT_FUNC_MEMO
+  if( (ctx.pFunc->flags & SQLITE_FUNC_CONSTANT)!=0 && !ctx.isError ){
+    sqlite3VdbeFuncMemoEnd(ctx.pVdbeFunc, pOut);
+  }
+#endif
+
 #if 0
   /* The app-defined function has done something that as caused this
   ** statement to expire.  (Perhaps the function called sqlite3_exec()
@@ -2474,9 +2563,6 @@ case OP_Column: {
                      ** *zEndHdr指向索引头后的第一个字节
                      */
   u32 offset;        /* Offset into the data */
-  u32 szField;       /* Number of bytes in the content of a field
-                     ** 
-                     */
   int szHdr;         /* Size of the header size field at start of record */
   int avail;         /* Number of bytes of available data */
   u32 t;             /* A type code from the record header */
@@ -2690,34 +2776,20 @@ case OP_Column: {
     ** 通过扫描头文件以获取数组aType[]和aOffset[]的值。aType[i]存储了第i个列的整型数据，
     ** aOffset[i]存储了从记录的起始地址到第i个列中数据存储的首地址的偏移量。
     */
-    for(i=0; i<nField; i++){
-      if( zIdx<zEndHdr ){
-        aOffset[i] = offset;
-        if( zIdx[0]<0x80 ){
-          t = zIdx[0];
-          zIdx++;
-        }else{
-          zIdx += sqlite3GetVarint32(zIdx, &t);
-        }
-        aType[i] = t;
-        szField = sqlite3VdbeSerialTypeLen(t);
-        offset += szField;
-        if( offset<szField ){  /* True if offset overflows */
-          zIdx = &zEndHdr[1];  /* Forces SQLITE_CORRUPT return below */
-          break;
-        }
-      }else{
-        /* If i is less that nField, then there are fewer fields in this
-        ** record than SetNumColumns indicated there are columns in the
-        ** table. Set the offset for any extra columns not present in
-        ** the record to 0. This tells code below to store the default value
-        ** for the column instead of deserializing a value from the record.
-        ** 如果i小于nField，那么记录中的字段是比SetNumColumns小，SetNumColumns是表中的列数。
-        ** 将offset设置为一个额外的、在记录总不存在的列，并赋值为0。也就是说，下面的代码将
-        ** 这一列赋值为默认值，而不是将记录中反序列化后的值赋值给它。
-        */
-        aOffset[i] = 0;
-      }
+    zIdx = (u8*)sqlite3VdbeHeaderDecode(zIdx, zEndHdr, nField, aType, aOffset,
+                                        &offset, &i);
+
+    /* If i is less that nField, then there are fewer fields in this
+    ** record than SetNumColumns indicated there are columns in the
+    ** table. Set the offset for any extra columns not present in
+    ** the record to 0. This tells code below to store the default value
+    ** for the column instead of deserializing a value from the record.
+    ** 如果i小于nField，那么记录中的字段是比SetNumColumns小，SetNumColumns是表中的列数。
+    ** 将offset设置为一个额外的、在记录总不存在的列，并赋值为0。也就是说，下面的代码将
+    ** 这一列赋值为默认值，而不是将记录中反序列化后的值赋值给它。
+    */
+    for(; i<nField; i++){
+      aOffset[i] = 0;
     }
     sqlite3VdbeMemRelease(&sMem);
     sMem.flags = MEM_Null;
@@ -3442,7 +3514,13 @@ case OP_SetCookie: {       /* in3 */
   sqlite3VdbeMemIntegerify(pIn3);
   /* See note about index shifting on OP_ReadCookie */
   rc = sqlite3BtreeUpdateMeta(pDb->pBt, pOp->p2, (int)pIn3->u.i);
-  if( pOp->p2==BTREE_SCHEMA_VERSION ){
+  if( (pOp->p2==BTREE_SCHEMA_VERSION || pOp->p2==BTREE_FILE_FORMAT)
+   && sqlite3SchemaUnshare(db, pOp->p1)
+  ){
+    /* The schema was shared with other connections and has been dropped.
+    ** It will be read again, with the new cookie, when next used.  Other
+    ** cookies, such as the user version, are not part of the schema. */
+  }else if( pOp->p2==BTREE_SCHEMA_VERSION ){
     /* When the schema cookie changes, record the new cookie internally */
     pDb->pSchema->schema_cookie = (int)pIn3->u.i;
     db->flags |= SQLITE_InternChanges;
@@ -3691,7 +3769,7 @@ case OP_OpenWrite: {
 /*翻译到这里，就ok了*/
 
 
-/* Opcode: OpenEphemeral P1 P2 * P4 P5
+/* Opcode: OpenEphemeral P1 P2 P3 P4 P5
 **
 ** Open a new cursor P1 to a transient table.
 ** The cursor is always opened read/write even if
@@ -3714,6 +3792,13 @@ case OP_OpenWrite: {
 ** in btree.h.  These flags control aspects of the operation of
 ** the btree.  The BTREE_OMIT_JOURNAL and BTREE_SINGLE flags are
 ** added automatically.
+**
+** If P3 is non-zero and P4 is not NULL, the index is only ever written
+** by IdxInsert, probed by Found and NotFound, or read from start to end.
+** In that case an in-memory hash set is used to buffer the index, so
+** that the b-tree is only written if the hash set grows too large or
+** the index is read.  Found and NotFound do not position the cursor
+** while the hash set is in use.
 */
 /* Opcode: OpenAutoindex P1 P2 * P4 *
 **
@@ -3761,6 +3846,11 @@ case OP_OpenEphemeral: {
         pCx->pKeyInfo->enc = ENC(p->db);
       }
       pCx->isTable = 0;
+#ifndef SQLITE_OMIT_VDBEHASH
+      if( rc==SQLITE_OK && pOp->p3 ){
+        rc = sqlite3VdbeHashSetInit(db, pCx);
+      }
+#endif
     }else{
       rc = sqlite3BtreeCursor(pCx->pBt, MASTER_ROOT, 1, 0, pCx->pCursor);
       pCx->isTable = 1;
@@ -3793,6 +3883,119 @@ case OP_SorterOpen: {
   break;
 }
 
+#ifndef SQLITE_OMIT_VDBEHASH
+/* Opcode: HashOpen P1 P2 P3 P4 *
+**
+** Open a new cursor P1 that refers to a transient in-memory hash table.
+** Each entry in the hash table has a key of P2 values and a payload
+** of P3 values.  P4 is a KeyInfo structure that defines the collating
+** sequence used to compare each value of the key.
+*/
+case OP_HashOpen: {
+  VdbeCursor *pCx;
+  assert( pOp->p1>=0 );
+  assert( pOp->p2>0 && pOp->p3>=0 );
+  pCx = allocateCursor(p, pOp->p1, pOp->p2, -1, 0);
+  if( pCx==0 ) goto no_mem;
+  pCx->pKeyInfo = pOp->p4.pKeyInfo;
+  if( pCx->pKeyInfo ) pCx->pKeyInfo->enc = ENC(p->db);
+  pCx->nullRow = 1;
+  rc = sqlite3VdbeHashInit(db, pCx, pOp->p2, pOp->p3);
+  break;
+}
+
+/* Opcode: HashAggLoad P1 P2 P3 P4 *
+**
+** P1 is a hash table cursor opened by OP_HashOpen.  Registers P3 and
+** following hold the GROUP BY key of the current row.  Find the hash
+** table entry for that key, adding a new entry if there is none, and move
+** the payload of the entry (the aggregate accumulators for the group)
+** into the registers starting at P4.  If a new entry is added, those
+** registers are all set to NULL.
+**
+** If there is no entry for the key and the hash table has already used
+** up its memory budget, jump to P2 without changing any registers.  The
+** row must then be aggregated some other way.
+*/
+case OP_HashAggLoad: {        /* jump */
+  VdbeCursor *pC;
+  int bSpill;
+
+  assert( pOp->p1>=0 && pOp->p1<p->nCursor );
+  pC = p->apCsr[pOp->p1];
+  assert( pC!=0 && pC->pHash!=0 );
+  assert( pOp->p3>0 && pOp->p3+pC->nField<=p->nMem+1 );
+  assert( pOp->p4type==P4_INT32 );
+  assert( pOp->p4.i>0 && pOp->p4.i<=p->nMem );
+  rc = sqlite3VdbeHashAggLoad(db, pC, &aMem[pOp->p3], &aMem[pOp->p4.i],
+                              &bSpill);
+  if( bSpill ){
+    pc = pOp->p2 - 1;
+  }
+  break;
+}
+
+/* Opcode: HashAggStore P1 P2 * * *
+**
+** Move the registers starting at P2 back into the payload of the hash
+** table entry most recently loaded by OP_HashAggLoad on cursor P1.  The
+** registers are left holding NULL.
+*/
+case OP_HashAggStore: {
+  VdbeCursor *pC;
+
+  assert( pOp->p1>=0 && pOp->p1<p->nCursor );
+  pC = p->apCsr[pOp->p1];
+  assert( pC!=0 && pC->pHash!=0 );
+  assert( pOp->p2>0 && pOp->p2<=p->nMem );
+  sqlite3VdbeHashAggStore(pC, &aMem[pOp->p2]);
+  break;
+}
+
+/* Opcode: HashRewind P1 P2 P3 * *
+**
+** Move the payload of the first entry in hash table P1 into the registers
+** starting at P3.  Entries are visited in the order in which they were
+** added.  If the hash table is empty, jump immediately to P2.
+*/
+case OP_HashRewind: {        /* jump */
+  VdbeCursor *pC;
+  int res;
+
+  assert( pOp->p1>=0 && pOp->p1<p->nCursor );
+  pC = p->apCsr[pOp->p1];
+  assert( pC!=0 && pC->pHash!=0 );
+  rc = sqlite3VdbeHashRewind(pC, &aMem[pOp->p3], &res);
+  pC->nullRow = (u8)res;
+  if( res ){
+    pc = pOp->p2 - 1;
+  }
+  break;
+}
+
+/* Opcode: HashNext P1 P2 P3 * *
+**
+** Advance hash table cursor P1 to its next entry and move the payload of
+** that entry into the registers starting at P3, then jump to P2.  If
+** there are no more entries, fall through to the next instruction.
+*/
+case OP_HashNext: {        /* jump */
+  VdbeCursor *pC;
+  int res;
+
+  CHECK_FOR_INTERRUPT;
+  assert( pOp->p1>=0 && pOp->p1<p->nCursor );
+  pC = p->apCsr[pOp->p1];
+  assert( pC!=0 && pC->pHash!=0 );
+  rc = sqlite3VdbeHashNext(pC, &aMem[pOp->p3], &res);
+  pC->nullRow = (u8)res;
+  if( res==0 ){
+    pc = pOp->p2 - 1;
+  }
+  break;
+}
+#endif /* SQLITE_OMIT_VDBEHASH */
+
 /* Opcode: OpenPseudo P1 P2 P3 * *
 **
 ** Open a new cursor that points to a fake table that contains a single
@@ -3905,6 +4108,10 @@ case OP_SeekGt: {       /* jump, in3 */
   assert( OP_SeekGe == OP_SeekLt+2 );
   assert( OP_SeekGt == OP_SeekLt+3 );
   assert( pC->isOrdered );
+  if( pC->pHash ){
+    rc = sqlite3VdbeHashSetFlush(db, pC);
+    if( rc!=SQLITE_OK ) goto abort_due_to_error;
+  }
   if( ALWAYS(pC->pCursor!=0) ){
     oc = pOp->opcode;
     pC->nullRow = 0;
@@ -4130,16 +4337,26 @@ case OP_Found: {        /* jump, in3 */
       sqlite3VdbeRecordUnpack(pC->pKeyInfo, pIn3->n, pIn3->z, pIdxKey);
       pIdxKey->flags |= UNPACKED_PREFIX_MATCH;
     }
-    rc = sqlite3BtreeMovetoUnpacked(pC->pCursor, pIdxKey, 0, 0, &res);
+    res = -1;
+#ifndef SQLITE_OMIT_VDBEHASH
+    if( pC->pHash ){
+      rc = sqlite3VdbeHashSetFound(db, pC, pIdxKey, &res);
+    }
+#endif
+    if( res<0 && rc==SQLITE_OK ){
+      rc = sqlite3BtreeMovetoUnpacked(pC->pCursor, pIdxKey, 0, 0, &res);
+      alreadyExists = (res==0);
+      pC->deferredMoveto = 0;
+      pC->cacheStatus = CACHE_STALE;
+    }else{
+      alreadyExists = res;
+    }
     if( pOp->p4.i==0 ){
       sqlite3DbFree(db, pFree);
     }
     if( rc!=SQLITE_OK ){
       break;
     }
-    alreadyExists = (res==0);
-    pC->deferredMoveto = 0;
-    pC->cacheStatus = CACHE_STALE;
   }
   if( pOp->opcode==OP_Found ){
     if( alreadyExists ) pc = pOp->p2 - 1;
@@ -4849,6 +5066,10 @@ case OP_Last: {        /* jump */
   assert( pC!=0 );
   pCrsr = pC->pCursor;
   res = 0;
+  if( pC->pHash ){
+    rc = sqlite3VdbeHashSetFlush(db, pC);
+    if( rc!=SQLITE_OK ) goto abort_due_to_error;
+  }
   if( ALWAYS(pCrsr!=0) ){
     rc = sqlite3BtreeLast(pCrsr, &res);
   }
@@ -4913,6 +5134,10 @@ case OP_Rewind: {        /* jump */
   }else{
     pCrsr = pC->pCursor;
     assert( pCrsr );
+    if( pC->pHash ){
+      rc = sqlite3VdbeHashSetFlush(db, pC);
+      if( rc!=SQLITE_OK ) goto abort_due_to_error;
+    }
     rc = sqlite3BtreeFirst(pCrsr, &res);
     pC->atFirst = res==0 ?1:0;
     pC->deferredMoveto = 0;
@@ -5000,6 +5225,91 @@ case OP_Next: {        /* jump */
   break;
 }
 
+#ifndef SQLITE_OMIT_ANALYZE
+/* Opcode: SampleLeaf P1 P2 P3 * *
+**
+** Move cursor P1 to the first entry of a leaf page of its b-tree chosen
+** at random, reading only the pages on the path down from the root.  Add
+** an estimate of the number of entries in the b-tree to the integer in
+** register P3.  If the b-tree is empty, jump to P2.
+**
+** This opcode and SampleNext are used by sampled ANALYZE.
+*/
+case OP_SampleLeaf: {        /* jump */
+  VdbeCursor *pC;
+  i64 nEst;
+  int res;
+
+  assert( pOp->p1>=0 && pOp->p1<p->nCursor );
+  assert( pOp->p3>0 && pOp->p3<=p->nMem );
+  pC = p->apCsr[pOp->p1];
+  assert( pC!=0 );
+  assert( pC->pCursor!=0 && !isSorter(pC) );
+  res = 1;
+  nEst = 0;
+  rc = sqlite3BtreeSampleLeaf(pC->pCursor, &nEst, &res);
+  if( rc!=SQLITE_OK ) goto abort_due_to_error;
+  pC->atFirst = 0;
+  pC->deferredMoveto = 0;
+  pC->cacheStatus = CACHE_STALE;
+  pC->rowidIsValid = 0;
+  pC->nullRow = (u8)res;
+  pIn3 = &aMem[pOp->p3];
+  memAboutToChange(p, pIn3);
+  sqlite3VdbeMemIntegerify(pIn3);
+  pIn3->u.i += nEst;
+  if( res ){
+    pc = pOp->p2 - 1;
+  }
+  break;
+}
+
+/* Opcode: SampleNext P1 P2 * * *
+**
+** Advance cursor P1 to the next entry on the leaf page that it points to
+** and jump to P2.  If the cursor already points to the last entry of the
+** page, fall through to the following instruction.
+*/
+case OP_SampleNext: {        /* jump */
+  VdbeCursor *pC;
+  int res;
+
+  CHECK_FOR_INTERRUPT;
+  assert( pOp->p1>=0 && pOp->p1<p->nCursor );
+  pC = p->apCsr[pOp->p1];
+  assert( pC!=0 );
+  assert( pC->pCursor!=0 && !isSorter(pC) );
+  res = 1;
+  rc = sqlite3BtreeNextInLeaf(pC->pCursor, &res);
+  if( rc!=SQLITE_OK ) goto abort_due_to_error;
+  pC->cacheStatus = CACHE_STALE;
+  pC->rowidIsValid = 0;
+  if( res==0 ){
+    pc = pOp->p2 - 1;
+  }
+  break;
+}
+
+/* Opcode: AnalysisFresh P1 P2 P3 P4 *
+**
+** Jump to P2 if the statistics of table P4 in database P1 need not be
+** refreshed by an incremental ANALYZE.  Register P3 holds an estimate of
+** the number of rows now in the table and register P3+1 a percentage.
+** The statistics are fresh if the table has an sqlite_stat1 entry and
+** the estimate differs from the row count recorded there by less than
+** that percentage.
+*/
+case OP_AnalysisFresh: {     /* jump, in3 */
+  assert( pOp->p3>0 && pOp->p3<p->nMem );
+  if( !sqlite3AnalysisIsStale(db, pOp->p1, pOp->p4.z,
+                              sqlite3VdbeIntValue(pIn3),
+                              (int)sqlite3VdbeIntValue(&pIn3[1])) ){
+    pc = pOp->p2 - 1;
+  }
+  break;
+}
+#endif /* SQLITE_OMIT_ANALYZE */
+
 /* Opcode: IdxInsert P1 P2 P3 * P5
 **
 ** Register P2 holds an SQL index key made using the
@@ -5033,9 +5343,15 @@ case OP_IdxInsert: {        /* in2 */
     assert( pC->isTable==0 );
     rc = ExpandBlob(pIn2);
     if( rc==SQLITE_OK ){
+      int bSpill = 1;
+#ifndef SQLITE_OMIT_VDBEHASH
+      if( pC->pHash ){
+        rc = sqlite3VdbeHashSetInsert(db, pC, pIn2, &bSpill);
+      }
+#endif
       if( isSorter(pC) ){
         rc = sqlite3VdbeSorterWrite(db, pC, pIn2);
-      }else{
+      }else if( bSpill && rc==SQLITE_OK ){
         nKey = pIn2->n;
         zKey = pIn2->z;
         rc = sqlite3BtreeInsert(pCrsr, zKey, nKey, "", 0, 0, pOp->p3, 
@@ -5109,7 +5425,9 @@ case OP_Destroy: {     /* out2-prerelease */
     pOut->u.i = iMoved;
 #ifndef SQLITE_OMIT_AUTOVACUUM
     if( rc==SQLITE_OK && iMoved!=0 ){
-      sqlite3RootPageMoved(db, iDb, iMoved, pOp->p1);
+      if( sqlite3SchemaUnshare(db, iDb)==0 ){
+        sqlite3RootPageMoved(db, iDb, iMoved, pOp->p1);
+      }
       /* All OP_Destroy operations occur on the same btree */
       assert( resetSchemaOnFault==0 || resetSchemaOnFault==iDb+1 );
       resetSchemaOnFault = iDb+1;
@@ -5241,6 +5559,11 @@ case OP_ParseSchema: {
 
   iDb = pOp->p1;
   assert( iDb>=0 && iDb<db->nDb );
+  if( sqlite3SchemaUnshare(db, iDb) ){
+    /* The schema was shared with other connections and has been dropped.
+    ** It will be read again, including the new objects, when next used. */
+    break;
+  }
   assert( DbHasProperty(db, iDb, DB_SchemaLoaded) );
   /* Used to be a conditional */ {
     zMaster = SCHEMA_TABLE(iDb);
@@ -5277,11 +5600,17 @@ case OP_ParseSchema: {
 ** of that table into the internal index hash table.  This will cause
 ** the analysis to be used when preparing all subsequent queries.
 读数据库P1的表sqlite_stat1和把那张表的内容加载到内部索引hash表。这将导致分析准备所有后续查询时使用。
-
+**
+** The statistics loaded are those of the current transaction.  If it is
+** rolled back, the schema is reloaded along with the statistics that
+** were last committed.
 */
 case OP_LoadAnalysis: {
   assert( pOp->p1>=0 && pOp->p1<db->nDb );
-  rc = sqlite3AnalysisLoad(db, pOp->p1);
+  if( sqlite3SchemaUnshare(db, pOp->p1)==0 ){
+    rc = sqlite3AnalysisLoad(db, pOp->p1);
+    db->flags |= SQLITE_InternChanges;
+  }
   break;  
 }
 #endif /* !defined(SQLITE_OMIT_ANALYZE) */
@@ -5295,7 +5624,9 @@ case OP_LoadAnalysis: {
 拆卸内部的描述数据库P1的P4表的数据结构(内存)。这就是以降序的索引命名，是为了保持内部表示的模式与什么是磁盘上的一致。
 */
 case OP_DropTable: {
-  sqlite3UnlinkAndDeleteTable(db, pOp->p1, pOp->p4.z);
+  if( sqlite3SchemaUnshare(db, pOp->p1)==0 ){
+    sqlite3UnlinkAndDeleteTable(db, pOp->p1, pOp->p4.z);
+  }
   break;
 }
 
@@ -5308,7 +5639,9 @@ case OP_DropTable: {
 拆卸内部的描述数据库P1的指数P4的数据结构(内存)。这就是以降序的索引命名，是为了保持内部表示的模式与什么是磁盘上的一致。
 */
 case OP_DropIndex: {
-  sqlite3UnlinkAndDeleteIndex(db, pOp->p1, pOp->p4.z);
+  if( sqlite3SchemaUnshare(db, pOp->p1)==0 ){
+    sqlite3UnlinkAndDeleteIndex(db, pOp->p1, pOp->p4.z);
+  }
   break;
 }
 
@@ -5322,7 +5655,9 @@ case OP_DropIndex: {
 
 */
 case OP_DropTrigger: {
-  sqlite3UnlinkAndDeleteTrigger(db, pOp->p1, pOp->p4.z);
+  if( sqlite3SchemaUnshare(db, pOp->p1)==0 ){
+    sqlite3UnlinkAndDeleteTrigger(db, pOp->p1, pOp->p4.z);
+  }
   break;
 }
 
@@ -6401,6 +6736,33 @@ case OP_VFilter: {   /* jump */
 }
 #endif /* SQLITE_OMIT_VIRTUALTABLE */
 
+#ifndef SQLITE_OMIT_VIRTUALTABLE
+/* Opcode: VInitIn P1 P2 P3 * *
+**
+** Set register P2 to a value that sqlite3_vtab_in_first() and
+** sqlite3_vtab_in_next() use to step through the right-hand side of an
+** IN operator, held in the b-tree open on cursor P1.  If P3 is true the
+** values are the rowids of P1, otherwise the first field of each key.
+**
+** 把寄存器P2设置为可以遍历游标P1中IN运算符右边所有值的对象。
+*/
+case OP_VInitIn: {        /* out2-prerelease */
+  VdbeCursor *pC;
+  ValueList *pRhs;
+
+  pC = p->apCsr[pOp->p1];
+  assert( pC!=0 && pC->pCursor!=0 );
+  pRhs = sqlite3_malloc(sizeof(*pRhs));
+  if( pRhs==0 ) goto no_mem;
+  pRhs->pCsr = pC->pCursor;
+  pRhs->bRowid = (u8)pOp->p3;
+  pRhs->pOut = 0;
+  sqlite3VdbeMemSetStr(pOut, (char*)pRhs, sizeof(*pRhs), 0,
+                       sqlite3VdbeValueListFree);
+  break;
+}
+#endif /* SQLITE_OMIT_VIRTUALTABLE */
+
 #ifndef SQLITE_OMIT_VIRTUALTABLE
 /* Opcode: VColumn P1 P2 P3 * *
 **
@@ -6749,6 +7111,18 @@ switch语句的情况下上面这一行,都应当缩进
 *****************************************************************************/
     }
 
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+    if( scanPc>=0 ){
+      p->anCycle[scanPc] += sqlite3Hwtime() - scanStart;
+      if( vdbeScanReadsPages(aOp[scanPc].opcode) ){
+        int nPage = vdbeScanPageCount(db);
+        p->anPage[scanPc] += nPage - scanPage;
+        scanPage = nPage;
+      }
+      scanPc = -1;
+    }
+#endif
+
 #ifdef VDBE_PROFILE
     {
       u64 elapsed = sqlite3Hwtime() - start;
@@ -230,7 +230,25 @@ char *sqlite3VdbeExpandSql(Vdbe*, const char*);
 
 void sqlite3VdbeRecordUnpack(KeyInfo*, int, const void*, UnpackedRecord*);//给定nKey字节大小的一条记录的二进制数据存在pKey[]，通过解码记录的第四个参数来填充UnpackedRecord结构实例。
 int sqlite3VdbeRecordCompare(int, const void*, UnpackedRecord*);//这个函数主要用来比较两个表的行数或者指定的索引记录
-UnpackedRecord *sqlite3VdbeAllocUnpackedRecord(KeyInfo *, char *, int, char **);//这个函数被用于给UnpackedRecord结构分配一个足够大的内存空间
+UnpackedRecord *sqlite3VdbeAllocUnpackedRecord(KeyInfo *, char *, int, char **);
+#ifdef SQLITE_ENABLE_STAT4
+int sqlite3VdbeRecordCompareValues(KeyInfo*,int,const void*,int,sqlite3_value**,int*);
+#endif//这个函数被用于给UnpackedRecord结构分配一个足够大的内存空间
+
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+int sqlite3VdbeScanStatus(Vdbe*, int, double, int, const char*, char*);
+void sqlite3VdbeScanStatusVisit(Vdbe*, int, int, int);
+void sqlite3VdbeScanStatusEnd(Vdbe*, int, int);
+#else
+# define sqlite3VdbeScanStatusVisit(V,I,A,B)
+# define sqlite3VdbeScanStatusEnd(V,I,A)
+#endif
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+void sqlite3VdbeScanFeedback(Vdbe*, int, int, char*);
+#endif
+#ifndef SQLITE_OMIT_INDEX_ADVISOR
+void sqlite3VdbeIndexAdvice(Vdbe*, char*, double);
+#endif
 
 #ifndef SQLITE_OMIT_TRIGGER
 void sqlite3VdbeLinkSubProgram(Vdbe *, SubProgram *);//链接子程序对象作为第二个参数传递到Vdbe.pSubProgram链表
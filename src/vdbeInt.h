@@ -38,6 +38,16 @@ typedef unsigned char Bool;
 */
 typedef struct VdbeSorter VdbeSorter;
 
+/* Opaque type used by code in vdbehash.c */
+typedef struct VdbeHash VdbeHash;
+
+/* Loop description used by sqlite3_stmt_scanstatus() */
+typedef struct ScanStatus ScanStatus;
+typedef struct VdbeAdvice VdbeAdvice;
+
+/* Array of parameter values bound by sqlite3_bind_array() */
+typedef struct VdbeArray VdbeArray;
+
 /* Opaque type used by the explainer 这个类型被解释器使用*/
 typedef struct Explain Explain;
 
@@ -77,6 +87,7 @@ struct VdbeCursor {
   i64 movetoTarget;     /* Argument to the deferred sqlite3BtreeMoveto() 对推迟的方法sqlite3BtreeMoveto() 的内容提要*/
   i64 lastRowid;        /* Last rowid from a Next or NextIdx operation最后一个行id来自下一个操作 */
   VdbeSorter *pSorter;  /* Sorter object for OP_SorterOpen cursors OP_SorterOpen指针的分类对象*/
+  VdbeHash *pHash;      /* Hash table or hash set used by this cursor */
 
   /* Result of last sqlite3BtreeMoveto() done by an OP_NotExists or 
   ** OP_IsUnique opcode on this cursor.
@@ -260,6 +271,11 @@ struct Mem {
 */
 struct VdbeFunc {
   FuncDef *pFunc;               /* The definition of the function */
+#ifndef SQLITE_OMIT_FUNC_MEMO
+  Mem *aMemo;                   /* Last arguments and result, deterministic only */
+  int nMemo;                    /* Number of entries in aMemo[] */
+  u8 memoValid;                 /* 1: aMemo[] complete, 2: arguments only */
+#endif
   int nAux;                     /* Number of entries allocated for apAux[] apAux[]方法的入口分配数量*/
   struct AuxData {
     void *pAux;                   /* Aux data for the i-th argument i-th的参数结构体*/
@@ -356,6 +372,7 @@ struct Vdbe {
   u8 usesStmtJournal;     /* True if uses a statement journal 如果使用这个声明日志则为真*/
   u8 readOnly;            /* True for read-only statements 只读声明则为真*/
   u8 isPrepareV2;         /* True if prepared with prepare_v2()用此方法准备则为真 */
+  u8 fetchPending;        /* Current row not yet returned by step_columns() */
   int nChange;            /* Number of db changes made since last reset 自上一次重置数据库引起的数据库变化数目*/
   yDbMask btreeMask;      /* Bitmask of db->aDb[] entries referenced 被引用的数组入口的位掩码*/
   yDbMask lockMask;       /* Subset of btreeMask that requires a lock 位掩码的子集需要一个锁。*/
@@ -382,8 +399,84 @@ struct Vdbe {
   SubProgram *pProgram;   /* Linked list of all sub-programs used by VM虚拟机使用的所有的子程序的关联列表 */
   int nOnceFlag;          /* Size of array aOnceFlag[] 数组的大小*/
   u8 *aOnceFlag;          /* Flags for OP_Once OP_Once的标记*/
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+  int nScan;              /* Entries in aScan[] */
+  ScanStatus *aScan;      /* Loops reported by sqlite3_stmt_scanstatus() */
+  u64 *anExec;            /* Number of times each opcode has run */
+  u64 *anCycle;           /* CPU cycles spent in each opcode, or NULL */
+  u64 *anPage;            /* Pages read from disk by each opcode, or NULL */
+#endif
+#ifndef SQLITE_OMIT_INDEX_ADVISOR
+  int nAdvice;            /* Entries in aAdvice[] */
+  VdbeAdvice *aAdvice;    /* Indexes the planner wanted for this program */
+#endif
+#ifndef SQLITE_OMIT_BIND_ARRAY
+  VdbeArray *aArray;      /* Arrays bound to each variable, or NULL */
+#endif
+};
+
+/*
+** An instance of the following structure describes one loop of a prepared
+** statement for the sqlite3_stmt_scanstatus() interface.  The loop starts
+** at instruction addrLoop and ends just before instruction addrEnd.  The
+** instruction at addrVisit runs once for each row visited by the loop and
+** the instruction at addrOut once for each row the loop passes on.
+*/
+struct ScanStatus {
+  int addrLoop;           /* First instruction of the loop */
+  int addrVisit;          /* Runs once for each row visited */
+  int addrOut;            /* Runs once for each row output */
+  int addrEnd;            /* First instruction after the loop */
+  int iSelectID;          /* The "Select-ID" for this loop */
+  double rEst;            /* Estimated rows output per loop */
+  char *zName;            /* Name of table or index */
+  char *zExplain;         /* EXPLAIN QUERY PLAN text for the loop */
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+  int addrDone;           /* Runs once each time the loop completes */
+  char *zFeedback;        /* Cardinality feedback key, or NULL */
+  u64 nLoopSeen;          /* anExec[addrLoop] when last fed back */
+  u64 nVisitSeen;         /* anExec[addrVisit] when last fed back */
+  u64 nDoneSeen;          /* anExec[addrDone] when last fed back */
+#endif
+};
+
+/*
+** An index that the query planner would have used had it existed.  Each
+** time the VM runs, rBenefit is credited to the index advisor entry
+** with key zKey.
+*/
+struct VdbeAdvice {
+  char *zKey;             /* Index advisor key */
+  double rBenefit;        /* Estimated saving per execution */
+};
+
+/*
+** The values bound to one parameter by sqlite3_bind_array().  Element
+** i of each array is bound to the parameter before sqlite3_step_array()
+** runs the statement for row i.  The arrays belong to the application.
+*/
+struct VdbeArray {
+  int eType;                  /* SQLITE_INTEGER, FLOAT, TEXT, BLOB or 0 */
+  const void *aData;          /* i64[], double[] or pointer[] of values */
+  const int *anData;          /* Bytes in each TEXT or BLOB value, or NULL */
+  const unsigned char *aNull; /* Non-zero entries are bound as NULL */
 };
 
+#ifndef SQLITE_OMIT_VIRTUALTABLE
+/*
+** The right-hand side of an IN operator that a virtual table processes
+** all at once.  OP_VInitIn passes it to xFilter as a blob whose
+** destructor is sqlite3VdbeValueListFree(), and the virtual table reads
+** it using sqlite3_vtab_in_first() and sqlite3_vtab_in_next().
+*/
+typedef struct ValueList ValueList;
+struct ValueList {
+  BtCursor *pCsr;         /* B-tree holding the values */
+  u8 bRowid;              /* Values are the rowids of pCsr, not its keys */
+  sqlite3_value *pOut;    /* Holds the current value, or NULL */
+};
+#endif
+
 /*
 ** The following are allowed values for Vdbe.magic
 **下面的是vdbe标示符被允许取的值
@@ -404,10 +497,20 @@ int sqlite3VdbeCursorMoveto(VdbeCursor*);
 void sqlite3VdbePrintOp(FILE*, int, Op*);
 #endif
 u32 sqlite3VdbeSerialTypeLen(u32);
+const u8 *sqlite3VdbeHeaderDecode(const u8*,const u8*,int,u32*,u32*,u32*,int*);
 u32 sqlite3VdbeSerialType(Mem*, int);
 u32 sqlite3VdbeSerialPut(unsigned char*, int, Mem*, int);
 u32 sqlite3VdbeSerialGet(const unsigned char*, u32, Mem*);
 void sqlite3VdbeDeleteAuxData(VdbeFunc*, int);
+#ifndef SQLITE_OMIT_FUNC_MEMO
+int sqlite3VdbeFuncMemoLookup(VdbeFunc*, int, sqlite3_value**, Mem*);
+VdbeFunc *sqlite3VdbeFuncMemoBegin(sqlite3*,VdbeFunc*,FuncDef*,int,sqlite3_value**);
+void sqlite3VdbeFuncMemoEnd(VdbeFunc*, Mem*);
+void sqlite3VdbeFuncMemoClear(sqlite3*, VdbeFunc*);
+#endif
+#ifndef SQLITE_OMIT_VIRTUALTABLE
+void sqlite3VdbeValueListFree(void*);
+#endif
 
 int sqlite2BtreeKeyCompare(BtCursor *, const void *, int, int, int *);
 int sqlite3VdbeIdxKeyCompare(VdbeCursor*,UnpackedRecord*,int*);
@@ -473,6 +576,22 @@ int sqlite3VdbeSorterWrite(sqlite3 *, const VdbeCursor *, Mem *);
 int sqlite3VdbeSorterCompare(const VdbeCursor *, Mem *, int *);
 #endif
 
+#ifdef SQLITE_OMIT_VDBEHASH
+# define sqlite3VdbeHashClose(Y,Z)
+# define sqlite3VdbeHashSetFlush(Y,Z) SQLITE_OK
+#else
+int sqlite3VdbeHashInit(sqlite3 *, VdbeCursor *, int, int);
+void sqlite3VdbeHashClose(sqlite3 *, VdbeCursor *);
+int sqlite3VdbeHashAggLoad(sqlite3 *, const VdbeCursor *, Mem *, Mem *, int *);
+void sqlite3VdbeHashAggStore(const VdbeCursor *, Mem *);
+int sqlite3VdbeHashRewind(const VdbeCursor *, Mem *, int *);
+int sqlite3VdbeHashNext(const VdbeCursor *, Mem *, int *);
+int sqlite3VdbeHashSetInit(sqlite3 *, VdbeCursor *);
+int sqlite3VdbeHashSetFound(sqlite3 *, VdbeCursor *, UnpackedRecord *, int *);
+int sqlite3VdbeHashSetInsert(sqlite3 *, VdbeCursor *, Mem *, int *);
+int sqlite3VdbeHashSetFlush(sqlite3 *, VdbeCursor *);
+#endif
+
 #if !defined(SQLITE_OMIT_SHARED_CACHE) && SQLITE_THREADSAFE>0
   void sqlite3VdbeEnter(Vdbe*);
   void sqlite3VdbeLeave(Vdbe*);
@@ -131,6 +131,10 @@ int sqlite3_clear_bindings(sqlite3_stmt *pStmt){
     sqlite3VdbeMemRelease(&p->aVar[i]);
     p->aVar[i].flags = MEM_Null;
   }
+#ifndef SQLITE_OMIT_BIND_ARRAY
+  sqlite3DbFree(p->db, p->aArray);
+  p->aArray = 0;
+#endif
   if( p->isPrepareV2 && p->expmask ){
     p->expired = 1;
   }
@@ -188,6 +192,109 @@ int sqlite3_value_type(sqlite3_value* pVal){
   return pVal->type;
 }
 
+#ifndef SQLITE_OMIT_VIRTUALTABLE
+/*
+** Destructor for the ValueList object that OP_VInitIn passes to xFilter.
+*/
+void sqlite3VdbeValueListFree(void *pToDelete){
+  ValueList *pRhs = (ValueList*)pToDelete;
+  sqlite3ValueFree(pRhs->pOut);
+  sqlite3_free(pRhs);
+}
+
+/*
+** Load the value that the cursor of pRhs points to into pRhs->pOut.
+** The cursor holds either rowids or index keys whose first field is
+** the value.
+*/
+static int valueListLoad(ValueList *pRhs){
+  Mem *pOut = pRhs->pOut;
+  int rc;
+
+  if( pRhs->bRowid ){
+    i64 iRowid;
+    rc = sqlite3BtreeKeySize(pRhs->pCsr, &iRowid);
+    if( rc==SQLITE_OK ) sqlite3VdbeMemSetInt64(pOut, iRowid);
+  }else{
+    i64 nKey;
+    u32 nHdr;
+    u32 iSerial;
+    int iHdr;
+    Mem sMem;
+    const u8 *z;
+
+    rc = sqlite3BtreeKeySize(pRhs->pCsr, &nKey);
+    if( rc!=SQLITE_OK ) return rc;
+    memset(&sMem, 0, sizeof(sMem));
+    sMem.db = pOut->db;
+    rc = sqlite3VdbeMemFromBtree(pRhs->pCsr, 0, (int)nKey, 1, &sMem);
+    if( rc!=SQLITE_OK ) return rc;
+    z = (const u8*)sMem.z;
+    iHdr = getVarint32(z, nHdr);
+    sqlite3VdbeMemSetNull(pOut);
+    if( nHdr>(u32)nKey || iHdr>=(int)nHdr ){
+      rc = SQLITE_CORRUPT_BKPT;
+    }else{
+      getVarint32(&z[iHdr], iSerial);
+      if( sqlite3VdbeSerialTypeLen(iSerial)>(u32)nKey-nHdr ){
+        rc = SQLITE_CORRUPT_BKPT;
+      }else{
+        sqlite3VdbeSerialGet(&z[nHdr], iSerial, pOut);
+        pOut->enc = ENC(pOut->db);
+        rc = sqlite3VdbeMemMakeWriteable(pOut);
+      }
+    }
+    sqlite3VdbeMemRelease(&sMem);
+  }
+  if( rc==SQLITE_OK ) sqlite3VdbeMemStoreType(pOut);
+  return rc;
+}
+
+/*
+** Implementation of sqlite3_vtab_in_first() (if bNext is false) and
+** sqlite3_vtab_in_next() (if bNext is true).  NULL values are skipped,
+** as they can never match.
+*/
+static int valueListStep(sqlite3_value *pVal, sqlite3_value **ppOut, int bNext){
+  ValueList *pRhs;
+  int rc;
+  int res;
+
+  *ppOut = 0;
+  if( pVal==0 || (pVal->flags & MEM_Dyn)==0
+   || pVal->xDel!=sqlite3VdbeValueListFree
+  ){
+    return SQLITE_MISUSE;
+  }
+  pRhs = (ValueList*)pVal->z;
+  if( pRhs->pOut==0 ){
+    pRhs->pOut = sqlite3ValueNew(pVal->db);
+    if( pRhs->pOut==0 ) return SQLITE_NOMEM;
+  }
+  for(;;){
+    if( bNext ){
+      rc = sqlite3BtreeNext(pRhs->pCsr, &res);
+    }else{
+      rc = sqlite3BtreeFirst(pRhs->pCsr, &res);
+    }
+    if( rc!=SQLITE_OK ) return rc;
+    if( res ) return SQLITE_DONE;
+    bNext = 1;
+    rc = valueListLoad(pRhs);
+    if( rc!=SQLITE_OK ) return rc;
+    if( (pRhs->pOut->flags & MEM_Null)==0 ) break;
+  }
+  *ppOut = pRhs->pOut;
+  return SQLITE_OK;
+}
+int sqlite3_vtab_in_first(sqlite3_value *pVal, sqlite3_value **ppOut){
+  return valueListStep(pVal, ppOut, 0);
+}
+int sqlite3_vtab_in_next(sqlite3_value *pVal, sqlite3_value **ppOut){
+  return valueListStep(pVal, ppOut, 1);
+}
+#endif /* SQLITE_OMIT_VIRTUALTABLE */
+
 /**************************** sqlite3_result_  *******************************
 ** The following routines are used by user-defined functions to specify
 ** the function result.
@@ -399,6 +506,7 @@ static int sqlite3Step(Vdbe *p){
     p->rc = SQLITE_NOMEM;
     return SQLITE_NOMEM;
   }
+  p->fetchPending = 0;
 
   if( p->pc<=0 && p->expired ){
     p->rc = SQLITE_SCHEMA;
@@ -500,28 +608,21 @@ end_of_step:
 #endif
 
 /*
-** This is the top-level implementation of sqlite3_step().  Call
-** sqlite3Step() to do most of the work.  If a schema error occurs,
-** call sqlite3Reprepare() and try again.
-** 这是一个顶级实现sqlite3_step()，唤醒sqlite3Step()来做大多数工作。
-** 如果这层出错，调用sqlite3Reprepare()并重试
+** Call sqlite3Step() to run statement v.  If a schema error occurs,
+** call sqlite3Reprepare() and try again.  The caller must hold the
+** database connection mutex.
 */
-int sqlite3_step(sqlite3_stmt *pStmt){
+static int vdbeStepWithRetry(Vdbe *v){
   int rc = SQLITE_OK;      /* Result from sqlite3Step() */
   int rc2 = SQLITE_OK;     /* Result from sqlite3Reprepare() */
-  Vdbe *v = (Vdbe*)pStmt;  /* the prepared statement */
   int cnt = 0;             /* Counter to prevent infinite loop of reprepares */
-  sqlite3 *db;             /* The database connection */
+  sqlite3 *db = v->db;     /* The database connection */
 
-  if( vdbeSafetyNotNull(v) ){//检查vdbe是否为空，是否关闭，
-    return SQLITE_MISUSE_BKPT;
-  }
-  db = v->db;
-  sqlite3_mutex_enter(db->mutex);
+  assert( sqlite3_mutex_held(db->mutex) );
   while( (rc = sqlite3Step(v))==SQLITE_SCHEMA/*执行pStmt语句*/
          && cnt++ < SQLITE_MAX_SCHEMA_RETRY/*编译次数*/
          && (rc2 = rc = sqlite3Reprepare(v))==SQLITE_OK/*重新编译当编译模式发生改变*/ ){
-    sqlite3_reset(pStmt);
+    sqlite3_reset((sqlite3_stmt*)v);
     assert( v->expired==0 );
   }
   if( rc2!=SQLITE_OK && ALWAYS(v->isPrepareV2) && ALWAYS(db->pErr) ){
@@ -546,11 +647,117 @@ int sqlite3_step(sqlite3_stmt *pStmt){
       v->rc = rc = SQLITE_NOMEM;
     }
   }
+  return rc;
+}
+
+/*
+** This is the top-level implementation of sqlite3_step().  Call
+** sqlite3Step() to do most of the work.  If a schema error occurs,
+** call sqlite3Reprepare() and try again.
+** 这是一个顶级实现sqlite3_step()，唤醒sqlite3Step()来做大多数工作。
+** 如果这层出错，调用sqlite3Reprepare()并重试
+*/
+int sqlite3_step(sqlite3_stmt *pStmt){
+  int rc;                  /* Result from vdbeStepWithRetry() */
+  Vdbe *v = (Vdbe*)pStmt;  /* the prepared statement */
+  sqlite3 *db;             /* The database connection */
+
+  if( vdbeSafetyNotNull(v) ){//检查vdbe是否为空，是否关闭，
+    return SQLITE_MISUSE_BKPT;
+  }
+  db = v->db;
+  sqlite3_mutex_enter(db->mutex);
+  rc = vdbeStepWithRetry(v);
   rc = sqlite3ApiExit(db, rc);//退出数据库调用
   sqlite3_mutex_leave(db->mutex);//程序退出之前由相同的线程输入的互斥对象
   return rc;
 }
 
+#ifndef SQLITE_OMIT_BIND_ARRAY
+/*
+** Load element iRow of every array bound by sqlite3_bind_array() into
+** the corresponding variable of VM p.  Return SQLITE_OK or an error code.
+*/
+static int vdbeArrayLoad(Vdbe *p, int iRow){
+  int i;
+  int rc = SQLITE_OK;
+  for(i=0; i<p->nVar && rc==SQLITE_OK; i++){
+    VdbeArray *pArray = &p->aArray[i];
+    Mem *pVar = &p->aVar[i];
+    if( pArray->eType==0 ) continue;
+    if( pArray->aNull && pArray->aNull[iRow] ){
+      sqlite3VdbeMemSetNull(pVar);
+    }else if( pArray->eType==SQLITE_INTEGER ){
+      sqlite3VdbeMemSetInt64(pVar, ((const i64*)pArray->aData)[iRow]);
+    }else if( pArray->eType==SQLITE_FLOAT ){
+      sqlite3VdbeMemSetDouble(pVar, ((const double*)pArray->aData)[iRow]);
+    }else{
+      const char *z = ((const char*const*)pArray->aData)[iRow];
+      int n = pArray->anData ? pArray->anData[iRow] : -1;
+      u8 enc = pArray->eType==SQLITE_TEXT ? SQLITE_UTF8 : 0;
+      rc = sqlite3VdbeMemSetStr(pVar, z, n, enc, SQLITE_STATIC);
+      if( rc==SQLITE_OK && enc ){
+        rc = sqlite3VdbeChangeEncoding(pVar, ENC(p->db));
+      }
+    }
+    if( p->isPrepareV2 &&
+       ((i<32 && p->expmask & ((u32)1 << i)) || p->expmask==0xffffffff)
+    ){
+      p->expired = 1;
+    }
+  }
+  return rc;
+}
+
+/*
+** Run statement pStmt once for each of the first nRow elements of the
+** arrays bound to it by sqlite3_bind_array().  Rows of output are
+** discarded.  Set *pnRow to the number of executions that ran to
+** completion.
+*/
+int sqlite3_step_array(sqlite3_stmt *pStmt, int nRow, int *pnRow){
+  Vdbe *v = (Vdbe*)pStmt;
+  sqlite3 *db;
+  int rc = SQLITE_DONE;
+  int iRow;
+
+  if( pnRow ) *pnRow = 0;
+  if( vdbeSafetyNotNull(v) || nRow<0 ){
+    return SQLITE_MISUSE_BKPT;
+  }
+  db = v->db;
+  sqlite3_mutex_enter(db->mutex);
+  if( v->pc>=0 ){
+    sqlite3VdbeReset(v);
+    sqlite3VdbeRewind(v);
+  }
+  for(iRow=0; iRow<nRow; iRow++){
+    if( v->aArray ){
+      rc = vdbeArrayLoad(v, iRow);
+      if( rc!=SQLITE_OK ){
+        sqlite3Error(db, rc, 0);
+        break;
+      }
+    }
+    do{
+      rc = vdbeStepWithRetry(v);
+    }while( rc==SQLITE_ROW );
+    if( rc!=SQLITE_DONE ){
+      int rc2 = sqlite3VdbeReset(v);
+      sqlite3VdbeRewind(v);
+      if( rc2!=SQLITE_OK ) rc = rc2;
+      break;
+    }
+    sqlite3VdbeReset(v);
+    sqlite3VdbeRewind(v);
+    if( pnRow ) *pnRow = iRow+1;
+  }
+  rc = sqlite3ApiExit(db, rc);
+  sqlite3_mutex_leave(db->mutex);
+  return rc;
+}
+#endif /* SQLITE_OMIT_BIND_ARRAY */
+
 /*
 ** Extract the user data from a sqlite3_context structure and return a
 ** pointer to it.
@@ -675,6 +882,13 @@ void sqlite3_set_auxdata(
     if( !pVdbeFunc ){
       goto failed;
     }
+#ifndef SQLITE_OMIT_FUNC_MEMO
+    if( pCtx->pVdbeFunc==0 ){
+      pVdbeFunc->aMemo = 0;
+      pVdbeFunc->nMemo = 0;
+      pVdbeFunc->memoValid = 0;
+    }
+#endif
     pCtx->pVdbeFunc = pVdbeFunc;
     memset(&pVdbeFunc->apAux[nAux], 0, sizeof(struct AuxData)*(iArg+1-nAux));
     pVdbeFunc->nAux = iArg+1;
@@ -893,6 +1107,115 @@ int sqlite3_column_type(sqlite3_stmt *pStmt, int i){
   return iType;
 }
 
+#ifndef SQLITE_OMIT_STEP_COLUMNS
+/*
+** Copy the current result row of VM p into row iRow of the columnar
+** buffers aCol[].  Return SQLITE_FULL without copying anything if the
+** TEXT and BLOB values of the row do not fit in the space that remains,
+** or SQLITE_NOMEM if a conversion fails.
+*/
+static int vdbeFetchRow(Vdbe *p, sqlite3_column_buffer *aCol, int iRow){
+  int i;
+
+  /* Convert TEXT and BLOB values first and check that they fit */
+  for(i=0; i<p->nResColumn; i++){
+    sqlite3_column_buffer *pCol = &aCol[i];
+    Mem *pVal = &p->pResultSet[i];
+    int n;
+    if( pCol->eType==SQLITE_TEXT ){
+      sqlite3_value_text(pVal);
+    }else if( pCol->eType==SQLITE_BLOB ){
+      sqlite3_value_blob(pVal);
+    }else{
+      continue;
+    }
+    n = sqlite3_value_bytes(pVal);
+    if( n>pCol->nData-pCol->aOffset[iRow] ) return SQLITE_FULL;
+  }
+  if( p->db->mallocFailed ) return SQLITE_NOMEM;
+
+  for(i=0; i<p->nResColumn; i++){
+    sqlite3_column_buffer *pCol = &aCol[i];
+    Mem *pVal = &p->pResultSet[i];
+    int isNull = (pVal->flags & MEM_Null)!=0;
+    switch( pCol->eType ){
+      case SQLITE_INTEGER: {
+        ((sqlite3_int64*)pCol->aData)[iRow] = sqlite3VdbeIntValue(pVal);
+        break;
+      }
+      case SQLITE_FLOAT: {
+        ((double*)pCol->aData)[iRow] = sqlite3VdbeRealValue(pVal);
+        break;
+      }
+      case SQLITE_TEXT:
+      case SQLITE_BLOB: {
+        int iOff = pCol->aOffset[iRow];
+        int n = isNull ? 0 : pVal->n;
+        if( n>0 ) memcpy(&((u8*)pCol->aData)[iOff], pVal->z, n);
+        pCol->aOffset[iRow+1] = iOff+n;
+        break;
+      }
+      default: {
+        continue;
+      }
+    }
+    if( pCol->aNull ) pCol->aNull[iRow] = (unsigned char)isNull;
+  }
+  return SQLITE_OK;
+}
+
+/*
+** Step statement pStmt up to nRow times, copying each result row into
+** the columnar buffers aCol[].
+*/
+int sqlite3_step_columns(
+  sqlite3_stmt *pStmt,
+  int nRow,
+  sqlite3_column_buffer *aCol,
+  int *pnRow
+){
+  Vdbe *v = (Vdbe*)pStmt;
+  sqlite3 *db;
+  int rc = SQLITE_ROW;
+  int iRow = 0;
+  int i;
+
+  if( pnRow ) *pnRow = 0;
+  if( vdbeSafetyNotNull(v) || nRow<0 || aCol==0 ){
+    return SQLITE_MISUSE_BKPT;
+  }
+  db = v->db;
+  sqlite3_mutex_enter(db->mutex);
+  for(i=0; i<v->nResColumn; i++){
+    if( aCol[i].eType==SQLITE_TEXT || aCol[i].eType==SQLITE_BLOB ){
+      aCol[i].aOffset[0] = 0;
+    }
+  }
+  while( iRow<nRow ){
+    int rc2;
+    if( !v->fetchPending ){
+      rc = vdbeStepWithRetry(v);
+      if( rc!=SQLITE_ROW ) break;
+    }
+    v->fetchPending = 0;
+    rc2 = vdbeFetchRow(v, aCol, iRow);
+    if( rc2==SQLITE_FULL ){
+      v->fetchPending = 1;
+      rc = iRow>0 ? SQLITE_ROW : SQLITE_TOOBIG;
+      break;
+    }else if( rc2!=SQLITE_OK ){
+      rc = rc2;
+      break;
+    }
+    iRow++;
+  }
+  if( pnRow ) *pnRow = iRow;
+  rc = sqlite3ApiExit(db, rc);
+  sqlite3_mutex_leave(db->mutex);
+  return rc;
+}
+#endif /* SQLITE_OMIT_STEP_COLUMNS */
+
 /* The following function is experimental and subject to change or
 ** removal
 ** 下面的函数是实验的，并随时更改或删除
@@ -1089,6 +1412,9 @@ static int vdbeUnbind(Vdbe *p, int i){
   pVar = &p->aVar[i];
   sqlite3VdbeMemRelease(pVar);//释放pVar操作码值
   pVar->flags = MEM_Null;//状态置为MEM_Null
+#ifndef SQLITE_OMIT_BIND_ARRAY
+  if( p->aArray ) p->aArray[i].eType = 0;
+#endif
   sqlite3Error(p->db, SQLITE_OK, 0);
 
   /* If the bit corresponding to this variable in Vdbe.expmask is set, then 
@@ -1253,6 +1579,49 @@ int sqlite3_bind_zeroblob(sqlite3_stmt *pStmt, int i, int n){
   }
   return rc;
 }
+#ifndef SQLITE_OMIT_BIND_ARRAY
+int sqlite3_bind_array(
+  sqlite3_stmt *pStmt,
+  int i,
+  int eType,
+  const void *aData,
+  const int *anData,
+  const unsigned char *aNull
+){
+  int rc;
+  Vdbe *p = (Vdbe *)pStmt;
+  if( (eType!=SQLITE_INTEGER && eType!=SQLITE_FLOAT && eType!=SQLITE_TEXT
+        && eType!=SQLITE_BLOB && eType!=SQLITE_NULL)
+   || (eType==SQLITE_BLOB && anData==0)
+   || (eType!=SQLITE_NULL && aData==0)
+  ){
+    return SQLITE_MISUSE_BKPT;
+  }
+  rc = vdbeUnbind(p, i);
+  if( rc==SQLITE_OK ){
+    if( p->aArray==0 ){
+      p->aArray = sqlite3DbMallocZero(p->db, p->nVar*sizeof(VdbeArray));
+    }
+    if( p->aArray ){
+      VdbeArray *pArray = &p->aArray[i-1];
+      if( eType==SQLITE_NULL ){
+        pArray->eType = 0;
+      }else{
+        pArray->eType = eType;
+        pArray->aData = aData;
+        pArray->anData = anData;
+        pArray->aNull = aNull;
+      }
+    }else{
+      rc = SQLITE_NOMEM;
+    }
+    sqlite3Error(p->db, rc, 0);
+    rc = sqlite3ApiExit(p->db, rc);
+    sqlite3_mutex_leave(p->db->mutex);
+  }
+  return rc;
+}
+#endif
 
 /*
 ** Return the number of wildcards that can be potentially bound to.
@@ -1414,3 +1783,103 @@ int sqlite3_stmt_status(sqlite3_stmt *pStmt, int op, int resetFlag){
   if( resetFlag ) pVdbe->aCounter[op-1] = 0;
   return v;
 }
+
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+/*
+** Sum the per-opcode counters in aCount[] for opcodes iFirst through
+** iLast-1.
+*/
+static sqlite3_int64 scanStatusSum(u64 *aCount, int iFirst, int iLast){
+  u64 nSum = 0;
+  int i;
+  for(i=iFirst; i<iLast; i++) nSum += aCount[i];
+  return (sqlite3_int64)nSum;
+}
+
+/*
+** Return information about loop idx of prepared statement pStmt.
+*/
+int sqlite3_stmt_scanstatus(
+  sqlite3_stmt *pStmt,            /* Prepared statement being queried */
+  int idx,                        /* Index of loop to report on */
+  int iScanStatusOp,              /* Which metric to return */
+  void *pOut                      /* OUT: Write the answer here */
+){
+  Vdbe *p = (Vdbe*)pStmt;
+  ScanStatus *pScan;
+  int rc = 0;
+  if( p==0 ) return 1;
+  sqlite3_mutex_enter(p->db->mutex);
+  if( idx<0 || idx>=p->nScan || p->anCycle==0 ){
+    sqlite3_mutex_leave(p->db->mutex);
+    return 1;
+  }
+  pScan = &p->aScan[idx];
+  switch( iScanStatusOp ){
+    case SQLITE_SCANSTAT_NLOOP: {
+      *(sqlite3_int64*)pOut = p->anExec[pScan->addrLoop];
+      break;
+    }
+    case SQLITE_SCANSTAT_NVISIT: {
+      *(sqlite3_int64*)pOut = p->anExec[pScan->addrVisit];
+      break;
+    }
+    case SQLITE_SCANSTAT_NOUT: {
+      *(sqlite3_int64*)pOut = p->anExec[pScan->addrOut];
+      break;
+    }
+    case SQLITE_SCANSTAT_EST: {
+      *(double*)pOut = pScan->rEst;
+      break;
+    }
+    case SQLITE_SCANSTAT_NAME: {
+      *(const char**)pOut = pScan->zName;
+      break;
+    }
+    case SQLITE_SCANSTAT_EXPLAIN: {
+      *(const char**)pOut = pScan->zExplain;
+      break;
+    }
+    case SQLITE_SCANSTAT_SELECTID: {
+      *(int*)pOut = pScan->iSelectID;
+      break;
+    }
+    case SQLITE_SCANSTAT_NPAGE: {
+      *(sqlite3_int64*)pOut =
+          scanStatusSum(p->anPage, pScan->addrLoop, pScan->addrEnd);
+      break;
+    }
+    case SQLITE_SCANSTAT_NCYCLE: {
+      *(sqlite3_int64*)pOut =
+          scanStatusSum(p->anCycle, pScan->addrLoop, pScan->addrEnd);
+      break;
+    }
+    default: {
+      rc = 1;
+      break;
+    }
+  }
+  sqlite3_mutex_leave(p->db->mutex);
+  return rc;
+}
+
+/*
+** Zero all scan-status counters of prepared statement pStmt.
+*/
+void sqlite3_stmt_scanstatus_reset(sqlite3_stmt *pStmt){
+  Vdbe *p = (Vdbe*)pStmt;
+  if( p==0 ) return;
+  sqlite3_mutex_enter(p->db->mutex);
+  if( p->anCycle ){
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+    int i;
+    for(i=0; i<p->nScan; i++){
+      ScanStatus *pScan = &p->aScan[i];
+      pScan->nLoopSeen = pScan->nVisitSeen = pScan->nDoneSeen = 0;
+    }
+#endif
+    memset(p->anExec, 0, p->nOp*3*sizeof(u64));
+  }
+  sqlite3_mutex_leave(p->db->mutex);
+}
+#endif /* SQLITE_OMIT_STMT_SCANSTATUS */
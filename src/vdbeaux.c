@@ -19,6 +19,21 @@
 #include "sqliteInt.h"
 #include "vdbeInt.h"
 
+/*
+** Record headers are scanned HDR_CHUNK bytes at a time to find runs of
+** single-byte serial types.  Use AVX2 or SSE2 when the compiler targets
+** them, and an 8-byte word test otherwise.
+*/
+#if defined(__GNUC__) && defined(__AVX2__) && !defined(SQLITE_DISABLE_SIMD)
+# include <immintrin.h>
+# define HDR_CHUNK 32
+#elif defined(__GNUC__) && defined(__SSE2__) && !defined(SQLITE_DISABLE_SIMD)
+# include <emmintrin.h>
+# define HDR_CHUNK 16
+#else
+# define HDR_CHUNK 8
+#endif
+
 
 
 /*
@@ -96,6 +111,13 @@ void sqlite3VdbeSwap(Vdbe *pA, Vdbe *pB){
   zTmp = pA->zSql;
   pA->zSql = pB->zSql;
   pB->zSql = zTmp;
+#ifndef SQLITE_OMIT_BIND_ARRAY
+  {
+    VdbeArray *aTmp = pA->aArray;
+    pA->aArray = pB->aArray;
+    pB->aArray = aTmp;
+  }
+#endif
   pB->isPrepareV2 = pA->isPrepareV2;
 }
 
@@ -675,6 +697,9 @@ static void freeP4(sqlite3 *db, int p4type, void *p4){
         VdbeFunc *pVdbeFunc = (VdbeFunc *)p4;
         freeEphemeralFunction(db, pVdbeFunc->pFunc);
         if( db->pnBytesFreed==0 ) sqlite3VdbeDeleteAuxData(pVdbeFunc, 0);
+#ifndef SQLITE_OMIT_FUNC_MEMO
+        sqlite3VdbeFuncMemoClear(db, pVdbeFunc);
+#endif
         sqlite3DbFree(db, pVdbeFunc);
         break;
       }
@@ -730,6 +755,149 @@ void sqlite3VdbeLinkSubProgram(Vdbe *pVdbe, SubProgram *p){
   pVdbe->pProgram = p;
 }
 
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+/*
+** Add a loop that starts at instruction addrLoop to the list of loops
+** reported by sqlite3_stmt_scanstatus().  Ownership of the string
+** zExplain, obtained from sqlite3MPrintf(), passes to the VM.
+**
+** The return value is a handle for the new loop to be passed to
+** sqlite3VdbeScanStatusVisit() and sqlite3VdbeScanStatusEnd(), or zero
+** if scan-status collection is not enabled for the database connection.
+*/
+int sqlite3VdbeScanStatus(
+  Vdbe *p,                        /* VM to add the loop to */
+  int addrLoop,                   /* First instruction of the loop */
+  double rEst,                    /* Estimated rows output per loop */
+  int iSelectID,                  /* Select-ID for the loop */
+  const char *zName,              /* Name of table or index, or NULL */
+  char *zExplain                  /* EXPLAIN QUERY PLAN text */
+){
+  sqlite3 *db = p->db;
+  ScanStatus *aNew;
+  ScanStatus *pNew;
+  int bCollect = (db->flags & SQLITE_ScanStatus)!=0;
+
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+  bCollect |= db->bCardFeedback;
+#endif
+  if( bCollect==0 ){
+    sqlite3DbFree(db, zExplain);
+    return 0;
+  }
+  aNew = (ScanStatus*)sqlite3DbRealloc(db, p->aScan,
+                                       (p->nScan+1)*sizeof(ScanStatus));
+  if( aNew==0 ){
+    sqlite3DbFree(db, zExplain);
+    return 0;
+  }
+  p->aScan = aNew;
+  pNew = &aNew[p->nScan++];
+  pNew->addrLoop = addrLoop;
+  pNew->addrVisit = addrLoop;
+  pNew->addrOut = addrLoop;
+  pNew->addrEnd = addrLoop;
+  pNew->iSelectID = iSelectID;
+  pNew->rEst = rEst;
+  pNew->zName = sqlite3DbStrDup(db, zName);
+  pNew->zExplain = zExplain;
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+  pNew->addrDone = 0;
+  pNew->zFeedback = 0;
+  pNew->nLoopSeen = pNew->nVisitSeen = pNew->nDoneSeen = 0;
+#endif
+  return p->nScan;
+}
+
+/*
+** Record the instructions that run once for each row visited and once
+** for each row output by the loop identified by handle iScan.
+*/
+void sqlite3VdbeScanStatusVisit(Vdbe *p, int iScan, int addrVisit, int addrOut){
+  if( iScan>0 ){
+    p->aScan[iScan-1].addrVisit = addrVisit;
+    p->aScan[iScan-1].addrOut = addrOut;
+  }
+}
+
+/*
+** Record the first instruction following the loop identified by handle
+** iScan.
+*/
+void sqlite3VdbeScanStatusEnd(Vdbe *p, int iScan, int addrEnd){
+  if( iScan>0 ){
+    p->aScan[iScan-1].addrEnd = addrEnd;
+  }
+}
+
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+/*
+** Arrange for the number of rows visited by the loop identified by handle
+** iScan to be reported to the cardinality feedback store under key zKey
+** each time the VM is reset.  Instruction addrDone runs once each time
+** the loop runs to completion.  Ownership of zKey, obtained from
+** sqlite3MPrintf(), passes to the VM.
+*/
+void sqlite3VdbeScanFeedback(Vdbe *p, int iScan, int addrDone, char *zKey){
+  ScanStatus *pScan;
+  assert( iScan>0 && iScan<=p->nScan );
+  pScan = &p->aScan[iScan-1];
+  sqlite3DbFree(p->db, pScan->zFeedback);
+  pScan->addrDone = addrDone;
+  pScan->zFeedback = zKey;
+}
+
+/*
+** Report the loops measured since the previous call to the cardinality
+** feedback store.  A loop that did not run to completion each time it
+** was started, for example because a LIMIT was reached, does not visit
+** all of the rows it would otherwise have visited, so nothing is
+** reported for it.
+*/
+static void vdbeScanFeedback(Vdbe *p){
+  int i;
+  if( p->anExec==0 || p->db->bCardFeedback==0 ) return;
+  for(i=0; i<p->nScan; i++){
+    ScanStatus *pScan = &p->aScan[i];
+    if( pScan->zFeedback ){
+      u64 nLoop = p->anExec[pScan->addrLoop] - pScan->nLoopSeen;
+      u64 nVisit = p->anExec[pScan->addrVisit] - pScan->nVisitSeen;
+      u64 nDone = p->anExec[pScan->addrDone] - pScan->nDoneSeen;
+      if( nLoop>0 && nDone>=nLoop ){
+        sqlite3WhereFeedback(p->db, pScan->zFeedback,
+                             (double)nVisit/(double)nLoop);
+      }
+      pScan->nLoopSeen += nLoop;
+      pScan->nVisitSeen += nVisit;
+      pScan->nDoneSeen += nDone;
+    }
+  }
+}
+#endif /* SQLITE_OMIT_CARD_FEEDBACK */
+#endif /* SQLITE_OMIT_STMT_SCANSTATUS */
+
+#ifndef SQLITE_OMIT_INDEX_ADVISOR
+/*
+** Arrange for rBenefit to be credited to the index advisor entry with
+** key zKey each time the VM runs.  Ownership of zKey, obtained from
+** sqlite3MPrintf(), passes to the VM.
+*/
+void sqlite3VdbeIndexAdvice(Vdbe *p, char *zKey, double rBenefit){
+  sqlite3 *db = p->db;
+  VdbeAdvice *aNew;
+  aNew = (VdbeAdvice*)sqlite3DbRealloc(db, p->aAdvice,
+                                       (p->nAdvice+1)*sizeof(VdbeAdvice));
+  if( aNew==0 ){
+    sqlite3DbFree(db, zKey);
+    return;
+  }
+  p->aAdvice = aNew;
+  aNew[p->nAdvice].zKey = zKey;
+  aNew[p->nAdvice].rBenefit = rBenefit;
+  p->nAdvice++;
+}
+#endif /* SQLITE_OMIT_INDEX_ADVISOR */
+
 /*
 ** Change the opcode at addr into OP_Noop 改变操作码的地址为OP_Noop
 */
@@ -1569,6 +1737,7 @@ void sqlite3VdbeRewind(Vdbe *p){
   p->rc = SQLITE_OK;
   p->errorAction = OE_Abort;
   p->magic = VDBE_MAGIC_RUN;
+  p->fetchPending = 0;
   p->nChange = 0;
   p->cacheCtr = 1;
   p->minWriteFileFormat = 255;
@@ -1718,6 +1887,19 @@ void sqlite3VdbeMakeReady(
     }
   }
   p->explain = pParse->explain;
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+  if( p->nScan && p->explain==0 ){
+    /* Cycle and page counts are only needed by sqlite3_stmt_scanstatus().
+    ** Cardinality feedback uses just the execution counts. */
+    int bTiming = (db->flags & SQLITE_ScanStatus)!=0;
+    p->anExec = (u64*)sqlite3DbMallocZero(db,
+                                  p->nOp*(bTiming ? 3 : 1)*sizeof(u64));
+    if( p->anExec && bTiming ){
+      p->anCycle = &p->anExec[p->nOp];
+      p->anPage = &p->anCycle[p->nOp];
+    }
+  }
+#endif
   sqlite3VdbeRewind(p);
 }
 
@@ -1731,6 +1913,7 @@ void sqlite3VdbeFreeCursor(Vdbe *p, VdbeCursor *pCx){
     return;
   }
   sqlite3VdbeSorterClose(p->db, pCx);
+  sqlite3VdbeHashClose(p->db, pCx);
   if( pCx->pBt ){
     sqlite3BtreeClose(pCx->pBt);
     /* The pCx->pCursor will be close automatically, if it exists, by
@@ -2627,6 +2810,14 @@ int sqlite3VdbeReset(Vdbe *p){
     sqlite3DbFree(db, p->zErrMsg);
     p->zErrMsg = 0;
     if( p->runOnlyOnce ) p->expired = 1;
+#ifndef SQLITE_OMIT_INDEX_ADVISOR
+    if( db->bIndexAdvisor ){
+      int i;
+      for(i=0; i<p->nAdvice; i++){
+        sqlite3WhereAdvice(db, p->aAdvice[i].zKey, p->aAdvice[i].rBenefit);
+      }
+    }
+#endif
   }else if( p->rc && p->expired ){
     /* 在第一次调用sqlite3_step()函数之前需要设置数据结构VDBE中的属性expired值。为了数据库设置的一致性
 	因为已经调用了sqlite3_step，同样也需要设置数据库错误的相关信息
@@ -2674,6 +2865,9 @@ int sqlite3VdbeReset(Vdbe *p){
       fclose(out);//关闭文件输出流
     }
   }
+#endif
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+  vdbeScanFeedback(p);
 #endif
   p->magic = VDBE_MAGIC_INIT;
   return p->rc & db->errMask;
@@ -2723,6 +2917,133 @@ void sqlite3VdbeDeleteAuxData(VdbeFunc *pVdbeFunc, int mask){
   }
 }
 
+#ifndef SQLITE_OMIT_FUNC_MEMO
+/*
+** The routines that follow maintain the one-entry result cache that
+** OP_Function keeps for a deterministic (SQLITE_FUNC_CONSTANT) function.
+** VdbeFunc.aMemo[0..nArg-1] holds copies of the arguments of the most
+** recent successful call and aMemo[nArg] holds its result.
+**
+** Two argument lists match only if every pair of values has the same
+** storage class and compares equal using BINARY collation.  Zero-blobs
+** never match.
+*/
+static int funcMemoMatch(Mem *pA, Mem *pB){
+  if( pA->type!=pB->type ) return 0;
+  if( ((pA->flags|pB->flags) & MEM_Zero)!=0 ) return 0;
+  return sqlite3MemCompare(pA, pB, 0)==0;
+}
+
+/*
+** Make pTo a copy of pFrom that owns its string or blob content.
+** sqlite3VdbeMemCopy() alone leaves MEM_Static content shared, and
+** such content (for example a value bound with SQLITE_STATIC, or the
+** copy of a bound value made by OP_Variable) may be changed or freed
+** while the cache entry still refers to it.
+*/
+static int funcMemoSave(Mem *pTo, Mem *pFrom){
+  int rc = sqlite3VdbeMemCopy(pTo, pFrom);
+  if( rc==SQLITE_OK ) rc = sqlite3VdbeMemMakeWriteable(pTo);
+  return rc;
+}
+
+/*
+** If the nArg values in apArg[] match the arguments of the cached call,
+** copy the cached result into pOut and return 1.  Otherwise return 0.
+*/
+int sqlite3VdbeFuncMemoLookup(
+  VdbeFunc *pVdbeFunc,       /* Auxiliary data for this OP_Function */
+  int nArg,                  /* Number of arguments */
+  sqlite3_value **apArg,     /* The arguments of the current call */
+  Mem *pOut                  /* Write the cached result here */
+){
+  int i;
+  if( pVdbeFunc==0 || pVdbeFunc->memoValid!=1 ) return 0;
+  assert( pVdbeFunc->nMemo==nArg+1 );
+  for(i=0; i<nArg; i++){
+    if( !funcMemoMatch(&pVdbeFunc->aMemo[i], (Mem*)apArg[i]) ) return 0;
+  }
+  sqlite3VdbeMemCopy(pOut, &pVdbeFunc->aMemo[nArg]);
+  return 1;
+}
+
+/*
+** Record the arguments of a call that is about to be made.  The
+** VdbeFunc object is allocated if pVdbeFunc is NULL.  The cache stays
+** invalid until sqlite3VdbeFuncMemoEnd() supplies the result, so an
+** error or a memory allocation failure in between merely leaves it
+** empty.
+**
+** Return the VdbeFunc object, which may be different from pVdbeFunc,
+** or NULL if an allocation fails.
+*/
+VdbeFunc *sqlite3VdbeFuncMemoBegin(
+  sqlite3 *db,               /* The database connection */
+  VdbeFunc *pVdbeFunc,       /* Existing auxiliary data, or NULL */
+  FuncDef *pFunc,            /* The function about to be called */
+  int nArg,                  /* Number of arguments */
+  sqlite3_value **apArg      /* The arguments */
+){
+  int i;
+  if( pVdbeFunc==0 ){
+    pVdbeFunc = sqlite3DbMallocZero(db, sizeof(VdbeFunc));
+    if( pVdbeFunc==0 ) return 0;
+    pVdbeFunc->pFunc = pFunc;
+  }
+  if( pVdbeFunc->aMemo==0 ){
+    pVdbeFunc->aMemo = sqlite3DbMallocZero(db, sizeof(Mem)*(nArg+1));
+    if( pVdbeFunc->aMemo==0 ) return pVdbeFunc;
+    pVdbeFunc->nMemo = nArg+1;
+    for(i=0; i<=nArg; i++){
+      pVdbeFunc->aMemo[i].flags = MEM_Null;
+      pVdbeFunc->aMemo[i].db = db;
+    }
+  }
+  assert( pVdbeFunc->nMemo==nArg+1 );
+  pVdbeFunc->memoValid = 0;
+  for(i=0; i<nArg; i++){
+    Mem *pArg = (Mem*)apArg[i];
+    if( (pArg->flags & MEM_Zero)!=0 ) return pVdbeFunc;
+    if( funcMemoSave(&pVdbeFunc->aMemo[i], pArg) ) return pVdbeFunc;
+  }
+  pVdbeFunc->memoValid = 2;
+  return pVdbeFunc;
+}
+
+/*
+** Complete the cache entry started by sqlite3VdbeFuncMemoBegin() using
+** the result of the call in pResult.
+*/
+void sqlite3VdbeFuncMemoEnd(VdbeFunc *pVdbeFunc, Mem *pResult){
+  if( pVdbeFunc==0 || pVdbeFunc->memoValid!=2 ) return;
+  if( funcMemoSave(&pVdbeFunc->aMemo[pVdbeFunc->nMemo-1], pResult) ){
+    pVdbeFunc->memoValid = 0;
+  }else{
+    pVdbeFunc->memoValid = 1;
+  }
+}
+
+/*
+** Free the result cache of pVdbeFunc.  This is only called when the
+** VdbeFunc object itself is about to be freed.  If db->pnBytesFreed is
+** set the memory is only measured, so the Mem objects are left intact.
+*/
+void sqlite3VdbeFuncMemoClear(sqlite3 *db, VdbeFunc *pVdbeFunc){
+  Mem *aMemo = pVdbeFunc->aMemo;
+  if( aMemo ){
+    int i;
+    for(i=0; i<pVdbeFunc->nMemo; i++){
+      if( db->pnBytesFreed ){
+        if( aMemo[i].zMalloc ) sqlite3DbFree(db, aMemo[i].zMalloc);
+      }else{
+        sqlite3VdbeMemRelease(&aMemo[i]);
+      }
+    }
+    sqlite3DbFree(db, aMemo);
+  }
+}
+#endif /* SQLITE_OMIT_FUNC_MEMO */
+
 /*
 将函数sqlite3VdbeDeleteObject的第二个参数关联Vdbe结构相关的资源全部释放掉。sqlite3VdbeDeleteObject和
 sqlite3VdbeDelete最大的不同在于：VdbeDelete仅仅是将从VMs列表和与之对应的数据库连接断开
@@ -2753,6 +3074,26 @@ void sqlite3VdbeDeleteObject(sqlite3 *db, Vdbe *p){
 #if defined(SQLITE_ENABLE_TREE_EXPLAIN)
   sqlite3DbFree(db, p->zExplain);
   sqlite3DbFree(db, p->pExplain);
+#endif
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+  for(i=0; i<p->nScan; i++){
+    sqlite3DbFree(db, p->aScan[i].zName);
+    sqlite3DbFree(db, p->aScan[i].zExplain);
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+    sqlite3DbFree(db, p->aScan[i].zFeedback);
+#endif
+  }
+  sqlite3DbFree(db, p->aScan);
+  sqlite3DbFree(db, p->anExec);
+#endif
+#ifndef SQLITE_OMIT_INDEX_ADVISOR
+  for(i=0; i<p->nAdvice; i++){
+    sqlite3DbFree(db, p->aAdvice[i].zKey);
+  }
+  sqlite3DbFree(db, p->aAdvice);
+#endif
+#ifndef SQLITE_OMIT_BIND_ARRAY
+  sqlite3DbFree(db, p->aArray);
 #endif
   sqlite3DbFree(db, p);//释放数据库运行占用的空间
 }
@@ -2943,6 +3284,97 @@ u32 sqlite3VdbeSerialTypeLen(u32 serial_type){
   }
 }
 
+/*
+** Return the number of leading bytes of z[0..HDR_CHUNK-1] that are
+** less than 0x80.  Each such byte is a complete serial type.
+*/
+static int hdrSingleByteRun(const u8 *z){
+#if HDR_CHUNK==32
+  u32 m = (u32)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)z));
+  return m ? __builtin_ctz(m) : 32;
+#elif HDR_CHUNK==16
+  u32 m = (u32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)z));
+  return m ? __builtin_ctz(m) : 16;
+#else
+  u64 w;
+  int i;
+  memcpy(&w, z, 8);
+  if( (w & (((u64)0x80808080)<<32 | 0x80808080))==0 ) return 8;
+  for(i=0; z[i]<0x80; i++){}
+  return i;
+#endif
+}
+
+/*
+** Decode the serial types of a record header.  zIdx points to the first
+** serial type and zEnd to the first byte past the end of the header.
+** At most nField types are decoded.  Each type is written to aType[i],
+** and the offset of the content of field i is written to aOffset[i].
+** *pOffset is the offset of the content of the first field on entry and
+** the offset just past the last decoded field on return.  The number of
+** fields decoded is written to *pnField.
+**
+** Runs of single-byte serial types, which make up nearly every header,
+** are found HDR_CHUNK bytes at a time and decoded without testing each
+** byte.  Return a pointer to the byte following the last type decoded,
+** or &zEnd[1] if the field offsets overflow.
+*/
+const u8 *sqlite3VdbeHeaderDecode(
+  const u8 *zIdx,         /* First serial type in the header */
+  const u8 *zEnd,         /* First byte past the end of the header */
+  int nField,             /* Maximum number of types to decode */
+  u32 *aType,             /* OUT: Serial type of each field */
+  u32 *aOffset,           /* OUT: Offset of the content of each field */
+  u32 *pOffset,           /* IN/OUT: Offset of the content of the next field */
+  int *pnField            /* OUT: Number of fields decoded */
+){
+  static const u8 aSize[] = { 0, 1, 2, 3, 4, 6, 8, 8, 0, 0, 0, 0 };
+  u32 offset = *pOffset;
+  int i = 0;
+
+  while( i<nField && zIdx<zEnd ){
+    u32 t;
+    u32 szField;
+    if( zEnd-zIdx>=HDR_CHUNK ){
+      u32 iStart = offset;
+      int n = hdrSingleByteRun(zIdx);
+      int k;
+      if( n>nField-i ) n = nField-i;
+      for(k=0; k<n; k++){
+        t = zIdx[k];
+        aType[i+k] = t;
+        aOffset[i+k] = offset;
+        offset += t>=12 ? (t-12)>>1 : aSize[t];
+      }
+      if( offset<iStart ){
+        zIdx = &zEnd[1];
+        break;
+      }
+      zIdx += n;
+      i += n;
+      if( n==HDR_CHUNK || i>=nField ) continue;
+    }
+    aOffset[i] = offset;
+    if( zIdx[0]<0x80 ){
+      t = zIdx[0];
+      zIdx++;
+    }else{
+      zIdx += sqlite3GetVarint32(zIdx, &t);
+    }
+    aType[i] = t;
+    szField = sqlite3VdbeSerialTypeLen(t);
+    offset += szField;
+    if( offset<szField ){
+      zIdx = &zEnd[1];
+      break;
+    }
+    i++;
+  }
+  *pOffset = offset;
+  *pnField = i;
+  return zIdx;
+}
+
 /*如果说我们需要在一个架构上面实现一个混合浮点数（例如：ARM7）那么我们需要讲低四位字节和高四位字节
   交换。然后在返回我们的结果。对于大多数硬件架构来说，不需要这样处理。
   混合浮点数问题在ARM7架构上只会出现在使用GCC时，在ARM7芯片上面不会出现异常。出现这样问题的原因是早期
@@ -3422,6 +3854,43 @@ int sqlite3VdbeRecordCompare(
   }
   return rc;
 }
+
+#ifdef SQLITE_ENABLE_STAT4
+/*
+** Compare the first nVal fields of the record {nKey, pKey} with the nVal
+** values in apVal[], using the collating sequences and sort orders in
+** pKeyInfo.  Set *pRes to a negative, zero or positive value if the
+** record is less than, equal to or greater than the values.
+**
+** This is used by the query planner to locate a set of values among the
+** sqlite_stat4 samples of an index.  SQLITE_NOMEM is returned if a malloc
+** fails.  Otherwise SQLITE_OK.
+*/
+int sqlite3VdbeRecordCompareValues(
+  KeyInfo *pKeyInfo,              /* Description of the record */
+  int nKey, const void *pKey,     /* The record */
+  int nVal,                       /* Number of values in apVal[] */
+  sqlite3_value **apVal,          /* Values to compare the record with */
+  int *pRes                       /* OUT: Result of the comparison */
+){
+  UnpackedRecord *pRec;
+  char *pFree;
+  int i;
+
+  assert( nVal<=pKeyInfo->nField );
+  pRec = sqlite3VdbeAllocUnpackedRecord(pKeyInfo, 0, 0, &pFree);
+  if( pRec==0 ) return SQLITE_NOMEM;
+  for(i=0; i<nVal; i++){
+    /* A shallow copy.  The copies are never released. */
+    memcpy(&pRec->aMem[i], apVal[i], sizeof(Mem));
+  }
+  pRec->nField = (u16)nVal;
+  pRec->flags = UNPACKED_PREFIX_MATCH;
+  *pRes = sqlite3VdbeRecordCompare(nKey, pKey, pRec);
+  sqlite3DbFree(pKeyInfo->db, pFree);
+  return SQLITE_OK;
+}
+#endif /* SQLITE_ENABLE_STAT4 */
  
 
 /*指针pCur指向一个由OP_MakeRecord操作码创造的索引项。读取rowid的值（记录中的最后一个域）并且将这个
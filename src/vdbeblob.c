@@ -201,6 +201,7 @@ int sqlite3_blob_open(
   Table *pTab;
   Parse *pParse = 0;
   Incrblob *pBlob = 0;
+  u8 bShareHeld;
 
   flags = !!flags;                /* flags = (flags ? 1 : 0); */
   *ppBlob = 0;
@@ -219,6 +220,7 @@ int sqlite3_blob_open(
     zErr = 0;
 
     sqlite3BtreeEnterAll(db);
+    bShareHeld = sqlite3SchemaShareEnter(db);
     pTab = sqlite3LocateTable(pParse, 0, zTable, zDb);
     if( pTab && IsVirtual(pTab) ){
       pTab = 0;
@@ -237,6 +239,7 @@ int sqlite3_blob_open(
         pParse->zErrMsg = 0;
       }
       rc = SQLITE_ERROR;
+      sqlite3SchemaShareLeave(db, bShareHeld);
       sqlite3BtreeLeaveAll(db);
       goto blob_open_out;
     }
@@ -254,6 +257,7 @@ int sqlite3_blob_open(
       sqlite3DbFree(db, zErr);
       zErr = sqlite3MPrintf(db, "no such column: \"%s\"", zColumn);
       rc = SQLITE_ERROR;
+      sqlite3SchemaShareLeave(db, bShareHeld);
       sqlite3BtreeLeaveAll(db);
       goto blob_open_out;
     }
@@ -301,6 +305,7 @@ int sqlite3_blob_open(
         sqlite3DbFree(db, zErr);
         zErr = sqlite3MPrintf(db, "cannot open %s column for writing", zFault);
         rc = SQLITE_ERROR;
+        sqlite3SchemaShareLeave(db, bShareHeld);
         sqlite3BtreeLeaveAll(db);
         goto blob_open_out;
       }
@@ -369,6 +374,7 @@ int sqlite3_blob_open(
     pBlob->flags = flags;
     pBlob->iCol = iCol;
     pBlob->db = db;
+    sqlite3SchemaShareLeave(db, bShareHeld);
     sqlite3BtreeLeaveAll(db);
     if( db->mallocFailed ){
       goto blob_open_out;
@@ -0,0 +1,684 @@
+/*
+** 2012 October 2
+**
+** The author disclaims copyright to this source code.  In place of
+** a legal notice, here is a blessing:
+**
+**    May you do good and not evil.
+**    May you find forgiveness for yourself and forgive others.
+**    May you share freely, never taking more than you give.
+**
+*************************************************************************
+** This file contains code for the VdbeHash object, used in concert with
+** a VdbeCursor to group rows by key in memory.  A VdbeHash is an
+** in-memory hash table whose entries each hold a key (an array of Mem
+** values) and an optional payload (a second array of Mem values).
+**
+** The hash table is used to implement GROUP BY aggregation without first
+** sorting the input.  Each entry holds the aggregate accumulators for one
+** group.  The accumulators are moved into VDBE registers before OP_AggStep
+** runs and moved back into the entry afterwards, so the aggregate functions
+** themselves are unaware that a hash table is in use.
+**
+** The amount of memory used by a hash table is bounded.  Once the budget
+** is exhausted no new keys are added.  Lookups for keys that are already
+** present continue to succeed, but lookups for new keys report that the
+** caller must "spill" the row.  The code generator arranges for spilled
+** rows to be aggregated using the usual sorter based algorithm.  Because
+** a key is either added to the table the first time it is seen or never
+** added at all, every group is aggregated entirely by one of the two
+** algorithms.
+**
+** A VdbeHash may also be attached to an ordinary ephemeral index cursor
+** as a "hash set".  In this mode each entry holds a single record blob
+** created by OP_MakeRecord.  Records written to the index by OP_IdxInsert
+** are added to the hash set instead of the b-tree, and OP_Found and
+** OP_NotFound test the hash set.  This is how DISTINCT, UNION and IN
+** membership tests avoid the cost of b-tree inserts and seeks.  If the
+** memory budget is exhausted, or if any opcode needs to read the index
+** in order, the contents of the hash set are written into the b-tree and
+** the hash set is discarded.  The cursor then behaves as it always has.
+*/
+#include "sqliteInt.h"
+#include "vdbeInt.h"
+
+#ifndef SQLITE_OMIT_VDBEHASH
+
+typedef struct VdbeHashEntry VdbeHashEntry;
+
+/*
+** The memory budget of a hash table is the same as the maximum size of
+** an in-memory PMA used by the sorter: the main database cache size
+** multiplied by the page size, but never less than HASH_MIN_WORKING pages.
+*/
+#define HASH_MIN_WORKING 10
+
+/*
+** Values for VdbeHash.aColl[].  Strings are hashed so that any two that
+** compare equal under the key's collating sequence hash to the same
+** value.  This can only be done for the built-in collations.
+*/
+#define HASH_COLL_BINARY   0      /* Hash the bytes as they are */
+#define HASH_COLL_NOCASE   1      /* Fold ASCII upper case to lower first */
+#define HASH_COLL_RTRIM    2      /* Ignore trailing spaces */
+#define HASH_COLL_OTHER    3      /* Application collation: cannot hash */
+
+/*
+** A single entry in the hash table.  The nKey key values followed by the
+** nPayload payload values are stored in the same allocation, immediately
+** following this structure.
+*/
+struct VdbeHashEntry {
+  VdbeHashEntry *pChain;          /* Next entry with the same hash bucket */
+  VdbeHashEntry *pNext;           /* Next entry in insertion order */
+  u32 h;                          /* Hash of the key */
+};
+
+/*
+** Access the key and payload arrays of an entry.
+*/
+#define hashEntryKey(p)        ((Mem*)&((u8*)(p))[ROUND8(sizeof(VdbeHashEntry))])
+#define hashEntryPayload(H,p)  (&hashEntryKey(p)[(H)->nKey])
+
+/*
+** The hash table object.
+*/
+struct VdbeHash {
+  int nKey;                       /* Number of key values per entry */
+  int nPayload;                   /* Number of payload values per entry */
+  u32 nBucket;                    /* Number of slots in aBucket[] */
+  u32 nEntry;                     /* Number of entries in the table */
+  i64 nByte;                      /* Approximate bytes of memory in use */
+  i64 mxByte;                     /* No new entries once nByte exceeds this */
+  int nField;                     /* Hash sets only: record fields hashed */
+  int nColl;                      /* Number of entries in aColl[] */
+  u8 *aColl;                      /* HASH_COLL_* value for each key field */
+  VdbeHashEntry **aBucket;        /* Hash buckets */
+  VdbeHashEntry *pFirst;          /* First entry in insertion order */
+  VdbeHashEntry *pLast;           /* Last entry in insertion order */
+  VdbeHashEntry *pCurrent;        /* Entry loaded by the last Load or Next */
+};
+
+/*
+** Mix a 64-bit integer into a 32-bit hash value.
+*/
+static u32 vdbeHashInt64(u64 x){
+  x ^= x >> 33;
+  x *= (((u64)0xff51afd7)<<32) | 0xed558ccd;
+  x ^= x >> 33;
+  return (u32)x;
+}
+
+/*
+** Compute a hash of the value held in pMem.  Values that compare equal
+** using sqlite3MemCompare() with the collating sequence described by
+** eColl, one of the HASH_COLL_* values, always hash to the same value.
+** In particular the integer 1 and the real value 1.0 hash identically,
+** since GROUP BY considers them equal.
+*/
+static u32 vdbeHashMem(const Mem *pMem, u8 eColl){
+  int f = pMem->flags;
+  if( f & MEM_Null ){
+    return 0x5bd1e995;
+  }
+  if( f & (MEM_Int|MEM_Real) ){
+    /* An integer whose magnitude is 2^53 or more compares equal to any
+    ** real value that it rounds to, and several such integers round to
+    ** the same real.  So integers and integral reals of magnitude less
+    ** than 2^53 are hashed as integers and everything else is hashed as
+    ** the bits of the equivalent real.  The boundary must be the same on
+    ** both sides: the integer 2^53+1 rounds to the real 2^53. */
+    static const double mx53 = (double)(((i64)1)<<53);
+    double r;
+    u64 u;
+    if( f & MEM_Int ){
+      i64 i = pMem->u.i;
+      if( i>-(((i64)1)<<53) && i<(((i64)1)<<53) ){
+        return vdbeHashInt64((u64)i);
+      }
+      r = (double)i;
+    }else{
+      r = pMem->r;
+      if( r>-mx53 && r<mx53 && r==(double)(i64)r ){
+        return vdbeHashInt64((u64)(i64)r);
+      }
+    }
+    memcpy(&u, &r, sizeof(u));
+    return vdbeHashInt64(u);
+  }
+  assert( eColl!=HASH_COLL_OTHER );
+  if( (f & MEM_Str)==0 ) eColl = HASH_COLL_BINARY;
+  {
+    u32 h = (f & MEM_Str) ? 0x01000193 : 0x811c9dc5;
+    const u8 *z = (const u8*)pMem->z;
+    int n = pMem->n;
+    int i;
+    if( eColl==HASH_COLL_RTRIM ){
+      /* Strip trailing spaces, which are two bytes wide in UTF-16 */
+      if( pMem->enc==SQLITE_UTF8 ){
+        while( n>0 && z[n-1]==' ' ) n--;
+      }else{
+        int iSp = (pMem->enc==SQLITE_UTF16LE ? 2 : 1);
+        while( n>1 && z[n-iSp]==' ' && z[n-3+iSp]==0 ) n -= 2;
+      }
+    }
+    if( eColl==HASH_COLL_NOCASE ){
+      /* Folding bytes rather than characters also folds some UTF-16
+      ** code units that NOCASE leaves alone.  That costs only extra
+      ** collisions, as strings equal under NOCASE still hash alike. */
+      for(i=0; i<n; i++){
+        h = (h ^ sqlite3UpperToLower[z[i]]) * 0x01000193;
+      }
+    }else{
+      for(i=0; i<n; i++){
+        h = (h ^ z[i]) * 0x01000193;
+      }
+    }
+    return h;
+  }
+}
+
+/*
+** Return the HASH_COLL_* value for key field i of hash table pHash.
+*/
+#define vdbeHashColl(pHash,i) \
+  ((i)<(pHash)->nColl ? (pHash)->aColl[i] : HASH_COLL_BINARY)
+
+/*
+** Compute the hash of the nKey values in array aKey[].
+*/
+static u32 vdbeHashKey(VdbeHash *pHash, Mem *aKey){
+  u32 h = 0;
+  int i;
+  for(i=0; i<pHash->nKey; i++){
+    h = (h<<5) + h + vdbeHashMem(&aKey[i], vdbeHashColl(pHash, i));
+  }
+  return h;
+}
+
+/*
+** Return true if the key stored in entry p is equal to aKey[].
+*/
+static int vdbeHashKeyEq(const VdbeCursor *pCsr, VdbeHashEntry *p, Mem *aKey){
+  VdbeHash *pHash = pCsr->pHash;
+  KeyInfo *pKeyInfo = pCsr->pKeyInfo;
+  Mem *aEntry = hashEntryKey(p);
+  int i;
+  for(i=0; i<pHash->nKey; i++){
+    CollSeq *pColl = (pKeyInfo && i<pKeyInfo->nField) ? pKeyInfo->aColl[i] : 0;
+    if( sqlite3MemCompare(&aEntry[i], &aKey[i], pColl) ) return 0;
+  }
+  return 1;
+}
+
+/*
+** Double the number of buckets in the hash table.  The inability to
+** allocate a larger bucket array is a performance hit but not an error,
+** so the allocation is marked as benign.
+*/
+static void vdbeHashRehash(VdbeHash *pHash){
+  u32 nNew = pHash->nBucket*2;
+  VdbeHashEntry **aNew;
+  VdbeHashEntry *p;
+
+  sqlite3BeginBenignMalloc();
+  aNew = (VdbeHashEntry**)sqlite3MallocZero(nNew*sizeof(VdbeHashEntry*));
+  sqlite3EndBenignMalloc();
+  if( aNew==0 ) return;
+  for(p=pHash->pFirst; p; p=p->pNext){
+    u32 iBucket = p->h & (nNew-1);
+    p->pChain = aNew[iBucket];
+    aNew[iBucket] = p;
+  }
+  pHash->nByte += (nNew - pHash->nBucket)*sizeof(VdbeHashEntry*);
+  sqlite3_free(pHash->aBucket);
+  pHash->aBucket = aNew;
+  pHash->nBucket = nNew;
+}
+
+/*
+** Add new entry p, with hash h and using approximately nByte bytes of
+** memory, to the hash table.
+*/
+static void vdbeHashLink(VdbeHash *pHash, VdbeHashEntry *p, u32 h, int nByte){
+  p->h = h;
+  p->pChain = pHash->aBucket[h & (pHash->nBucket-1)];
+  pHash->aBucket[h & (pHash->nBucket-1)] = p;
+  if( pHash->pLast ){
+    pHash->pLast->pNext = p;
+  }else{
+    pHash->pFirst = p;
+  }
+  pHash->pLast = p;
+  pHash->nEntry++;
+  pHash->nByte += nByte;
+  if( pHash->nEntry>pHash->nBucket ){
+    vdbeHashRehash(pHash);
+  }
+}
+
+/*
+** Initialize the cursor just opened as a hash table cursor.  Each entry
+** of the table has nKey key values and nPayload payload values.
+*/
+int sqlite3VdbeHashInit(sqlite3 *db, VdbeCursor *pCsr, int nKey, int nPayload){
+  int pgsz;                       /* Page size of main database */
+  int mxCache;                    /* Cache size */
+  VdbeHash *pHash;                /* The new hash table */
+  KeyInfo *pKeyInfo = pCsr->pKeyInfo;
+  int nColl = pKeyInfo ? pKeyInfo->nField : 0;
+  int i;
+
+  assert( nKey>0 && nPayload>=0 );
+  pCsr->pHash = pHash = sqlite3DbMallocZero(db, sizeof(VdbeHash)+nColl);
+  if( pHash==0 ){
+    return SQLITE_NOMEM;
+  }
+  pHash->nColl = nColl;
+  pHash->aColl = (u8*)&pHash[1];
+  pHash->nKey = nKey;
+  pHash->nPayload = nPayload;
+  pHash->nBucket = 64;
+  pHash->aBucket = sqlite3MallocZero(64*sizeof(VdbeHashEntry*));
+  if( pHash->aBucket==0 ){
+    return SQLITE_NOMEM;
+  }
+  pHash->nByte = sizeof(VdbeHash) + 64*sizeof(VdbeHashEntry*);
+
+  pgsz = sqlite3BtreeGetPageSize(db->aDb[0].pBt);
+  mxCache = db->aDb[0].pSchema->cache_size;
+  if( mxCache<HASH_MIN_WORKING ) mxCache = HASH_MIN_WORKING;
+  pHash->mxByte = (i64)mxCache * pgsz;
+
+  for(i=0; i<nColl; i++){
+    CollSeq *pColl = pKeyInfo->aColl[i];
+    if( pColl==0 || sqlite3StrICmp(pColl->zName, "BINARY")==0 ){
+      pHash->aColl[i] = HASH_COLL_BINARY;
+    }else if( sqlite3StrICmp(pColl->zName, "NOCASE")==0 ){
+      pHash->aColl[i] = HASH_COLL_NOCASE;
+    }else if( sqlite3StrICmp(pColl->zName, "RTRIM")==0 ){
+      pHash->aColl[i] = HASH_COLL_RTRIM;
+    }else{
+      pHash->aColl[i] = HASH_COLL_OTHER;
+    }
+  }
+  return SQLITE_OK;
+}
+
+/*
+** Free any cursor components allocated by sqlite3VdbeHashXXX routines.
+** The payload of any entry that has not been consumed is released,
+** which finalizes any aggregate contexts it holds.
+*/
+void sqlite3VdbeHashClose(sqlite3 *db, VdbeCursor *pCsr){
+  VdbeHash *pHash = pCsr->pHash;
+  if( pHash ){
+    VdbeHashEntry *p;
+    VdbeHashEntry *pNext;
+    for(p=pHash->pFirst; p; p=pNext){
+      Mem *a = hashEntryKey(p);
+      int i;
+      pNext = p->pNext;
+      for(i=0; i<pHash->nKey+pHash->nPayload; i++){
+        sqlite3VdbeMemRelease(&a[i]);
+      }
+      sqlite3DbFree(db, p);
+    }
+    sqlite3_free(pHash->aBucket);
+    sqlite3DbFree(db, pHash);
+    pCsr->pHash = 0;
+  }
+}
+
+/*
+** Look up the key aKey[] in the hash table.  If the key is found, the
+** entry becomes the current entry and *ppEntry is set to point to it.
+**
+** If the key is not found and the memory budget allows, a new entry
+** holding a copy of the key and a NULL payload is added to the table,
+** becomes the current entry and *ppEntry is set to point to it.
+** Otherwise *ppEntry is set to NULL and there is no current entry.
+*/
+static int vdbeHashFindOrAdd(
+  sqlite3 *db,                    /* Database connection */
+  const VdbeCursor *pCsr,         /* Hash table cursor */
+  Mem *aKey,                      /* Key to look up */
+  VdbeHashEntry **ppEntry         /* OUT: Entry for key aKey[] */
+){
+  VdbeHash *pHash = pCsr->pHash;
+  VdbeHashEntry *p;
+  Mem *aNew;
+  u32 h;
+  int nMem;
+  int nByte;
+  int i;
+  int rc = SQLITE_OK;
+
+  for(i=0; i<pHash->nKey; i++){
+    if( (rc = ExpandBlob(&aKey[i]))!=SQLITE_OK ) return rc;
+  }
+  h = vdbeHashKey(pHash, aKey);
+  for(p=pHash->aBucket[h & (pHash->nBucket-1)]; p; p=p->pChain){
+    if( p->h==h && vdbeHashKeyEq(pCsr, p, aKey) ) break;
+  }
+  if( p==0 && pHash->nByte<pHash->mxByte ){
+    nMem = pHash->nKey + pHash->nPayload;
+    nByte = ROUND8(sizeof(VdbeHashEntry)) + nMem*sizeof(Mem);
+    p = (VdbeHashEntry*)sqlite3DbMallocZero(db, nByte);
+    if( p==0 ) return SQLITE_NOMEM;
+    aNew = hashEntryKey(p);
+    for(i=0; i<nMem; i++){
+      aNew[i].flags = MEM_Null;
+      aNew[i].db = db;
+    }
+    for(i=0; i<pHash->nKey; i++){
+      rc = sqlite3VdbeMemCopy(&aNew[i], &aKey[i]);
+      if( rc ) break;
+      if( aNew[i].flags & (MEM_Str|MEM_Blob) ) nByte += aNew[i].n;
+    }
+    if( rc ){
+      for(i=0; i<pHash->nKey; i++) sqlite3VdbeMemRelease(&aNew[i]);
+      sqlite3DbFree(db, p);
+      return rc;
+    }
+    vdbeHashLink(pHash, p, h, nByte);
+  }
+  pHash->pCurrent = p;
+  *ppEntry = p;
+  return rc;
+}
+
+/*
+** Return the number of bytes of dynamic memory held by the nPayload
+** values in a[].  For an aggregate accumulator this is the size of the
+** aggregate context.
+*/
+static i64 vdbeHashPayloadBytes(VdbeHash *pHash, Mem *a){
+  i64 nByte = 0;
+  int i;
+  for(i=0; i<pHash->nPayload; i++){
+    if( a[i].zMalloc ) nByte += sqlite3DbMallocSize(a[i].db, a[i].zMalloc);
+  }
+  return nByte;
+}
+
+/*
+** Move the payload of the current entry into registers aOut[], or set
+** those registers to NULL if there is no current entry.  The memory
+** held by the payload is no longer counted against the budget until
+** it is moved back by sqlite3VdbeHashAggStore().
+*/
+static void vdbeHashLoadPayload(VdbeHash *pHash, Mem *aOut){
+  int i;
+  if( pHash->pCurrent ){
+    Mem *aPayload = hashEntryPayload(pHash, pHash->pCurrent);
+    pHash->nByte -= vdbeHashPayloadBytes(pHash, aPayload);
+    for(i=0; i<pHash->nPayload; i++){
+      sqlite3VdbeMemMove(&aOut[i], &aPayload[i]);
+    }
+  }else{
+    for(i=0; i<pHash->nPayload; i++){
+      sqlite3VdbeMemSetNull(&aOut[i]);
+    }
+  }
+}
+
+/*
+** Find the entry for the nKey values in aKey[], adding a new entry if
+** there is none and the memory budget allows.  The payload of the entry
+** (the aggregate accumulators for the group) is then moved into the
+** nPayload registers starting at aAcc[].  For a new entry the registers
+** are all set to NULL.
+**
+** If the key is not present and cannot be added because the table is
+** full, *pbSpill is set to 1 and aAcc[] is not modified.  Otherwise
+** *pbSpill is set to 0.
+*/
+int sqlite3VdbeHashAggLoad(
+  sqlite3 *db,                    /* Database connection */
+  const VdbeCursor *pCsr,         /* Hash table cursor */
+  Mem *aKey,                      /* Group key */
+  Mem *aAcc,                      /* OUT: Accumulator registers */
+  int *pbSpill                    /* OUT: True if the row must be spilled */
+){
+  VdbeHashEntry *p = 0;
+  int rc;
+
+  rc = vdbeHashFindOrAdd(db, pCsr, aKey, &p);
+  *pbSpill = (p==0);
+  if( p ){
+    vdbeHashLoadPayload(pCsr->pHash, aAcc);
+  }
+  return rc;
+}
+
+/*
+** Move the accumulator registers aAcc[] back into the payload of the
+** current entry.  This is a no-op if there is no current entry.  The
+** memory held by the accumulators, which may grow as rows are added to
+** the group, is counted against the memory budget.
+*/
+void sqlite3VdbeHashAggStore(const VdbeCursor *pCsr, Mem *aAcc){
+  VdbeHash *pHash = pCsr->pHash;
+  if( pHash->pCurrent ){
+    Mem *aPayload = hashEntryPayload(pHash, pHash->pCurrent);
+    int i;
+    pHash->nByte += vdbeHashPayloadBytes(pHash, aAcc);
+    for(i=0; i<pHash->nPayload; i++){
+      sqlite3VdbeMemMove(&aPayload[i], &aAcc[i]);
+    }
+  }
+}
+
+/*
+** Make the first entry of the hash table the current entry and move its
+** payload into the registers aAcc[].  Set *pbEof to true if the table is
+** empty.
+*/
+int sqlite3VdbeHashRewind(const VdbeCursor *pCsr, Mem *aAcc, int *pbEof){
+  VdbeHash *pHash = pCsr->pHash;
+  pHash->pCurrent = pHash->pFirst;
+  *pbEof = (pHash->pCurrent==0);
+  if( !*pbEof ) vdbeHashLoadPayload(pHash, aAcc);
+  return SQLITE_OK;
+}
+
+/*
+** Advance to the next entry in insertion order and move its payload
+** into the registers aAcc[].  Set *pbEof to true if there are no more
+** entries.
+*/
+int sqlite3VdbeHashNext(const VdbeCursor *pCsr, Mem *aAcc, int *pbEof){
+  VdbeHash *pHash = pCsr->pHash;
+  if( pHash->pCurrent ){
+    pHash->pCurrent = pHash->pCurrent->pNext;
+  }
+  *pbEof = (pHash->pCurrent==0);
+  if( !*pbEof ) vdbeHashLoadPayload(pHash, aAcc);
+  return SQLITE_OK;
+}
+
+/*
+** Attach a hash set to ephemeral index cursor pCsr, which has just been
+** opened.  Each entry of the hash set is a single record.  The first
+** KeyInfo.nField fields of each record are hashed.
+**
+** If any of those fields uses an application-defined collating sequence,
+** strings that compare equal cannot be made to hash alike.  No hash set
+** is attached in that case and the cursor is used as an ordinary
+** ephemeral index.
+*/
+int sqlite3VdbeHashSetInit(sqlite3 *db, VdbeCursor *pCsr){
+  int rc;
+  int i;
+  assert( pCsr->pKeyInfo && pCsr->isTable==0 );
+  rc = sqlite3VdbeHashInit(db, pCsr, 1, 0);
+  if( rc==SQLITE_OK ){
+    VdbeHash *pHash = pCsr->pHash;
+    pHash->nField = pCsr->pKeyInfo->nField;
+    for(i=0; i<pHash->nColl; i++){
+      if( pHash->aColl[i]==HASH_COLL_OTHER ){
+        sqlite3VdbeHashClose(db, pCsr);
+        break;
+      }
+    }
+  }
+  return rc;
+}
+
+/*
+** Return the hash of the unpacked record pRec, or set *pbShort and return
+** zero if pRec has too few fields to be hashed.  Any zero-blobs in the
+** record are expanded first.
+*/
+static u32 vdbeHashRecord(VdbeHash *pHash, UnpackedRecord *pRec, int *pbShort){
+  u32 h = 0;
+  int i;
+  *pbShort = (pRec->nField<pHash->nField);
+  if( *pbShort ) return 0;
+  for(i=0; i<pHash->nField; i++){
+    if( ExpandBlob(&pRec->aMem[i]) ) return 0;
+    h = (h<<5) + h + vdbeHashMem(&pRec->aMem[i], vdbeHashColl(pHash, i));
+  }
+  return h;
+}
+
+/*
+** Return the entry of the hash set with hash h whose record matches pRec,
+** or NULL if there is no such entry.  Records are compared exactly as the
+** b-tree compares them when searching for a prefix match.
+*/
+static VdbeHashEntry *vdbeHashSetLookup(
+  VdbeHash *pHash,                /* Hash set to search */
+  UnpackedRecord *pRec,           /* Record to search for */
+  u32 h                           /* Hash of pRec */
+){
+  VdbeHashEntry *p;
+  u8 flags = pRec->flags;
+  pRec->flags = UNPACKED_PREFIX_MATCH;
+  for(p=pHash->aBucket[h & (pHash->nBucket-1)]; p; p=p->pChain){
+    Mem *pKey = hashEntryKey(p);
+    if( p->h==h && sqlite3VdbeRecordCompare(pKey->n, pKey->z, pRec)==0 ) break;
+  }
+  pRec->flags = flags;
+  return p;
+}
+
+/*
+** Set *pbFound to true if the hash set attached to cursor pCsr contains
+** a record that matches pRec, or to false otherwise.  If pRec has too
+** few fields to be looked up in the hash set, the hash set is flushed to
+** the b-tree and *pbFound is set to -1.  The caller must then search the
+** b-tree instead.
+*/
+int sqlite3VdbeHashSetFound(
+  sqlite3 *db,                    /* Database connection */
+  VdbeCursor *pCsr,               /* Ephemeral index cursor */
+  UnpackedRecord *pRec,           /* Record to search for */
+  int *pbFound                    /* OUT: True if the record is present */
+){
+  VdbeHash *pHash = pCsr->pHash;
+  int bShort;
+  u32 h;
+
+  h = vdbeHashRecord(pHash, pRec, &bShort);
+  if( bShort ){
+    *pbFound = -1;
+    return sqlite3VdbeHashSetFlush(db, pCsr);
+  }
+  if( db->mallocFailed ) return SQLITE_NOMEM;
+  *pbFound = (vdbeHashSetLookup(pHash, pRec, h)!=0);
+  return SQLITE_OK;
+}
+
+/*
+** Add the record in pRec, a blob created by OP_MakeRecord, to the hash
+** set attached to cursor pCsr.  If the hash set already holds a matching
+** record it is replaced by the new one, just as the b-tree would replace
+** it.
+**
+** If the record cannot be added because the memory budget is exhausted,
+** the hash set is flushed to the b-tree and *pbSpill is set to true.  The
+** caller must then insert pRec into the b-tree itself.
+*/
+int sqlite3VdbeHashSetInsert(
+  sqlite3 *db,                    /* Database connection */
+  VdbeCursor *pCsr,               /* Ephemeral index cursor */
+  Mem *pRec,                      /* Record to add */
+  int *pbSpill                    /* OUT: True if caller must insert pRec */
+){
+  VdbeHash *pHash = pCsr->pHash;
+  VdbeHashEntry *p;
+  UnpackedRecord *pIdxKey;
+  char *pFree;
+  char aTempRec[ROUND8(sizeof(UnpackedRecord)) + sizeof(Mem)*3 + 7];
+  int bShort;
+  int nByte;
+  u32 h;
+  int rc = SQLITE_OK;
+
+  assert( pRec->flags & MEM_Blob );
+  *pbSpill = 0;
+  pIdxKey = sqlite3VdbeAllocUnpackedRecord(
+      pCsr->pKeyInfo, aTempRec, sizeof(aTempRec), &pFree
+  );
+  if( pIdxKey==0 ) return SQLITE_NOMEM;
+  sqlite3VdbeRecordUnpack(pCsr->pKeyInfo, pRec->n, pRec->z, pIdxKey);
+  h = vdbeHashRecord(pHash, pIdxKey, &bShort);
+  if( bShort ){
+    *pbSpill = 1;
+  }else{
+    p = vdbeHashSetLookup(pHash, pIdxKey, h);
+    if( p ){
+      Mem *pKey = hashEntryKey(p);
+      pHash->nByte += pRec->n - pKey->n;
+      rc = sqlite3VdbeMemCopy(pKey, pRec);
+    }else if( pHash->nByte<pHash->mxByte ){
+      nByte = ROUND8(sizeof(VdbeHashEntry)) + sizeof(Mem);
+      p = (VdbeHashEntry*)sqlite3DbMallocZero(db, nByte);
+      if( p==0 ){
+        rc = SQLITE_NOMEM;
+      }else{
+        Mem *pKey = hashEntryKey(p);
+        pKey->flags = MEM_Null;
+        pKey->db = db;
+        rc = sqlite3VdbeMemCopy(pKey, pRec);
+        if( rc ){
+          sqlite3DbFree(db, p);
+        }else{
+          vdbeHashLink(pHash, p, h, nByte + pRec->n);
+        }
+      }
+    }else{
+      *pbSpill = 1;
+    }
+  }
+  sqlite3DbFree(db, pFree);
+  if( rc==SQLITE_OK && *pbSpill ){
+    rc = sqlite3VdbeHashSetFlush(db, pCsr);
+  }
+  return rc;
+}
+
+/*
+** Write every record held by the hash set attached to cursor pCsr into
+** the b-tree, then discard the hash set.  This is a no-op if the cursor
+** has no hash set.
+*/
+int sqlite3VdbeHashSetFlush(sqlite3 *db, VdbeCursor *pCsr){
+  VdbeHash *pHash = pCsr->pHash;
+  int rc = SQLITE_OK;
+  if( pHash ){
+    VdbeHashEntry *p;
+    assert( pHash->nField>0 );
+    for(p=pHash->pFirst; p && rc==SQLITE_OK; p=p->pNext){
+      Mem *pKey = hashEntryKey(p);
+      rc = sqlite3BtreeInsert(pCsr->pCursor, pKey->z, pKey->n, "", 0, 0, 0, 0);
+    }
+    sqlite3VdbeHashClose(db, pCsr);
+    pCsr->cacheStatus = CACHE_STALE;
+  }
+  return rc;
+}
+
+#endif /* #ifndef SQLITE_OMIT_VDBEHASH */
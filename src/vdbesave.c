@@ -0,0 +1,1242 @@
+/*
+** 2012 October 19
+**
+** The author disclaims copyright to this source code.  In place of
+** a legal notice, here is a blessing:
+**
+**    May you do good and not evil.
+**    May you find forgiveness for yourself and forgive others.
+**    May you share freely, never taking more than you give.
+**
+*************************************************************************
+**
+** This file contains code used to implement sqlite3_stmt_serialize() and
+** sqlite3_stmt_deserialize().  These save the program of a prepared
+** statement to a buffer and load it back into a new prepared statement,
+** possibly in another process, without parsing or planning the SQL
+** again.
+**
+** The buffer holds everything that sqlite3VdbeMakeReady() needs: the
+** opcodes and their operands, the number of registers, cursors and
+** parameters, the parameter and result column names, the SQL text and
+** any trigger sub-programs.  Operands that are pointers are saved by
+** name: collating sequences and SQL functions are looked up again on the
+** connection the statement is loaded into, KeyInfo and Mem operands are
+** rebuilt from their contents, and sub-programs are saved by number.
+** Statements that use virtual tables, the TEMP database, or functions
+** that exist only for the duration of one statement cannot be saved.
+**
+** The name and schema cookie of each database the statement uses are
+** saved too, along with a checksum of the contents of its sqlite_master
+** table.  A statement is only loaded if those databases are attached
+** under the same names and have the same cookies and sqlite_master
+** contents, so that the root pages and column numbers in the program are
+** still correct.  If the schema changes after the statement is loaded,
+** the OP_VerifyCookie opcode reports SQLITE_SCHEMA as usual and, if the
+** statement was saved with its SQL text, sqlite3_step() recompiles it.
+**
+** The buffer is tied to the build of SQLite that wrote it (the opcode
+** numbers are generated at build time) and to the byte order and
+** floating point format of the host.  It ends with a checksum of the
+** rest of the buffer, and every opcode loaded is checked to be a known
+** opcode whose jump targets, registers, cursors and databases are within
+** the bounds of the program.  P4 operands and values computed at run
+** time, such as the return addresses used by OP_Return and OP_Yield, are
+** not checked, so a buffer should still only be loaded from a source
+** that is trusted not to have crafted it.
+*/
+#include "sqliteInt.h"
+#include "vdbeInt.h"
+
+#ifndef SQLITE_OMIT_STMT_SERIALIZE
+
+/*
+** The first bytes of every serialized statement.  The last byte is the
+** version of the format.
+*/
+static const u8 aStmtMagic[8] = { 'S', 'Q', 'L', 'S', 'T', 'M', 'T', 3 };
+
+/*
+** The largest number of registers plus cursors, or of once-flags, that a
+** loaded program or sub-program may ask for.
+*/
+#define STMT_MAX_FRAME 0x00ffffff
+
+/*
+** An instance of this object accumulates a serialized statement.
+*/
+typedef struct StmtWriter StmtWriter;
+struct StmtWriter {
+  Vdbe *v;                /* Statement being saved */
+  u8 *a;                  /* Buffer obtained from sqlite3_malloc() */
+  int n;                  /* Bytes of a[] used */
+  int nAlloc;             /* Bytes allocated for a[] */
+  int rc;                 /* SQLITE_OK, SQLITE_NOMEM or SQLITE_ERROR */
+  const char *zErr;       /* Why the statement cannot be saved */
+};
+
+/*
+** An instance of this object reads a serialized statement.
+*/
+typedef struct StmtReader StmtReader;
+struct StmtReader {
+  sqlite3 *db;            /* Connection the statement is loaded into */
+  const u8 *a;            /* Serialized statement */
+  int n;                  /* Size of a[] in bytes */
+  int i;                  /* Read offset */
+  int bCorrupt;           /* Set if a read went past the end of a[] */
+  SubProgram **apSub;     /* Sub-programs, in the order they were saved */
+  int nSub;               /* Number of entries in apSub[] */
+  int nIntArray;          /* Entries in the last P4_INTARRAY read, or -1 */
+};
+
+/*
+** Record that the statement cannot be saved.
+*/
+static void stmtCannotSave(StmtWriter *p, const char *zErr){
+  if( p->rc==SQLITE_OK ){
+    p->rc = SQLITE_ERROR;
+    p->zErr = zErr;
+  }
+}
+
+/*
+** Append n bytes to the writer.
+*/
+static void stmtWrite(StmtWriter *p, const void *z, int n){
+  if( p->rc ) return;
+  if( p->n+n>p->nAlloc ){
+    int nNew = p->nAlloc*2 + n + 256;
+    u8 *aNew = sqlite3_realloc(p->a, nNew);
+    if( aNew==0 ){
+      p->rc = SQLITE_NOMEM;
+      return;
+    }
+    p->a = aNew;
+    p->nAlloc = nNew;
+  }
+  memcpy(&p->a[p->n], z, n);
+  p->n += n;
+}
+
+static void stmtWriteVarint(StmtWriter *p, u64 v){
+  u8 aBuf[9];
+  stmtWrite(p, aBuf, sqlite3PutVarint(aBuf, v));
+}
+
+static void stmtWriteInt(StmtWriter *p, int v){
+  stmtWriteVarint(p, (u64)(u32)v);
+}
+
+/*
+** Write n bytes of binary data, preceded by their length.
+*/
+static void stmtWriteBlob(StmtWriter *p, const void *z, int n){
+  stmtWriteInt(p, n);
+  stmtWrite(p, z, n);
+}
+
+/*
+** Write a nul-terminated string, or a NULL pointer.
+*/
+static void stmtWriteString(StmtWriter *p, const char *z){
+  if( z==0 ){
+    stmtWriteInt(p, 0);
+  }else{
+    int n = sqlite3Strlen30(z) + 1;
+    stmtWriteInt(p, n);
+    stmtWrite(p, z, n);
+  }
+}
+
+static void stmtWriteCollSeq(StmtWriter *p, CollSeq *pColl){
+  if( pColl==0 ){
+    stmtWriteString(p, 0);
+  }else{
+    stmtWriteString(p, pColl->zName);
+    stmtWriteInt(p, pColl->enc);
+  }
+}
+
+/*
+** Read n bytes.  Return a pointer to them within the buffer, or NULL if
+** there are not enough bytes left.
+*/
+static const u8 *stmtRead(StmtReader *p, int n){
+  const u8 *z;
+  if( n<0 || p->n-p->i<n ){
+    p->bCorrupt = 1;
+    p->i = p->n;
+    return 0;
+  }
+  z = &p->a[p->i];
+  p->i += n;
+  return z;
+}
+
+static u64 stmtReadVarint(StmtReader *p){
+  u8 aBuf[9];
+  u64 v;
+  int n = p->n - p->i;
+  if( n<=0 ){
+    p->bCorrupt = 1;
+    return 0;
+  }
+  if( n>9 ) n = 9;
+  memset(aBuf, 0, sizeof(aBuf));
+  memcpy(aBuf, &p->a[p->i], n);
+  p->i += sqlite3GetVarint(aBuf, &v);
+  if( p->i>p->n ){
+    p->bCorrupt = 1;
+    p->i = p->n;
+  }
+  return v;
+}
+
+static int stmtReadInt(StmtReader *p){
+  return (int)(u32)stmtReadVarint(p);
+}
+
+/*
+** Read a string written by stmtWriteString().  The string returned
+** points into the buffer.
+*/
+static const char *stmtReadString(StmtReader *p){
+  int n = stmtReadInt(p);
+  const char *z;
+  if( n==0 ) return 0;
+  z = (const char*)stmtRead(p, n);
+  if( z && z[n-1]!=0 ){
+    p->bCorrupt = 1;
+    return 0;
+  }
+  return z;
+}
+
+/*
+** Read a collating sequence written by stmtWriteCollSeq() and find it
+** on the connection.  Set *pbMissing if it is not defined.
+*/
+static CollSeq *stmtReadCollSeq(StmtReader *p, int *pbMissing){
+  const char *zName = stmtReadString(p);
+  CollSeq *pColl;
+  if( zName==0 ) return 0;
+  pColl = sqlite3FindCollSeq(p->db, (u8)stmtReadInt(p), zName, 0);
+  if( pColl==0 || pColl->xCmp==0 ){
+    *pbMissing = 1;
+  }
+  return pColl;
+}
+
+/*
+** Add n bytes to the running checksum aSum[].  This is the same
+** Fletcher-style sum that the WAL uses, computed a byte at a time.
+*/
+static void stmtChecksum(const u8 *z, int n, u32 *aSum){
+  u32 s1 = aSum[0];
+  u32 s2 = aSum[1];
+  int i;
+  for(i=0; i<n; i++){
+    s1 += z[i] + s2;
+    s2 += s1;
+  }
+  aSum[0] = s1;
+  aSum[1] = s2;
+}
+
+/*
+** sqlite3_exec() callback for stmtSchemaDigest().  Each value is added
+** to the checksum behind a tag byte, so that NULLs and the boundaries
+** between values change the result.
+*/
+static int stmtDigestCallback(
+  void *pArg,                   /* Running checksum */
+  int nCol,                     /* Number of values in azVal[] */
+  char **azVal,                 /* Values of one row of sqlite_master */
+  char **NotUsed                /* Column names */
+){
+  u32 *aSum = (u32*)pArg;
+  int i;
+  UNUSED_PARAMETER(NotUsed);
+  for(i=0; i<nCol; i++){
+    if( azVal[i] ){
+      stmtChecksum((const u8*)"s", 1, aSum);
+      stmtChecksum((const u8*)azVal[i], sqlite3Strlen30(azVal[i])+1, aSum);
+    }else{
+      stmtChecksum((const u8*)"n", 1, aSum);
+    }
+  }
+  return 0;
+}
+
+/*
+** Compute a checksum of the sqlite_master table of database iDb, which
+** covers the name, root page and CREATE statement of every table, index,
+** view and trigger in it.  Return SQLITE_OK or an error code.
+*/
+static int stmtSchemaDigest(sqlite3 *db, int iDb, u32 *aSum){
+  char *zSql;
+  int rc;
+  aSum[0] = aSum[1] = 0;
+  zSql = sqlite3MPrintf(db,
+      "SELECT type, name, tbl_name, rootpage, sql FROM \"%w\".%s"
+      " ORDER BY rowid", db->aDb[iDb].zName, SCHEMA_TABLE(iDb));
+  if( zSql==0 ) return SQLITE_NOMEM;
+  rc = sqlite3_exec(db, zSql, stmtDigestCallback, (void*)aSum, 0);
+  sqlite3DbFree(db, zSql);
+  if( rc==SQLITE_NOMEM ) db->mallocFailed = 1;
+  return rc;
+}
+
+/*
+** Write the P4 operand of opcode pOp, which is the iOp'th opcode of
+** array aOp[] of nOp opcodes.
+*/
+static void stmtWriteP4(StmtWriter *p, VdbeOp *aOp, int nOp, int iOp){
+  VdbeOp *pOp = &aOp[iOp];
+  Vdbe *v = p->v;
+  sqlite3 *db = v->db;
+  signed char p4type = pOp->p4type;
+  int i;
+
+  switch( p4type ){
+    case P4_STATIC:
+    case P4_MPRINTF:
+    case P4_DYNAMIC:    p4type = P4_DYNAMIC;  break;
+    case P4_VDBEFUNC:   p4type = P4_FUNCDEF;  break;
+    case P4_KEYINFO_STATIC: p4type = P4_KEYINFO;  break;
+    case P4_ADVANCE:    p4type = P4_NOTUSED;  break;
+  }
+  if( pOp->p4.p==0 && p4type!=P4_INT32 ) p4type = P4_NOTUSED;
+  stmtWrite(p, &p4type, 1);
+
+  switch( p4type ){
+    case P4_NOTUSED:
+      break;
+    case P4_INT32:
+      stmtWriteInt(p, pOp->p4.i);
+      break;
+    case P4_INT64:
+      stmtWriteVarint(p, (u64)*pOp->p4.pI64);
+      break;
+    case P4_REAL:
+      stmtWrite(p, pOp->p4.pReal, sizeof(double));
+      break;
+    case P4_DYNAMIC: {
+      /* OP_Blob, and OP_String once OP_String8 has been run, hold P1
+      ** bytes that may include embedded nul characters. */
+      int n;
+      if( pOp->opcode==OP_Blob || pOp->opcode==OP_String ){
+        n = pOp->p1;
+      }else{
+        n = sqlite3Strlen30(pOp->p4.z);
+      }
+      stmtWriteBlob(p, pOp->p4.z, n);
+      break;
+    }
+    case P4_COLLSEQ:
+      stmtWriteCollSeq(p, pOp->p4.pColl);
+      break;
+    case P4_FUNCDEF: {
+      FuncDef *pFunc = pOp->p4type==P4_VDBEFUNC ?
+                              pOp->p4.pVdbeFunc->pFunc : pOp->p4.pFunc;
+      if( pFunc->flags & SQLITE_FUNC_EPHEM ){
+        stmtCannotSave(p, "statement uses a virtual table function");
+      }
+      stmtWriteString(p, pFunc->zName);
+      stmtWriteInt(p, pFunc->nArg);
+      break;
+    }
+    case P4_KEYINFO: {
+      KeyInfo *pKeyInfo = pOp->p4.pKeyInfo;
+      stmtWriteInt(p, pKeyInfo->nField);
+      stmtWriteInt(p, pKeyInfo->aSortOrder!=0);
+      if( pKeyInfo->aSortOrder ){
+        stmtWrite(p, pKeyInfo->aSortOrder, pKeyInfo->nField);
+      }
+      for(i=0; i<pKeyInfo->nField; i++){
+        stmtWriteCollSeq(p, pKeyInfo->aColl[i]);
+      }
+      break;
+    }
+    case P4_MEM: {
+      sqlite3_value *pVal = (sqlite3_value*)pOp->p4.pMem;
+      int eType = sqlite3_value_type(pVal);
+      stmtWriteInt(p, eType);
+      switch( eType ){
+        case SQLITE_INTEGER:
+          stmtWriteVarint(p, (u64)sqlite3_value_int64(pVal));
+          break;
+        case SQLITE_FLOAT: {
+          double r = sqlite3_value_double(pVal);
+          stmtWrite(p, &r, sizeof(r));
+          break;
+        }
+        case SQLITE_TEXT: {
+          const void *z = sqlite3ValueText(pVal, ENC(db));
+          stmtWriteBlob(p, z, sqlite3ValueBytes(pVal, ENC(db)));
+          break;
+        }
+        case SQLITE_BLOB:
+          stmtWriteBlob(p, sqlite3_value_blob(pVal), sqlite3_value_bytes(pVal));
+          break;
+      }
+      break;
+    }
+    case P4_INTARRAY: {
+      /* The only user is OP_Permutation, and the length of the array is
+      ** given by the OP_Compare that follows it. */
+      int n;
+      if( iOp+1>=nOp || aOp[iOp+1].opcode!=OP_Compare ){
+        stmtCannotSave(p, "unexpected P4_INTARRAY operand");
+        break;
+      }
+      n = aOp[iOp+1].p3;
+      stmtWriteInt(p, n);
+      for(i=0; i<n; i++){
+        stmtWriteInt(p, pOp->p4.ai[i]);
+      }
+      break;
+    }
+    case P4_SUBPROGRAM: {
+      SubProgram *pSub;
+      for(i=0, pSub=v->pProgram; pSub && pSub!=pOp->p4.pProgram; i++){
+        pSub = pSub->pNext;
+      }
+      if( pSub==0 ) stmtCannotSave(p, "unknown sub-program");
+      stmtWriteInt(p, i);
+      break;
+    }
+    case P4_VTAB:
+      stmtCannotSave(p, "statement uses a virtual table");
+      break;
+    default:
+      stmtCannotSave(p, "unsupported P4 operand");
+      break;
+  }
+}
+
+/*
+** Write the nOp opcodes in array aOp[].
+*/
+static void stmtWriteOps(StmtWriter *p, VdbeOp *aOp, int nOp){
+  int i;
+  stmtWriteInt(p, nOp);
+  for(i=0; i<nOp && p->rc==SQLITE_OK; i++){
+    VdbeOp *pOp = &aOp[i];
+    stmtWrite(p, &pOp->opcode, 1);
+    stmtWriteInt(p, pOp->p1);
+    stmtWriteInt(p, pOp->p2);
+    stmtWriteInt(p, pOp->p3);
+    stmtWrite(p, &pOp->p5, 1);
+    stmtWriteP4(p, aOp, nOp, i);
+  }
+}
+
+/*
+** Read the P4 operand of the opcode at address addr of v.  Return an
+** error message if it cannot be loaded on this connection, or NULL
+** otherwise.
+*/
+static char *stmtReadP4(StmtReader *p, Vdbe *v, int addr){
+  sqlite3 *db = p->db;
+  signed char p4type = 0;
+  const u8 *z = stmtRead(p, 1);
+  char *zP4 = 0;
+  int bMissing = 0;
+  int i, n;
+
+  if( z ) p4type = (signed char)z[0];
+  switch( p4type ){
+    case P4_NOTUSED:
+      return 0;
+    case P4_INT32:
+      sqlite3VdbeChangeP4(v, addr, SQLITE_INT_TO_PTR(stmtReadInt(p)), P4_INT32);
+      return 0;
+    case P4_INT64: {
+      i64 *pI64 = (i64*)sqlite3DbMallocRaw(db, sizeof(i64));
+      if( pI64 ) *pI64 = (i64)stmtReadVarint(p);
+      zP4 = (char*)pI64;
+      break;
+    }
+    case P4_REAL: {
+      double *pReal = (double*)sqlite3DbMallocRaw(db, sizeof(double));
+      z = stmtRead(p, sizeof(double));
+      if( pReal && z ) memcpy(pReal, z, sizeof(double));
+      zP4 = (char*)pReal;
+      break;
+    }
+    case P4_DYNAMIC:
+      n = stmtReadInt(p);
+      z = stmtRead(p, n);
+      if( z==0 ) return 0;
+      /* Add a nul terminator wide enough for UTF-16 */
+      zP4 = (char*)sqlite3DbMallocZero(db, n+2);
+      if( zP4 ) memcpy(zP4, z, n);
+      break;
+    case P4_COLLSEQ: {
+      CollSeq *pColl = stmtReadCollSeq(p, &bMissing);
+      if( bMissing ) return sqlite3MPrintf(db, "no such collation sequence");
+      zP4 = (char*)pColl;
+      break;
+    }
+    case P4_FUNCDEF: {
+      const char *zName = stmtReadString(p);
+      int nArg = stmtReadInt(p);
+      FuncDef *pFunc;
+      if( zName==0 ) return 0;
+      pFunc = sqlite3FindFunction(db, zName, sqlite3Strlen30(zName),
+                                  nArg, ENC(db), 0);
+      if( pFunc==0 || pFunc->nArg!=nArg ){
+        return sqlite3MPrintf(db, "no such function: %s", zName);
+      }
+      zP4 = (char*)pFunc;
+      break;
+    }
+    case P4_KEYINFO: {
+      KeyInfo *pKeyInfo;
+      int nField = stmtReadInt(p);
+      int bSortOrder = stmtReadInt(p);
+      int nByte;
+      if( nField<=0 || nField>0xffff ){
+        p->bCorrupt = 1;
+        return 0;
+      }
+      nByte = sizeof(KeyInfo) + (nField-1)*sizeof(CollSeq*) + nField;
+      pKeyInfo = (KeyInfo*)sqlite3DbMallocZero(db, nByte);
+      if( pKeyInfo==0 ) return 0;
+      pKeyInfo->db = db;
+      pKeyInfo->enc = ENC(db);
+      pKeyInfo->nField = (u16)nField;
+      if( bSortOrder ){
+        pKeyInfo->aSortOrder = (u8*)&pKeyInfo->aColl[nField];
+        z = stmtRead(p, nField);
+        if( z ) memcpy(pKeyInfo->aSortOrder, z, nField);
+      }
+      for(i=0; i<nField; i++){
+        pKeyInfo->aColl[i] = stmtReadCollSeq(p, &bMissing);
+      }
+      sqlite3VdbeChangeP4(v, addr, (char*)pKeyInfo, P4_KEYINFO_HANDOFF);
+      if( bMissing ) return sqlite3MPrintf(db, "no such collation sequence");
+      return 0;
+    }
+    case P4_MEM: {
+      sqlite3_value *pVal = sqlite3ValueNew(db);
+      int eType = stmtReadInt(p);
+      if( pVal==0 ) return 0;
+      switch( eType ){
+        case SQLITE_INTEGER:
+          sqlite3VdbeMemSetInt64(pVal, (i64)stmtReadVarint(p));
+          break;
+        case SQLITE_FLOAT: {
+          double r = 0.0;
+          z = stmtRead(p, sizeof(double));
+          if( z ) memcpy(&r, z, sizeof(double));
+          sqlite3VdbeMemSetDouble(pVal, r);
+          break;
+        }
+        case SQLITE_TEXT:
+        case SQLITE_BLOB:
+          n = stmtReadInt(p);
+          z = stmtRead(p, n);
+          if( z ){
+            sqlite3VdbeMemSetStr(pVal, (const char*)z, n,
+                eType==SQLITE_TEXT ? ENC(db) : 0, SQLITE_TRANSIENT);
+          }
+          break;
+      }
+      zP4 = (char*)pVal;
+      break;
+    }
+    case P4_INTARRAY: {
+      int *ai;
+      n = stmtReadInt(p);
+      if( n<0 || n>p->n ){
+        p->bCorrupt = 1;
+        return 0;
+      }
+      ai = (int*)sqlite3DbMallocRaw(db, (n ? n : 1)*sizeof(int));
+      for(i=0; i<n; i++){
+        int x = stmtReadInt(p);
+        if( ai ) ai[i] = x;
+      }
+      p->nIntArray = n;
+      zP4 = (char*)ai;
+      break;
+    }
+    case P4_SUBPROGRAM:
+      i = stmtReadInt(p);
+      if( i<0 || i>=p->nSub ){
+        p->bCorrupt = 1;
+        return 0;
+      }
+      zP4 = (char*)p->apSub[i];
+      break;
+    default:
+      p->bCorrupt = 1;
+      return 0;
+  }
+  if( zP4 ){
+    sqlite3VdbeChangeP4(v, addr, zP4, p4type);
+  }
+  return 0;
+}
+
+/*
+** Read opcodes into the Vdbe v, which has just been created.  Return an
+** error message if one of them cannot be loaded on this connection.
+*/
+static char *stmtReadOps(StmtReader *p, Vdbe *v){
+  sqlite3 *db = p->db;
+  int nOp = stmtReadInt(p);
+  int nPermute = -1;      /* Size of the P4 of a preceding OP_Permutation */
+  int i;
+  char *zErr = 0;
+  if( nOp<=0 || nOp>p->n ){
+    p->bCorrupt = 1;
+    return 0;
+  }
+  for(i=0; i<nOp && zErr==0 && !p->bCorrupt && !db->mallocFailed; i++){
+    const u8 *z;
+    int opcode, p1, p2, p3, addr;
+    u8 p5;
+    z = stmtRead(p, 1);
+    opcode = z ? z[0] : 0;
+    p1 = stmtReadInt(p);
+    p2 = stmtReadInt(p);
+    p3 = stmtReadInt(p);
+    z = stmtRead(p, 1);
+    p5 = z ? z[0] : 0;
+    if( opcode==OP_VerifyCookie ){
+      /* The schema generation counter is local to the connection */
+      if( p1<0 || p1>=db->nDb || db->aDb[p1].pSchema==0 ){
+        p->bCorrupt = 1;
+        break;
+      }
+      if( p2!=db->aDb[p1].pSchema->schema_cookie ){
+        return sqlite3MPrintf(db, "database schema has changed");
+      }
+      p3 = db->aDb[p1].pSchema->iGeneration;
+    }
+    if( nPermute>=0 && (opcode!=OP_Compare || p3<0 || p3>nPermute) ){
+      /* OP_Compare looks up P3 entries of the permutation */
+      p->bCorrupt = 1;
+      break;
+    }
+    addr = sqlite3VdbeAddOp3(v, opcode, p1, p2, p3);
+    sqlite3VdbeChangeP5(v, p5);
+    p->nIntArray = -1;
+    zErr = stmtReadP4(p, v, addr);
+    nPermute = opcode==OP_Permutation ? p->nIntArray : -1;
+  }
+  return zErr;
+}
+
+/*
+** Return true if registers iReg through iReg+n-1 all lie within a frame
+** of nMem registers.
+*/
+static int stmtRegsOk(int iReg, int n, int nMem){
+  return n<=0 || (iReg>0 && iReg<=nMem && n<=nMem-iReg+1);
+}
+
+/*
+** Return true if database iDb is attached and, if bUsed is set, is
+** one of the databases statement v was loaded against.
+*/
+static int stmtDbOk(Vdbe *v, int iDb, int bUsed){
+  if( iDb<0 || iDb>=v->db->nDb ) return 0;
+  return !bUsed || (v->btreeMask & (((yDbMask)1)<<iDb))!=0;
+}
+
+/*
+** Return true if a frame of nMem registers, nCsr cursors and nOnce
+** once-flags is small enough for sqlite3VdbeMakeReady() and OP_Program
+** to size without overflow.
+*/
+static int stmtFrameOk(int nMem, int nCsr, int nOnce){
+  return nMem>=0 && nMem<=STMT_MAX_FRAME
+      && nCsr>=0 && nCsr<=STMT_MAX_FRAME-nMem
+      && nOnce>=0 && nOnce<=STMT_MAX_FRAME;
+}
+
+/*
+** Check that the nOp opcodes in aOp[], which run in a frame of nMem
+** registers (cursors included), nCsr cursors and nOnce once-flags, only
+** jump to instructions and use registers, cursors and databases that
+** exist.  These are the conditions sqlite3VdbeExec() asserts before it
+** uses each operand.  Return 0 if any opcode fails them.
+*/
+static int stmtOpsValid(
+  Vdbe *v,                /* Statement being loaded */
+  VdbeOp *aOp,            /* Opcodes to check */
+  int nOp,                /* Number of entries in aOp[] */
+  int nMem,               /* Registers in the frame */
+  int nCsr,               /* Cursors in the frame */
+  int nOnce,              /* Once-flags in the frame */
+  int nVar                /* Parameters of the statement */
+){
+  int i, k;
+  for(i=0; i<nOp; i++){
+    VdbeOp *pOp = &aOp[i];
+    int bCursor = 0;      /* True if P1 is a cursor number */
+    int ok = 1;
+    u8 opflags;
+
+    if( pOp->opcode==0 || pOp->opcode>=sqlite3OpcodeCount ) return 0;
+    opflags = sqlite3OpcodeProperty[pOp->opcode];
+    if( (opflags & OPFLG_JUMP)!=0 && (pOp->p2<0 || pOp->p2>=nOp) ) return 0;
+    if( (opflags & OPFLG_IN1)!=0 && !stmtRegsOk(pOp->p1, 1, nMem) ) return 0;
+    if( (opflags & (OPFLG_IN2|OPFLG_OUT2|OPFLG_OUT2_PRERELEASE))!=0
+     && !stmtRegsOk(pOp->p2, 1, nMem)
+    ){
+      return 0;
+    }
+    if( (opflags & (OPFLG_IN3|OPFLG_OUT3))!=0
+     && !stmtRegsOk(pOp->p3, 1, nMem)
+    ){
+      return 0;
+    }
+    if( pOp->p4type==P4_INTARRAY && pOp->opcode!=OP_Permutation ) return 0;
+
+    switch( pOp->opcode ){
+      case OP_Jump:
+        ok = pOp->p1>=0 && pOp->p1<nOp && pOp->p3>=0 && pOp->p3<nOp;
+        break;
+      case OP_Once:
+        ok = pOp->p1>=0 && pOp->p1<nOnce;
+        break;
+      case OP_Variable:
+        ok = pOp->p1>0 && pOp->p1<=nVar;
+        break;
+      case OP_Gosub:
+      case OP_AggFinal:
+        ok = stmtRegsOk(pOp->p1, 1, nMem);
+        break;
+      case OP_Null:
+        ok = pOp->p3<=nMem;
+        break;
+      case OP_Move:
+        ok = pOp->p3>0 && stmtRegsOk(pOp->p1, pOp->p3, nMem)
+                       && stmtRegsOk(pOp->p2, pOp->p3, nMem);
+        break;
+      case OP_ResultRow:
+      case OP_Affinity:
+        ok = stmtRegsOk(pOp->p1, pOp->p2, nMem);
+        break;
+      case OP_MakeRecord:
+        ok = pOp->p2>0 && stmtRegsOk(pOp->p1, pOp->p2, nMem)
+                       && stmtRegsOk(pOp->p3, 1, nMem);
+        break;
+      case OP_Function:
+      case OP_AggStep:
+        ok = stmtRegsOk(pOp->p2, pOp->p5, nMem)
+          && stmtRegsOk(pOp->p3, 1, nMem);
+        break;
+      case OP_Permutation:
+        /* stmtReadOps() made sure the OP_Compare that follows looks up
+        ** no more entries than the array holds */
+        ok = pOp->p4type==P4_INTARRAY && i+1<nOp
+          && aOp[i+1].opcode==OP_Compare;
+        for(k=0; ok && k<aOp[i+1].p3; k++){
+          ok = pOp->p4.ai[k]>=0 && pOp->p4.ai[k]<aOp[i+1].p3;
+        }
+        break;
+      case OP_Compare:
+        ok = pOp->p4type==P4_KEYINFO && pOp->p3>=0
+          && pOp->p3<=pOp->p4.pKeyInfo->nField
+          && stmtRegsOk(pOp->p1, pOp->p3, nMem)
+          && stmtRegsOk(pOp->p2, pOp->p3, nMem);
+        break;
+      case OP_Program:
+        ok = pOp->p4type==P4_SUBPROGRAM && stmtRegsOk(pOp->p3, 1, nMem);
+        break;
+
+      case OP_OpenRead:
+      case OP_OpenWrite:
+        bCursor = 1;
+        ok = stmtDbOk(v, pOp->p3, 1);
+        if( pOp->p5 & OPFLAG_P2ISREG ){
+          ok = ok && stmtRegsOk(pOp->p2, 1, nMem);
+        }
+        break;
+      case OP_OpenPseudo:
+      case OP_HashAggStore:
+      case OP_RowKey:
+      case OP_RowData:
+      case OP_SorterData:
+      case OP_InsertInt:
+        bCursor = 1;
+        ok = stmtRegsOk(pOp->p2, 1, nMem);
+        break;
+      case OP_Insert:
+        bCursor = 1;
+        ok = stmtRegsOk(pOp->p2, 1, nMem) && stmtRegsOk(pOp->p3, 1, nMem);
+        break;
+      case OP_Column:
+      case OP_SorterCompare:
+      case OP_HashRewind:
+        bCursor = 1;
+        ok = stmtRegsOk(pOp->p3, 1, nMem);
+        break;
+      case OP_HashAggLoad:
+        bCursor = 1;
+        ok = stmtRegsOk(pOp->p3, 1, nMem)
+          && pOp->p4type==P4_INT32 && stmtRegsOk(pOp->p4.i, 1, nMem);
+        break;
+      case OP_IsUnique:
+        bCursor = 1;
+        ok = pOp->p4type==P4_INT32 && stmtRegsOk(pOp->p4.i, 1, nMem);
+        break;
+      case OP_OpenAutoindex:
+      case OP_OpenEphemeral:
+      case OP_SorterOpen:
+      case OP_HashOpen:
+      case OP_HashNext:
+      case OP_Close:
+      case OP_SeekLt:
+      case OP_SeekLe:
+      case OP_SeekGe:
+      case OP_SeekGt:
+      case OP_Seek:
+      case OP_NotFound:
+      case OP_Found:
+      case OP_NotExists:
+      case OP_Sequence:
+      case OP_NewRowid:
+      case OP_Delete:
+      case OP_Rowid:
+      case OP_NullRow:
+      case OP_Last:
+      case OP_SorterSort:
+      case OP_Sort:
+      case OP_Rewind:
+      case OP_SorterNext:
+      case OP_Prev:
+      case OP_Next:
+      case OP_SampleLeaf:
+      case OP_SampleNext:
+      case OP_SorterInsert:
+      case OP_IdxInsert:
+      case OP_Count:
+        bCursor = 1;
+        break;
+
+      case OP_Transaction:
+      case OP_ReadCookie:
+      case OP_SetCookie:
+      case OP_VerifyCookie:
+      case OP_CreateTable:
+      case OP_CreateIndex:
+      case OP_IncrVacuum:
+      case OP_TableLock:
+        ok = stmtDbOk(v, pOp->p1, 1);
+        break;
+      case OP_Destroy:
+        ok = stmtDbOk(v, pOp->p3, 1);
+        break;
+      case OP_Clear:
+        ok = stmtDbOk(v, pOp->p2, 1);
+        break;
+      case OP_IntegrityCk:
+        ok = stmtDbOk(v, pOp->p5, 1);
+        break;
+      case OP_ParseSchema:
+      case OP_LoadAnalysis:
+      case OP_AnalysisFresh:
+      case OP_DropTable:
+      case OP_DropIndex:
+      case OP_DropTrigger:
+      case OP_JournalMode:
+      case OP_Pagecount:
+      case OP_MaxPgcnt:
+        ok = stmtDbOk(v, pOp->p1, 0);
+        break;
+      case OP_Checkpoint:
+        ok = pOp->p1==SQLITE_MAX_ATTACHED || stmtDbOk(v, pOp->p1, 0);
+        break;
+    }
+    if( !ok || (bCursor && (pOp->p1<0 || pOp->p1>=nCsr)) ) return 0;
+  }
+  return 1;
+}
+
+/*
+** Serialize prepared statement pStmt.
+*/
+int sqlite3_stmt_serialize(sqlite3_stmt *pStmt, void **ppOut, int *pnOut){
+  Vdbe *v = (Vdbe*)pStmt;
+  sqlite3 *db;
+  StmtWriter w;
+  SubProgram *pSub;
+  const double rProbe = 1.5;
+  int nDb;
+  int i;
+
+  *ppOut = 0;
+  *pnOut = 0;
+  if( v==0 ) return SQLITE_MISUSE_BKPT;
+  db = v->db;
+  sqlite3_mutex_enter(db->mutex);
+  memset(&w, 0, sizeof(w));
+  w.v = v;
+
+  if( v->magic!=VDBE_MAGIC_RUN ){
+    stmtCannotSave(&w, "statement is not ready");
+  }
+  if( v->btreeMask & (((yDbMask)1)<<1) ){
+    stmtCannotSave(&w, "statement uses the TEMP database");
+  }
+
+  /* Header */
+  stmtWrite(&w, aStmtMagic, sizeof(aStmtMagic));
+  stmtWrite(&w, &rProbe, sizeof(rProbe));
+  stmtWriteString(&w, sqlite3_sourceid());
+  stmtWriteInt(&w, ENC(db));
+  for(nDb=i=0; i<db->nDb; i++){
+    if( v->btreeMask & (((yDbMask)1)<<i) ) nDb++;
+  }
+  stmtWriteInt(&w, nDb);
+  for(i=0; i<db->nDb && w.rc==SQLITE_OK; i++){
+    if( v->btreeMask & (((yDbMask)1)<<i) ){
+      u32 aDigest[2];
+      int rc = stmtSchemaDigest(db, i, aDigest);
+      if( rc==SQLITE_NOMEM ){
+        w.rc = SQLITE_NOMEM;
+      }else if( rc!=SQLITE_OK ){
+        stmtCannotSave(&w, "cannot read the schema");
+      }
+      stmtWriteInt(&w, i);
+      stmtWriteString(&w, db->aDb[i].zName);
+      stmtWriteInt(&w, db->aDb[i].pSchema->schema_cookie);
+      stmtWriteInt(&w, (int)aDigest[0]);
+      stmtWriteInt(&w, (int)aDigest[1]);
+    }
+  }
+
+  /* The values sqlite3VdbeMakeReady() takes from the Parse object, and
+  ** the properties the code generator sets directly on the Vdbe. */
+  stmtWriteInt(&w, v->nMem - v->nCursor);
+  stmtWriteInt(&w, v->nCursor);
+  stmtWriteInt(&w, v->nOnceFlag);
+  stmtWriteInt(&w, v->nVar);
+  stmtWriteInt(&w, v->explain);
+  stmtWriteInt(&w, v->usesStmtJournal);
+  stmtWriteInt(&w, v->changeCntOn);
+  stmtWriteInt(&w, v->runOnlyOnce);
+  stmtWriteInt(&w, v->expmask);
+  stmtWriteInt(&w, v->nzVar);
+  for(i=0; i<v->nzVar; i++){
+    stmtWriteString(&w, v->azVar[i]);
+  }
+  stmtWriteInt(&w, v->nResColumn);
+  for(i=0; i<v->nResColumn*COLNAME_N; i++){
+    stmtWriteString(&w, (const char*)sqlite3ValueText(&v->aColName[i],
+                                                      SQLITE_UTF8));
+  }
+  stmtWriteInt(&w, v->isPrepareV2);
+  stmtWriteString(&w, v->zSql);
+
+  /* Sub-programs, then the main program.  Sub-programs generated for the
+  ** same trigger share a token, which OP_Program uses to detect
+  ** recursion. */
+  for(i=0, pSub=v->pProgram; pSub; pSub=pSub->pNext) i++;
+  stmtWriteInt(&w, i);
+  for(pSub=v->pProgram; pSub; pSub=pSub->pNext){
+    SubProgram *pTok;
+    for(i=0, pTok=v->pProgram; pTok->token!=pSub->token; pTok=pTok->pNext){
+      i++;
+    }
+    stmtWriteInt(&w, i);
+    stmtWriteInt(&w, pSub->nMem);
+    stmtWriteInt(&w, pSub->nCsr);
+    stmtWriteInt(&w, pSub->nOnce);
+    stmtWriteOps(&w, pSub->aOp, pSub->nOp);
+  }
+  stmtWriteOps(&w, v->aOp, v->nOp);
+
+  /* A checksum of everything above */
+  if( w.rc==SQLITE_OK ){
+    u32 aSum[2] = {0, 0};
+    u8 aBuf[8];
+    stmtChecksum(w.a, w.n, aSum);
+    sqlite3Put4byte(aBuf, aSum[0]);
+    sqlite3Put4byte(&aBuf[4], aSum[1]);
+    stmtWrite(&w, aBuf, sizeof(aBuf));
+  }
+
+  if( w.rc==SQLITE_OK ){
+    *ppOut = (void*)w.a;
+    *pnOut = w.n;
+    sqlite3Error(db, SQLITE_OK, 0);
+  }else{
+    sqlite3_free(w.a);
+    if( w.rc==SQLITE_NOMEM ){
+      db->mallocFailed = 1;
+    }else{
+      sqlite3Error(db, w.rc, "cannot serialize statement: %s", w.zErr);
+    }
+  }
+  w.rc = sqlite3ApiExit(db, w.rc);
+  sqlite3_mutex_leave(db->mutex);
+  return w.rc;
+}
+
+/*
+** Load a statement serialized by sqlite3_stmt_serialize().  The caller
+** holds the connection and b-tree mutexes and has loaded the schema.
+*/
+static int stmtLoad(StmtReader *p, sqlite3_stmt **ppStmt, char **pzErr){
+  sqlite3 *db = p->db;
+  Vdbe *v;
+  Parse sParse;
+  const u8 *z;
+  const char *zSql;
+  const char *zSource;
+  double rProbe;
+  u32 aSum[2] = {0, 0};
+  int nDb, nVar, nResColumn, isPrepareV2;
+  int i;
+  int rcErr = SQLITE_SCHEMA;
+  char *zErr = 0;
+
+  memset(&sParse, 0, sizeof(sParse));
+  sParse.db = db;
+
+  /* Header and trailing checksum */
+  if( p->n<(int)sizeof(aStmtMagic)+8
+   || memcmp(p->a, aStmtMagic, sizeof(aStmtMagic))!=0
+  ){
+    *pzErr = sqlite3MPrintf(db, "not a serialized statement");
+    return SQLITE_ERROR;
+  }
+  p->n -= 8;
+  stmtChecksum(p->a, p->n, aSum);
+  if( aSum[0]!=sqlite3Get4byte(&p->a[p->n])
+   || aSum[1]!=sqlite3Get4byte(&p->a[p->n+4])
+  ){
+    *pzErr = sqlite3MPrintf(db, "malformed serialized statement");
+    return SQLITE_CORRUPT_BKPT;
+  }
+  stmtRead(p, sizeof(aStmtMagic));
+  z = stmtRead(p, sizeof(rProbe));
+  if( z ) memcpy(&rProbe, z, sizeof(rProbe));
+  zSource = stmtReadString(p);
+  if( z==0 || rProbe!=1.5
+   || zSource==0 || strcmp(zSource, sqlite3_sourceid())!=0
+  ){
+    *pzErr = sqlite3MPrintf(db, "statement serialized by another build");
+    return SQLITE_ERROR;
+  }
+  if( stmtReadInt(p)!=ENC(db) ){
+    *pzErr = sqlite3MPrintf(db, "statement serialized for another encoding");
+    return SQLITE_SCHEMA;
+  }
+  v = sqlite3VdbeCreate(db);
+  if( v==0 ) return SQLITE_NOMEM;
+  nDb = stmtReadInt(p);
+  for(i=0; i<nDb && zErr==0 && !p->bCorrupt; i++){
+    int iDb = stmtReadInt(p);
+    const char *zName = stmtReadString(p);
+    int iCookie = stmtReadInt(p);
+    u32 aDigest[2];
+    aDigest[0] = (u32)stmtReadInt(p);
+    aDigest[1] = (u32)stmtReadInt(p);
+    if( p->bCorrupt ) break;
+    if( iDb<0 || iDb>=db->nDb || db->aDb[iDb].pBt==0 || zName==0
+     || sqlite3StrICmp(db->aDb[iDb].zName, zName)!=0
+    ){
+      zErr = sqlite3MPrintf(db, "no such database: %s", zName);
+    }else if( db->aDb[iDb].pSchema->schema_cookie!=iCookie ){
+      zErr = sqlite3MPrintf(db, "database schema has changed");
+    }else{
+      int rc = stmtSchemaDigest(db, iDb, aSum);
+      if( rc!=SQLITE_OK ){
+        if( rc!=SQLITE_NOMEM ){
+          rcErr = rc;
+          zErr = sqlite3MPrintf(db, "%s", sqlite3_errmsg(db));
+        }
+        break;
+      }
+      if( aSum[0]!=aDigest[0] || aSum[1]!=aDigest[1] ){
+        zErr = sqlite3MPrintf(db, "database schema has changed");
+      }else{
+        sqlite3VdbeUsesBtree(v, iDb);
+      }
+    }
+  }
+
+  sParse.nMem = stmtReadInt(p);
+  sParse.nTab = stmtReadInt(p);
+  sParse.nOnce = stmtReadInt(p);
+  nVar = stmtReadInt(p);
+  if( !stmtFrameOk(sParse.nMem, sParse.nTab, sParse.nOnce)
+   || nVar<0 || nVar>db->aLimit[SQLITE_LIMIT_VARIABLE_NUMBER]
+  ){
+    p->bCorrupt = 1;
+    nVar = 0;
+  }
+  sParse.nVar = (ynVar)nVar;
+  sParse.explain = (u8)stmtReadInt(p);
+  sParse.isMultiWrite = sParse.mayAbort = (u8)stmtReadInt(p);
+  v->changeCntOn = (u8)stmtReadInt(p);
+  v->runOnlyOnce = (u8)stmtReadInt(p);
+  v->expmask = (u32)stmtReadInt(p);
+  sParse.nzVar = stmtReadInt(p);
+  if( sParse.nzVar<0 || sParse.nzVar>p->n ){
+    p->bCorrupt = 1;
+    sParse.nzVar = 0;
+  }
+  if( sParse.nzVar>0 ){
+    sParse.azVar = (char**)sqlite3DbMallocZero(db,
+                                      sParse.nzVar*sizeof(sParse.azVar[0]));
+  }
+  for(i=0; i<sParse.nzVar; i++){
+    const char *zVar = stmtReadString(p);
+    if( sParse.azVar ) sParse.azVar[i] = sqlite3DbStrDup(db, zVar);
+  }
+  nResColumn = stmtReadInt(p);
+  if( nResColumn<0 || nResColumn>p->n ){
+    p->bCorrupt = 1;
+    nResColumn = 0;
+  }
+  if( nResColumn>0 ) sqlite3VdbeSetNumCols(v, nResColumn);
+  for(i=0; i<nResColumn*COLNAME_N && !db->mallocFailed; i++){
+    const char *zName = stmtReadString(p);
+    if( zName ){
+      sqlite3VdbeSetColName(v, i%nResColumn, i/nResColumn, zName,
+                            SQLITE_TRANSIENT);
+    }
+  }
+  isPrepareV2 = stmtReadInt(p);
+  zSql = stmtReadString(p);
+  if( zSql ) sqlite3VdbeSetSql(v, zSql, sqlite3Strlen30(zSql), isPrepareV2);
+
+  /* Sub-programs.  Each is read into a temporary Vdbe, from which the
+  ** resolved opcode array is then taken, as codeRowTrigger() does. */
+  p->nSub = stmtReadInt(p);
+  if( p->nSub<0 || p->nSub>p->n ){
+    p->bCorrupt = 1;
+    p->nSub = 0;
+  }
+  if( p->nSub>0 ){
+    p->apSub = (SubProgram**)sqlite3DbMallocZero(db,
+                                          p->nSub*sizeof(SubProgram*));
+    for(i=0; p->apSub && i<p->nSub; i++){
+      p->apSub[i] = (SubProgram*)sqlite3DbMallocZero(db, sizeof(SubProgram));
+    }
+    for(i=p->nSub-1; p->apSub && i>=0; i--){
+      if( p->apSub[i] ) sqlite3VdbeLinkSubProgram(v, p->apSub[i]);
+    }
+  }
+  for(i=0; i<p->nSub && zErr==0 && !p->bCorrupt && !db->mallocFailed; i++){
+    SubProgram *pSub = p->apSub[i];
+    Vdbe *vSub;
+    int iTok = stmtReadInt(p);
+    if( iTok<0 || iTok>i ){
+      p->bCorrupt = 1;
+      break;
+    }
+    pSub->token = (void*)p->apSub[iTok];
+    pSub->nMem = stmtReadInt(p);
+    pSub->nCsr = stmtReadInt(p);
+    pSub->nOnce = stmtReadInt(p);
+    if( !stmtFrameOk(pSub->nMem, pSub->nCsr, pSub->nOnce) ){
+      p->bCorrupt = 1;
+      break;
+    }
+    vSub = sqlite3VdbeCreate(db);
+    if( vSub==0 ) break;
+    zErr = stmtReadOps(p, vSub);
+    if( zErr==0 && !p->bCorrupt && !db->mallocFailed ){
+      if( !stmtOpsValid(v, vSub->aOp, vSub->nOp, pSub->nMem+pSub->nCsr,
+                        pSub->nCsr, pSub->nOnce, nVar) ){
+        p->bCorrupt = 1;
+      }else{
+        pSub->aOp = sqlite3VdbeTakeOpArray(vSub, &pSub->nOp, &sParse.nMaxArg);
+      }
+    }
+    sqlite3VdbeDelete(vSub);
+  }
+
+  /* The main program */
+  if( zErr==0 && !p->bCorrupt && !db->mallocFailed ){
+    zErr = stmtReadOps(p, v);
+  }
+  if( zErr==0 && !p->bCorrupt && !db->mallocFailed
+   && !stmtOpsValid(v, v->aOp, v->nOp, sParse.nMem+sParse.nTab,
+                    sParse.nTab, sParse.nOnce, nVar)
+  ){
+    p->bCorrupt = 1;
+  }
+  if( zErr==0 && p->i!=p->n ) p->bCorrupt = 1;
+  if( zErr==0 && !p->bCorrupt && !db->mallocFailed ){
+    sqlite3VdbeMakeReady(v, &sParse);
+  }
+
+  for(i=0; i<sParse.nzVar; i++){
+    if( sParse.azVar ) sqlite3DbFree(db, sParse.azVar[i]);
+  }
+  sqlite3DbFree(db, sParse.azVar);
+  sqlite3DbFree(db, p->apSub);
+  p->apSub = 0;
+
+  if( zErr || p->bCorrupt || db->mallocFailed ){
+    sqlite3VdbeFinalize(v);
+    if( zErr ){
+      *pzErr = zErr;
+      return rcErr;
+    }
+    if( db->mallocFailed ) return SQLITE_NOMEM;
+    *pzErr = sqlite3MPrintf(db, "malformed serialized statement");
+    return SQLITE_CORRUPT_BKPT;
+  }
+  *ppStmt = (sqlite3_stmt*)v;
+  return SQLITE_OK;
+}
+
+/*
+** Load a statement serialized by sqlite3_stmt_serialize() into a new
+** prepared statement on connection db.
+*/
+int sqlite3_stmt_deserialize(
+  sqlite3 *db,                  /* Database handle */
+  const void *pData,            /* Serialized statement */
+  int nData,                    /* Size of pData in bytes */
+  sqlite3_stmt **ppStmt         /* OUT: The new prepared statement */
+){
+  StmtReader r;
+  char *zErr = 0;
+  int rc;
+  u8 bShareHeld;
+
+  *ppStmt = 0;
+  if( !sqlite3SafetyCheckOk(db) || pData==0 || nData<0 ){
+    return SQLITE_MISUSE_BKPT;
+  }
+  memset(&r, 0, sizeof(r));
+  r.db = db;
+  r.a = (const u8*)pData;
+  r.n = nData;
+
+  sqlite3_mutex_enter(db->mutex);
+  sqlite3BtreeEnterAll(db);
+  bShareHeld = sqlite3SchemaShareEnter(db);
+  rc = sqlite3Init(db, &zErr);
+  if( rc==SQLITE_OK ){
+    rc = stmtLoad(&r, ppStmt, &zErr);
+  }
+  sqlite3SchemaShareLeave(db, bShareHeld);
+  sqlite3BtreeLeaveAll(db);
+  if( zErr ){
+    sqlite3Error(db, rc, "%s", zErr);
+    sqlite3DbFree(db, zErr);
+  }else{
+    sqlite3Error(db, rc, 0);
+  }
+  rc = sqlite3ApiExit(db, rc);
+  sqlite3_mutex_leave(db->mutex);
+  return rc;
+}
+
+#endif /* SQLITE_OMIT_STMT_SERIALIZE */
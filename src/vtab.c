@@ -706,10 +706,14 @@ int sqlite3_declare_vtab(sqlite3 *db, const char *zCreateTable){
   if( pParse==0 ){
     rc = SQLITE_NOMEM;
   }else{
+    ParseArena *pSavedArena = db->pArena;
     pParse->declareVtab = 1;
     pParse->db = db;
     pParse->nQueryLoop = 1;
-  
+
+    /* The columns become part of pTab, so they must not be built in the
+    ** arena of a statement that is being prepared. */
+    db->pArena = 0;
     if( SQLITE_OK==sqlite3RunParser(pParse, zCreateTable, &zErr) 
      && pParse->pNewTable
      && !db->mallocFailed
@@ -734,6 +738,7 @@ int sqlite3_declare_vtab(sqlite3 *db, const char *zCreateTable){
       sqlite3VdbeFinalize(pParse->pVdbe);
     }
     sqlite3DeleteTable(db, pParse->pNewTable);
+    db->pArena = pSavedArena;
     sqlite3StackFree(db, pParse);
   }
 
@@ -468,6 +468,7 @@ struct WhereCost {
 #define WO_OR     0x100 //16进制0001 0000 0000  /* Two or more OR-connected terms  两个或更多个OR-connected terms */
 #define WO_AND    0x200 //16进制0010 0000 0000  /* Two or more AND-connected terms  两个或更多个AND-connected terms */
 #define WO_NOOP   0x800 //16进制1000 0000 0000  /* This term does not restrict(限制) search space 这个term不限制搜索空间 */
+#define WO_AUX    0x1000 /* LIMIT or OFFSET offered to a virtual table  提供给虚表的LIMIT或OFFSET */
 #define WO_ALL    0xfff //16进制1111 1111 1111  /* Mask of all possible WO_* values  所有可能的WO_*值的掩码 */
 #define WO_SINGLE 0x0ff //16进制0000 1111 1111  /* Mask of all non-compound(不混合的) WO_* values  所有不混合的WO_*值的掩码 */
 
@@ -3388,6 +3389,114 @@ struct SrcList_item *pSrc,  /* The FROM clause term to get the next index *//* 
 #endif /* SQLITE_OMIT_AUTOMATIC_INDEX *//* SQLITE_OMIT_AUTOMATIC_INDEX结束*/
 
 #ifndef SQLITE_OMIT_VIRTUALTABLE
+/*
+** Extra information that allocateIndexInfo() places immediately after
+** the sqlite3_index_info structure, for use by sqlite3_vtab_in() and
+** sqlite3_vtab_distinct().  Only the first 32 constraints can be IN
+** operators processed all at once.
+**
+** 紧跟在sqlite3_index_info结构之后的附加信息。
+*/
+typedef struct HiddenIndexInfo HiddenIndexInfo;
+struct HiddenIndexInfo {
+  u32 mIn;              /* Mask of aConstraint[] entries that are IN operators */
+  u32 mHandleIn;        /* Mask of IN constraints to process all at once */
+  u8 bDistinct;         /* aOrderBy[] holds the DISTINCT columns */
+  u8 eDistinct;         /* Value returned by sqlite3_vtab_distinct() */
+};
+
+/*
+** Return true if the module of virtual table pTab is version 3 or
+** greater, and so is prepared to see IN, LIMIT and OFFSET constraints.
+*/
+static int vtabIsRich(sqlite3 *db, Table *pTab){
+  return sqlite3GetVTable(db, pTab)->pVtab->pModule->iVersion>=3;
+}
+
+/*
+** Return true if pTerm, a term of the WHERE clause, is passed to the
+** xBestIndex method of the virtual table open on cursor iCur.
+*/
+static int vtabTermIsConstraint(WhereTerm *pTerm, int iCur, int bRich){
+  if( pTerm->leftCursor!=iCur ) return 0;
+  if( pTerm->eOperator & WO_ISNULL ) return 0;
+  if( pTerm->eOperator==WO_IN && !bRich ) return 0;
+  if( pTerm->wtFlags & TERM_VNULL ) return 0;
+  return 1;
+}
+
+/*
+** Add to pWC a virtual term that offers the LIMIT (if op is TK_LIMIT)
+** or OFFSET (TK_OFFSET) held in register iReg to the virtual table
+** open on cursor iCur.
+*/
+static void whereAddLimitTerm(WhereClause *pWC, int iCur, int op, int iReg){
+  Parse *pParse = pWC->pParse;
+  Expr *pVal;
+  Expr *pNew;
+  int idx;
+
+  pVal = sqlite3PExpr(pParse, TK_REGISTER, 0, 0, 0);
+  if( pVal==0 ) return;
+  pVal->iTable = iReg;
+  pNew = sqlite3PExpr(pParse, op, 0, pVal, 0);
+  if( pNew==0 ) return;
+  idx = whereClauseInsert(pWC, pNew, TERM_VIRTUAL|TERM_DYNAMIC);
+  if( pParse->db->mallocFailed==0 ){
+    WhereTerm *pTerm = &pWC->a[idx];
+    pTerm->leftCursor = iCur;
+    pTerm->u.leftColumn = -1;
+    pTerm->eOperator = WO_AUX;
+    pTerm->prereqRight = 0;
+    pTerm->prereqAll = 0;
+  }
+}
+
+/*
+** If pLimit has a LIMIT clause, the FROM clause holds a single virtual
+** table whose module is version 3 or greater and every term of the WHERE
+** clause is passed to xBestIndex, then add terms to pWC that offer the
+** LIMIT and OFFSET to the virtual table as constraints.
+**
+** The value offered for LIMIT is the register computeLimitRegisters()
+** in select.c fills with LIMIT+OFFSET, or the LIMIT counter if there
+** is no OFFSET.  SQLite still enforces the LIMIT itself.  A LIMIT that
+** is a negative constant is not offered.  A LIMIT computed at run-time
+** may still turn out to be negative, in which case that register holds
+** a negative value and there is no limit.
+**
+** 如果可能，将LIMIT和OFFSET作为约束提供给虚表。
+*/
+static void whereAddLimitTerms(
+  WhereClause *pWC,     /* The WHERE clause */
+  SrcList *pTabList,    /* The FROM clause */
+  Select *pLimit        /* SELECT statement with the LIMIT clause */
+){
+  struct SrcList_item *pItem = &pTabList->a[0];
+  int iReg;
+  int n;
+  int i;
+
+  if( pTabList->nSrc!=1 || pLimit->iLimit<=0 ) return;
+  if( !IsVirtual(pItem->pTab) ) return;
+  if( !vtabIsRich(pWC->pParse->db, pItem->pTab) ) return;
+  for(i=0; i<pWC->nTerm; i++){
+    WhereTerm *pTerm = &pWC->a[i];
+    if( pTerm->wtFlags & TERM_VIRTUAL ) continue;
+    if( !vtabTermIsConstraint(pTerm, pItem->iCursor, 1) ) return;
+    if( pTerm->prereqRight ) return;
+  }
+  /* A negative LIMIT means that there is no limit, so only the OFFSET,
+  ** if any, is offered in that case. */
+  if( !sqlite3ExprIsInteger(pLimit->pLimit, &n) || n>=0 ){
+    iReg = pLimit->iOffset ? pLimit->iOffset+1 : pLimit->iLimit;
+    whereAddLimitTerm(pWC, pItem->iCursor, TK_LIMIT, iReg);
+  }
+  if( pLimit->iOffset ){
+    whereAddLimitTerm(pWC, pItem->iCursor, TK_OFFSET, pLimit->iOffset);
+  }
+}
+
 /*
 ** Allocate and populate an sqlite3_index_info structure. It is the 
 ** responsibility of the caller to eventually release the structure
@@ -3404,7 +3513,8 @@ static sqlite3_index_info *allocateIndexInfo(
   Parse *pParse, 
   WhereClause *pWC,
   struct SrcList_item *pSrc,
-  ExprList *pOrderBy
+  ExprList *pOrderBy,
+  ExprList *pDistinct
 ){
   int i, j;
   int nTerm;
@@ -3414,6 +3524,9 @@ static sqlite3_index_info *allocateIndexInfo(
   WhereTerm *pTerm;
   int nOrderBy;
   sqlite3_index_info *pIdxInfo;
+  HiddenIndexInfo *pHidden;
+  int bRich = vtabIsRich(pParse->db, pSrc->pTab);
+  int bDistinct = 0;
 
   WHERETRACE(("Recomputing index info for %s...\n", pSrc->pTab->zName));
 
@@ -3422,12 +3535,10 @@ static sqlite3_index_info *allocateIndexInfo(
   /* 计算指向这个虚表的可能的WHERE子句约束的数量。
   */
   for(i=nTerm=0, pTerm=pWC->a; i<pWC->nTerm; i++, pTerm++){
-    if( pTerm->leftCursor != pSrc->iCursor ) continue;
     assert( (pTerm->eOperator&(pTerm->eOperator-1))==0 );
     testcase( pTerm->eOperator==WO_IN );
     testcase( pTerm->eOperator==WO_ISNULL );
-    if( pTerm->eOperator & (WO_IN|WO_ISNULL) ) continue;
-    if( pTerm->wtFlags & TERM_VNULL ) continue;
+    if( !vtabTermIsConstraint(pTerm, pSrc->iCursor, bRich) ) continue;
     nTerm++;
   }
 
@@ -3449,6 +3560,18 @@ static sqlite3_index_info *allocateIndexInfo(
     if( i==pOrderBy->nExpr ){
       nOrderBy = pOrderBy->nExpr;
     }
+  }else if( pDistinct ){
+    /* With no ORDER BY clause, aOrderBy[] may instead describe the
+    ** columns of a DISTINCT query.  See sqlite3_vtab_distinct(). */
+    for(i=0; i<pDistinct->nExpr; i++){
+      Expr *pExpr = pDistinct->a[i].pExpr;
+      if( pExpr->op!=TK_COLUMN || pExpr->iTable!=pSrc->iCursor ) break;
+    }
+    if( i==pDistinct->nExpr ){
+      nOrderBy = pDistinct->nExpr;
+      bDistinct = 1;
+      pOrderBy = pDistinct;
+    }
   }
 
   /* Allocate the sqlite3_index_info structure 分配sqlite3_index_info数据结构
@@ -3456,6 +3579,7 @@ static sqlite3_index_info *allocateIndexInfo(
   /* 分配sqlite3_index_info结构。
   */
   pIdxInfo = sqlite3DbMallocZero(pParse->db, sizeof(*pIdxInfo)
+                           + sizeof(*pHidden)
                            + (sizeof(*pIdxCons) + sizeof(*pUsage))*nTerm
                            + sizeof(*pIdxOrderBy)*nOrderBy );
   if( pIdxInfo==0 ){
@@ -3475,7 +3599,9 @@ static sqlite3_index_info *allocateIndexInfo(
   /* 初始化结构。sqlite3_index_info结构包含许多字段声明“常量”,以防止
   ** xBestIndex改变他们。我们必须做一些操作来初始化这些字段。
   */
-  pIdxCons = (struct sqlite3_index_constraint*)&pIdxInfo[1];
+  pHidden = (HiddenIndexInfo*)&pIdxInfo[1];
+  pHidden->bDistinct = (u8)bDistinct;
+  pIdxCons = (struct sqlite3_index_constraint*)&pHidden[1];
   pIdxOrderBy = (struct sqlite3_index_orderby*)&pIdxCons[nTerm];
   pUsage = (struct sqlite3_index_constraint_usage*)&pIdxOrderBy[nOrderBy];
   *(int*)&pIdxInfo->nConstraint = nTerm;
@@ -3486,14 +3612,23 @@ static sqlite3_index_info *allocateIndexInfo(
                                                                    pUsage;
 
   for(i=j=0, pTerm=pWC->a; i<pWC->nTerm; i++, pTerm++){
-    if( pTerm->leftCursor != pSrc->iCursor ) continue;
-    assert( (pTerm->eOperator&(pTerm->eOperator-1))==0 );
-    testcase( pTerm->eOperator==WO_IN );
-    testcase( pTerm->eOperator==WO_ISNULL );
-    if( pTerm->eOperator & (WO_IN|WO_ISNULL) ) continue;
-    if( pTerm->wtFlags & TERM_VNULL ) continue;
+    if( !vtabTermIsConstraint(pTerm, pSrc->iCursor, bRich) ) continue;
     pIdxCons[j].iColumn = pTerm->u.leftColumn;
     pIdxCons[j].iTermOffset = i;
+    if( pTerm->eOperator==WO_IN ){
+      /* IN operators are reported as "=".  sqlite3_vtab_in() tells
+      ** them apart. */
+      if( j<32 ) pHidden->mIn |= ((u32)1)<<j;
+      pIdxCons[j].op = SQLITE_INDEX_CONSTRAINT_EQ;
+      j++;
+      continue;
+    }
+    if( pTerm->eOperator==WO_AUX ){
+      pIdxCons[j].op = pTerm->pExpr->op==TK_LIMIT ?
+          SQLITE_INDEX_CONSTRAINT_LIMIT : SQLITE_INDEX_CONSTRAINT_OFFSET;
+      j++;
+      continue;
+    }
     pIdxCons[j].op = (u8)pTerm->eOperator;
     /* The direct assignment in the previous line is possible only because
     ** the WO_ and SQLITE_INDEX_CONSTRAINT_ codes are identical.  The
@@ -3637,6 +3772,7 @@ struct SrcList_item *pSrc,      /* The FROM clause term to search *//* 用于搜
 	Bitmask notReady,               /* Mask of cursors not available for index *//* 索引不可用的指针掩码*/
 	Bitmask notValid,               /* Cursors not valid for any purpose *//* 所有无效的指针*/
 	ExprList *pOrderBy,             /* The order by clause *//* 子句排序*/
+	ExprList *pDistinct,            /* The select-list if query is DISTINCT *//* DISTINCT查询的选择列表*/
 	WhereCost *pCost,               /* Lowest cost query plan *//* 查询计划的最小代价*/
 	sqlite3_index_info **ppIdxInfo  /* Index information passed to xBestIndex *//* 传送到xBestIndex的索引信息*/
 =======
@@ -3646,12 +3782,14 @@ struct SrcList_item *pSrc,      /* The FROM clause term to search *//* 用于搜
   Bitmask notReady,               /* Mask of cursors not available for index 游标掩码对于索引无效 */
   Bitmask notValid,               /* Cursors not valid for any purpose 游标对于任何用途都无效 */
   ExprList *pOrderBy,             /* The order by clause ORDER BY子句 */
+  ExprList *pDistinct,            /* The select-list if query is DISTINCT DISTINCT查询的选择列表 */
   WhereCost *pCost,               /* Lowest cost query plan 最小代价插叙计划 */
   sqlite3_index_info **ppIdxInfo  /* Index information passed to xBestIndex 传人xBestIndex的索引信息 */
 >>>>>>> 91288352e83e9763d493ed84aec377d15ced3949
 ){
   Table *pTab = pSrc->pTab; //初始化表结构
   sqlite3_index_info *pIdxInfo; //用于存储选出的索引信息
+  HiddenIndexInfo *pHidden;     //紧跟在pIdxInfo之后的附加信息
   struct sqlite3_index_constraint *pIdxCons;  //用于存储索引约束信息
   struct sqlite3_index_constraint_usage *pUsage; //用于有用的索引约束
   WhereTerm *pTerm;
@@ -3689,7 +3827,8 @@ struct SrcList_item *pSrc,      /* The FROM clause term to search *//* 用于搜
   */
   pIdxInfo = *ppIdxInfo;
   if( pIdxInfo==0 ){//如果索引信息为被初始化
-    *ppIdxInfo = pIdxInfo = allocateIndexInfo(pParse, pWC, pSrc, pOrderBy);//分配和初始化索引信息
+    *ppIdxInfo = pIdxInfo = allocateIndexInfo(pParse, pWC, pSrc, pOrderBy,
+                                              pDistinct);//分配和初始化索引信息
   }
   if( pIdxInfo==0 ){//如果分配和初始化索引信息失败
     return;
@@ -3789,6 +3928,7 @@ struct SrcList_item *pSrc,      /* The FROM clause term to search *//* 用于搜
     pTerm = &pWC->a[j];
     pIdxCons->usable = (pTerm->prereqRight&notReady) ? 0 : 1;
   }
+best_index_retry:
   memset(pUsage, 0, sizeof(pUsage[0])*pIdxInfo->nConstraint);
   if( pIdxInfo->needToFreeIdxStr ){
     sqlite3_free(pIdxInfo->idxStr);
@@ -3800,14 +3940,63 @@ struct SrcList_item *pSrc,      /* The FROM clause term to search *//* 用于搜
   /* ((double)2) In case of SQLITE_OMIT_FLOATING_POINT... */
   pIdxInfo->estimatedCost = SQLITE_BIG_DBL / ((double)2);
   nOrderBy = pIdxInfo->nOrderBy;
-  if( !pOrderBy ){
+  pHidden = (HiddenIndexInfo*)&pIdxInfo[1];
+  pHidden->mHandleIn = 0;
+  pHidden->eDistinct = 0;
+  if( pHidden->bDistinct ){
+    if( pDistinct ){
+      pHidden->eDistinct = 2;
+    }else{
+      pIdxInfo->nOrderBy = 0;
+    }
+  }else if( !pOrderBy ){
     pIdxInfo->nOrderBy = 0;
   }
 
   if( vtabBestIndex(pParse, pTab, pIdxInfo) ){
+    pIdxInfo->nOrderBy = nOrderBy;
     return;
   }
 
+  /* A virtual table that uses the LIMIT or OFFSET may stop early or skip
+  ** rows, so it must also do all of the filtering and sorting itself,
+  ** and must see every value of an IN operator in a single xFilter call.
+  ** If it does not, the LIMIT and OFFSET are withdrawn and xBestIndex is
+  ** invoked again.  It cannot use them the second time, since a plan that
+  ** uses an unusable constraint is rejected by vtabBestIndex().
+  **
+  ** 使用LIMIT或OFFSET的虚表必须自己完成所有的过滤和排序。
+  */
+  pIdxCons = *(struct sqlite3_index_constraint**)&pIdxInfo->aConstraint;
+  for(i=0; i<pIdxInfo->nConstraint; i++){
+    if( pUsage[i].argvIndex>0
+     && pIdxCons[i].op>=SQLITE_INDEX_CONSTRAINT_LIMIT
+    ){
+      break;
+    }
+  }
+  if( i<pIdxInfo->nConstraint ){
+    int bBad = (pOrderBy && pIdxInfo->orderByConsumed==0);
+    for(i=0; i<pIdxInfo->nConstraint; i++){
+      u32 m = i<32 ? ((u32)1)<<i : 0;
+      if( pIdxCons[i].op>=SQLITE_INDEX_CONSTRAINT_LIMIT ) continue;
+      if( !pUsage[i].omit ) bBad = 1;
+      if( (pWC->a[pIdxCons[i].iTermOffset].eOperator & WO_IN)
+       && (pHidden->mHandleIn & m)==0
+      ){
+        bBad = 1;
+      }
+    }
+    if( bBad ){
+      for(i=0; i<pIdxInfo->nConstraint; i++){
+        if( pIdxCons[i].op>=SQLITE_INDEX_CONSTRAINT_LIMIT ){
+          pIdxCons[i].usable = 0;
+        }
+      }
+      goto best_index_retry;
+    }
+  }
+
   pIdxCons = *(struct sqlite3_index_constraint**)&pIdxInfo->aConstraint;
   for(i=0; i<pIdxInfo->nConstraint; i++){
     if( pUsage[i].argvIndex>0 ){
@@ -3853,7 +4042,11 @@ struct SrcList_item *pSrc,      /* The FROM clause term to search *//* 用于搜
   }
   pCost->plan.u.pVtabIdx = pIdxInfo;
   if( pIdxInfo->orderByConsumed ){
-    pCost->plan.wsFlags |= WHERE_ORDERBY;
+    if( pHidden->eDistinct ){
+      pCost->plan.wsFlags |= WHERE_DISTINCT;
+    }else if( pOrderBy ){
+      pCost->plan.wsFlags |= WHERE_ORDERBY;
+    }
   }
   pCost->plan.nEq = 0;
   pIdxInfo->nOrderBy = nOrderBy;
@@ -3867,6 +4060,39 @@ struct SrcList_item *pSrc,      /* The FROM clause term to search *//* 用于搜
   */
   bestOrClauseIndex(pParse, pWC, pSrc, notReady, notValid, pOrderBy, pCost);
 }
+
+/*
+** This interface is used by xBestIndex to find out whether constraint
+** iCons is an IN operator, and to ask for it to be processed all at once.
+** See the documentation of sqlite3_vtab_in() in sqlite.h.in.
+**
+** xBestIndex用于判断约束是否为IN运算符。
+*/
+int sqlite3_vtab_in(sqlite3_index_info *pIdxInfo, int iCons, int bHandle){
+  HiddenIndexInfo *pHidden = (HiddenIndexInfo*)&pIdxInfo[1];
+  u32 m;
+  if( iCons<0 || iCons>=32 ) return 0;
+  m = ((u32)1)<<iCons;
+  if( (pHidden->mIn & m)==0 ) return 0;
+  if( bHandle==0 ){
+    pHidden->mHandleIn &= ~m;
+  }else if( bHandle>0 ){
+    pHidden->mHandleIn |= m;
+  }
+  return 1;
+}
+
+/*
+** Return 2 if the aOrderBy[] array passed to xBestIndex describes the
+** columns of a DISTINCT query rather than an ORDER BY clause, or 0
+** otherwise.
+**
+** 如果aOrderBy[]描述的是DISTINCT查询的列，返回2。
+*/
+int sqlite3_vtab_distinct(sqlite3_index_info *pIdxInfo){
+  HiddenIndexInfo *pHidden = (HiddenIndexInfo*)&pIdxInfo[1];
+  return pHidden->eDistinct;
+}
 #endif /* SQLITE_OMIT_VIRTUALTABLE */
 
 #ifdef SQLITE_ENABLE_STAT3
@@ -3876,6 +4102,7 @@ struct SrcList_item *pSrc,      /* The FROM clause term to search *//* 用于搜
 **
 **    aStat[0]      Est. number of rows less than pVal
 **    aStat[1]      Est. number of rows equal to pVal
+**    aStat[2]      1 if pVal is equal to one of the samples, else 0
 **
 ** Return SQLITE_OK on success.
 ** 估计在一个索引的所有键中的一个特别键的位置。在aStat中像下面这样保存结果:
@@ -4027,6 +4254,7 @@ static int whereKeyStats(
   ** i==pIdx->nSample时，所有的样本值都小于pVal。如果aSample[i]=pVal，则
   ** isEq的值为1.
   */
+  aStat[2] = isEq;
   if( isEq ){
     assert( i<pIdx->nSample );
     aStat[0] = aSample[i].nLt;
@@ -4229,7 +4457,7 @@ static int whereRangeScanEst(
     sqlite3_value *pRangeVal;
     tRowcnt iLower = 0;
     tRowcnt iUpper = p->aiRowEst[0];
-    tRowcnt a[2];
+    tRowcnt a[3];
     u8 aff = p->pTable->aCol[p->aiColumn[0]].affinity;
 
     if( pLower ){
@@ -4294,7 +4522,9 @@ static int whereRangeScanEst(
 **
 ** Write the estimated row count into *pnRow and return SQLITE_OK. 
 ** If unable to make an estimate, leave *pnRow unchanged and return
-** non-zero.
+** non-zero.  If pbSample is not NULL and VALUE is equal to one of the
+** samples, so that the estimate is the exact count recorded by ANALYZE,
+** set *pbSample to 1.
 **
 ** 把估计的行数写入到*pnRow中并且返回SQLITE_OK.
 ** 如果不能做一个估计，保持*pnRow不变并且返回非0值。
@@ -4325,22 +4555,24 @@ static int whereEqualScanEst(
 	Parse *pParse,       /* Parsing & code generating context *//*解析上下文并且生成代码*/
 	Index *p,            /* The index whose left-most column is pTerm *//*最左列是pTerm的索引*/
 	Expr *pExpr,         /* Expression for VALUE in the x=VALUE constraint *//*x=VALUE约束条件中VALUE的表达式*/
-	double *pnRow        /* Write the revised row estimate here *//*在此写下最终修改的行的估计值*/
+	double *pnRow,       /* Write the revised row estimate here *//*在此写下最终修改的行的估计值*/
+	int *pbSample        /* OUT: Set to 1 if VALUE is one of the samples */
 ){
 	sqlite3_value *pRhs = 0;  /* VALUE on right-hand side of pTerm *//*pTerm右边项的值*/
 	u8 aff;                   /* Column affinity *//*同类列*/
 	int rc;                   /* Subfunction return code *//*子函数返回代码*/
-	tRowcnt a[2];             /* Statistics *//*统计数据*/
+	tRowcnt a[3];             /* Statistics *//*统计数据*/
 =======
   Parse *pParse,       /* Parsing & code generating context 分析上下文和生成代码 */
   Index *p,            /* The index whose left-most column is pTerm pTerm的最左列的索引 */
   Expr *pExpr,         /* Expression for VALUE in the x=VALUE constraint 在x=VALUE约束中的VALUE表达式 */
-  double *pnRow        /* Write the revised row estimate here 写入修改后的估计的行 */
+  double *pnRow,       /* Write the revised row estimate here 写入修改后的估计的行 */
+  int *pbSample        /* OUT: Set to 1 if VALUE is one of the samples */
 ){
   sqlite3_value *pRhs = 0;  /* VALUE on right-hand side of pTerm 在pTerm右边的VALUE */
   u8 aff;                   /* Column affinity 列亲和性 */
   int rc;                   /* Subfunction return code 返回代码的子函数 */
-  tRowcnt a[2];             /* Statistics 统计信息 */
+  tRowcnt a[3];             /* Statistics 统计信息 */
 >>>>>>> 91288352e83e9763d493ed84aec377d15ced3949
 
   assert( p->aSample!=0 );
@@ -4357,6 +4589,7 @@ static int whereEqualScanEst(
   if( rc==SQLITE_OK ){
     WHERETRACE(("equality scan regions: %d\n", (int)a[1]));
     *pnRow = a[1];
+    if( pbSample ) *pbSample = (int)a[2];
   }
 whereEqualScanEst_cancel:
   sqlite3ValueFree(pRhs);
@@ -4429,7 +4662,7 @@ static int whereInScanEst(
   assert( p->aSample!=0 );
   for(i=0; rc==SQLITE_OK && i<pList->nExpr; i++){
     nEst = p->aiRowEst[0];
-    rc = whereEqualScanEst(pParse, p, pList->a[i].pExpr, &nEst);
+    rc = whereEqualScanEst(pParse, p, pList->a[i].pExpr, &nEst, 0);
     nRowEst += nEst;
   }
   if( rc==SQLITE_OK ){
@@ -4441,6 +4674,524 @@ static int whereInScanEst(
 }
 //毕赣斌结束
 
+#ifdef SQLITE_ENABLE_STAT4
+/*
+** Estimate the number of rows matched by "==" constraints on the first
+** nEq columns of index p, where nEq>1, using the sqlite_stat4 samples of
+** the nEq-column prefix of the index.  Each constraint must compare the
+** column with a constant or a bound parameter.
+**
+** If the values match a sample, the estimate is the nEq of the sample.
+** Otherwise it is the average number of rows per distinct prefix in the
+** gap between the two samples that the values fall between.  Unlike the
+** sqlite_stat1 averages, neither estimate assumes that the values of
+** the columns are independent of each other.
+**
+** Write the estimated row count into *pnRow and return SQLITE_OK. 
+** If unable to make an estimate, leave *pnRow unchanged and return
+** non-zero.  Set *pbSample to 1 if the values match a sample.
+*/
+static int whereMultiEqualScanEst(
+  Parse *pParse,       /* Parsing & code generating context */
+  WhereClause *pWC,    /* The WHERE clause */
+  int iCur,            /* Cursor number of the table being scanned */
+  Bitmask notReady,    /* Mask of cursors not available for indexing */
+  Index *p,            /* The index */
+  int nEq,             /* Number of "==" constraints on columns of p */
+  double *pnRow,       /* Write the revised row estimate here */
+  int *pbSample        /* OUT: Set to 1 if the values match a sample */
+){
+  sqlite3 *db = pParse->db;
+  IndexSample *aSample;       /* Samples of the nEq-column prefix */
+  int nSample;                /* Number of entries in aSample[] */
+  sqlite3_value **apVal;      /* Right-hand sides of the constraints */
+  KeyInfo *pKeyInfo = 0;      /* Collating sequences of the index */
+  tRowcnt nLtLo, nDLtLo;      /* Rows and prefixes before the gap */
+  tRowcnt nLtHi, nDLtHi;      /* Rows and prefixes up to the end of the gap */
+  int res = -1;               /* Result of comparing a sample */
+  int rc = SQLITE_OK;         /* Subfunction return code */
+  int i;                      /* Loop counter */
+
+  for(i=0; i<p->nPrefixSample && p->aPrefixSample[i].nField!=nEq; i++);
+  aSample = &p->aPrefixSample[i];
+  for(nSample=0; i+nSample<p->nPrefixSample; nSample++){
+    if( aSample[nSample].nField!=nEq ) break;
+  }
+  if( nSample==0 ) return SQLITE_NOTFOUND;
+
+  apVal = (sqlite3_value**)sqlite3DbMallocZero(db, sizeof(apVal[0])*nEq);
+  if( apVal==0 ) return SQLITE_NOMEM;
+  for(i=0; i<nEq; i++){
+    int iCol = p->aiColumn[i];
+    WhereTerm *pTerm = findTerm(pWC, iCur, iCol, notReady, WO_EQ, p);
+    if( pTerm==0 ){
+      rc = SQLITE_NOTFOUND;
+      goto whereMultiEqualScanEst_cancel;
+    }
+    rc = valueFromExpr(pParse, pTerm->pExpr->pRight,
+                       p->pTable->aCol[iCol].affinity, &apVal[i]);
+    if( rc==SQLITE_OK && apVal[i]==0 ) rc = SQLITE_NOTFOUND;
+    if( rc ) goto whereMultiEqualScanEst_cancel;
+  }
+  pKeyInfo = sqlite3IndexKeyinfo(pParse, p);
+  if( pKeyInfo==0 ){
+    rc = SQLITE_NOTFOUND;
+    goto whereMultiEqualScanEst_cancel;
+  }
+
+  /* Find the first sample that is not less than the values */
+  for(i=0; i<nSample; i++){
+    rc = sqlite3VdbeRecordCompareValues(pKeyInfo, aSample[i].nByte,
+                                        aSample[i].u.z, nEq, apVal, &res);
+    if( rc || res>=0 ) break;
+  }
+  if( rc ) goto whereMultiEqualScanEst_cancel;
+
+  if( i<nSample && res==0 ){
+    *pnRow = aSample[i].nEq;
+    *pbSample = 1;
+  }else{
+    if( i==0 ){
+      nLtLo = 0;
+      nDLtLo = 0;
+    }else{
+      nLtLo = aSample[i-1].nLt + aSample[i-1].nEq;
+      nDLtLo = aSample[i-1].nDLt + 1;
+    }
+    if( i<nSample ){
+      nLtHi = aSample[i].nLt;
+      nDLtHi = aSample[i].nDLt;
+    }else{
+      nLtHi = p->aiRowEst[0];
+      nDLtHi = p->aiRowEst[nEq] ? p->aiRowEst[0]/p->aiRowEst[nEq] : 0;
+    }
+    if( nLtHi>nLtLo && nDLtHi>nDLtLo ){
+      *pnRow = (double)(nLtHi - nLtLo)/(double)(nDLtHi - nDLtLo);
+    }else{
+      rc = SQLITE_NOTFOUND;
+    }
+  }
+  WHERETRACE(("%d-column equality estimate: rc=%d est=%g\n", nEq, rc, *pnRow));
+
+whereMultiEqualScanEst_cancel:
+  for(i=0; i<nEq; i++){
+    sqlite3ValueFree(apVal[i]);
+  }
+  sqlite3DbFree(db, apVal);
+  sqlite3DbFree(db, pKeyInfo);
+  return rc;
+}
+#endif /* SQLITE_ENABLE_STAT4 */
+
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+/*
+** Cardinality feedback.
+**
+** While PRAGMA cardinality_feedback is on, the WHERE loops of each new
+** statement that step through a table or index are measured using the
+** sqlite3_stmt_scanstatus() counters.  When the statement is reset or
+** finalized, the average number of rows visited by each loop that ran
+** to completion is folded into the sqlite3.aCardFeedback hash table.
+** Entries are keyed by the shape of the loop: the table or index, the
+** number of "==" constraints used and whether or not the range has an
+** upper and a lower bound.  The key also holds the schema cookie of the
+** database, so that measurements made before a table or index was
+** dropped and recreated, or before any other schema change, are never
+** applied to the new object.  Entries made stale this way are discarded
+** the next time a measurement is recorded.  When a later statement considers a loop of
+** the same shape, bestBtreeIndex() uses the measured row count in place
+** of the estimate derived from sqlite_stat1 and sqlite_stat3, unless a
+** sqlite_stat3 or sqlite_stat4 sample records the number of rows for the
+** very value being looked up.
+**
+** Loops that use an IN operator are not measured, as the number of rows
+** they visit depends on the size of the IN list as much as on the data.
+*/
+typedef struct WhereFeedback WhereFeedback;
+struct WhereFeedback {
+  double rRow;            /* Average rows visited per loop */
+  int nObs;               /* Number of measurements averaged into rRow */
+  char zKey[1];           /* Hash key.  MUST BE LAST */
+};
+
+/*
+** Maximum number of entries in the feedback store.  The store is emptied
+** when it fills up.
+*/
+#ifndef SQLITE_MAX_CARD_FEEDBACK
+# define SQLITE_MAX_CARD_FEEDBACK 1000
+#endif
+
+/*
+** Each new measurement has a weight of at least 1/WHERE_FEEDBACK_OBS in
+** the average, so that the store follows a table whose contents change.
+*/
+#define WHERE_FEEDBACK_OBS 8
+
+/*
+** Return the feedback key for a loop over index pIdx of table pTab (or
+** over the table itself if pIdx is NULL) using nEq "==" constraints and
+** the range bounds in wsFlags.  Space to hold the key is obtained from
+** sqlite3DbMalloc().  NULL is returned if loops of this kind are not
+** measured.
+*/
+static char *whereFeedbackKey(
+  sqlite3 *db,                    /* Database connection */
+  Table *pTab,                    /* Table being scanned */
+  Index *pIdx,                    /* Index being scanned, or NULL */
+  int nEq,                        /* Number of "==" constraints used */
+  u32 wsFlags                     /* WHERE_* flags for the loop */
+){
+  if( pTab->pSchema==0 ) return 0;
+  if( wsFlags & (WHERE_COLUMN_IN|WHERE_UNIQUE|WHERE_MULTI_OR
+                |WHERE_VIRTUALTABLE|WHERE_TEMP_INDEX) ){
+    return 0;
+  }
+  return sqlite3MPrintf(db, "%d.%d.%s/%d/%d%d",
+      sqlite3SchemaToIndex(db, pTab->pSchema), pTab->pSchema->schema_cookie,
+      pIdx ? pIdx->zName : pTab->zName, nEq,
+      (wsFlags & WHERE_BTM_LIMIT)!=0, (wsFlags & WHERE_TOP_LIMIT)!=0
+  );
+}
+
+/*
+** Return true if feedback key zKey was made under the current schema of
+** the database it refers to.
+*/
+static int whereFeedbackIsCurrent(sqlite3 *db, const char *zKey){
+  char zPrefix[30];
+  const char *z;
+  int iDb = 0;
+
+  for(z=zKey; sqlite3Isdigit(*z) && iDb<db->nDb; z++){
+    iDb = iDb*10 + *z - '0';
+  }
+  if( iDb>=db->nDb || db->aDb[iDb].pSchema==0 ) return 0;
+  sqlite3_snprintf(sizeof(zPrefix), zPrefix, "%d.%d.",
+                   iDb, db->aDb[iDb].pSchema->schema_cookie);
+  return strncmp(zKey, zPrefix, sqlite3Strlen30(zPrefix))==0;
+}
+
+/*
+** Record that a loop with feedback key zKey visited rRow rows per
+** iteration.
+*/
+void sqlite3WhereFeedback(sqlite3 *db, const char *zKey, double rRow){
+  int nKey = sqlite3Strlen30(zKey);
+  WhereFeedback *p;
+  HashElem *i, *pNext;
+
+  /* Ignore measurements made by statements compiled against an earlier
+  ** schema. */
+  if( !whereFeedbackIsCurrent(db, zKey) ) return;
+
+  p = (WhereFeedback*)sqlite3HashFind(&db->aCardFeedback, zKey, nKey);
+  if( p ){
+    if( p->nObs<WHERE_FEEDBACK_OBS ) p->nObs++;
+    p->rRow += (rRow - p->rRow)/p->nObs;
+    return;
+  }
+
+  /* Before adding a new entry, discard any that were made under an
+  ** earlier schema. */
+  for(i=sqliteHashFirst(&db->aCardFeedback); i; i=pNext){
+    pNext = sqliteHashNext(i);
+    p = (WhereFeedback*)sqliteHashData(i);
+    if( !whereFeedbackIsCurrent(db, p->zKey) ){
+      sqlite3HashInsert(&db->aCardFeedback, p->zKey,
+                        sqlite3Strlen30(p->zKey), 0);
+      sqlite3_free(p);
+    }
+  }
+  if( (int)db->aCardFeedback.count>=SQLITE_MAX_CARD_FEEDBACK ){
+    sqlite3WhereFeedbackClear(db);
+  }
+  p = (WhereFeedback*)sqlite3Malloc(sizeof(WhereFeedback) + nKey);
+  if( p ){
+    p->rRow = rRow;
+    p->nObs = 1;
+    memcpy(p->zKey, zKey, nKey+1);
+    if( sqlite3HashInsert(&db->aCardFeedback, p->zKey, nKey, p)==p ){
+      /* Malloc failed within the hash table */
+      sqlite3_free(p);
+    }
+  }
+}
+
+/*
+** Discard the contents of the feedback store.
+*/
+void sqlite3WhereFeedbackClear(sqlite3 *db){
+  HashElem *i;
+  for(i=sqliteHashFirst(&db->aCardFeedback); i; i=sqliteHashNext(i)){
+    sqlite3_free(sqliteHashData(i));
+  }
+  sqlite3HashClear(&db->aCardFeedback);
+}
+
+/*
+** If loops of the shape described by the arguments have been measured,
+** set *pnRow to the measured number of rows visited per loop.
+*/
+static void whereFeedbackEst(
+  Parse *pParse,                  /* Parsing & code generating context */
+  Table *pTab,                    /* Table being scanned */
+  Index *pIdx,                    /* Index being scanned, or NULL */
+  int nEq,                        /* Number of "==" constraints used */
+  u32 wsFlags,                    /* WHERE_* flags for the loop */
+  double *pnRow                   /* IN/OUT: Estimated rows per loop */
+){
+  sqlite3 *db = pParse->db;
+  char *zKey;
+  WhereFeedback *p;
+
+  zKey = whereFeedbackKey(db, pTab, pIdx, nEq, wsFlags);
+  if( zKey==0 ) return;
+  p = (WhereFeedback*)sqlite3HashFind(&db->aCardFeedback, zKey,
+                                      sqlite3Strlen30(zKey));
+  sqlite3DbFree(db, zKey);
+  if( p ){
+    WHERETRACE(("... feedback for %s: %g rows\n", p->zKey, p->rRow));
+    *pnRow = p->rRow<1 ? 1 : p->rRow;
+  }
+}
+#endif /* SQLITE_OMIT_CARD_FEEDBACK */
+
+#ifndef SQLITE_OMIT_INDEX_ADVISOR
+/*
+** Index advisor.
+**
+** While PRAGMA index_advisor is on, each loop of a new statement that is
+** planned as a full table scan or as an automatic index is examined to
+** see whether or not an index on the table would have served it better.
+** The candidate index is made up of the columns of the "==" constraints
+** that an automatic index could be built on, followed by at most one
+** column constrained by a range.  If the planner's cost estimate for
+** the candidate is less than that of the chosen plan, the difference,
+** scaled by the number of times the loop is expected to run, is
+** attached to the VM as the benefit of the index.  Each time the VM
+** runs, the benefit is credited to the candidate's entry in the
+** sqlite3.aIndexAdvice hash table.  PRAGMA index_advice lists the
+** entries.
+**
+** Entries are keyed by the database, table and columns of the candidate
+** and the CREATE INDEX statement for it, separated by 0x01 bytes.
+*/
+
+/*
+** Maximum number of entries in the index advisor.  Once the limit is
+** reached, new candidates are ignored.
+*/
+#ifndef SQLITE_MAX_INDEX_ADVICE
+# define SQLITE_MAX_INDEX_ADVICE 200
+#endif
+
+/*
+** Credit an execution that wanted the index with key zKey and that would
+** have saved rBenefit by using it.
+*/
+void sqlite3WhereAdvice(sqlite3 *db, const char *zKey, double rBenefit){
+  int nKey = sqlite3Strlen30(zKey);
+  IndexAdvice *p;
+  const char **azPart;
+  char *z;
+  int i;
+
+  p = (IndexAdvice*)sqlite3HashFind(&db->aIndexAdvice, zKey, nKey);
+  if( p ){
+    p->nUse++;
+    p->rBenefit += rBenefit;
+    return;
+  }
+  if( (int)db->aIndexAdvice.count>=SQLITE_MAX_INDEX_ADVICE ) return;
+  p = (IndexAdvice*)sqlite3Malloc(sizeof(IndexAdvice) + 2*nKey + 1);
+  if( p==0 ) return;
+  p->nUse = 1;
+  p->rBenefit = rBenefit;
+  memcpy(p->zKey, zKey, nKey+1);
+
+  /* A second copy of the key is split into its four parts */
+  z = &p->zKey[nKey+1];
+  memcpy(z, zKey, nKey+1);
+  azPart = &p->zDb;
+  assert( &azPart[3]==&p->zSql );
+  for(i=0; i<4 && z; i++){
+    azPart[i] = z;
+    z = strchr(z, '\001');
+    if( z ) *(z++) = 0;
+  }
+  if( i<4 || z ){
+    sqlite3_free(p);
+    return;
+  }
+  if( sqlite3HashInsert(&db->aIndexAdvice, p->zKey, nKey, p)==p ){
+    /* Malloc failed within the hash table */
+    sqlite3_free(p);
+  }
+}
+
+/*
+** Discard the contents of the index advisor.
+*/
+void sqlite3WhereAdviceClear(sqlite3 *db){
+  HashElem *i;
+  for(i=sqliteHashFirst(&db->aIndexAdvice); i; i=sqliteHashNext(i)){
+    sqlite3_free(sqliteHashData(i));
+  }
+  sqlite3HashClear(&db->aIndexAdvice);
+}
+
+/*
+** Return an array of pointers to the entries of the index advisor, the
+** entry with the greatest total benefit first, and set *pnAdvice to the
+** number of entries.  The array is obtained from sqlite3DbMallocRaw()
+** and must be freed by the caller.  NULL is returned if the advisor is
+** empty or if a malloc fails.
+*/
+IndexAdvice **sqlite3WhereAdviceList(sqlite3 *db, int *pnAdvice){
+  IndexAdvice **a;
+  HashElem *i;
+  int n = 0;
+
+  *pnAdvice = 0;
+  if( db->aIndexAdvice.count==0 ) return 0;
+  a = sqlite3DbMallocRaw(db, db->aIndexAdvice.count*sizeof(IndexAdvice*));
+  if( a==0 ) return 0;
+  for(i=sqliteHashFirst(&db->aIndexAdvice); i; i=sqliteHashNext(i)){
+    IndexAdvice *p = (IndexAdvice*)sqliteHashData(i);
+    int j;
+    for(j=n; j>0 && a[j-1]->rBenefit<p->rBenefit; j--){
+      a[j] = a[j-1];
+    }
+    a[j] = p;
+    n++;
+  }
+  *pnAdvice = n;
+  return a;
+}
+
+/*
+** Return true if pTerm is a range constraint on a column of pSrc that
+** an index could be used for.  See also termCanDriveIndex().
+*/
+static int termCanBoundIndex(
+  WhereTerm *pTerm,              /* WHERE clause term to check */
+  struct SrcList_item *pSrc,     /* Table we are trying to access */
+  Bitmask notReady               /* Tables in outer loops of the join */
+){
+  char aff;
+  if( pTerm->leftCursor!=pSrc->iCursor ) return 0;
+  if( (pTerm->eOperator & (WO_LT|WO_LE|WO_GT|WO_GE))==0 ) return 0;
+  if( (pTerm->prereqRight & notReady)!=0 ) return 0;
+  aff = pSrc->pTab->aCol[pTerm->u.leftColumn].affinity;
+  if( !sqlite3IndexAffinityOk(pTerm->pExpr, aff) ) return 0;
+  return 1;
+}
+
+/*
+** The query planner has chosen plan pCost for the loop over pSrc.  If the
+** plan is a full table scan or an automatic index and a suitable index
+** on the table would have been cheaper, attach the index and the saving
+** to the VM being constructed.  See the comments above for details.
+*/
+static void whereIndexAdvice(
+  Parse *pParse,              /* The parsing context */
+  WhereClause *pWC,           /* The WHERE clause */
+  struct SrcList_item *pSrc,  /* The FROM clause term the plan is for */
+  Bitmask notReady,           /* Mask of cursors that are not available */
+  WhereCost *pCost            /* The plan chosen for pSrc */
+){
+  sqlite3 *db = pParse->db;
+  Table *pTab = pSrc->pTab;
+  Vdbe *v = pParse->pVdbe;
+  WhereTerm *pTerm;           /* A term of the WHERE clause */
+  WhereTerm *pWCEnd;          /* End of pWC->a[] */
+  Bitmask mCol = 0;           /* Columns already in the candidate */
+  int aiCol[BMS];             /* Columns of the candidate index */
+  int nEq = 0;                /* Number of "==" columns in aiCol[] */
+  int nCol;                   /* Number of columns in aiCol[] */
+  double nTableRow;           /* Rows in the table */
+  double logN;                /* log(nTableRow) */
+  double nRowOut;             /* Rows visited using the candidate */
+  double rBenefit;            /* Estimated saving per execution */
+  char *zCols = 0;            /* Column names separated by "," */
+  char *zList = 0;            /* Quoted column names separated by "," */
+  char *zName = 0;            /* Name for the index */
+  char *zKey;                 /* Index advisor key */
+  const char *zDb;            /* Database holding pTab */
+  int iDb;                    /* Index of zDb in db->aDb[] */
+  int i;
+
+  if( db->bIndexAdvisor==0 || db->init.busy || pParse->explain || v==0 ){
+    return;
+  }
+  if( (pCost->plan.wsFlags & (WHERE_NOT_FULLSCAN|WHERE_VIRTUALTABLE)) ){
+    return;
+  }
+  if( pSrc->pSelect || pSrc->notIndexed || pTab->pSchema==0 ) return;
+  if( IsVirtual(pTab) || sqlite3StrNICmp(pTab->zName, "sqlite_", 7)==0 ){
+    return;
+  }
+
+  /* Gather the "==" columns, then at most one range column */
+  pWCEnd = &pWC->a[pWC->nTerm];
+  for(pTerm=pWC->a; pTerm<pWCEnd && nEq<BMS-1; pTerm++){
+    int iCol = pTerm->u.leftColumn;
+    if( pTerm->leftCursor!=pSrc->iCursor || iCol<0 || iCol>=BMS ) continue;
+    if( (mCol & (((Bitmask)1)<<iCol))!=0 ) continue;
+    if( termCanDriveIndex(pTerm, pSrc, notReady) ){
+      mCol |= ((Bitmask)1)<<iCol;
+      aiCol[nEq++] = iCol;
+    }
+  }
+  nCol = nEq;
+  for(pTerm=pWC->a; pTerm<pWCEnd && nCol==nEq; pTerm++){
+    int iCol = pTerm->u.leftColumn;
+    if( pTerm->leftCursor!=pSrc->iCursor || iCol<0 || iCol>=BMS ) continue;
+    if( (mCol & (((Bitmask)1)<<iCol))!=0 ) continue;
+    if( termCanBoundIndex(pTerm, pSrc, notReady) ){
+      aiCol[nCol++] = iCol;
+    }
+  }
+  if( nCol==0 ) return;
+
+  /* Cost the candidate the way bestBtreeIndex() would without sqlite_stat1
+  ** data: 10 rows for each "==" prefix, a third of the rows for a range,
+  ** and a binary search plus a rowid lookup for each row visited. */
+  nTableRow = pTab->nRowEst;
+  logN = estLog(nTableRow);
+  nRowOut = nEq>0 ? 10 : nTableRow;
+  if( nCol>nEq ) nRowOut /= 3;
+  if( nRowOut>nTableRow ) nRowOut = nTableRow;
+  rBenefit = pCost->rCost - (logN + nRowOut*(logN+1));
+  if( rBenefit<=0 ) return;
+  rBenefit *= pParse->nQueryLoop;
+
+  for(i=0; i<nCol; i++){
+    const char *zCol = pTab->aCol[aiCol[i]].zName;
+    const char *zSep = i ? "," : "";
+    zCols = sqlite3MAppendf(db, zCols, "%s%s%s", zCols, zSep, zCol);
+    zList = sqlite3MAppendf(db, zList, "%s%s\"%w\"", zList, zSep, zCol);
+    zName = sqlite3MAppendf(db, zName, "%s_%s", zName, zCol);
+  }
+  iDb = sqlite3SchemaToIndex(db, pTab->pSchema);
+  zDb = db->aDb[iDb].zName;
+  zKey = sqlite3MPrintf(db,
+      "%s\001%s\001%s\001CREATE INDEX \"%w\".\"advice_%w%w\" ON \"%w\"(%s)",
+      zDb, pTab->zName, zCols, zDb, pTab->zName, zName, pTab->zName, zList
+  );
+  sqlite3DbFree(db, zCols);
+  sqlite3DbFree(db, zList);
+  sqlite3DbFree(db, zName);
+  if( zKey ){
+    WHERETRACE(("... index advice %s: benefit %g\n", zKey, rBenefit));
+    sqlite3VdbeIndexAdvice(v, zKey, rBenefit);
+  }
+}
+#else
+# define whereIndexAdvice(A,B,C,D,E)
+#endif /* SQLITE_OMIT_INDEX_ADVISOR */
+
 /*王秀超 从此开始
 ** Find the best query plan for accessing a particular table.  Write the
 ** best query plan and its cost into the WhereCost object supplied as the
@@ -4812,6 +5563,7 @@ static void bestBtreeIndex(
     WhereTerm *pTerm;             /* 一个WHERE子句 */
 #ifdef SQLITE_ENABLE_STAT3
     WhereTerm *pFirstTerm = 0;    /* 第一个查询匹配的索引*/
+    int bSampleEst = 0;           /* True if nRow is the count of a sample */
 #endif
 
     /* Determine the values of nEq and nInMul 
@@ -4829,6 +5581,7 @@ static void bestBtreeIndex(
     WhereTerm *pTerm;             /* A single term of the WHERE clause WHERE子句的一个单独的term */
 #ifdef SQLITE_ENABLE_STAT3
     WhereTerm *pFirstTerm = 0;    /* First term matching the index 匹配索引的第一个term */
+    int bSampleEst = 0;           /* True if nRow is the count of a sample */
 #endif
 
     /* Determine the values of nEq and nInMul 确定nEq和nInMul的值  */
@@ -5037,12 +5790,24 @@ static void bestBtreeIndex(
       if( pFirstTerm->eOperator & (WO_EQ|WO_ISNULL) ){
         testcase( pFirstTerm->eOperator==WO_EQ );
         testcase( pFirstTerm->eOperator==WO_ISNULL );
-        whereEqualScanEst(pParse, pProbe, pFirstTerm->pExpr->pRight, &nRow);
+        whereEqualScanEst(pParse, pProbe, pFirstTerm->pExpr->pRight, &nRow,
+                          &bSampleEst);
       }else if( bInEst==0 ){
         assert( pFirstTerm->eOperator==WO_IN );
         whereInScanEst(pParse, pProbe, pFirstTerm->pExpr->x.pList, &nRow);
       }
     }
+#ifdef SQLITE_ENABLE_STAT4
+    /* Likewise for "==" constraints on two or more leading columns of the
+    ** index, if there are sqlite_stat4 samples for that many columns.
+    */
+    else if( nRow>(double)1 && nEq>1 && pProbe->nPrefixSample>0
+          && (wsFlags & (WHERE_COLUMN_IN|WHERE_COLUMN_NULL))==0
+    ){
+      whereMultiEqualScanEst(pParse, pWC, iCur, notReady, pProbe, nEq, &nRow,
+                             &bSampleEst);
+    }
+#endif
 #endif /* SQLITE_ENABLE_STAT3 */
 
     /* Adjust the number of output rows and downward to reflect rows
@@ -5057,6 +5822,23 @@ static void bestBtreeIndex(
     nRow = nRow/rangeDiv;
     if( nRow<1 ) nRow = 1;
 
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+    /* Prefer a row count measured by earlier executions of loops of
+    ** the same shape to the estimate obtained above, unless that estimate
+    ** is the number of rows that ANALYZE counted for the very value being
+    ** looked up.  The measured count is an average over all the values
+    ** seen, so it is no better than the stat3 or stat4 figure for a
+    ** sampled value.
+    */
+    if( pParse->db->bCardFeedback
+#ifdef SQLITE_ENABLE_STAT3
+     && bSampleEst==0
+#endif
+    ){
+      whereFeedbackEst(pParse, pSrc->pTab, pIdx, nEq, wsFlags, &nRow);
+    }
+#endif
+
     /* Experiments run on real SQLite databases show that the time needed
     ** to do a binary search to locate a row in a table or index is roughly
     ** log10(N) times the time to move from one row to the next row within
@@ -5457,7 +6239,8 @@ static void bestIndex(
 #ifndef SQLITE_OMIT_VIRTUALTABLE
   if( IsVirtual(pSrc->pTab) ){ //如果是虚表
     sqlite3_index_info *p = 0;
-    bestVirtualIndex(pParse, pWC, pSrc, notReady, notValid, pOrderBy, pCost,&p);
+    bestVirtualIndex(pParse, pWC, pSrc, notReady, notValid, pOrderBy, 0,
+                     pCost, &p);
     if( p->needToFreeIdxStr ){
       sqlite3_free(p->idxStr);
     }
@@ -5551,6 +6334,48 @@ static void disableTerm(WhereLevel *pLevel, WhereTerm *pTerm){
   }
 }
 
+#ifndef SQLITE_OMIT_SUBQUERY
+/*
+** Code the top of a loop over the values on the right-hand side of the
+** IN operator pX, leaving the current value in register iReg.  The loop
+** is closed by sqlite3WhereEnd().
+**
+** 生成遍历IN运算符右边所有值的循环的开始部分，当前值存放在寄存器iReg中。
+*/
+static void codeInLoop(Parse *pParse, Expr *pX, WhereLevel *pLevel, int iReg){
+  Vdbe *v = pParse->pVdbe;
+  int eType;
+  int iTab;
+  struct InLoop *pIn;
+
+  assert( pX->op==TK_IN );
+  eType = sqlite3FindInIndex(pParse, pX, 0);
+  iTab = pX->iTable;
+  sqlite3VdbeAddOp2(v, OP_Rewind, iTab, 0);
+  assert( pLevel->plan.wsFlags & (WHERE_IN_ABLE|WHERE_VIRTUALTABLE) );
+  if( pLevel->u.in.nIn==0 ){
+    pLevel->addrNxt = sqlite3VdbeMakeLabel(v);
+  }
+  pLevel->u.in.nIn++;
+  pLevel->u.in.aInLoop =
+     sqlite3DbReallocOrFree(pParse->db, pLevel->u.in.aInLoop,
+                            sizeof(pLevel->u.in.aInLoop[0])*pLevel->u.in.nIn);
+  pIn = pLevel->u.in.aInLoop;
+  if( pIn ){
+    pIn += pLevel->u.in.nIn - 1;
+    pIn->iCur = iTab;
+    if( eType==IN_INDEX_ROWID ){
+      pIn->addrInTop = sqlite3VdbeAddOp2(v, OP_Rowid, iTab, iReg);
+    }else{
+      pIn->addrInTop = sqlite3VdbeAddOp3(v, OP_Column, iTab, 0, iReg);
+    }
+    sqlite3VdbeAddOp1(v, OP_IsNull, iReg);
+  }else{
+    pLevel->u.in.nIn = 0;
+  }
+}
+#endif
+
 /*
 ** Code an OP_Affinity opcode to apply the column affinity string zAff
 ** to the n registers starting at base. 
@@ -5681,36 +6506,9 @@ static int codeEqualityTerm(
     sqlite3VdbeAddOp2(v, OP_Null, 0, iReg);
 #ifndef SQLITE_OMIT_SUBQUERY
   }else{
-    int eType;
-    int iTab;
-    struct InLoop *pIn;
-
-    assert( pX->op==TK_IN );
-    iReg = iTarget;
-    eType = sqlite3FindInIndex(pParse, pX, 0);
-    iTab = pX->iTable;
-    sqlite3VdbeAddOp2(v, OP_Rewind, iTab, 0);
     assert( pLevel->plan.wsFlags & WHERE_IN_ABLE );
-    if( pLevel->u.in.nIn==0 ){
-      pLevel->addrNxt = sqlite3VdbeMakeLabel(v);
-    }
-    pLevel->u.in.nIn++;
-    pLevel->u.in.aInLoop =
-       sqlite3DbReallocOrFree(pParse->db, pLevel->u.in.aInLoop,
-                              sizeof(pLevel->u.in.aInLoop[0])*pLevel->u.in.nIn);
-    pIn = pLevel->u.in.aInLoop;
-    if( pIn ){
-      pIn += pLevel->u.in.nIn - 1;
-      pIn->iCur = iTab;
-      if( eType==IN_INDEX_ROWID ){
-        pIn->addrInTop = sqlite3VdbeAddOp2(v, OP_Rowid, iTab, iReg);
-      }else{
-        pIn->addrInTop = sqlite3VdbeAddOp3(v, OP_Column, iTab, 0, iReg);
-      }
-      sqlite3VdbeAddOp1(v, OP_IsNull, iReg);
-    }else{
-      pLevel->u.in.nIn = 0;
-    }
+    iReg = iTarget;
+    codeInLoop(pParse, pX, pLevel, iReg);
 #endif
   }
   disableTerm(pLevel, pTerm);
@@ -6087,7 +6885,15 @@ static void explainOneScan(
   u16 wctrlFlags                  /* Flags passed to sqlite3WhereBegin() 传给sqlite3WhereBegin()的标志 */
 >>>>>>> 91288352e83e9763d493ed84aec377d15ced3949
 ){
-  if( pParse->explain==2 ){
+  int bScanStatus = 0;            /* True to record sqlite3_stmt_scanstatus() */
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+  bScanStatus = pParse->explain==0
+             && (pParse->db->flags & SQLITE_ScanStatus)!=0;
+#endif
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+  bScanStatus |= pParse->explain==0 && pParse->db->bCardFeedback;
+#endif
+  if( pParse->explain==2 || bScanStatus ){
     u32 flags = pLevel->plan.wsFlags;
     struct SrcList_item *pItem = &pTabList->a[pLevel->iFrom];
 <<<<<<< HEAD
@@ -6159,6 +6965,17 @@ static void explainOneScan(
       nRow = (sqlite3_int64)pLevel->plan.nRow;
     }
     zMsg = sqlite3MAppendf(db, zMsg, "%s (~%lld rows)", zMsg, nRow);
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+    if( bScanStatus ){
+      const char *zName = pItem->zName;
+      if( (flags & WHERE_INDEXED)!=0 && (flags & WHERE_TEMP_INDEX)==0 ){
+        zName = pLevel->plan.u.pIdx->zName;
+      }
+      pLevel->iScan = sqlite3VdbeScanStatus(v, sqlite3VdbeCurrentAddr(v),
+          (double)nRow, iId, zName, zMsg);
+      return;
+    }
+#endif
     sqlite3VdbeAddOp4(v, OP_Explain, iId, iLevel, iFrom, zMsg, P4_DYNAMIC);
   }
 }
@@ -6291,7 +7108,9 @@ static Bitmask codeOneLoopStart(
 >>>>>>> 91288352e83e9763d493ed84aec377d15ced3949
     */
     int iReg;   /* P3 Value for OP_VFilter OP_VFilter的P3值 */
+    int iPass;  /* 0 for IN loops, 1 for all other arguments 0为IN循环，1为其它参数 */
     sqlite3_index_info *pVtabIdx = pLevel->plan.u.pVtabIdx;
+    HiddenIndexInfo *pHidden = (HiddenIndexInfo*)&pVtabIdx[1];
     int nConstraint = pVtabIdx->nConstraint;
     struct sqlite3_index_constraint_usage *aUsage =
                                                 pVtabIdx->aConstraintUsage;
@@ -6300,19 +7119,53 @@ static Bitmask codeOneLoopStart(
 
     sqlite3ExprCachePush(pParse);
     iReg = sqlite3GetTempRange(pParse, nConstraint+2);
-    for(j=1; j<=nConstraint; j++){
-      for(k=0; k<nConstraint; k++){
-        if( aUsage[k].argvIndex==j ){
-          int iTerm = aConstraint[k].iTermOffset;
-          sqlite3ExprCode(pParse, pWC->a[iTerm].pExpr->pRight, iReg+j+1);
-          break;
+
+    /* IN operators that the virtual table does not process all at once
+    ** become loops around the OP_VFilter.  Code those loops first, so
+    ** that every other argument is recomputed on each iteration.
+    **
+    ** 虚表不一次处理的IN运算符变成OP_VFilter外层的循环，先为这些循环生成代码。
+    */
+    for(iPass=0; iPass<2; iPass++){
+      for(j=1; j<=nConstraint; j++){
+        Expr *pX;
+        int bInLoop;
+        for(k=0; k<nConstraint && aUsage[k].argvIndex!=j; k++){}
+        if( k==nConstraint ) break;
+        pTerm = &pWC->a[aConstraint[k].iTermOffset];
+        pX = pTerm->pExpr;
+        bInLoop = (pTerm->eOperator & WO_IN)!=0
+               && (k>=32 || (pHidden->mHandleIn & (((u32)1)<<k))==0);
+        if( bInLoop!=(iPass==0) ) continue;
+#ifndef SQLITE_OMIT_SUBQUERY
+        if( pTerm->eOperator & WO_IN ){
+          if( bInLoop ){
+            codeInLoop(pParse, pX, pLevel, iReg+j+1);
+          }else{
+            int eType = sqlite3FindInIndex(pParse, pX, 0);
+            sqlite3VdbeAddOp3(v, OP_VInitIn, pX->iTable, iReg+j+1,
+                              eType==IN_INDEX_ROWID);
+          }
+          continue;
+        }
+#endif
+        if( pTerm->eOperator==WO_AUX ){
+          /* The LIMIT and OFFSET registers are deep-copied so that an
+          ** omitted OFFSET can be cleared before xFilter runs. */
+          assert( pX->pRight->op==TK_REGISTER );
+          sqlite3VdbeAddOp2(v, OP_Copy, pX->pRight->iTable, iReg+j+1);
+          if( pX->op==TK_OFFSET && aUsage[k].omit ){
+            sqlite3VdbeAddOp2(v, OP_Integer, 0, pX->pRight->iTable);
+          }
+          continue;
         }
+        sqlite3ExprCode(pParse, pX->pRight, iReg+j+1);
       }
-      if( k==nConstraint ) break;
     }
     sqlite3VdbeAddOp2(v, OP_Integer, pVtabIdx->idxNum, iReg);
     sqlite3VdbeAddOp2(v, OP_Integer, j-1, iReg+1);
-    sqlite3VdbeAddOp4(v, OP_VFilter, iCur, addrBrk, iReg, pVtabIdx->idxStr,
+    sqlite3VdbeAddOp4(v, OP_VFilter, iCur, pLevel->addrNxt, iReg,
+                      pVtabIdx->idxStr,
                       pVtabIdx->needToFreeIdxStr ? P4_MPRINTF : P4_STATIC);
     pVtabIdx->needToFreeIdxStr = 0;
     for(j=0; j<nConstraint; j++){
@@ -7098,7 +7951,7 @@ static Bitmask codeOneLoopStart(
 =======
         /* Loop through table entries that match term pOrTerm. 循环遍历表中匹配pOrTerm的条目 */
 >>>>>>> 91288352e83e9763d493ed84aec377d15ced3949
-        pSubWInfo = sqlite3WhereBegin(pParse, pOrTab, pOrExpr, 0, 0,
+        pSubWInfo = sqlite3WhereBegin(pParse, pOrTab, pOrExpr, 0, 0, 0,
                         WHERE_OMIT_OPEN_CLOSE | WHERE_AND_ONLY |
                         WHERE_FORCE_TABLE | WHERE_ONETABLE_ONLY, iCovCur);
         assert( pSubWInfo || pParse->nErr || pParse->db->mallocFailed );
@@ -7547,6 +8400,7 @@ WhereInfo *sqlite3WhereBegin(
   Expr *pWhere,         /* The WHERE clause  WHERE子句*/
   ExprList **ppOrderBy, /* An ORDER BY clause, or NULL  ORDER BY集，或NULL*/
   ExprList *pDistinct,  /* The select-list for DISTINCT queries - or NULL  选择列表中的DISTINCT查询 - 或NULL*/
+  Select *pLimit,       /* SELECT whose LIMIT a virtual table may use, or NULL  其LIMIT可下推到虚表的SELECT，或NULL*/
   u16 wctrlFlags,       /* One of the WHERE_* flags defined in sqliteInt.h  一个在sqliteInt.h定义的WHERE_*标志 */
   int iIdxCur           /* If WHERE_ONETABLE_ONLY is set, index cursor number 如果WHERE_ONETABLE_ONLY被设置，索引光标号*/
 ){
@@ -7583,6 +8437,7 @@ WhereInfo *sqlite3WhereBegin(
   Expr *pWhere,         /* The WHERE clause WHERE子句 */
   ExprList **ppOrderBy, /* An ORDER BY clause, or NULL 一个ORDER BY子句或NULL*/
   ExprList *pDistinct,  /* The select-list for DISTINCT queries - or NULL DISTINCT查询的查询列表或NULL */
+  Select *pLimit,       /* SELECT whose LIMIT a virtual table may use, or NULL 其LIMIT可下推到虚表的SELECT或NULL */
   u16 wctrlFlags,       /* One of the WHERE_* flags defined in sqliteInt.h 在sqliteInt.h中定义的WHERE_*中的一个 */
   int iIdxCur           /* If WHERE_ONETABLE_ONLY is set, index cursor number 如果设置了WHERE_ONETABLE_ONLY，则为索引游标数 */
 ){
@@ -7649,7 +8504,7 @@ WhereInfo *sqlite3WhereBegin(
   */
   db = pParse->db;	//连接数据库
   nByteWInfo = ROUND8(sizeof(WhereInfo)+(nTabList-1)*sizeof(WhereLevel));	//为WhereInfo分配相应的字节数
-  pWInfo = sqlite3DbMallocZero(db, 
+  pWInfo = sqlite3ArenaMallocZero(db, 
       nByteWInfo + 
       sizeof(WhereClause) +
       sizeof(WhereMaskSet)
@@ -7799,6 +8654,11 @@ WhereInfo *sqlite3WhereBegin(
 >>>>>>> 91288352e83e9763d493ed84aec377d15ced3949
   */
   exprAnalyzeAll(pTabList, pWC);//分析where子句中的所有terms
+#ifndef SQLITE_OMIT_VIRTUALTABLE
+  if( pLimit ){
+    whereAddLimitTerms(pWC, pTabList, pLimit);
+  }
+#endif
   if( db->mallocFailed ){  //如果数据库内存分配错误
     goto whereBeginError; //跳转到whereBeginError处理错误
   }
@@ -8013,7 +8873,7 @@ WhereInfo *sqlite3WhereBegin(
         if( IsVirtual(pTabItem->pTab) ){ //判断表是否为虚表
           sqlite3_index_info **pp = &pWInfo->a[j].pIdxInfo; //初始化**pp
           bestVirtualIndex(pParse, pWC, pTabItem, mask, notReady, pOrderBy,
-                           &sCost, pp); //获得虚表的最佳索引
+                           pDist, &sCost, pp); //获得虚表的最佳索引
         }else 
 #endif
         {
@@ -8125,6 +8985,7 @@ WhereInfo *sqlite3WhereBegin(
     }else{
       pLevel->iIdxCur = -1;
     }
+    whereIndexAdvice(pParse, pWC, &pTabList->a[bestJ], notReady, &bestPlan);
     notReady &= ~getMask(pMaskSet, pTabList->a[bestJ].iCursor);
     pLevel->iFrom = (u8)bestJ;
     if( bestPlan.plan.nRow>=(double)1 ){
@@ -8292,6 +9153,15 @@ WhereInfo *sqlite3WhereBegin(
     explainOneScan(pParse, pTabList, pLevel, i, pLevel->iFrom, wctrlFlags);
     notReady = codeOneLoopStart(pWInfo, i, wctrlFlags, notReady);
     pWInfo->iContinue = pLevel->addrCont;
+#ifndef SQLITE_OMIT_STMT_SCANSTATUS
+    if( pLevel->iScan ){
+      int addrOut = sqlite3VdbeCurrentAddr(v);
+      int isLoop = pLevel->op==OP_Next || pLevel->op==OP_Prev
+                || pLevel->op==OP_VNext;
+      sqlite3VdbeScanStatusVisit(v, pLevel->iScan,
+          isLoop ? pLevel->p2 : addrOut, addrOut);
+    }
+#endif
   }
 
 #ifdef SQLITE_TEST  /* For testing and debugging use only 只用于测试和调试 */
@@ -8411,7 +9281,9 @@ void sqlite3WhereEnd(WhereInfo *pWInfo){
       sqlite3VdbeAddOp2(v, pLevel->op, pLevel->p1, pLevel->p2);
       sqlite3VdbeChangeP5(v, pLevel->p5);
     }
-    if( pLevel->plan.wsFlags & WHERE_IN_ABLE && pLevel->u.in.nIn>0 ){
+    if( (pLevel->plan.wsFlags & (WHERE_IN_ABLE|WHERE_VIRTUALTABLE))!=0
+     && pLevel->u.in.nIn>0
+    ){
       struct InLoop *pIn;
       int j;
       sqlite3VdbeResolveLabel(v, pLevel->addrNxt);
@@ -8423,6 +9295,24 @@ void sqlite3WhereEnd(WhereInfo *pWInfo){
       sqlite3DbFree(db, pLevel->u.in.aInLoop);
     }
     sqlite3VdbeResolveLabel(v, pLevel->addrBrk);
+#ifndef SQLITE_OMIT_CARD_FEEDBACK
+    /* The OP_Noop runs once each time the loop runs to completion.  The
+    ** "break" label of the entire WHERE clause, used by LIMIT, is past
+    ** the end of the outer loop, so abandoned loops are not counted. */
+    if( pLevel->iScan && db->bCardFeedback
+     && (pLevel->op==OP_Next || pLevel->op==OP_Prev)
+    ){
+      u32 wsFlags = pLevel->plan.wsFlags;
+      char *zKey = whereFeedbackKey(db, pTabList->a[pLevel->iFrom].pTab,
+          (wsFlags & WHERE_INDEXED) ? pLevel->plan.u.pIdx : 0,
+          pLevel->plan.nEq, wsFlags
+      );
+      if( zKey ){
+        int addrDone = sqlite3VdbeAddOp0(v, OP_Noop);
+        sqlite3VdbeScanFeedback(v, pLevel->iScan, addrDone, zKey);
+      }
+    }
+#endif
     if( pLevel->iLeftJoin ){
       int addr;
       addr = sqlite3VdbeAddOp1(v, OP_IfPos, pLevel->iLeftJoin);
@@ -8441,6 +9331,7 @@ void sqlite3WhereEnd(WhereInfo *pWInfo){
       }
       sqlite3VdbeJumpHere(v, addr);
     }
+    sqlite3VdbeScanStatusEnd(v, pLevel->iScan, sqlite3VdbeCurrentAddr(v));
   }
 
   /* The "break" point is here, just past the end of the outer loop.